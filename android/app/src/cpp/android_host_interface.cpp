@@ -185,6 +185,11 @@ void AndroidHostInterface::ReportMessage(const char* message)
   env->DeleteLocalRef(message_jstr);
 }
 
+void AndroidHostInterface::RunLater(std::function<void()> callback)
+{
+  RunOnEmulationThread(std::move(callback), false);
+}
+
 std::string AndroidHostInterface::GetStringSettingValue(const char* section, const char* key, const char* default_value)
 {
   return m_settings_interface.GetStringValue(section, key, default_value);
@@ -448,20 +453,21 @@ void AndroidHostInterface::EmulationThreadLoop(JNIEnv* env)
         UpdateVibration();
     }
 
-    // rendering
+    // rendering, skipped frames aren't presented
+    if (!System::IsRunning() || !System::IsFrameSkipped())
     {
       DrawImGuiWindows();
 
       m_display->Render();
       ImGui::NewFrame();
+    }
 
-      if (System::IsRunning())
-      {
-        System::UpdatePerformanceCounters();
+    if (System::IsRunning())
+    {
+      System::UpdatePerformanceCounters();
 
-        if (m_throttler_enabled)
-          System::Throttle();
-      }
+      if (m_throttler_enabled)
+        System::Throttle();
     }
   }
 }
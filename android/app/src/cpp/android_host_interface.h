@@ -32,6 +32,7 @@ public:
 
   void ReportError(const char* message) override;
   void ReportMessage(const char* message) override;
+  void RunLater(std::function<void()> callback) override;
 
   std::string GetStringSettingValue(const char* section, const char* key, const char* default_value = "") override;
   bool GetBoolSettingValue(const char* section, const char* key, bool default_value = false) override;
@@ -0,0 +1,53 @@
+#include "common/latency_histogram.h"
+#include <gtest/gtest.h>
+
+using Common::LatencyHistogram;
+
+TEST(LatencyHistogram, EmptyHistogramReturnsZero)
+{
+  LatencyHistogram h;
+  ASSERT_EQ(h.GetSampleCount(), 0u);
+  ASSERT_EQ(h.GetAverage(), 0.0f);
+  ASSERT_EQ(h.GetPercentile(0.99f), 0.0f);
+}
+
+TEST(LatencyHistogram, AverageAndMaximum)
+{
+  LatencyHistogram h;
+  h.AddSample(2.0f);
+  h.AddSample(4.0f);
+  h.AddSample(9.0f);
+  ASSERT_EQ(h.GetSampleCount(), 3u);
+  ASSERT_FLOAT_EQ(h.GetAverage(), 5.0f);
+  ASSERT_FLOAT_EQ(h.GetMaximum(), 9.0f);
+}
+
+TEST(LatencyHistogram, PercentileReturnsBucketUpperEdge)
+{
+  LatencyHistogram h;
+  for (int i = 0; i < 99; i++)
+    h.AddSample(1.1f);
+  h.AddSample(20.0f);
+
+  ASSERT_FLOAT_EQ(h.GetPercentile(0.5f), 1.25f);
+  ASSERT_FLOAT_EQ(h.GetPercentile(0.99f), 1.25f);
+  ASSERT_FLOAT_EQ(h.GetPercentile(1.0f), 20.0f);
+}
+
+TEST(LatencyHistogram, OverflowReportsMaximum)
+{
+  LatencyHistogram h;
+  h.AddSample(500.0f);
+  ASSERT_EQ(h.GetBuckets()[LatencyHistogram::NUM_BUCKETS], 1u);
+  ASSERT_FLOAT_EQ(h.GetPercentile(0.5f), 500.0f);
+}
+
+TEST(LatencyHistogram, ResetClearsSamples)
+{
+  LatencyHistogram h;
+  h.AddSample(3.0f);
+  h.Reset();
+  ASSERT_EQ(h.GetSampleCount(), 0u);
+  ASSERT_EQ(h.GetMaximum(), 0.0f);
+  ASSERT_EQ(h.GetBuckets()[12], 0u);
+}
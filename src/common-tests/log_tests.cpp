@@ -0,0 +1,96 @@
+#include "common/log.h"
+#include <cinttypes>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+struct CapturedMessages
+{
+  std::vector<std::string> messages;
+
+  static void Callback(void* param, const char* channelName, const char* functionName, LOGLEVEL level,
+                       const char* message)
+  {
+    static_cast<CapturedMessages*>(param)->messages.emplace_back(message);
+  }
+};
+
+class AsyncLog : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    Log::RegisterCallback(&CapturedMessages::Callback, &m_captured);
+    Log::SetAsyncOutputParams(true);
+  }
+
+  void TearDown() override
+  {
+    Log::SetAsyncOutputParams(false);
+    Log::UnregisterCallback(&CapturedMessages::Callback, &m_captured);
+  }
+
+  CapturedMessages m_captured;
+};
+} // namespace
+
+#define CHECK_FORMAT(...)                                                                                              \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    char expected[1024];                                                                                               \
+    std::snprintf(expected, sizeof(expected), __VA_ARGS__);                                                            \
+    m_captured.messages.clear();                                                                                       \
+    Log::Writef("Test", __FUNCTION__, LOGLEVEL_INFO, __VA_ARGS__);                                                     \
+    Log::FlushAsyncOutput();                                                                                           \
+    ASSERT_EQ(m_captured.messages.size(), 1u);                                                                         \
+    ASSERT_EQ(m_captured.messages[0], expected);                                                                       \
+  } while (0)
+
+TEST_F(AsyncLog, DeferredFormatMatchesSnprintf)
+{
+  CHECK_FORMAT("plain text");
+  CHECK_FORMAT("%d %i %u %x %X %o", -1, 42, 3000000000u, 0xBEEF, 0xCAFE, 8);
+  CHECK_FORMAT("%hhu %hd %ld %lld %llx", 300, 70000, -5L, -1234567890123LL, 0xDEADBEEF12345678ULL);
+  CHECK_FORMAT("%zu %td %jd", static_cast<size_t>(12345), static_cast<ptrdiff_t>(-7), static_cast<intmax_t>(99));
+  CHECK_FORMAT("%08.3f %e %g %a %.2Lf", 3.14159, 1e-10, 0.5, 1.0, 2.5L);
+  CHECK_FORMAT("%-10s|%5.2s|%c|%%|%p", "left", "truncated", 'z', reinterpret_cast<void*>(0x1234));
+  CHECK_FORMAT("%*d|%-*.*f|%.*s", 6, 42, 8, 2, 1.5, 3, "abcdef");
+  CHECK_FORMAT("%" PRIu64 " %" PRIX32, static_cast<u64>(1) << 40, 0xABCDu);
+}
+
+TEST_F(AsyncLog, DeferredStringsAreCopied)
+{
+  m_captured.messages.clear();
+  {
+    std::string temp("temporary string");
+    Log::Writef("Test", __FUNCTION__, LOGLEVEL_INFO, "value: %s", temp.c_str());
+    temp.assign(temp.size(), 'x');
+  }
+  Log::FlushAsyncOutput();
+  ASSERT_EQ(m_captured.messages.size(), 1u);
+  ASSERT_EQ(m_captured.messages[0], "value: temporary string");
+}
+
+TEST_F(AsyncLog, ArgumentsTooLargeAreFormattedImmediately)
+{
+  const std::string long_string(1000, 'a');
+  m_captured.messages.clear();
+  Log::Writef("Test", __FUNCTION__, LOGLEVEL_INFO, "%s", long_string.c_str());
+  Log::FlushAsyncOutput();
+  ASSERT_EQ(m_captured.messages.size(), 1u);
+
+  // falls back to formatting into the queue entry, which truncates
+  ASSERT_FALSE(m_captured.messages[0].empty());
+  ASSERT_EQ(m_captured.messages[0], long_string.substr(0, m_captured.messages[0].size()));
+}
+
+TEST_F(AsyncLog, DisablingDeliversQueuedMessages)
+{
+  m_captured.messages.clear();
+  Log::Writef("Test", __FUNCTION__, LOGLEVEL_INFO, "queued %d", 1);
+  Log::SetAsyncOutputParams(false);
+  ASSERT_EQ(m_captured.messages.size(), 1u);
+  ASSERT_EQ(m_captured.messages[0], "queued 1");
+}
@@ -0,0 +1,159 @@
+#include "common/byte_stream.h"
+#include "common/state_wrapper.h"
+#include <array>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class TestEnum : u8
+{
+  A,
+  B,
+  C
+};
+
+// Roughly the shape of a full system state - a few large memory blocks plus lots of small registers.
+struct TestState
+{
+  static constexpr u32 RAM_SIZE = 2048 * 1024;
+  static constexpr u32 VRAM_SIZE = 1024 * 512 * sizeof(u16);
+  static constexpr u32 SPU_RAM_SIZE = 512 * 1024;
+  static constexpr u32 NUM_REGISTERS = 4096;
+
+  std::vector<u8> ram = std::vector<u8>(RAM_SIZE);
+  std::vector<u8> vram = std::vector<u8>(VRAM_SIZE);
+  std::vector<u8> spu_ram = std::vector<u8>(SPU_RAM_SIZE);
+  std::array<u32, NUM_REGISTERS> registers = {};
+  std::array<s16, 128> samples = {};
+  std::string name;
+  TestEnum mode = TestEnum::A;
+  bool flag = false;
+  float volume = 0.0f;
+
+  void Fill(u32 seed)
+  {
+    u32 value = seed;
+    const auto next = [&value]() {
+      value = value * 1103515245u + 12345u;
+      return value;
+    };
+
+    for (u8& b : ram)
+      b = static_cast<u8>(next() >> 16);
+    for (u8& b : vram)
+      b = static_cast<u8>(next() >> 16);
+    for (u8& b : spu_ram)
+      b = static_cast<u8>(next() >> 16);
+    for (u32& reg : registers)
+      reg = next();
+    for (s16& sample : samples)
+      sample = static_cast<s16>(next());
+
+    name = "state " + std::to_string(seed);
+    mode = TestEnum::C;
+    flag = true;
+    volume = 0.5f;
+  }
+
+  bool DoState(StateWrapper& sw)
+  {
+    if (!sw.DoMarker("TestState"))
+      return false;
+
+    sw.DoBytes(ram.data(), ram.size());
+    sw.DoBytes(vram.data(), vram.size());
+    sw.DoBytes(spu_ram.data(), spu_ram.size());
+
+    // individual fields, like most of the components
+    for (u32& reg : registers)
+      sw.Do(&reg);
+
+    sw.Do(&samples);
+    sw.Do(&name);
+    sw.Do(&mode);
+    sw.Do(&flag);
+    sw.Do(&volume);
+    return !sw.HasError();
+  }
+
+  bool operator==(const TestState& rhs) const
+  {
+    return (ram == rhs.ram && vram == rhs.vram && spu_ram == rhs.spu_ram && registers == rhs.registers &&
+            samples == rhs.samples && name == rhs.name && mode == rhs.mode && flag == rhs.flag &&
+            volume == rhs.volume);
+  }
+};
+
+} // namespace
+
+TEST(StateWrapper, MeasureMatchesStreamSize)
+{
+  TestState state;
+  state.Fill(1);
+
+  StateWrapper measure_sw(nullptr, 0, StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(measure_sw.IsMeasuring());
+  ASSERT_TRUE(state.DoState(measure_sw));
+
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream_CreateGrowableMemoryStream();
+  StateWrapper stream_sw(stream.get(), StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(state.DoState(stream_sw));
+  ASSERT_EQ(measure_sw.GetBufferPosition(), static_cast<u32>(stream->GetSize()));
+}
+
+TEST(StateWrapper, BufferMatchesStreamFormat)
+{
+  TestState state;
+  state.Fill(2);
+
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream_CreateGrowableMemoryStream();
+  StateWrapper stream_sw(stream.get(), StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(state.DoState(stream_sw));
+
+  std::vector<u8> buffer(static_cast<size_t>(stream->GetSize()));
+  StateWrapper buffer_sw(buffer.data(), static_cast<u32>(buffer.size()), StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(state.DoState(buffer_sw));
+  ASSERT_EQ(buffer_sw.GetBufferPosition(), static_cast<u32>(buffer.size()));
+  ASSERT_EQ(std::memcmp(buffer.data(), stream->GetMemoryPointer(), buffer.size()), 0);
+
+  // states saved through one path must load through the other
+  TestState loaded;
+  StateWrapper read_sw(buffer.data(), static_cast<u32>(buffer.size()), StateWrapper::Mode::Read, 1);
+  ASSERT_TRUE(loaded.DoState(read_sw));
+  ASSERT_TRUE(loaded == state);
+}
+
+TEST(StateWrapper, BufferOverflowIsError)
+{
+  TestState state;
+  state.Fill(3);
+
+  std::vector<u8> buffer(TestState::RAM_SIZE);
+  StateWrapper write_sw(buffer.data(), static_cast<u32>(buffer.size()), StateWrapper::Mode::Write, 1);
+  ASSERT_FALSE(state.DoState(write_sw));
+
+  StateWrapper read_sw(buffer.data(), static_cast<u32>(buffer.size()), StateWrapper::Mode::Read, 1);
+  ASSERT_FALSE(state.DoState(read_sw));
+}
+
+TEST(StateWrapper, ResetBufferRoundTrip)
+{
+  TestState state;
+  state.Fill(4);
+
+  StateWrapper measure_sw(nullptr, 0, StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(state.DoState(measure_sw));
+
+  std::vector<u8> buffer(measure_sw.GetBufferPosition());
+  StateWrapper sw(buffer.data(), static_cast<u32>(buffer.size()), StateWrapper::Mode::Write, 1);
+  ASSERT_TRUE(state.DoState(sw));
+
+  TestState loaded;
+  sw.ResetBuffer(StateWrapper::Mode::Read);
+  ASSERT_TRUE(loaded.DoState(sw));
+  ASSERT_TRUE(loaded == state);
+}
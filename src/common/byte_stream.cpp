@@ -17,6 +17,7 @@
 #else
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
 
 Log_SetChannel(ByteStream);
@@ -255,9 +256,10 @@ protected:
 class AtomicUpdatedFileByteStream : public FileByteStream
 {
 public:
-  AtomicUpdatedFileByteStream(FILE* pFile, const char* originalFileName, const char* temporaryFileName)
-    : FileByteStream(pFile), m_committed(false), m_discarded(false), m_originalFileName(originalFileName),
-      m_temporaryFileName(temporaryFileName)
+  AtomicUpdatedFileByteStream(FILE* pFile, const char* originalFileName, const char* temporaryFileName,
+                              bool syncOnCommit)
+    : FileByteStream(pFile), m_committed(false), m_discarded(false), m_syncOnCommit(syncOnCommit),
+      m_originalFileName(originalFileName), m_temporaryFileName(temporaryFileName)
   {
   }
 
@@ -308,6 +310,15 @@ public:
 
     fflush(m_pFile);
 
+    // without this, a crash after the rename can leave the file empty on some filesystems
+    if (m_syncOnCommit && !SyncToDisk())
+    {
+      Log_WarningPrintf("AtomicUpdatedFileByteStream::Commit(): Failed to sync temporary file '%s'",
+                        m_temporaryFileName.c_str());
+      m_discarded = true;
+      return false;
+    }
+
 #ifdef WIN32
     // move the atomic file name to the original file name
     if (!MoveFileExW(StringUtil::UTF8StringToWideString(m_temporaryFileName).c_str(),
@@ -346,8 +357,18 @@ public:
   }
 
 private:
+  bool SyncToDisk()
+  {
+#ifdef WIN32
+    return (_commit(_fileno(m_pFile)) == 0);
+#else
+    return (fsync(fileno(m_pFile)) == 0);
+#endif
+  }
+
   bool m_committed;
   bool m_discarded;
+  bool m_syncOnCommit;
   std::string m_originalFileName;
   std::string m_temporaryFileName;
 };
@@ -1031,7 +1052,8 @@ std::unique_ptr<ByteStream> ByteStream_OpenFileStream(const char* fileName, u32
 
     // create the stream pointer
     std::unique_ptr<AtomicUpdatedFileByteStream> pStream =
-      std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName);
+      std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName,
+                                                    (openMode & BYTESTREAM_OPEN_SYNC_ON_COMMIT) != 0);
 
     // do we need to copy the existing file into this one?
     if (!(openMode & BYTESTREAM_OPEN_TRUNCATE))
@@ -1212,7 +1234,8 @@ std::unique_ptr<ByteStream> ByteStream_OpenFileStream(const char* fileName, u32
 
     // create the stream pointer
     std::unique_ptr<AtomicUpdatedFileByteStream> pStream =
-      std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName);
+      std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName,
+                                                    (openMode & BYTESTREAM_OPEN_SYNC_ON_COMMIT) != 0);
 
     // do we need to copy the existing file into this one?
     if (!(openMode & BYTESTREAM_OPEN_TRUNCATE))
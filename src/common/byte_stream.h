@@ -14,6 +14,7 @@ enum BYTESTREAM_OPEN_MODE
   BYTESTREAM_OPEN_ATOMIC_UPDATE = 64, //
   BYTESTREAM_OPEN_SEEKABLE = 128,
   BYTESTREAM_OPEN_STREAMED = 256,
+  BYTESTREAM_OPEN_SYNC_ON_COMMIT = 512, // flush atomic updates through to the disk before renaming
 };
 
 // interface class used by readers, writers, etc.
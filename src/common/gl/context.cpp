@@ -17,6 +17,7 @@ Log_SetChannel(GL::Context);
 
 #ifdef USE_EGL
 #if defined(USE_X11) || defined(USE_WAYLAND)
+#include "context_egl.h"
 #if defined(USE_X11)
 #include "context_egl_x11.h"
 #endif
@@ -105,6 +106,12 @@ std::unique_ptr<GL::Context> Context::Create(const WindowInfo& wi, const Version
     context = ContextEGLWayland::Create(wi, versions_to_try, num_versions_to_try);
 #endif
 
+#if defined(USE_EGL) && (defined(USE_X11) || defined(USE_WAYLAND))
+  // No window, e.g. running headless. Doesn't need a display server when the driver supports surfaceless platforms.
+  if (wi.type == WindowInfo::Type::Surfaceless)
+    context = ContextEGL::Create(wi, versions_to_try, num_versions_to_try);
+#endif
+
   if (!context)
     return nullptr;
 
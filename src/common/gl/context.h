@@ -40,6 +40,9 @@ public:
   virtual bool SetSwapInterval(s32 interval) = 0;
   virtual std::unique_ptr<Context> CreateSharedContext(const WindowInfo& wi) = 0;
 
+  /// Returns true if ChangeSurface() can switch to a surfaceless window, e.g. to leave the window to a shared context.
+  virtual bool SupportsSurfaceless() const { return false; }
+
   static std::unique_ptr<Context> Create(const WindowInfo& wi, const Version* versions_to_try,
                                          size_t num_versions_to_try);
 
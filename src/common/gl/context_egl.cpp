@@ -33,7 +33,22 @@ bool ContextEGL::Initialize(const Version* versions_to_try, size_t num_versions_
     return false;
   }
 
-  m_display = eglGetDisplay(static_cast<EGLNativeDisplayType>(m_wi.display_connection));
+  m_display = EGL_NO_DISPLAY;
+  if (m_wi.type == WindowInfo::Type::Surfaceless && !m_wi.display_connection)
+  {
+    // Render nodes can be used without a display server through the surfaceless platform.
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (client_extensions && std::strstr(client_extensions, "EGL_MESA_platform_surfaceless") &&
+        eglGetPlatformDisplayEXT)
+    {
+      m_display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+      if (m_display)
+        Log_InfoPrintf("Using EGL surfaceless platform");
+    }
+  }
+
+  if (!m_display)
+    m_display = eglGetDisplay(static_cast<EGLNativeDisplayType>(m_wi.display_connection));
   if (!m_display)
   {
     Log_ErrorPrintf("eglGetDisplay() failed: %d", eglGetError());
@@ -228,7 +243,7 @@ bool ContextEGL::CreateContext(const Version& version, EGLContext share_context)
                                       ((version.major_version == 2) ? EGL_OPENGL_ES2_BIT : EGL_OPENGL_ES_BIT)) :
       EGL_OPENGL_BIT,
     EGL_SURFACE_TYPE,
-    (m_wi.type != WindowInfo::Type::Surfaceless) ? EGL_WINDOW_BIT : 0,
+    (m_wi.type != WindowInfo::Type::Surfaceless) ? EGL_WINDOW_BIT : (m_supports_surfaceless ? 0 : EGL_PBUFFER_BIT),
   };
   int nsurface_attribs = 4;
 
@@ -21,6 +21,7 @@ public:
   bool DoneCurrent() override;
   bool SetSwapInterval(s32 interval) override;
   virtual std::unique_ptr<Context> CreateSharedContext(const WindowInfo& wi) override;
+  bool SupportsSurfaceless() const override { return true; }
 
 protected:
   virtual EGLNativeWindowType GetNativeWindow(EGLConfig config);
@@ -4,6 +4,7 @@
 #include "../string_util.h"
 #include <array>
 #include <fstream>
+#include <utility>
 Log_SetChannel(GL);
 
 namespace GL {
@@ -121,6 +122,30 @@ bool Program::Compile(const std::string_view vertex_shader, const std::string_vi
   return true;
 }
 
+void Program::StartCompile(const std::string_view vertex_shader, const std::string_view geometry_shader,
+                           const std::string_view fragment_shader)
+{
+  m_program_id = glCreateProgram();
+
+  const std::array<std::pair<GLenum, std::string_view>, 3> stages = {
+    {{GL_VERTEX_SHADER, vertex_shader}, {GL_GEOMETRY_SHADER, geometry_shader}, {GL_FRAGMENT_SHADER, fragment_shader}}};
+  for (const auto& [type, source] : stages)
+  {
+    if (source.empty())
+      continue;
+
+    const GLuint id = glCreateShader(type);
+    const GLchar* source_ptr = source.data();
+    const GLint source_length = static_cast<GLint>(source.size());
+    glShaderSource(id, 1, &source_ptr, &source_length);
+    glCompileShader(id);
+    glAttachShader(m_program_id, id);
+
+    // only flagged for deletion while attached, a failed compile shows up in the link status
+    glDeleteShader(id);
+  }
+}
+
 bool Program::CreateFromBinary(const void* data, u32 data_length, u32 data_format)
 {
   GLuint prog = glCreateProgram();
@@ -208,6 +233,12 @@ void Program::BindFragDataIndexed(GLuint color_number /*= 0*/, const char* name
 }
 
 bool Program::Link()
+{
+  StartLink();
+  return FinishLink();
+}
+
+void Program::StartLink()
 {
   glLinkProgram(m_program_id);
 
@@ -217,7 +248,20 @@ bool Program::Link()
   if (m_fragment_shader_id != 0)
     glDeleteShader(m_fragment_shader_id);
   m_fragment_shader_id = 0;
+}
 
+bool Program::IsLinkComplete() const
+{
+  if (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile)
+    return true;
+
+  GLint status = GL_FALSE;
+  glGetProgramiv(m_program_id, GL_COMPLETION_STATUS_KHR, &status);
+  return (status == GL_TRUE);
+}
+
+bool Program::FinishLink()
+{
   GLint status = GL_FALSE;
   glGetProgramiv(m_program_id, GL_LINK_STATUS, &status);
 
@@ -237,6 +281,26 @@ bool Program::Link()
     else
     {
       Log_ErrorPrintf("Program failed to link:\n%s", info_log.c_str());
+
+      // shaders from StartCompile() haven't been checked yet
+      std::array<GLuint, 3> shaders;
+      GLsizei num_shaders = 0;
+      glGetAttachedShaders(m_program_id, static_cast<GLsizei>(shaders.size()), &num_shaders, shaders.data());
+      for (GLsizei i = 0; i < num_shaders; i++)
+      {
+        GLint shader_status = GL_TRUE;
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &shader_status);
+        if (shader_status == GL_TRUE)
+          continue;
+
+        GLint shader_info_log_length = 0;
+        glGetShaderiv(shaders[i], GL_INFO_LOG_LENGTH, &shader_info_log_length);
+        std::string shader_info_log;
+        shader_info_log.resize(shader_info_log_length + 1);
+        glGetShaderInfoLog(shaders[i], shader_info_log_length, &shader_info_log_length, &shader_info_log[0]);
+        Log_ErrorPrintf("Shader failed to compile:\n%s", shader_info_log.c_str());
+      }
+
       glDeleteProgram(m_program_id);
       m_program_id = 0;
       return false;
@@ -22,6 +22,10 @@ public:
   bool Compile(const std::string_view vertex_shader, const std::string_view geometry_shader,
                const std::string_view fragment_shader);
 
+  /// Like Compile(), but doesn't wait for the shaders to compile. Errors are reported by FinishLink().
+  void StartCompile(const std::string_view vertex_shader, const std::string_view geometry_shader,
+                    const std::string_view fragment_shader);
+
   bool CreateFromBinary(const void* data, u32 data_length, u32 data_format);
 
   bool GetBinary(std::vector<u8>* out_data, u32* out_data_format);
@@ -35,6 +39,12 @@ public:
 
   bool Link();
 
+  /// Asynchronous linking, split into StartLink() and FinishLink(). With KHR/ARB_parallel_shader_compile, the driver
+  /// compiles and links on its own threads, and IsLinkComplete() can be polled without blocking.
+  void StartLink();
+  bool IsLinkComplete() const;
+  bool FinishLink();
+
   void Bind() const;
 
   void Destroy();
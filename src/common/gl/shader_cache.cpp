@@ -322,13 +322,19 @@ std::optional<Program> ShaderCache::CompileAndAddProgram(const CacheIndexKey& ke
   if (!prog)
     return std::nullopt;
 
+  AddProgram(key, *prog);
+  return prog;
+}
+
+void ShaderCache::AddProgram(const CacheIndexKey& key, Program& prog)
+{
   std::vector<u8> prog_data;
   u32 prog_format = 0;
-  if (!prog->GetBinary(&prog_data, &prog_format))
-    return std::nullopt;
+  if (!prog.GetBinary(&prog_data, &prog_format))
+    return;
 
   if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
-    return prog;
+    return;
 
   CacheIndexData data;
   data.file_offset = static_cast<u32>(std::ftell(m_blob_file));
@@ -354,11 +360,45 @@ std::optional<Program> ShaderCache::CompileAndAddProgram(const CacheIndexKey& ke
       std::fflush(m_index_file) != 0)
   {
     Log_ErrorPrintf("Failed to write shader blob to file");
-    return prog;
+    return;
   }
 
   m_index.emplace(key, data);
-  return prog;
+}
+
+std::optional<Program> ShaderCache::GetProgramAsync(const std::string_view vertex_shader,
+                                                    const std::string_view geometry_shader,
+                                                    const std::string_view fragment_shader,
+                                                    const PreLinkCallback& callback, bool* pending)
+{
+  *pending = false;
+
+  const bool use_cache = (m_program_binary_supported && m_blob_file);
+  if (use_cache && m_index.find(GetCacheKey(vertex_shader, geometry_shader, fragment_shader)) != m_index.end())
+    return GetProgram(vertex_shader, geometry_shader, fragment_shader, callback);
+
+  Program prog;
+  prog.StartCompile(vertex_shader, geometry_shader, fragment_shader);
+  if (callback)
+    callback(prog);
+  if (use_cache)
+    prog.SetBinaryRetrievableHint();
+  prog.StartLink();
+
+  *pending = true;
+  return std::optional<Program>(std::move(prog));
+}
+
+bool ShaderCache::FinishProgram(Program& prog, const std::string_view vertex_shader,
+                                const std::string_view geometry_shader, const std::string_view fragment_shader)
+{
+  if (!prog.FinishLink())
+    return false;
+
+  if (m_program_binary_supported && m_blob_file)
+    AddProgram(GetCacheKey(vertex_shader, geometry_shader, fragment_shader), prog);
+
+  return true;
 }
 
 } // namespace GL
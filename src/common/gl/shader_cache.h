@@ -25,6 +25,14 @@ public:
   std::optional<Program> GetProgram(const std::string_view vertex_shader, const std::string_view geometry_shader,
                                     const std::string_view fragment_shader, const PreLinkCallback& callback = {});
 
+  /// Like GetProgram(), but programs which aren't in the cache are returned still linking, with *pending set. Those
+  /// must be passed to FinishProgram() with the same sources, which waits for the link and adds them to the cache.
+  std::optional<Program> GetProgramAsync(const std::string_view vertex_shader, const std::string_view geometry_shader,
+                                         const std::string_view fragment_shader, const PreLinkCallback& callback,
+                                         bool* pending);
+  bool FinishProgram(Program& prog, const std::string_view vertex_shader, const std::string_view geometry_shader,
+                     const std::string_view fragment_shader);
+
 private:
   static constexpr u32 FILE_VERSION = 3;
 
@@ -82,6 +90,7 @@ private:
   std::optional<Program> CompileAndAddProgram(const CacheIndexKey& key, const std::string_view& vertex_shader,
                                               const std::string_view& geometry_shader,
                                               const std::string_view& fragment_shader, const PreLinkCallback& callback);
+  void AddProgram(const CacheIndexKey& key, Program& prog);
 
   std::string m_base_path;
   std::FILE* m_index_file = nullptr;
@@ -29,6 +29,21 @@ bool LoadImageFromFile(Common::RGBA8Image* image, const char* filename)
   return true;
 }
 
+bool GetImageInfoFromFile(const char* filename, u32* width, u32* height)
+{
+  auto fp = FileSystem::OpenManagedCFile(filename, "rb");
+  if (!fp)
+    return false;
+
+  int image_width, image_height, file_channels;
+  if (!stbi_info_from_file(fp.get(), &image_width, &image_height, &file_channels))
+    return false;
+
+  *width = static_cast<u32>(image_width);
+  *height = static_cast<u32>(image_height);
+  return true;
+}
+
 bool LoadImageFromBuffer(Common::RGBA8Image* image, const void* buffer, std::size_t buffer_size)
 {
   int width, height, file_channels;
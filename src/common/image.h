@@ -93,6 +93,9 @@ private:
 using RGBA8Image = Image<u32>;
 
 bool LoadImageFromFile(Common::RGBA8Image* image, const char* filename);
+
+/// Reads the dimensions of an image from its header, without decoding it.
+bool GetImageInfoFromFile(const char* filename, u32* width, u32* height);
 bool LoadImageFromBuffer(Common::RGBA8Image* image, const void* buffer, std::size_t buffer_size);
 bool WriteImageToFile(const Common::RGBA8Image& image, const char* filename);
 
@@ -0,0 +1,52 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Common {
+
+LatencyHistogram::LatencyHistogram()
+{
+  Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+  m_buckets.fill(0);
+  m_total = 0.0;
+  m_maximum = 0.0f;
+  m_sample_count = 0;
+}
+
+void LatencyHistogram::AddSample(float ms)
+{
+  ms = std::max(ms, 0.0f);
+
+  const u32 bucket = std::min(static_cast<u32>(ms / BUCKET_WIDTH_MS), NUM_BUCKETS);
+  m_buckets[bucket]++;
+  m_total += ms;
+  m_maximum = std::max(m_maximum, ms);
+  m_sample_count++;
+}
+
+float LatencyHistogram::GetPercentile(float fraction) const
+{
+  if (m_sample_count == 0)
+    return 0.0f;
+
+  // smallest number of samples which covers the fraction, at least one so zero returns the first non-empty bucket.
+  // done in single precision, widening e.g. 0.99f to double would round 99 of 100 samples up to 100.
+  const u32 target =
+    std::clamp<u32>(static_cast<u32>(std::ceil(fraction * static_cast<float>(m_sample_count))), 1, m_sample_count);
+
+  u32 count = 0;
+  for (u32 i = 0; i < NUM_BUCKETS; i++)
+  {
+    count += m_buckets[i];
+    if (count >= target)
+      return std::min(static_cast<float>(i + 1) * BUCKET_WIDTH_MS, m_maximum);
+  }
+
+  return m_maximum;
+}
+
+} // namespace Common
@@ -0,0 +1,41 @@
+#pragma once
+#include "types.h"
+#include <array>
+
+namespace Common {
+
+/// Fixed-resolution histogram of durations in milliseconds, for frame timing statistics. Samples past the last bucket
+/// are counted in an overflow bucket, so percentiles which land there report the largest sample instead.
+class LatencyHistogram
+{
+public:
+  static constexpr u32 NUM_BUCKETS = 256;
+  static constexpr float BUCKET_WIDTH_MS = 0.25f;
+
+  using BucketArray = std::array<u32, NUM_BUCKETS + 1>;
+
+  LatencyHistogram();
+
+  ALWAYS_INLINE u32 GetSampleCount() const { return m_sample_count; }
+  ALWAYS_INLINE float GetMaximum() const { return m_maximum; }
+  ALWAYS_INLINE float GetAverage() const
+  {
+    return (m_sample_count > 0) ? static_cast<float>(m_total / static_cast<double>(m_sample_count)) : 0.0f;
+  }
+  ALWAYS_INLINE const BucketArray& GetBuckets() const { return m_buckets; }
+
+  void Reset();
+  void AddSample(float ms);
+
+  /// Returns the upper edge of the bucket which holds the given fraction of samples, e.g. 0.99 for the 99th
+  /// percentile, or zero if there are no samples.
+  float GetPercentile(float fraction) const;
+
+private:
+  BucketArray m_buckets;
+  double m_total;
+  float m_maximum;
+  u32 m_sample_count;
+};
+
+} // namespace Common
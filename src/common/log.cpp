@@ -3,8 +3,14 @@
 #include "file_system.h"
 #include "string.h"
 #include "timer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #if defined(WIN32)
@@ -33,6 +39,9 @@ static LOGLEVEL s_filter_level = LOGLEVEL_TRACE;
 
 static Common::Timer::Value s_startTimeStamp = Common::Timer::GetValue();
 
+// messages written from the async thread carry the time they were queued, not the time they were written
+static thread_local Common::Timer::Value s_async_message_timestamp = 0;
+
 static bool s_consoleOutputEnabled = false;
 static String s_consoleOutputChannelFilter;
 static LOGLEVEL s_consoleOutputLevelFilter = LOGLEVEL_TRACE;
@@ -93,6 +102,13 @@ static void ExecuteCallbacks(const char* channelName, const char* functionName,
     callback.Function(callback.Parameter, channelName, functionName, level, message);
 }
 
+static float GetMessageTime()
+{
+  const Common::Timer::Value timestamp =
+    (s_async_message_timestamp != 0) ? s_async_message_timestamp : Common::Timer::GetValue();
+  return static_cast<float>(Common::Timer::ConvertValueToSeconds(timestamp - s_startTimeStamp));
+}
+
 static void FormatLogMessageForDisplay(const char* channelName, const char* functionName, LOGLEVEL level,
                                        const char* message, void (*printCallback)(const char*, void*),
                                        void* pCallbackUserData, bool timestamp = true)
@@ -100,8 +116,7 @@ static void FormatLogMessageForDisplay(const char* channelName, const char* func
   if (timestamp)
   {
     // find time since start of process
-    float messageTime =
-      static_cast<float>(Common::Timer::ConvertValueToSeconds(Common::Timer::GetValue() - s_startTimeStamp));
+    float messageTime = GetMessageTime();
 
     // write prefix
     char prefix[256];
@@ -439,8 +454,7 @@ static void FileOutputLogCallback(void* pUserParam, const char* channelName, con
   if (s_fileOutputTimestamp)
   {
     // find time since start of process
-    float messageTime =
-      static_cast<float>(Common::Timer::ConvertValueToSeconds(Common::Timer::GetValue() - s_startTimeStamp));
+    float messageTime = GetMessageTime();
 
     // write prefix
     if (level <= LOGLEVEL_PERF)
@@ -498,6 +512,610 @@ void SetFileOutputParams(bool enabled, const char* filename, bool timestamps /*
   s_fileOutputLevelFilter = levelFilter;
 }
 
+// Async output. Each logging thread gets its own single-producer/single-consumer ring of fixed-size messages, so
+// queueing a message is a copy into the ring and an atomic store. The ring is drained by a single thread, which
+// formats the messages and passes them on to the callbacks in timestamp order.
+struct AsyncMessage
+{
+  Common::Timer::Value timestamp;
+  const char* channel_name;
+  const char* function_name;
+  LOGLEVEL level;
+  bool deferred; // data holds the format string followed by the captured arguments, otherwise the message text
+  char data[512 - sizeof(Common::Timer::Value) - (sizeof(const char*) * 2) - sizeof(LOGLEVEL) - sizeof(bool)];
+};
+
+// Deferred formatting. The format string is copied into the message, followed by a tag and value for each argument it
+// consumes, with strings copied inline since the caller's buffer is gone by the time the message is written. Anything
+// which can't be captured this way (wide strings, %n, or not enough space) is formatted on the logging thread instead.
+enum class AsyncArgType : u8
+{
+  Int,
+  Long,
+  LongLong,
+  IntMax,
+  Size,
+  PtrDiff,
+  Double,
+  LongDouble,
+  Pointer,
+  String,
+  NullString
+};
+
+namespace {
+class AsyncArgWriter
+{
+public:
+  AsyncArgWriter(char* data, size_t size) : m_ptr(data), m_end(data + size) {}
+
+  template<typename T>
+  bool Write(AsyncArgType type, const T& value)
+  {
+    if (static_cast<size_t>(m_end - m_ptr) < (sizeof(type) + sizeof(value)))
+      return false;
+
+    std::memcpy(m_ptr, &type, sizeof(type));
+    std::memcpy(m_ptr + sizeof(type), &value, sizeof(value));
+    m_ptr += sizeof(type) + sizeof(value);
+    return true;
+  }
+
+  bool WriteString(const char* str, size_t length)
+  {
+    if (static_cast<size_t>(m_end - m_ptr) < (sizeof(AsyncArgType) + length + 1))
+      return false;
+
+    *(m_ptr++) = static_cast<char>(AsyncArgType::String);
+    std::memcpy(m_ptr, str, length);
+    m_ptr[length] = '\0';
+    m_ptr += length + 1;
+    return true;
+  }
+
+private:
+  char* m_ptr;
+  char* m_end;
+};
+
+class AsyncArgReader
+{
+public:
+  explicit AsyncArgReader(const char* data) : m_ptr(data) {}
+
+  AsyncArgType ReadType() { return static_cast<AsyncArgType>(*(m_ptr++)); }
+
+  template<typename T>
+  T Read()
+  {
+    T value;
+    std::memcpy(&value, m_ptr, sizeof(value));
+    m_ptr += sizeof(value);
+    return value;
+  }
+
+  const char* ReadString()
+  {
+    const char* str = m_ptr;
+    m_ptr += std::strlen(str) + 1;
+    return str;
+  }
+
+private:
+  const char* m_ptr;
+};
+} // namespace
+
+// Parses the conversion specifier starting after the '%' at spec, returning its length including the conversion
+// character, the length modifier, and the number of '*' widths/precisions. Returns 0 if it's not understood.
+static size_t ParseFormatSpec(const char* spec, char* conversion, char* length_mod, u32* num_stars)
+{
+  const char* p = spec;
+  *num_stars = 0;
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'')
+    p++;
+  for (u32 i = 0; i < 2; i++)
+  {
+    if (*p == '*')
+    {
+      (*num_stars)++;
+      p++;
+    }
+    else
+    {
+      while (*p >= '0' && *p <= '9')
+        p++;
+    }
+
+    if (i == 0 && *p == '.')
+      p++;
+    else
+      break;
+  }
+
+  *length_mod = 0;
+  if (p[0] == 'h' || p[0] == 'l')
+  {
+    // hh/ll are stored as H/Q
+    *length_mod = (p[1] == p[0]) ? ((p[0] == 'h') ? 'H' : 'Q') : p[0];
+    p += (p[1] == p[0]) ? 2 : 1;
+  }
+  else if (*p == 'j' || *p == 'z' || *p == 't' || *p == 'L')
+  {
+    *length_mod = *(p++);
+  }
+
+  *conversion = *p;
+  return (*p != '\0') ? static_cast<size_t>(p - spec + 1) : 0;
+}
+
+// Copies the format string and its arguments into data. Returns false if the message has to be formatted instead.
+static bool CaptureFormatArgs(char* data, size_t data_size, const char* format, va_list ap)
+{
+  const size_t format_length = std::strlen(format);
+  if (format_length >= data_size)
+    return false;
+
+  std::memcpy(data, format, format_length + 1);
+  AsyncArgWriter writer(data + format_length + 1, data_size - format_length - 1);
+
+  for (const char* p = std::strchr(format, '%'); p; p = std::strchr(p, '%'))
+  {
+    p++;
+    if (*p == '%')
+    {
+      p++;
+      continue;
+    }
+
+    char conversion, length_mod;
+    u32 num_stars;
+    const size_t spec_length = ParseFormatSpec(p, &conversion, &length_mod, &num_stars);
+    if (spec_length == 0)
+      return false;
+    p += spec_length;
+
+    for (u32 i = 0; i < num_stars; i++)
+    {
+      if (!writer.Write(AsyncArgType::Int, va_arg(ap, int)))
+        return false;
+    }
+
+    bool result;
+    switch (conversion)
+    {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      {
+        switch (length_mod)
+        {
+          case 'l':
+            result = writer.Write(AsyncArgType::Long, va_arg(ap, long));
+            break;
+          case 'Q':
+            result = writer.Write(AsyncArgType::LongLong, va_arg(ap, long long));
+            break;
+          case 'j':
+            result = writer.Write(AsyncArgType::IntMax, va_arg(ap, intmax_t));
+            break;
+          case 'z':
+            result = writer.Write(AsyncArgType::Size, va_arg(ap, size_t));
+            break;
+          case 't':
+            result = writer.Write(AsyncArgType::PtrDiff, va_arg(ap, ptrdiff_t));
+            break;
+          default:
+            // char and short are promoted to int, the h/hh modifiers truncate it again when formatted
+            result = writer.Write(AsyncArgType::Int, va_arg(ap, int));
+            break;
+        }
+      }
+      break;
+
+      case 'c':
+        result = (length_mod != 'l') && writer.Write(AsyncArgType::Int, va_arg(ap, int));
+        break;
+
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        if (length_mod == 'L')
+          result = writer.Write(AsyncArgType::LongDouble, va_arg(ap, long double));
+        else
+          result = writer.Write(AsyncArgType::Double, va_arg(ap, double));
+      }
+      break;
+
+      case 'p':
+        result = writer.Write(AsyncArgType::Pointer, va_arg(ap, void*));
+        break;
+
+      case 's':
+      {
+        if (length_mod == 'l')
+          return false;
+
+        const char* str = va_arg(ap, const char*);
+        result = str ? writer.WriteString(str, std::strlen(str)) : writer.Write(AsyncArgType::NullString, u8(0));
+      }
+      break;
+
+      default:
+        result = false;
+        break;
+    }
+
+    if (!result)
+      return false;
+  }
+
+  return true;
+}
+
+template<typename T>
+static int FormatAsyncArg(char* buffer, size_t size, const char* spec, const int* stars, u32 num_stars, T value)
+{
+  switch (num_stars)
+  {
+    case 0:
+      return std::snprintf(buffer, size, spec, value);
+    case 1:
+      return std::snprintf(buffer, size, spec, stars[0], value);
+    default:
+      return std::snprintf(buffer, size, spec, stars[0], stars[1], value);
+  }
+}
+
+// Formats a message captured by CaptureFormatArgs(). Output past the end of the buffer is truncated.
+static void FormatCapturedArgs(char* buffer, size_t buffer_size, const char* data)
+{
+  const char* format = data;
+  AsyncArgReader reader(data + std::strlen(format) + 1);
+
+  size_t pos = 0;
+  const auto advance = [&pos, buffer_size](int written) {
+    if (written > 0)
+      pos = std::min(pos + static_cast<size_t>(written), buffer_size - 1);
+  };
+
+  for (const char* p = format; *p != '\0' && pos < (buffer_size - 1);)
+  {
+    if (*p != '%' || p[1] == '%')
+    {
+      buffer[pos++] = *p;
+      p += (*p == '%') ? 2 : 1;
+      continue;
+    }
+
+    char conversion, length_mod;
+    u32 num_stars;
+    const size_t spec_length = ParseFormatSpec(p + 1, &conversion, &length_mod, &num_stars) + 1;
+
+    char spec[64];
+    if (spec_length >= countof(spec))
+      break;
+    std::memcpy(spec, p, spec_length);
+    spec[spec_length] = '\0';
+    p += spec_length;
+
+    int stars[2] = {};
+    for (u32 i = 0; i < num_stars; i++)
+    {
+      reader.ReadType();
+      stars[i] = reader.Read<int>();
+    }
+
+    char* out = buffer + pos;
+    const size_t out_size = buffer_size - pos;
+    switch (reader.ReadType())
+    {
+      case AsyncArgType::Int:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<int>()));
+        break;
+      case AsyncArgType::Long:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<long>()));
+        break;
+      case AsyncArgType::LongLong:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<long long>()));
+        break;
+      case AsyncArgType::IntMax:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<intmax_t>()));
+        break;
+      case AsyncArgType::Size:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<size_t>()));
+        break;
+      case AsyncArgType::PtrDiff:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<ptrdiff_t>()));
+        break;
+      case AsyncArgType::Double:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<double>()));
+        break;
+      case AsyncArgType::LongDouble:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<long double>()));
+        break;
+      case AsyncArgType::Pointer:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.Read<void*>()));
+        break;
+      case AsyncArgType::String:
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, reader.ReadString()));
+        break;
+      case AsyncArgType::NullString:
+        reader.Read<u8>();
+        advance(FormatAsyncArg(out, out_size, spec, stars, num_stars, static_cast<const char*>(nullptr)));
+        break;
+    }
+  }
+
+  buffer[pos] = '\0';
+}
+
+struct AsyncQueue
+{
+  explicit AsyncQueue(u32 size_) : messages(std::make_unique<AsyncMessage[]>(size_)), size(size_) {}
+
+  std::unique_ptr<AsyncMessage[]> messages;
+  u32 size;
+
+  std::atomic<u32> head{0}; // written by the producer
+  std::atomic<u32> tail{0}; // written by the consumer
+  std::atomic<u32> dropped{0};
+  std::atomic_bool orphaned{false};
+  u32 reported_dropped = 0;
+};
+
+// marks the queue for deletion once drained when the owning thread exits
+struct AsyncQueueHandle
+{
+  AsyncQueue* queue = nullptr;
+
+  ~AsyncQueueHandle()
+  {
+    if (queue)
+      queue->orphaned.store(true, std::memory_order_release);
+  }
+};
+
+static constexpr u32 MIN_ASYNC_QUEUE_SIZE = 16;
+static constexpr auto ASYNC_POLL_INTERVAL = std::chrono::milliseconds(5);
+
+static std::atomic_bool s_async_output_enabled{false};
+static u32 s_async_queue_size = 1024;
+static std::mutex s_async_mutex;
+static std::condition_variable s_async_wake_cv;
+static std::condition_variable s_async_flush_cv;
+static std::vector<std::unique_ptr<AsyncQueue>> s_async_queues;
+static u64 s_async_dropped_from_exited_threads = 0;
+static u64 s_async_flush_requests = 0;
+static u64 s_async_flush_completed = 0;
+static bool s_async_shutdown = false;
+static std::atomic_bool s_async_wake_requested{false};
+static std::thread s_async_thread;
+static thread_local AsyncQueueHandle s_async_queue_handle;
+
+static AsyncQueue* GetAsyncQueueForThread()
+{
+  if (s_async_queue_handle.queue)
+    return s_async_queue_handle.queue;
+
+  std::unique_lock<std::mutex> lock(s_async_mutex);
+  s_async_queue_handle.queue = s_async_queues.emplace_back(std::make_unique<AsyncQueue>(s_async_queue_size)).get();
+  return s_async_queue_handle.queue;
+}
+
+static AsyncMessage* BeginAsyncMessage(AsyncQueue* queue, const char* channelName, const char* functionName,
+                                       LOGLEVEL level)
+{
+  const u32 head = queue->head.load(std::memory_order_relaxed);
+  if ((head - queue->tail.load(std::memory_order_acquire)) >= queue->size)
+  {
+    queue->dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  AsyncMessage* msg = &queue->messages[head & (queue->size - 1)];
+  msg->timestamp = Common::Timer::GetValue();
+  msg->channel_name = channelName;
+  msg->function_name = functionName;
+  msg->level = level;
+  msg->deferred = false;
+  return msg;
+}
+
+static void EndAsyncMessage(AsyncQueue* queue)
+{
+  const u32 head = queue->head.load(std::memory_order_relaxed) + 1;
+  queue->head.store(head, std::memory_order_release);
+
+  // don't wait for the next poll if we're getting close to dropping messages
+  if ((head - queue->tail.load(std::memory_order_relaxed)) >= (queue->size / 2) &&
+      !s_async_wake_requested.exchange(true, std::memory_order_relaxed))
+  {
+    s_async_wake_cv.notify_one();
+  }
+}
+
+static void DrainAsyncQueues(std::unique_lock<std::mutex>& lock)
+{
+  struct QueueSnapshot
+  {
+    AsyncQueue* queue;
+    u32 head;
+  };
+
+  std::vector<QueueSnapshot> snapshots;
+  snapshots.reserve(s_async_queues.size());
+  for (const std::unique_ptr<AsyncQueue>& queue : s_async_queues)
+    snapshots.push_back({queue.get(), queue->head.load(std::memory_order_acquire)});
+
+  // callbacks can log themselves, which would need the lock to register a queue for this thread
+  lock.unlock();
+
+  std::vector<const AsyncMessage*> batch;
+  u32 dropped = 0;
+  for (QueueSnapshot& snapshot : snapshots)
+  {
+    AsyncQueue* queue = snapshot.queue;
+    for (u32 pos = queue->tail.load(std::memory_order_relaxed); pos != snapshot.head; pos++)
+      batch.push_back(&queue->messages[pos & (queue->size - 1)]);
+
+    const u32 queue_dropped = queue->dropped.load(std::memory_order_relaxed);
+    dropped += queue_dropped - queue->reported_dropped;
+    queue->reported_dropped = queue_dropped;
+  }
+
+  std::stable_sort(batch.begin(), batch.end(),
+                   [](const AsyncMessage* lhs, const AsyncMessage* rhs) { return lhs->timestamp < rhs->timestamp; });
+
+  for (const AsyncMessage* msg : batch)
+  {
+    s_async_message_timestamp = msg->timestamp;
+    if (msg->deferred)
+    {
+      char buffer[1024];
+      FormatCapturedArgs(buffer, countof(buffer), msg->data);
+      ExecuteCallbacks(msg->channel_name, msg->function_name, msg->level, buffer);
+    }
+    else
+    {
+      ExecuteCallbacks(msg->channel_name, msg->function_name, msg->level, msg->data);
+    }
+  }
+  s_async_message_timestamp = 0;
+
+  if (dropped > 0)
+  {
+    char buffer[128];
+    std::snprintf(buffer, countof(buffer), "Dropped %u log messages, queue is full", dropped);
+    ExecuteCallbacks("Log", __FUNCTION__, LOGLEVEL_WARNING, buffer);
+  }
+
+  // write the file out once per batch, instead of after every message
+  if (!batch.empty() && s_fileOutputEnabled)
+  {
+    std::lock_guard<std::mutex> guard(s_callback_mutex);
+    if (s_fileOutputHandle)
+      std::fflush(s_fileOutputHandle.get());
+  }
+
+  lock.lock();
+
+  for (const QueueSnapshot& snapshot : snapshots)
+    snapshot.queue->tail.store(snapshot.head, std::memory_order_release);
+
+  // threads which have exited can't produce any more messages, so once drained their queue can go
+  for (auto iter = s_async_queues.begin(); iter != s_async_queues.end();)
+  {
+    AsyncQueue* queue = iter->get();
+    if (queue->orphaned.load(std::memory_order_acquire) &&
+        queue->head.load(std::memory_order_acquire) == queue->tail.load(std::memory_order_relaxed))
+    {
+      s_async_dropped_from_exited_threads += queue->dropped.load(std::memory_order_relaxed);
+      iter = s_async_queues.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+}
+
+static void AsyncOutputThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(s_async_mutex);
+  for (;;)
+  {
+    s_async_wake_cv.wait_for(lock, ASYNC_POLL_INTERVAL, []() {
+      return s_async_shutdown || s_async_flush_requests != s_async_flush_completed ||
+             s_async_wake_requested.load(std::memory_order_relaxed);
+    });
+    s_async_wake_requested.store(false, std::memory_order_relaxed);
+
+    const u64 flush_request = s_async_flush_requests;
+    const bool shutdown = s_async_shutdown;
+    DrainAsyncQueues(lock);
+
+    s_async_flush_completed = flush_request;
+    s_async_flush_cv.notify_all();
+    if (shutdown)
+      break;
+  }
+}
+
+bool IsAsyncOutputEnabled()
+{
+  return s_async_output_enabled.load(std::memory_order_relaxed);
+}
+
+void SetAsyncOutputParams(bool enabled, u32 queue_size /* = 1024 */)
+{
+  std::unique_lock<std::mutex> lock(s_async_mutex);
+
+  // only applies to threads which haven't logged yet
+  u32 rounded_queue_size = MIN_ASYNC_QUEUE_SIZE;
+  while (rounded_queue_size < queue_size)
+    rounded_queue_size <<= 1;
+  s_async_queue_size = rounded_queue_size;
+
+  if (enabled == s_async_thread.joinable())
+    return;
+
+  if (enabled)
+  {
+    s_async_shutdown = false;
+    s_async_thread = std::thread(AsyncOutputThreadEntryPoint);
+    s_async_output_enabled.store(true);
+  }
+  else
+  {
+    // the thread drains everything queued before exiting
+    s_async_output_enabled.store(false);
+    s_async_shutdown = true;
+    s_async_wake_cv.notify_one();
+    lock.unlock();
+    s_async_thread.join();
+
+    // a thread which saw async output still enabled can have queued after the output thread's last drain
+    lock.lock();
+    DrainAsyncQueues(lock);
+  }
+}
+
+void FlushAsyncOutput()
+{
+  std::unique_lock<std::mutex> lock(s_async_mutex);
+  if (!s_async_thread.joinable() || std::this_thread::get_id() == s_async_thread.get_id())
+    return;
+
+  const u64 request = ++s_async_flush_requests;
+  s_async_wake_cv.notify_one();
+  s_async_flush_cv.wait(lock, [request]() { return s_async_flush_completed >= request; });
+}
+
+u64 GetAsyncDroppedMessageCount()
+{
+  std::unique_lock<std::mutex> lock(s_async_mutex);
+  u64 count = s_async_dropped_from_exited_threads;
+  for (const std::unique_ptr<AsyncQueue>& queue : s_async_queues)
+    count += queue->dropped.load(std::memory_order_relaxed);
+  return count;
+}
+
+// the thread has to be joined before the queues and sinks are destroyed at exit
+static struct AsyncOutputShutdown
+{
+  ~AsyncOutputShutdown() { SetAsyncOutputParams(false); }
+} s_async_output_shutdown;
+
 void SetFilterLevel(LOGLEVEL level)
 {
   DebugAssert(level < LOGLEVEL_COUNT);
@@ -509,6 +1127,18 @@ void Write(const char* channelName, const char* functionName, LOGLEVEL level, co
   if (level > s_filter_level)
     return;
 
+  if (s_async_output_enabled.load(std::memory_order_relaxed))
+  {
+    AsyncQueue* queue = GetAsyncQueueForThread();
+    if (AsyncMessage* msg = BeginAsyncMessage(queue, channelName, functionName, level); msg)
+    {
+      std::snprintf(msg->data, countof(msg->data), "%s", message);
+      EndAsyncMessage(queue);
+    }
+
+    return;
+  }
+
   ExecuteCallbacks(channelName, functionName, level, message);
 }
 
@@ -528,6 +1158,25 @@ void Writev(const char* channelName, const char* functionName, LOGLEVEL level, c
   if (level > s_filter_level)
     return;
 
+  if (s_async_output_enabled.load(std::memory_order_relaxed))
+  {
+    AsyncQueue* queue = GetAsyncQueueForThread();
+    if (AsyncMessage* msg = BeginAsyncMessage(queue, channelName, functionName, level); msg)
+    {
+      // leave the formatting to the output thread where possible
+      va_list apCopy;
+      va_copy(apCopy, ap);
+      msg->deferred = CaptureFormatArgs(msg->data, countof(msg->data), format, apCopy);
+      va_end(apCopy);
+      if (!msg->deferred)
+        std::vsnprintf(msg->data, countof(msg->data), format, ap);
+
+      EndAsyncMessage(queue);
+    }
+
+    return;
+  }
+
   va_list apCopy;
   va_copy(apCopy, ap);
 
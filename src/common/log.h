@@ -44,6 +44,19 @@ void SetFileOutputParams(bool enabled, const char* filename, bool timestamps = t
 // Sets global filtering level, messages below this level won't be sent to any of the logging sinks.
 void SetFilterLevel(LOGLEVEL level);
 
+// enables asynchronous output - messages are queued per-thread without locking, and sent to the sinks from a
+// background thread. formatted messages are queued as the format string and arguments and formatted on the background
+// thread, unless they use wide strings or %n, or don't fit in a queue entry, in which case they're formatted by the
+// caller. long messages are truncated, and messages are dropped instead of blocking when a queue is full.
+bool IsAsyncOutputEnabled();
+void SetAsyncOutputParams(bool enabled, u32 queue_size = 1024);
+
+// blocks until all messages queued before the call have been written.
+void FlushAsyncOutput();
+
+// returns the number of messages dropped due to full queues since the process started.
+u64 GetAsyncDroppedMessageCount();
+
 // writes a message to the log
 void Write(const char* channelName, const char* functionName, LOGLEVEL level, const char* message);
 void Writef(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, ...);
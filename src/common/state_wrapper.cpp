@@ -1,4 +1,5 @@
 #include "state_wrapper.h"
+#include "assert.h"
 #include "log.h"
 #include "string.h"
 #include <cinttypes>
@@ -10,19 +11,34 @@ StateWrapper::StateWrapper(ByteStream* stream, Mode mode, u32 version)
 {
 }
 
+StateWrapper::StateWrapper(void* buffer, u32 buffer_size, Mode mode, u32 version)
+  : m_buffer(static_cast<u8*>(buffer)), m_buffer_size(buffer ? buffer_size : UINT32_MAX), m_mode(mode),
+    m_version(version)
+{
+  // measuring only makes sense when writing
+  m_error = (!buffer && mode == Mode::Read);
+}
+
 StateWrapper::~StateWrapper() = default;
 
+void StateWrapper::ResetBuffer(Mode mode)
+{
+  DebugAssert(!m_stream);
+  m_mode = mode;
+  m_buffer_position = 0;
+  m_error = (!m_buffer && mode == Mode::Read);
+}
+
 void StateWrapper::DoBytes(void* data, size_t length)
 {
   if (m_mode == Mode::Read)
   {
-    if (m_error || (m_error |= !m_stream->Read2(data, static_cast<u32>(length))) == true)
+    if (!ReadData(data, static_cast<u32>(length)))
       std::memset(data, 0, length);
   }
   else
   {
-    if (!m_error)
-      m_error |= !m_stream->Write2(data, static_cast<u32>(length));
+    WriteData(data, static_cast<u32>(length));
   }
 }
 
@@ -31,15 +47,13 @@ void StateWrapper::Do(bool* value_ptr)
   if (m_mode == Mode::Read)
   {
     u8 value = 0;
-    if (!m_error)
-      m_error |= !m_stream->ReadByte(&value);
+    ReadData(&value, sizeof(value));
     *value_ptr = (value != 0);
   }
   else
   {
     u8 value = static_cast<u8>(*value_ptr);
-    if (!m_error)
-      m_error |= !m_stream->WriteByte(value);
+    WriteData(&value, sizeof(value));
   }
 }
 
@@ -73,8 +87,9 @@ bool StateWrapper::DoMarker(const char* marker)
   if (m_mode == Mode::Write || file_value.Compare(marker))
     return true;
 
-  Log_ErrorPrintf("Marker mismatch at offset %" PRIu64 ": found '%s' expected '%s'", m_stream->GetPosition(),
-                  file_value.GetCharArray(), marker);
+  Log_ErrorPrintf("Marker mismatch at offset %" PRIu64 ": found '%s' expected '%s'",
+                  m_stream ? m_stream->GetPosition() : static_cast<u64>(m_buffer_position), file_value.GetCharArray(),
+                  marker);
 
   return false;
 }
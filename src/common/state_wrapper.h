@@ -21,6 +21,11 @@ public:
   };
 
   StateWrapper(ByteStream* stream, Mode mode, u32 version);
+
+  /// Serializes directly into/out of a contiguous buffer, bypassing the stream interface. Running a write with a null
+  /// buffer measures the state instead, so that a buffer can be sized up front; nothing is written in this case.
+  StateWrapper(void* buffer, u32 buffer_size, Mode mode, u32 version);
+
   StateWrapper(const StateWrapper&) = delete;
   ~StateWrapper();
 
@@ -28,23 +33,29 @@ public:
   bool HasError() const { return m_error; }
   bool IsReading() const { return (m_mode == Mode::Read); }
   bool IsWriting() const { return (m_mode == Mode::Write); }
+  bool IsMeasuring() const { return (!m_stream && !m_buffer); }
   Mode GetMode() const { return m_mode; }
   void SetMode(Mode mode) { m_mode = mode; }
   u32 GetVersion() const { return m_version; }
 
+  /// Returns the number of bytes read/written so far in buffer mode.
+  u32 GetBufferPosition() const { return m_buffer_position; }
+
+  /// Switches the direction of a buffer-mode wrapper, and rewinds to the start of the buffer.
+  void ResetBuffer(Mode mode);
+
   /// Overload for integral or floating-point types. Writes bytes as-is.
   template<typename T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, int> = 0>
   void Do(T* value_ptr)
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (!ReadData(value_ptr, sizeof(T)))
         *value_ptr = static_cast<T>(0);
     }
     else
     {
-      if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+      WriteData(value_ptr, sizeof(T));
     }
   }
 
@@ -56,7 +67,7 @@ public:
     if (m_mode == Mode::Read)
     {
       TType temp;
-      if (m_error || (m_error |= !m_stream->Read2(&temp, sizeof(TType))) == true)
+      if (!ReadData(&temp, sizeof(TType)))
         temp = static_cast<TType>(0);
 
       *value_ptr = static_cast<T>(temp);
@@ -65,8 +76,7 @@ public:
     {
       TType temp;
       std::memcpy(&temp, value_ptr, sizeof(TType));
-      if (!m_error)
-        m_error |= !m_stream->Write2(&temp, sizeof(TType));
+      WriteData(&temp, sizeof(TType));
     }
   }
 
@@ -76,28 +86,38 @@ public:
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (!ReadData(value_ptr, sizeof(T)))
         std::memset(value_ptr, 0, sizeof(*value_ptr));
     }
     else
     {
-      if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+      WriteData(value_ptr, sizeof(T));
     }
   }
 
   template<typename T>
   void DoArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      Do(&values[i]);
+    // integers and floats are stored as-is, so the whole array can go in one block
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    {
+      DoBytes(values, sizeof(T) * count);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      DoBytes(values, sizeof(T) * count);
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i++)
+        Do(&values[i]);
+    }
   }
 
   template<typename T>
   void DoPODArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      DoPOD(&values[i]);
+    DoBytes(values, sizeof(T) * count);
   }
 
   void DoBytes(void* data, size_t length);
@@ -189,7 +209,57 @@ public:
   }
 
 private:
-  ByteStream* m_stream;
+  ALWAYS_INLINE bool ReadData(void* data, u32 size)
+  {
+    if (m_error)
+      return false;
+
+    if (m_stream)
+    {
+      m_error |= !m_stream->Read2(data, size);
+      return !m_error;
+    }
+
+    if ((m_buffer_size - m_buffer_position) < size)
+    {
+      m_error = true;
+      return false;
+    }
+
+    std::memcpy(data, m_buffer + m_buffer_position, size);
+    m_buffer_position += size;
+    return true;
+  }
+
+  ALWAYS_INLINE void WriteData(const void* data, u32 size)
+  {
+    if (m_error)
+      return;
+
+    if (m_stream)
+    {
+      m_error |= !m_stream->Write2(data, size);
+      return;
+    }
+
+    if (m_buffer)
+    {
+      if ((m_buffer_size - m_buffer_position) < size)
+      {
+        m_error = true;
+        return;
+      }
+
+      std::memcpy(m_buffer + m_buffer_position, data, size);
+    }
+
+    m_buffer_position += size;
+  }
+
+  ByteStream* m_stream = nullptr;
+  u8* m_buffer = nullptr;
+  u32 m_buffer_size = 0;
+  u32 m_buffer_position = 0;
   Mode m_mode;
   u32 m_version;
   bool m_error = false;
@@ -574,7 +574,7 @@ bool Context::CreateDevice(VkSurfaceKHR surface, bool enable_validation_layer, c
   }};
 
   device_info.queueCreateInfoCount = 1;
-  if (m_graphics_queue_family_index != m_present_queue_family_index)
+  if (surface && m_graphics_queue_family_index != m_present_queue_family_index)
   {
     device_info.queueCreateInfoCount = 2;
   }
@@ -815,7 +815,9 @@ void Context::WaitForFenceCounter(u64 fence_counter)
 
 void Context::WaitForGPUIdle()
 {
-  WaitForPresentComplete();
+  // the queues can't be used while waiting, and SubmitAndPresent() can be called from other threads
+  std::unique_lock<std::mutex> lock(m_present_mutex);
+  WaitForPresentComplete(lock);
   vkDeviceWaitIdle(m_device);
 }
 
@@ -939,6 +941,46 @@ void Context::DoPresent(VkSemaphore wait_semaphore, VkSwapchainKHR present_swap_
   }
 }
 
+VkResult Context::SubmitAndPresent(VkCommandBuffer command_buffer, VkFence fence, VkSemaphore wait_semaphore,
+                                   VkPipelineStageFlags wait_stage, VkSemaphore signal_semaphore,
+                                   VkSwapchainKHR present_swap_chain, uint32_t present_image_index)
+{
+  const VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                                    nullptr,
+                                    1u,
+                                    &wait_semaphore,
+                                    &wait_stage,
+                                    1u,
+                                    &command_buffer,
+                                    1u,
+                                    &signal_semaphore};
+
+  std::unique_lock<std::mutex> lock(m_present_mutex);
+  WaitForPresentComplete(lock);
+
+  VkResult res = vkQueueSubmit(m_graphics_queue, 1, &submit_info, fence);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkQueueSubmit failed: ");
+    Panic("Failed to submit command buffer.");
+  }
+
+  const VkPresentInfoKHR present_info = {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+                                         nullptr,
+                                         1,
+                                         &signal_semaphore,
+                                         1,
+                                         &present_swap_chain,
+                                         &present_image_index,
+                                         nullptr};
+
+  res = vkQueuePresentKHR(m_present_queue, &present_info);
+  if (res != VK_SUCCESS && res != VK_ERROR_OUT_OF_DATE_KHR && res != VK_SUBOPTIMAL_KHR)
+    LOG_VULKAN_ERROR(res, "vkQueuePresentKHR failed: ");
+
+  return res;
+}
+
 void Context::WaitForPresentComplete()
 {
   std::unique_lock<std::mutex> lock(m_present_mutex);
@@ -154,6 +154,12 @@ public:
                            uint32_t present_image_index = 0xFFFFFFFF, bool submit_on_thread = false);
   void MoveToNextCommandBuffer();
 
+  // Submits a command buffer which was recorded outside of the context, e.g. on a display's present thread, then
+  // presents the image. Queue access is serialized with SubmitCommandBuffer(). Returns the result of the present.
+  VkResult SubmitAndPresent(VkCommandBuffer command_buffer, VkFence fence, VkSemaphore wait_semaphore,
+                            VkPipelineStageFlags wait_stage, VkSemaphore signal_semaphore,
+                            VkSwapchainKHR present_swap_chain, uint32_t present_image_index);
+
   void ExecuteCommandBuffer(bool wait_for_completion);
   void WaitForPresentComplete();
 
@@ -369,7 +369,7 @@ bool SwapChain::CreateSwapChain()
   if (!(surface_capabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR))
     transform = surface_capabilities.currentTransform;
 
-  // Select swap chain flags, we only need a colour attachment
+  // Select swap chain flags, we need a colour attachment
   VkImageUsageFlags image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
   if (!(surface_capabilities.supportedUsageFlags & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT))
   {
@@ -377,6 +377,11 @@ bool SwapChain::CreateSwapChain()
     return false;
   }
 
+  // Copying into the images lets a display present frames which were rendered elsewhere
+  m_can_copy_to_images = (surface_capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+  if (m_can_copy_to_images)
+    image_usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
   // Store the old/current swap chain when recreating for resize
   VkSwapchainKHR old_swap_chain = m_swap_chain;
   m_swap_chain = VK_NULL_HANDLE;
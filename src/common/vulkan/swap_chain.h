@@ -33,6 +33,7 @@ public:
   ALWAYS_INLINE VkSurfaceFormatKHR GetSurfaceFormat() const { return m_surface_format; }
   ALWAYS_INLINE VkFormat GetTextureFormat() const { return m_surface_format.format; }
   ALWAYS_INLINE bool IsVSyncEnabled() const { return m_vsync_enabled; }
+  ALWAYS_INLINE bool CanCopyToImages() const { return m_can_copy_to_images; }
   ALWAYS_INLINE VkSwapchainKHR GetSwapChain() const { return m_swap_chain; }
   ALWAYS_INLINE u32 GetWidth() const { return m_width; }
   ALWAYS_INLINE u32 GetHeight() const { return m_height; }
@@ -81,6 +82,7 @@ private:
   u32 m_height = 0;
   WindowInfo m_wi;
   bool m_vsync_enabled = false;
+  bool m_can_copy_to_images = false;
 
   VkSurfaceKHR m_surface = VK_NULL_HANDLE;
   VkSurfaceFormatKHR m_surface_format = {};
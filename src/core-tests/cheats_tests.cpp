@@ -0,0 +1,293 @@
+#include "core/bus.h"
+#include "core/cheats.h"
+#include "core/cpu_core.h"
+#include <array>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+using InstructionCode = CheatCode::InstructionCode;
+
+// Codes only touch a small window, so conditionals regularly see values written by earlier instructions.
+constexpr u32 TEST_ADDRESS = 0x00100000;
+constexpr u32 TEST_WINDOW_SIZE = 32;
+constexpr u32 TEST_SCRATCHPAD_OFFSET = 0x100;
+
+class CheatCompilerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_ram.resize(Bus::RAM_SIZE);
+    m_old_ram = Bus::g_ram;
+    Bus::g_ram = m_ram.data();
+  }
+
+  void TearDown() override { Bus::g_ram = m_old_ram; }
+
+  void RandomizeMemory()
+  {
+    for (u32 i = 0; i < TEST_WINDOW_SIZE; i++)
+    {
+      m_ram[TEST_ADDRESS + i] = RandomByte();
+      CPU::g_state.dcache[TEST_SCRATCHPAD_OFFSET + i] = RandomByte();
+    }
+  }
+
+  u8 RandomByte()
+  {
+    // few enough distinct values that comparisons go both ways
+    static constexpr std::array<u8, 5> values = {{0x00, 0x01, 0x7F, 0x80, 0xFF}};
+    return values[m_rng() % values.size()];
+  }
+
+  u32 RandomValue(u32 size)
+  {
+    u32 value = 0;
+    for (u32 i = 0; i < size; i++)
+      value |= static_cast<u32>(RandomByte()) << (i * 8);
+    return value;
+  }
+
+  u32 RandomAddress(u32 size) { return TEST_ADDRESS + (m_rng() % (TEST_WINDOW_SIZE / size)) * size; }
+
+  static CheatCode::Instruction MakeInstruction(InstructionCode code, u32 address, u32 value)
+  {
+    CheatCode::Instruction inst;
+    inst.first = (static_cast<u32>(code) << 24) | (address & 0xFFFFFFu);
+    inst.second = value;
+    return inst;
+  }
+
+  void AddRandomInstruction(std::vector<CheatCode::Instruction>* instructions, bool allow_slide)
+  {
+    static constexpr std::array<InstructionCode, 12> writes = {
+      {InstructionCode::ConstantWrite8, InstructionCode::ConstantWrite16, InstructionCode::ExtConstantWrite32,
+       InstructionCode::Increment8, InstructionCode::Increment16, InstructionCode::ExtIncrement32,
+       InstructionCode::Decrement8, InstructionCode::Decrement16, InstructionCode::ExtDecrement32,
+       InstructionCode::ExtConstantBitSet16, InstructionCode::ExtConstantBitClear8,
+       InstructionCode::ExtConstantBitClear32}};
+    static constexpr std::array<InstructionCode, 12> compares = {
+      {InstructionCode::CompareEqual8, InstructionCode::CompareNotEqual8, InstructionCode::CompareLess8,
+       InstructionCode::CompareGreater8, InstructionCode::CompareEqual16, InstructionCode::CompareNotEqual16,
+       InstructionCode::CompareLess16, InstructionCode::CompareGreater16, InstructionCode::ExtCompareEqual32,
+       InstructionCode::ExtCompareNotEqual32, InstructionCode::ExtCompareLess32,
+       InstructionCode::ExtCompareGreater32}};
+
+    const auto size_of = [](InstructionCode code) -> u32 {
+      switch (code)
+      {
+        case InstructionCode::ConstantWrite8:
+        case InstructionCode::Increment8:
+        case InstructionCode::Decrement8:
+        case InstructionCode::ExtConstantBitClear8:
+        case InstructionCode::CompareEqual8:
+        case InstructionCode::CompareNotEqual8:
+        case InstructionCode::CompareLess8:
+        case InstructionCode::CompareGreater8:
+          return 1;
+
+        case InstructionCode::ExtConstantWrite32:
+        case InstructionCode::ExtIncrement32:
+        case InstructionCode::ExtDecrement32:
+        case InstructionCode::ExtConstantBitClear32:
+        case InstructionCode::ExtCompareEqual32:
+        case InstructionCode::ExtCompareNotEqual32:
+        case InstructionCode::ExtCompareLess32:
+        case InstructionCode::ExtCompareGreater32:
+        case InstructionCode::ExtSkipIfNotEqual32:
+        case InstructionCode::ExtScratchpadWrite32:
+          return 4;
+
+        default:
+          return 2;
+      }
+    };
+
+    switch (m_rng() % 10)
+    {
+      case 0:
+      case 1:
+      case 2:
+      {
+        const InstructionCode code = writes[m_rng() % writes.size()];
+        instructions->push_back(MakeInstruction(code, RandomAddress(size_of(code)), RandomValue(size_of(code))));
+      }
+      break;
+
+      case 3:
+      case 4:
+      {
+        const InstructionCode code = compares[m_rng() % compares.size()];
+        instructions->push_back(MakeInstruction(code, RandomAddress(size_of(code)), RandomValue(size_of(code))));
+      }
+      break;
+
+      case 5:
+      {
+        // skip to separator
+        const InstructionCode code = (m_rng() & 1) ? InstructionCode::SkipIfNotEqual16 :
+                                                      InstructionCode::ExtSkipIfNotEqual32;
+        instructions->push_back(MakeInstruction(code, RandomAddress(size_of(code)), RandomValue(size_of(code))));
+      }
+      break;
+
+      case 6:
+        instructions->push_back(MakeInstruction(InstructionCode::Nop, 0, 0xFFFF));
+        break;
+
+      case 7:
+      {
+        // no controllers are connected, so the buttons always read as zero
+        static constexpr std::array<InstructionCode, 3> button_compares = {
+          {InstructionCode::CompareButtons, InstructionCode::SkipIfButtonsNotEqual,
+           InstructionCode::SkipIfButtonsEqual}};
+        instructions->push_back(
+          MakeInstruction(button_compares[m_rng() % button_compares.size()], 0, (m_rng() & 1) ? 0x0000 : 0x4000));
+      }
+      break;
+
+      case 8:
+      {
+        const bool is_32bit = (m_rng() & 1) != 0;
+        const u32 offset = TEST_SCRATCHPAD_OFFSET + (m_rng() % (TEST_WINDOW_SIZE / 4)) * 4;
+        instructions->push_back(
+          MakeInstruction(is_32bit ? InstructionCode::ExtScratchpadWrite32 : InstructionCode::ScratchpadWrite16,
+                          offset, RandomValue(is_32bit ? 4 : 2)));
+      }
+      break;
+
+      case 9:
+      default:
+      {
+        if (!allow_slide)
+        {
+          instructions->push_back(MakeInstruction(InstructionCode::DelayActivation, 0, (m_rng() & 1) ? 0 : 100));
+          break;
+        }
+
+        // the whole code falls back to the interpreter
+        const u32 count = 1 + (m_rng() % 4);
+        const u32 address_increment = 1 + (m_rng() % 2);
+        CheatCode::Instruction slide = MakeInstruction(InstructionCode::Slide, 0, m_rng() % 3);
+        slide.first |= (count << 8) | (address_increment * 2);
+        instructions->push_back(slide);
+        instructions->push_back(MakeInstruction(InstructionCode::ConstantWrite16, RandomAddress(2), RandomValue(2)));
+      }
+      break;
+    }
+  }
+
+  CheatCode RandomCode(bool allow_slide)
+  {
+    CheatCode cc;
+    cc.description = "test";
+    cc.enabled = true;
+
+    const u32 count = 1 + (m_rng() % 8);
+    for (u32 i = 0; i < count; i++)
+      AddRandomInstruction(&cc.instructions, allow_slide);
+
+    return cc;
+  }
+
+  std::vector<u8> SnapshotMemory() const
+  {
+    std::vector<u8> data(m_ram.begin() + TEST_ADDRESS, m_ram.begin() + TEST_ADDRESS + TEST_WINDOW_SIZE);
+    data.insert(data.end(), CPU::g_state.dcache.begin() + TEST_SCRATCHPAD_OFFSET,
+                CPU::g_state.dcache.begin() + TEST_SCRATCHPAD_OFFSET + TEST_WINDOW_SIZE);
+    return data;
+  }
+
+  void RestoreMemory(const std::vector<u8>& data)
+  {
+    std::memcpy(&m_ram[TEST_ADDRESS], data.data(), TEST_WINDOW_SIZE);
+    std::memcpy(&CPU::g_state.dcache[TEST_SCRATCHPAD_OFFSET], data.data() + TEST_WINDOW_SIZE, TEST_WINDOW_SIZE);
+  }
+
+  void CheckEquivalence(u32 iterations, bool allow_slide)
+  {
+    static constexpr u32 FRAMES = 3;
+
+    for (u32 iteration = 0; iteration < iterations; iteration++)
+    {
+      CheatList list;
+      const u32 num_codes = 1 + (m_rng() % 4);
+      for (u32 i = 0; i < num_codes; i++)
+        list.AddCode(RandomCode(allow_slide));
+
+      RandomizeMemory();
+      const std::vector<u8> initial_memory = SnapshotMemory();
+
+      // the interpreter applies each enabled code in turn
+      for (u32 frame = 0; frame < FRAMES; frame++)
+      {
+        for (u32 i = 0; i < list.GetCodeCount(); i++)
+          list.GetCode(i).Apply();
+      }
+      const std::vector<u8> interpreted_memory = SnapshotMemory();
+
+      RestoreMemory(initial_memory);
+      for (u32 frame = 0; frame < FRAMES; frame++)
+        list.Apply();
+      const std::vector<u8> compiled_memory = SnapshotMemory();
+
+      if (compiled_memory != interpreted_memory)
+      {
+        std::string codes;
+        for (u32 i = 0; i < list.GetCodeCount(); i++)
+          codes += list.GetCode(i).GetInstructionsAsString() + "--\n";
+
+        FAIL() << "Compiled and interpreted results differ in iteration " << iteration << " for codes:\n" << codes;
+      }
+    }
+  }
+
+  std::mt19937 m_rng{0x43484541u};
+
+private:
+  std::vector<u8> m_ram;
+  u8* m_old_ram = nullptr;
+};
+} // namespace
+
+TEST_F(CheatCompilerTest, ConditionalsMatchInterpreter)
+{
+  CheckEquivalence(5000, false);
+}
+
+TEST_F(CheatCompilerTest, MixedWithInterpretedCodesMatchesInterpreter)
+{
+  CheckEquivalence(5000, true);
+}
+
+TEST_F(CheatCompilerTest, MergedWritesMatchInterpreter)
+{
+  // consecutive constant writes are merged into one copy, unless something jumps between them
+  CheatCode cc;
+  cc.description = "test";
+  cc.enabled = true;
+  cc.instructions.push_back(MakeInstruction(InstructionCode::ConstantWrite16, TEST_ADDRESS, 0x1234));
+  cc.instructions.push_back(MakeInstruction(InstructionCode::ConstantWrite16, TEST_ADDRESS + 2, 0x5678));
+  cc.instructions.push_back(MakeInstruction(InstructionCode::CompareEqual8, TEST_ADDRESS + 8, 0x01));
+  cc.instructions.push_back(MakeInstruction(InstructionCode::ConstantWrite8, TEST_ADDRESS + 4, 0x9A));
+  cc.instructions.push_back(MakeInstruction(InstructionCode::ConstantWrite8, TEST_ADDRESS + 5, 0xBC));
+  cc.instructions.push_back(MakeInstruction(InstructionCode::ExtConstantWrite32, TEST_ADDRESS + 6, 0xDEF01234));
+
+  for (const u8 condition_value : {0x00, 0x01})
+  {
+    RandomizeMemory();
+    Bus::g_ram[TEST_ADDRESS + 8] = condition_value;
+    const std::vector<u8> initial_memory = SnapshotMemory();
+    cc.Apply();
+    const std::vector<u8> interpreted_memory = SnapshotMemory();
+
+    RestoreMemory(initial_memory);
+    CheatList list;
+    list.AddCode(cc);
+    list.Apply();
+    EXPECT_EQ(SnapshotMemory(), interpreted_memory) << "condition value " << static_cast<u32>(condition_value);
+  }
+}
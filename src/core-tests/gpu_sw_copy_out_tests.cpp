@@ -0,0 +1,247 @@
+#include "common/timer.h"
+#include "core/gpu_sw_copy_out.h"
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+// Covers every vector loop length with each possible tail, plus a full display line.
+constexpr u32 MAX_TEST_WIDTH = 72;
+constexpr u32 DISPLAY_WIDTH = 640;
+constexpr u32 GUARD_PIXELS = 16;
+
+template<typename T>
+constexpr T GuardValue()
+{
+  return static_cast<T>(0xCDCDCDCDu);
+}
+
+std::vector<u16> RandomPixels(u32 count, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u16> pixels(count);
+  for (u16& pixel : pixels)
+    pixel = static_cast<u16>(rng());
+
+  // make sure the extremes of each channel and the mask bit are exercised
+  if (count >= 4)
+  {
+    pixels[0] = 0x0000;
+    pixels[1] = 0xFFFF;
+    pixels[2] = 0x7FFF;
+    pixels[3] = 0x8000;
+  }
+  return pixels;
+}
+
+template<typename T>
+void CheckGuard(const std::vector<T>& dst, u32 width)
+{
+  for (u32 i = width; i < dst.size(); i++)
+    ASSERT_EQ(dst[i], GuardValue<T>()) << "wrote past pixel " << width;
+}
+
+template<HostDisplayPixelFormat format, typename T>
+void CheckRow16()
+{
+  const std::vector<u16> src = RandomPixels(DISPLAY_WIDTH + 8, 16);
+
+  std::vector<u32> widths;
+  for (u32 width = 0; width <= MAX_TEST_WIDTH; width++)
+    widths.push_back(width);
+  widths.push_back(DISPLAY_WIDTH);
+
+  for (u32 offset = 0; offset < 8; offset++)
+  {
+    for (const u32 width : widths)
+    {
+      std::vector<T> dst(width + GUARD_PIXELS, GuardValue<T>());
+      CopyOutRow16<format>(src.data() + offset, dst.data(), width);
+      for (u32 i = 0; i < width; i++)
+      {
+        ASSERT_EQ(dst[i], (VRAM16ToOutput<format, T>(src[offset + i])))
+          << "offset " << offset << " width " << width << " pixel " << i;
+      }
+      CheckGuard(dst, width);
+    }
+  }
+}
+
+template<HostDisplayPixelFormat format, typename T>
+void CheckRow24()
+{
+  std::vector<u32> widths;
+  for (u32 width = 0; width <= MAX_TEST_WIDTH; width++)
+    widths.push_back(width);
+  widths.push_back(DISPLAY_WIDTH);
+
+  for (u32 offset = 0; offset < 6; offset++)
+  {
+    for (const u32 width : widths)
+    {
+      // The source ends exactly after the last byte converted, so an over-read shows up under a memory checker.
+      const std::vector<u16> pixels = RandomPixels(((offset + (width * 3)) + 1) / 2, 24 + width);
+      std::vector<u8> src(offset + (width * 3));
+      std::memcpy(src.data(), pixels.data(), src.size());
+
+      std::vector<T> dst(width + GUARD_PIXELS, GuardValue<T>());
+      CopyOutRow24<format>(src.data() + offset, dst.data(), width);
+      for (u32 i = 0; i < width; i++)
+      {
+        ASSERT_EQ(dst[i], (RGB24ToOutput<format, T>(&src[offset + (i * 3)])))
+          << "offset " << offset << " width " << width << " pixel " << i;
+      }
+      CheckGuard(dst, width);
+    }
+  }
+}
+
+template<HostDisplayPixelFormat format, typename T>
+void CheckRow16Wrapped()
+{
+  const std::vector<u16> row = RandomPixels(VRAM_WIDTH, 1616);
+
+  static constexpr u32 src_xs[] = {0, 1, 500, VRAM_WIDTH - 100, VRAM_WIDTH - 9, VRAM_WIDTH - 8, VRAM_WIDTH - 7,
+                                   VRAM_WIDTH - 1};
+  static constexpr u32 widths[] = {1, 7, 8, 9, 17, 100, 333, DISPLAY_WIDTH, VRAM_WIDTH};
+  for (const u32 src_x : src_xs)
+  {
+    for (const u32 width : widths)
+    {
+      std::vector<T> dst(width + GUARD_PIXELS, GuardValue<T>());
+      CopyOutRow16Wrapped<format>(row.data(), src_x, dst.data(), width);
+      for (u32 i = 0; i < width; i++)
+      {
+        ASSERT_EQ(dst[i], (VRAM16ToOutput<format, T>(row[(src_x + i) % VRAM_WIDTH])))
+          << "src_x " << src_x << " width " << width << " pixel " << i;
+      }
+      CheckGuard(dst, width);
+    }
+  }
+}
+
+template<HostDisplayPixelFormat format, typename T>
+void CheckRow24Wrapped()
+{
+  // The unwrapped reference reads from two copies of the row back to back.
+  const std::vector<u16> row = RandomPixels(VRAM_WIDTH, 2424);
+  std::vector<u16> doubled_row(row);
+  doubled_row.insert(doubled_row.end(), row.begin(), row.end());
+
+  static constexpr u32 src_xs[] = {0, 3, 500, VRAM_WIDTH - 100, VRAM_WIDTH - 9, VRAM_WIDTH - 2, VRAM_WIDTH - 1};
+  static constexpr u32 widths[] = {1, 2, 7, 8, 9, 10, 11, 17, 100, 333, DISPLAY_WIDTH};
+  for (const u32 src_x : src_xs)
+  {
+    for (u32 skip_x = 0; skip_x < 4; skip_x++)
+    {
+      for (const u32 width : widths)
+      {
+        std::vector<T> dst(width + GUARD_PIXELS, GuardValue<T>());
+        CopyOutRow24Wrapped<format>(row.data(), src_x, skip_x, dst.data(), width);
+
+        std::vector<T> expected(width);
+        CopyOutRow24<format>(reinterpret_cast<const u8*>(&doubled_row[src_x]) + (skip_x * 3), expected.data(), width);
+        for (u32 i = 0; i < width; i++)
+        {
+          ASSERT_EQ(dst[i], expected[i]) << "src_x " << src_x << " skip_x " << skip_x << " width " << width
+                                         << " pixel " << i;
+        }
+        CheckGuard(dst, width);
+      }
+    }
+  }
+}
+
+template<HostDisplayPixelFormat format, typename T>
+void BenchmarkFormat(const char* name, const std::vector<u16>& vram)
+{
+  static constexpr u32 ITERATIONS = 20;
+  static constexpr u32 HEIGHT = 480;
+
+  std::vector<T> dst(DISPLAY_WIDTH * HEIGHT);
+  Common::Timer::Value row16_time = 0, pixel16_time = 0, row24_time = 0, pixel24_time = 0;
+  for (u32 i = 0; i < ITERATIONS; i++)
+  {
+    Common::Timer::Value start = Common::Timer::GetValue();
+    for (u32 row = 0; row < HEIGHT; row++)
+      CopyOutRow16<format>(&vram[row * VRAM_WIDTH], &dst[row * DISPLAY_WIDTH], DISPLAY_WIDTH);
+    row16_time += Common::Timer::GetValue() - start;
+
+    start = Common::Timer::GetValue();
+    for (u32 row = 0; row < HEIGHT; row++)
+    {
+      for (u32 col = 0; col < DISPLAY_WIDTH; col++)
+        dst[row * DISPLAY_WIDTH + col] = VRAM16ToOutput<format, T>(vram[row * VRAM_WIDTH + col]);
+    }
+    pixel16_time += Common::Timer::GetValue() - start;
+
+    start = Common::Timer::GetValue();
+    for (u32 row = 0; row < HEIGHT; row++)
+    {
+      CopyOutRow24<format>(reinterpret_cast<const u8*>(&vram[row * VRAM_WIDTH]), &dst[row * DISPLAY_WIDTH],
+                           DISPLAY_WIDTH);
+    }
+    row24_time += Common::Timer::GetValue() - start;
+
+    start = Common::Timer::GetValue();
+    for (u32 row = 0; row < HEIGHT; row++)
+    {
+      const u8* src_ptr = reinterpret_cast<const u8*>(&vram[row * VRAM_WIDTH]);
+      for (u32 col = 0; col < DISPLAY_WIDTH; col++)
+        dst[row * DISPLAY_WIDTH + col] = RGB24ToOutput<format, T>(src_ptr + (col * 3));
+    }
+    pixel24_time += Common::Timer::GetValue() - start;
+  }
+
+  const auto average_ms = [](Common::Timer::Value total) {
+    return Common::Timer::ConvertValueToMilliseconds(total) / static_cast<double>(ITERATIONS);
+  };
+  std::printf("%-8s 15-bit: row %.3f ms, per-pixel %.3f ms; 24-bit: row %.3f ms, per-pixel %.3f ms\n", name,
+              average_ms(row16_time), average_ms(pixel16_time), average_ms(row24_time), average_ms(pixel24_time));
+}
+} // namespace
+
+TEST(GPU_SW_CopyOut, Row16MatchesPerPixel)
+{
+  CheckRow16<HostDisplayPixelFormat::RGBA5551, u16>();
+  CheckRow16<HostDisplayPixelFormat::RGB565, u16>();
+  CheckRow16<HostDisplayPixelFormat::RGBA8, u32>();
+  CheckRow16<HostDisplayPixelFormat::BGRA8, u32>();
+}
+
+TEST(GPU_SW_CopyOut, Row24MatchesPerPixel)
+{
+  CheckRow24<HostDisplayPixelFormat::RGBA5551, u16>();
+  CheckRow24<HostDisplayPixelFormat::RGB565, u16>();
+  CheckRow24<HostDisplayPixelFormat::RGBA8, u32>();
+  CheckRow24<HostDisplayPixelFormat::BGRA8, u32>();
+}
+
+TEST(GPU_SW_CopyOut, WrappedRow16MatchesPerPixel)
+{
+  CheckRow16Wrapped<HostDisplayPixelFormat::RGBA5551, u16>();
+  CheckRow16Wrapped<HostDisplayPixelFormat::RGB565, u16>();
+  CheckRow16Wrapped<HostDisplayPixelFormat::RGBA8, u32>();
+  CheckRow16Wrapped<HostDisplayPixelFormat::BGRA8, u32>();
+}
+
+TEST(GPU_SW_CopyOut, WrappedRow24MatchesUnwrapped)
+{
+  CheckRow24Wrapped<HostDisplayPixelFormat::RGBA5551, u16>();
+  CheckRow24Wrapped<HostDisplayPixelFormat::RGB565, u16>();
+  CheckRow24Wrapped<HostDisplayPixelFormat::RGBA8, u32>();
+  CheckRow24Wrapped<HostDisplayPixelFormat::BGRA8, u32>();
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(GPU_SW_CopyOut, DISABLED_Benchmark)
+{
+  const std::vector<u16> vram = RandomPixels(VRAM_WIDTH * VRAM_HEIGHT, 640);
+  std::printf("640x480 frame:\n");
+  BenchmarkFormat<HostDisplayPixelFormat::RGBA5551, u16>("RGBA5551", vram);
+  BenchmarkFormat<HostDisplayPixelFormat::RGB565, u16>("RGB565", vram);
+  BenchmarkFormat<HostDisplayPixelFormat::RGBA8, u32>("RGBA8", vram);
+  BenchmarkFormat<HostDisplayPixelFormat::BGRA8, u32>("BGRA8", vram);
+}
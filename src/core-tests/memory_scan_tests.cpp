@@ -0,0 +1,277 @@
+#include "core/bus.h"
+#include "core/cheats.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+using Operator = MemoryScan::Operator;
+
+constexpr PhysicalMemoryAddress TEST_ADDRESS = 0x1000;
+constexpr u32 TEST_WINDOW_SIZE = 512;
+
+constexpr std::array<MemoryAccessSize, 3> SIZES = {
+  {MemoryAccessSize::Byte, MemoryAccessSize::HalfWord, MemoryAccessSize::Word}};
+
+// Same semantics as the interpreter-era MemoryScan::Result::Filter(), one element at a time.
+bool ReferenceFilter(Operator op, u32 value, u32 last_value, u32 comp_value, bool is_signed)
+{
+  const s32 svalue = static_cast<s32>(value);
+  const s32 slast_value = static_cast<s32>(last_value);
+  const s32 scomp_value = static_cast<s32>(comp_value);
+  switch (op)
+  {
+    case Operator::Equal:
+      return (value == comp_value);
+    case Operator::NotEqual:
+      return (value != comp_value);
+    case Operator::GreaterThan:
+      return is_signed ? (svalue > scomp_value) : (value > comp_value);
+    case Operator::GreaterEqual:
+      return is_signed ? (svalue >= scomp_value) : (value >= comp_value);
+    case Operator::LessThan:
+      return is_signed ? (svalue < scomp_value) : (value < comp_value);
+    case Operator::LessEqual:
+      return is_signed ? (svalue <= scomp_value) : (value <= comp_value);
+    case Operator::IncreasedBy:
+      return is_signed ? ((svalue - slast_value) == scomp_value) : ((value - last_value) == comp_value);
+    case Operator::DecreasedBy:
+      return is_signed ? ((slast_value - svalue) == scomp_value) : ((last_value - value) == comp_value);
+    case Operator::ChangedBy:
+      return is_signed ? (std::abs(slast_value - svalue) == scomp_value) :
+                         (((last_value > value) ? (last_value - value) : (value - last_value)) == comp_value);
+    case Operator::EqualLast:
+      return (value == last_value);
+    case Operator::NotEqualLast:
+      return (value != last_value);
+    case Operator::GreaterThanLast:
+      return is_signed ? (svalue > slast_value) : (value > last_value);
+    case Operator::GreaterEqualLast:
+      return is_signed ? (svalue >= slast_value) : (value >= last_value);
+    case Operator::LessThanLast:
+      return is_signed ? (svalue < slast_value) : (value < last_value);
+    case Operator::LessEqualLast:
+      return is_signed ? (svalue <= slast_value) : (value <= last_value);
+    case Operator::Any:
+      return true;
+    default:
+      return false;
+  }
+}
+
+class MemoryScanTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_ram.resize(Bus::RAM_SIZE);
+    m_old_ram = Bus::g_ram;
+    Bus::g_ram = m_ram.data();
+  }
+
+  void TearDown() override { Bus::g_ram = m_old_ram; }
+
+  void RandomizeMemory(u32 change_percent = 100)
+  {
+    // few enough distinct values that equality matches are common, and runs of equal blocks occur
+    static constexpr std::array<u8, 4> values = {{0x00, 0x01, 0x80, 0xFF}};
+    for (u32 i = 0; i < TEST_WINDOW_SIZE + sizeof(u32); i++)
+    {
+      if ((m_rng() % 100) < change_percent)
+        m_ram[TEST_ADDRESS + i] = (m_rng() % 4 == 0) ? values[m_rng() % values.size()] : 0;
+    }
+  }
+
+  u32 ReadValue(PhysicalMemoryAddress address, MemoryAccessSize size, bool is_signed) const
+  {
+    switch (size)
+    {
+      case MemoryAccessSize::Byte:
+        return is_signed ? SignExtend32(m_ram[address]) : ZeroExtend32(m_ram[address]);
+
+      case MemoryAccessSize::HalfWord:
+      {
+        u16 value;
+        std::memcpy(&value, &m_ram[address], sizeof(value));
+        return is_signed ? SignExtend32(value) : ZeroExtend32(value);
+      }
+
+      case MemoryAccessSize::Word:
+      default:
+      {
+        u32 value;
+        std::memcpy(&value, &m_ram[address], sizeof(value));
+        return value;
+      }
+    }
+  }
+
+  std::mt19937 m_rng{0x5343414Eu};
+
+private:
+  std::vector<u8> m_ram;
+  u8* m_old_ram = nullptr;
+};
+
+void CheckResults(const MemoryScan& scan, const std::vector<PhysicalMemoryAddress>& expected_addresses,
+                  const char* what)
+{
+  ASSERT_EQ(scan.GetResultCount(), static_cast<u32>(expected_addresses.size())) << what;
+  for (u32 i = 0; i < scan.GetResultCount(); i++)
+    ASSERT_EQ(scan.GetResult(i).address, expected_addresses[i]) << what << " result " << i;
+}
+} // namespace
+
+TEST_F(MemoryScanTest, SearchMatchesScalar)
+{
+  static constexpr std::array<Operator, 7> operators = {{Operator::Equal, Operator::NotEqual, Operator::GreaterThan,
+                                                         Operator::LessEqual, Operator::EqualLast,
+                                                         Operator::NotEqualLast, Operator::Any}};
+  static constexpr std::array<u32, 7> comp_values = {{0x00, 0x01, 0x80, 0xFF, 0xFFFF, 0xFFFFFF80u, 0x12345}};
+  static constexpr std::array<u32, 7> lengths = {{0, 3, 16, 17, 48, 63, TEST_WINDOW_SIZE}};
+
+  RandomizeMemory();
+
+  for (const MemoryAccessSize size : SIZES)
+  {
+    const u32 element_size = 1u << static_cast<u32>(size);
+    for (const bool is_signed : {false, true})
+    {
+      for (const Operator op : operators)
+      {
+        for (const u32 comp_value : comp_values)
+        {
+          for (u32 misalignment = 0; misalignment < 4; misalignment++)
+          {
+            for (const u32 length : lengths)
+            {
+              const PhysicalMemoryAddress start = TEST_ADDRESS + misalignment;
+              const PhysicalMemoryAddress end = start + std::min(length, TEST_WINDOW_SIZE - misalignment);
+
+              MemoryScan scan;
+              scan.SetSize(size);
+              scan.SetValueSigned(is_signed);
+              scan.SetOperator(op);
+              scan.SetValue(comp_value);
+              scan.SetStartAddress(start);
+              scan.SetEndAddress(end);
+              scan.Search();
+
+              std::vector<PhysicalMemoryAddress> expected;
+              for (PhysicalMemoryAddress address = start; address < end; address += element_size)
+              {
+                const u32 value = ReadValue(address, size, is_signed);
+                if (ReferenceFilter(op, value, value, comp_value, is_signed))
+                  expected.push_back(address);
+              }
+
+              SCOPED_TRACE(testing::Message() << "size " << element_size << " signed " << is_signed << " op "
+                                              << static_cast<u32>(op) << " value " << comp_value << " start "
+                                              << start << " end " << end);
+              CheckResults(scan, expected, "search");
+              for (u32 i = 0; i < scan.GetResultCount(); i++)
+              {
+                const MemoryScan::Result res = scan.GetResult(i);
+                ASSERT_EQ(res.value, ReadValue(res.address, size, is_signed));
+                ASSERT_FALSE(res.value_changed);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(MemoryScanTest, SearchAgainMatchesScalar)
+{
+  static constexpr std::array<Operator, 9> operators = {
+    {Operator::EqualLast, Operator::NotEqualLast, Operator::GreaterThanLast, Operator::LessEqualLast,
+     Operator::IncreasedBy, Operator::DecreasedBy, Operator::ChangedBy, Operator::NotEqual, Operator::Any}};
+
+  for (u32 iteration = 0; iteration < 200; iteration++)
+  {
+    const MemoryAccessSize size = SIZES[m_rng() % SIZES.size()];
+    const u32 element_size = 1u << static_cast<u32>(size);
+    const bool is_signed = (m_rng() & 1) != 0;
+    const PhysicalMemoryAddress start = TEST_ADDRESS + (m_rng() % 4);
+    const PhysicalMemoryAddress end = start + 64 + (m_rng() % (TEST_WINDOW_SIZE - 64 - 4));
+    SCOPED_TRACE(testing::Message() << "iteration " << iteration << " size " << element_size << " signed "
+                                    << is_signed << " start " << start << " end " << end);
+
+    RandomizeMemory();
+
+    // start with everything, so the first pass compares whole snapshots and later ones only the results
+    MemoryScan scan;
+    scan.SetSize(size);
+    scan.SetValueSigned(is_signed);
+    scan.SetOperator(Operator::Any);
+    scan.SetStartAddress(start);
+    scan.SetEndAddress(end);
+    scan.Search();
+
+    // value as of the last search or update, and as of the last search the result survived
+    std::map<PhysicalMemoryAddress, std::pair<u32, u32>> expected;
+    std::vector<PhysicalMemoryAddress> expected_addresses;
+    for (PhysicalMemoryAddress address = start; address < end; address += element_size)
+    {
+      const u32 value = ReadValue(address, size, is_signed);
+      expected.emplace(address, std::make_pair(value, value));
+      expected_addresses.push_back(address);
+    }
+    CheckResults(scan, expected_addresses, "search");
+
+    for (u32 pass = 0; pass < 4 && !expected.empty(); pass++)
+    {
+      RandomizeMemory(10);
+
+      if (pass == 2)
+      {
+        // an update moves the value the changed flag is based on, but not the last value
+        scan.UpdateResultsValues();
+        for (auto& [address, values] : expected)
+          values.first = ReadValue(address, size, is_signed);
+
+        RandomizeMemory(10);
+      }
+
+      const Operator op = operators[m_rng() % operators.size()];
+      const u32 comp_value = (op == Operator::NotEqual) ? 0 : 1;
+      scan.SetOperator(op);
+      scan.SetValue(comp_value);
+      scan.SearchAgain();
+
+      std::vector<bool> expected_changed;
+      expected_addresses.clear();
+      for (auto it = expected.begin(); it != expected.end();)
+      {
+        const u32 value = ReadValue(it->first, size, is_signed);
+        if (!ReferenceFilter(op, value, it->second.second, comp_value, is_signed))
+        {
+          it = expected.erase(it);
+          continue;
+        }
+
+        expected_addresses.push_back(it->first);
+        expected_changed.push_back(value != it->second.first);
+        it->second = std::make_pair(value, value);
+        ++it;
+      }
+
+      SCOPED_TRACE(testing::Message() << "pass " << pass << " op " << static_cast<u32>(op));
+      CheckResults(scan, expected_addresses, "search again");
+      for (u32 i = 0; i < scan.GetResultCount(); i++)
+      {
+        const MemoryScan::Result res = scan.GetResult(i);
+        ASSERT_EQ(res.value, ReadValue(res.address, size, is_signed)) << "result " << i;
+        ASSERT_EQ(res.last_value, res.value) << "result " << i;
+        ASSERT_EQ(res.value_changed, expected_changed[i]) << "result " << i;
+      }
+    }
+  }
+}
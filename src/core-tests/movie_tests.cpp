@@ -0,0 +1,202 @@
+#include "common/byte_stream.h"
+#include "core/movie.h"
+#include "core/save_state_version.h"
+#include <cstddef>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr u32 KEYFRAME_INTERVAL = 10;
+constexpr u32 FRAME_COUNT = 25;
+constexpr u32 INPUT_SIZE = 4;
+
+Movie::FileHeader MakeHeader()
+{
+  Movie::FileHeader header = {};
+  header.magic = Movie::FILE_MAGIC;
+  header.version = Movie::FILE_VERSION;
+  header.save_state_version = SAVE_STATE_VERSION;
+  header.keyframe_interval = KEYFRAME_INTERVAL;
+  header.frame_record_size = sizeof(Movie::FrameRecordHeader) + INPUT_SIZE;
+  header.controller_types[0] = 1;
+  header.input_sizes[0] = INPUT_SIZE;
+  std::strcpy(header.game_code, "SCUS-94900");
+  return header;
+}
+
+std::vector<u8> MakeKeyframe(u32 frame)
+{
+  // partly compressible, like a real state
+  std::mt19937 rng(frame);
+  std::vector<u8> data(4096 + frame);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (i & 1) ? static_cast<u8>(rng()) : static_cast<u8>(i);
+  return data;
+}
+
+u64 MakeHash(u32 frame)
+{
+  return 0x9E3779B97F4A7C15ull * (frame + 1);
+}
+
+u32 MakeInput(u32 frame)
+{
+  return frame * 3 + 7;
+}
+
+std::vector<u8> WriteMovie()
+{
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream_CreateGrowableMemoryStream();
+  Movie::FileWriter writer;
+  EXPECT_TRUE(writer.Open(stream.get(), MakeHeader()));
+
+  for (u32 frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    if ((frame % KEYFRAME_INTERVAL) == 0)
+    {
+      const std::vector<u8> keyframe = MakeKeyframe(frame);
+      EXPECT_TRUE(writer.WriteKeyframe(frame, keyframe.data(), static_cast<u32>(keyframe.size())));
+    }
+
+    const u32 input = MakeInput(frame);
+    std::memcpy(writer.BeginFrame(), &input, sizeof(input));
+    writer.EndFrame(MakeHash(frame));
+  }
+
+  EXPECT_EQ(writer.GetFrameCount(), FRAME_COUNT);
+  EXPECT_TRUE(writer.Finish());
+  return std::vector<u8>(stream->GetMemoryPointer(), stream->GetMemoryPointer() + stream->GetSize());
+}
+
+bool OpenMovie(Movie::FileReader* reader, std::unique_ptr<ReadOnlyMemoryByteStream>* stream,
+               const std::vector<u8>& data)
+{
+  *stream = ByteStream_CreateReadOnlyMemoryStream(data.data(), static_cast<u32>(data.size()));
+  return reader->Open(stream->get(), "test");
+}
+} // namespace
+
+TEST(Movie, HeaderRoundTrip)
+{
+  const std::vector<u8> data = WriteMovie();
+  std::unique_ptr<ReadOnlyMemoryByteStream> stream;
+  Movie::FileReader reader;
+  ASSERT_TRUE(OpenMovie(&reader, &stream, data));
+
+  const Movie::FileHeader expected = MakeHeader();
+  const Movie::FileHeader& header = reader.GetHeader();
+  EXPECT_EQ(header.frame_count, FRAME_COUNT);
+  EXPECT_EQ(header.keyframe_count, 3u);
+  EXPECT_EQ(header.keyframe_interval, KEYFRAME_INTERVAL);
+  EXPECT_EQ(header.frame_record_size, expected.frame_record_size);
+  EXPECT_EQ(header.controller_types, expected.controller_types);
+  EXPECT_EQ(header.input_sizes, expected.input_sizes);
+  EXPECT_STREQ(header.game_code, expected.game_code);
+}
+
+TEST(Movie, FramesRoundTrip)
+{
+  const std::vector<u8> data = WriteMovie();
+  std::unique_ptr<ReadOnlyMemoryByteStream> stream;
+  Movie::FileReader reader;
+  ASSERT_TRUE(OpenMovie(&reader, &stream, data));
+
+  for (u32 frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    u32 input;
+    std::memcpy(&input, reader.GetFrameInputs(frame), sizeof(input));
+    EXPECT_EQ(input, MakeInput(frame)) << "frame " << frame;
+    EXPECT_EQ(reader.GetFrameHash(frame), MakeHash(frame)) << "frame " << frame;
+  }
+}
+
+TEST(Movie, KeyframesRoundTrip)
+{
+  const std::vector<u8> data = WriteMovie();
+  std::unique_ptr<ReadOnlyMemoryByteStream> stream;
+  Movie::FileReader reader;
+  ASSERT_TRUE(OpenMovie(&reader, &stream, data));
+  ASSERT_EQ(reader.GetKeyframes().size(), 3u);
+
+  std::vector<u8> state;
+  for (const Movie::KeyframeEntry& entry : reader.GetKeyframes())
+  {
+    EXPECT_LT(entry.compressed_size, entry.uncompressed_size);
+    ASSERT_TRUE(reader.ReadKeyframe(entry, &state));
+    EXPECT_EQ(state, MakeKeyframe(entry.frame)) << "keyframe " << entry.frame;
+  }
+
+  // seeks land on the last keyframe at or before the target
+  static constexpr u32 targets[][2] = {{0, 0}, {1, 0}, {9, 0}, {10, 10}, {19, 10}, {20, 20}, {24, 20}, {1000, 20}};
+  for (const auto& [target, keyframe] : targets)
+  {
+    const Movie::KeyframeEntry* entry = reader.FindKeyframe(target);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->frame, keyframe) << "target " << target;
+  }
+}
+
+TEST(Movie, RejectsInvalidHeader)
+{
+  const std::vector<u8> data = WriteMovie();
+  const auto check_field = [&data](size_t offset) {
+    std::vector<u8> bad_data(data);
+    bad_data[offset] ^= 0xFF;
+
+    std::unique_ptr<ReadOnlyMemoryByteStream> stream;
+    Movie::FileReader reader;
+    return OpenMovie(&reader, &stream, bad_data);
+  };
+
+  EXPECT_FALSE(check_field(offsetof(Movie::FileHeader, magic)));
+  EXPECT_FALSE(check_field(offsetof(Movie::FileHeader, version)));
+  EXPECT_FALSE(check_field(offsetof(Movie::FileHeader, save_state_version)));
+  EXPECT_FALSE(check_field(offsetof(Movie::FileHeader, frame_count) + 3));
+  EXPECT_FALSE(check_field(offsetof(Movie::FileHeader, keyframe_count) + 3));
+}
+
+TEST(Movie, RejectsTruncatedFile)
+{
+  const std::vector<u8> data = WriteMovie();
+  for (const size_t size : {size_t(0), sizeof(Movie::FileHeader) - 1, sizeof(Movie::FileHeader), data.size() - 1})
+  {
+    const std::vector<u8> truncated_data(data.begin(), data.begin() + size);
+    std::unique_ptr<ReadOnlyMemoryByteStream> stream;
+    Movie::FileReader reader;
+    EXPECT_FALSE(OpenMovie(&reader, &stream, truncated_data)) << "size " << size;
+  }
+}
+
+TEST(Movie, PlayerDetectsDesync)
+{
+  const std::vector<u8> data = WriteMovie();
+  Movie::Player player;
+  ASSERT_TRUE(player.Open(ByteStream_CreateReadOnlyMemoryStream(data.data(), static_cast<u32>(data.size())), "test"));
+  EXPECT_EQ(player.GetFrameCount(), FRAME_COUNT);
+  EXPECT_EQ(player.GetKeyframeInterval(), KEYFRAME_INTERVAL);
+
+  while (!player.IsFinished())
+  {
+    const u32 frame = player.GetCurrentFrame();
+    player.EndFrame((frame == 12 || frame == 20) ? ~MakeHash(frame) : MakeHash(frame));
+  }
+
+  EXPECT_EQ(player.GetCurrentFrame(), FRAME_COUNT);
+  EXPECT_EQ(player.GetDesyncCount(), 2u);
+  EXPECT_EQ(player.GetFirstDesyncFrame(), 12u);
+}
+
+TEST(Movie, PlayerMatchingHashesDoNotDesync)
+{
+  const std::vector<u8> data = WriteMovie();
+  Movie::Player player;
+  ASSERT_TRUE(player.Open(ByteStream_CreateReadOnlyMemoryStream(data.data(), static_cast<u32>(data.size())), "test"));
+
+  while (!player.IsFinished())
+    player.EndFrame(MakeHash(player.GetCurrentFrame()));
+
+  EXPECT_EQ(player.GetDesyncCount(), 0u);
+}
@@ -93,6 +93,13 @@ bool AnalogController::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void AnalogController::DoInputState(StateWrapper& sw)
+{
+  sw.Do(&m_button_state);
+  sw.Do(&m_axis_state);
+  sw.Do(&m_analog_toggle_queued);
+}
+
 std::optional<s32> AnalogController::GetAxisCodeByName(std::string_view axis_name) const
 {
   return StaticGetAxisCodeByName(axis_name);
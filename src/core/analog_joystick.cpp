@@ -59,6 +59,14 @@ bool AnalogJoystick::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void AnalogJoystick::DoInputState(StateWrapper& sw)
+{
+  // the mode button toggles analog mode immediately, so it's part of the input
+  sw.Do(&m_analog_mode);
+  sw.Do(&m_button_state);
+  sw.Do(&m_axis_state);
+}
+
 std::optional<s32> AnalogJoystick::GetAxisCodeByName(std::string_view axis_name) const
 {
   return StaticGetAxisCodeByName(axis_name);
@@ -1,5 +1,6 @@
 #include "cheats.h"
 #include "bus.h"
+#include "common/align.h"
 #include "common/assert.h"
 #include "common/byte_stream.h"
 #include "common/file_system.h"
@@ -11,32 +12,25 @@
 #include "cpu_core.h"
 #include "host_interface.h"
 #include "system.h"
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 Log_SetChannel(Cheats);
 
 using KeyValuePairVector = std::vector<std::pair<std::string, std::string>>;
 
-static bool IsValidScanAddress(PhysicalMemoryAddress address)
-{
-  if ((address & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION &&
-      (address & CPU::DCACHE_OFFSET_MASK) < CPU::DCACHE_SIZE)
-  {
-    return true;
-  }
-
-  address &= CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
-
-  if (address < Bus::RAM_MIRROR_END)
-    return true;
-
-  if (address >= Bus::BIOS_BASE && address < (Bus::BIOS_BASE + Bus::BIOS_SIZE))
-    return true;
-
-  return false;
-}
-
 template<typename T>
 static T DoMemoryRead(PhysicalMemoryAddress address)
 {
@@ -231,7 +225,7 @@ bool CheatList::LoadFromPCSXRString(const std::string& str)
 
       // new cheat
       if (current_code.Valid())
-        m_codes.push_back(std::move(current_code));
+        AddCode(std::move(current_code));
 
       current_code = CheatCode();
       if (group.empty())
@@ -280,7 +274,7 @@ bool CheatList::LoadFromPCSXRString(const std::string& str)
     // technically this isn't the place for end of file
     if (!comments.empty())
       current_code.comments += comments;
-    m_codes.push_back(std::move(current_code));
+    AddCode(std::move(current_code));
   }
 
   Log_InfoPrintf("Loaded %zu cheats (PCSXR format)", m_codes.size());
@@ -383,7 +377,7 @@ bool CheatList::LoadFromLibretroString(const std::string& str)
     cc.description = *desc;
     cc.enabled = StringUtil::FromChars<bool>(*enable).value_or(false);
     if (ParseLibretroCheat(&cc, code->c_str()))
-      m_codes.push_back(std::move(cc));
+      AddCode(std::move(cc));
   }
 
   Log_InfoPrintf("Loaded %zu cheats (libretro format)", m_codes.size());
@@ -426,7 +420,7 @@ bool CheatList::LoadFromEPSXeString(const std::string& str)
 
       // new cheat
       if (current_code.Valid())
-        m_codes.push_back(std::move(current_code));
+        AddCode(std::move(current_code));
 
       current_code = CheatCode();
       if (group.empty())
@@ -471,7 +465,7 @@ bool CheatList::LoadFromEPSXeString(const std::string& str)
   }
 
   if (current_code.Valid())
-    m_codes.push_back(std::move(current_code));
+    AddCode(std::move(current_code));
 
   Log_InfoPrintf("Loaded %zu cheats (EPSXe format)", m_codes.size());
   return !m_codes.empty();
@@ -525,16 +519,17 @@ bool CheatList::ParseLibretroCheat(CheatCode* cc, const char* line)
 
 void CheatList::Apply()
 {
-  for (const CheatCode& code : m_codes)
-  {
-    if (code.enabled)
-      code.Apply();
-  }
+  // RAM is reallocated when the system is recreated, which the compiled pointers depend on
+  if (!m_program_valid || m_program_ram != Bus::g_ram)
+    CompileProgram();
+
+  ExecuteProgram();
 }
 
 void CheatList::AddCode(CheatCode cc)
 {
   m_codes.push_back(std::move(cc));
+  InvalidateProgram();
 }
 
 void CheatList::SetCode(u32 index, CheatCode cc)
@@ -544,16 +539,18 @@ void CheatList::SetCode(u32 index, CheatCode cc)
 
   if (index == m_codes.size())
   {
-    m_codes.push_back(std::move(cc));
+    AddCode(std::move(cc));
     return;
   }
 
   m_codes[index] = std::move(cc);
+  InvalidateProgram();
 }
 
 void CheatList::RemoveCode(u32 i)
 {
   m_codes.erase(m_codes.begin() + i);
+  InvalidateProgram();
 }
 
 std::optional<CheatList::Format> CheatList::DetectFileFormat(const char* filename)
@@ -721,7 +718,7 @@ bool CheatList::LoadFromPackage(const std::string& game_code)
 
         if (current_code.Valid())
         {
-          m_codes.push_back(std::move(current_code));
+          AddCode(std::move(current_code));
           current_code = CheatCode();
         }
 
@@ -760,7 +757,7 @@ bool CheatList::LoadFromPackage(const std::string& game_code)
     }
 
     if (current_code.Valid())
-      m_codes.push_back(std::move(current_code));
+      AddCode(std::move(current_code));
 
     Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), game_code.c_str());
     return !m_codes.empty();
@@ -802,6 +799,7 @@ void CheatList::SetCodeEnabled(u32 index, bool state)
     return;
 
   m_codes[index].enabled = state;
+  InvalidateProgram();
   if (!state)
     m_codes[index].ApplyOnDisable();
 }
@@ -855,6 +853,433 @@ void CheatList::MergeList(const CheatList& cl)
   }
 }
 
+void CheatList::InvalidateProgram()
+{
+  m_program_valid = false;
+}
+
+// Reads of unmapped addresses return zero, same as the interpreter.
+static u8 s_compiled_zero_bytes[sizeof(u32)] = {};
+
+static u8* ResolveCompiledAddress(PhysicalMemoryAddress address, bool for_write, bool* in_ram)
+{
+  *in_ram = false;
+
+  if ((address & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION &&
+      (address & CPU::DCACHE_OFFSET_MASK) < CPU::DCACHE_SIZE)
+  {
+    return &CPU::g_state.dcache[address & CPU::DCACHE_OFFSET_MASK];
+  }
+
+  address &= CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+
+  if (address < Bus::RAM_MIRROR_END)
+  {
+    *in_ram = true;
+    return &Bus::g_ram[address & Bus::RAM_MASK];
+  }
+
+  // writes anywhere else are ignored
+  if (for_write)
+    return nullptr;
+
+  if (address >= Bus::BIOS_BASE && address < (Bus::BIOS_BASE + Bus::BIOS_SIZE))
+    return &Bus::g_bios[address & Bus::BIOS_MASK];
+
+  return s_compiled_zero_bytes;
+}
+
+static u32 GetSkipToSeparatorTarget(const std::vector<CheatCode::Instruction>& instructions, u32 index)
+{
+  // matches the interpreter, the separator (00000000 FFFF) is skipped too
+  constexpr u64 separator_value = UINT64_C(0x000000000000FFFF);
+  const u32 count = static_cast<u32>(instructions.size());
+  while (index < count)
+  {
+    if (instructions[index++].bits == separator_value)
+      break;
+  }
+
+  return index;
+}
+
+void CheatList::CompileProgram()
+{
+  m_program.clear();
+  m_program_data.clear();
+  m_program_ram = Bus::g_ram;
+  m_program_valid = true;
+
+  u32 interpreted_codes = 0;
+  for (u32 i = 0; i < static_cast<u32>(m_codes.size()); i++)
+  {
+    if (!m_codes[i].enabled)
+      continue;
+
+    if (!CompileCode(i))
+    {
+      CompiledOp op = {};
+      op.type = CompiledOp::Type::Interpret;
+      op.value = i;
+      m_program.push_back(op);
+      interpreted_codes++;
+    }
+  }
+
+  Log_DevPrintf("Compiled cheats to %zu operations and %zu bytes of data, %u codes interpreted", m_program.size(),
+                m_program_data.size(), interpreted_codes);
+}
+
+bool CheatList::CompileCode(u32 code_index)
+{
+  using Type = CompiledOp::Type;
+  using Condition = CompiledOp::Condition;
+  using InstructionCode = CheatCode::InstructionCode;
+
+  const CheatCode& cc = m_codes[code_index];
+  const u32 count = static_cast<u32>(cc.instructions.size());
+  const size_t program_start = m_program.size();
+  const size_t data_start = m_program_data.size();
+
+  // jumps are always forward, so targets are known before we get to them
+  std::vector<u32> instruction_op_index(count + 1);
+  std::vector<bool> is_jump_target(count + 1);
+  std::vector<std::pair<size_t, u32>> jumps;
+
+  const auto emit_write = [this, program_start, &is_jump_target](u32 index, PhysicalMemoryAddress address,
+                                                                 u32 value, u8 size) {
+    bool in_ram;
+    u8* ptr = ResolveCompiledAddress(address, true, &in_ram);
+    if (!ptr)
+      return;
+
+    // extend the previous write if this one follows on from it and nothing jumps in between
+    if (m_program.size() > program_start && !is_jump_target[index])
+    {
+      CompiledOp& last = m_program.back();
+      if (last.type == Type::Write && last.in_ram == in_ram && (last.ptr + last.length) == ptr)
+      {
+        const size_t data_offset = m_program_data.size();
+        m_program_data.resize(data_offset + size);
+        std::memcpy(&m_program_data[data_offset], &value, size);
+        last.length += size;
+        return;
+      }
+    }
+
+    CompiledOp op = {};
+    op.type = Type::Write;
+    op.in_ram = in_ram;
+    op.value = static_cast<u32>(m_program_data.size());
+    op.length = size;
+    op.ptr = ptr;
+    m_program_data.resize(m_program_data.size() + size);
+    std::memcpy(&m_program_data[op.value], &value, size);
+    m_program.push_back(op);
+  };
+
+  const auto emit_modify = [this](Type type, PhysicalMemoryAddress address, u32 value, u8 size) {
+    bool in_ram;
+    u8* ptr = ResolveCompiledAddress(address, true, &in_ram);
+    if (!ptr)
+      return;
+
+    CompiledOp op = {};
+    op.type = type;
+    op.size = size;
+    op.in_ram = in_ram;
+    op.value = value;
+    op.ptr = ptr;
+    m_program.push_back(op);
+  };
+
+  const auto emit_compare = [this, &jumps, &is_jump_target](Type type, Condition condition,
+                                                             PhysicalMemoryAddress address, u32 value, u8 size,
+                                                             u32 target) {
+    CompiledOp op = {};
+    op.type = type;
+    op.condition = condition;
+    op.size = size;
+    op.value = value;
+    if (type == Type::CompareMemory)
+      op.ptr = ResolveCompiledAddress(address, false, &op.in_ram);
+
+    jumps.emplace_back(m_program.size(), target);
+    is_jump_target[target] = true;
+    m_program.push_back(op);
+  };
+
+  for (u32 index = 0; index < count; index++)
+  {
+    const CheatCode::Instruction& inst = cc.instructions[index];
+    instruction_op_index[index] = static_cast<u32>(m_program.size());
+
+    switch (inst.code)
+    {
+      case InstructionCode::Nop:
+        break;
+
+      case InstructionCode::ConstantWrite8:
+        emit_write(index, inst.address, inst.value8, sizeof(u8));
+        break;
+
+      case InstructionCode::ConstantWrite16:
+        emit_write(index, inst.address, inst.value16, sizeof(u16));
+        break;
+
+      case InstructionCode::ExtConstantWrite32:
+        emit_write(index, inst.address, inst.value32, sizeof(u32));
+        break;
+
+      case InstructionCode::ScratchpadWrite16:
+        emit_write(index, CPU::DCACHE_LOCATION | (inst.address & CPU::DCACHE_OFFSET_MASK), inst.value16,
+                   sizeof(u16));
+        break;
+
+      case InstructionCode::ExtScratchpadWrite32:
+        emit_write(index, CPU::DCACHE_LOCATION | (inst.address & CPU::DCACHE_OFFSET_MASK), inst.value32,
+                   sizeof(u32));
+        break;
+
+      case InstructionCode::ExtConstantBitSet8:
+        emit_modify(Type::BitSet, inst.address, inst.value8, sizeof(u8));
+        break;
+
+      case InstructionCode::ExtConstantBitSet16:
+        emit_modify(Type::BitSet, inst.address, inst.value16, sizeof(u16));
+        break;
+
+      case InstructionCode::ExtConstantBitSet32:
+        emit_modify(Type::BitSet, inst.address, inst.value32, sizeof(u32));
+        break;
+
+      case InstructionCode::ExtConstantBitClear8:
+        emit_modify(Type::BitClear, inst.address, inst.value8, sizeof(u8));
+        break;
+
+      case InstructionCode::ExtConstantBitClear16:
+        emit_modify(Type::BitClear, inst.address, inst.value16, sizeof(u16));
+        break;
+
+      case InstructionCode::ExtConstantBitClear32:
+        emit_modify(Type::BitClear, inst.address, inst.value32, sizeof(u32));
+        break;
+
+      case InstructionCode::Increment8:
+        emit_modify(Type::Increment, inst.address, inst.value8, sizeof(u8));
+        break;
+
+      case InstructionCode::Increment16:
+        emit_modify(Type::Increment, inst.address, inst.value16, sizeof(u16));
+        break;
+
+      case InstructionCode::ExtIncrement32:
+        emit_modify(Type::Increment, inst.address, inst.value32, sizeof(u32));
+        break;
+
+      case InstructionCode::Decrement8:
+        emit_modify(Type::Decrement, inst.address, inst.value8, sizeof(u8));
+        break;
+
+      case InstructionCode::Decrement16:
+        emit_modify(Type::Decrement, inst.address, inst.value16, sizeof(u16));
+        break;
+
+      case InstructionCode::ExtDecrement32:
+        emit_modify(Type::Decrement, inst.address, inst.value32, sizeof(u32));
+        break;
+
+      case InstructionCode::CompareEqual8:
+      case InstructionCode::CompareNotEqual8:
+      case InstructionCode::CompareLess8:
+      case InstructionCode::CompareGreater8:
+      {
+        static constexpr Condition conditions[] = {Condition::Equal, Condition::NotEqual, Condition::Less,
+                                                   Condition::Greater};
+        const u32 condition_index =
+          static_cast<u32>(inst.code.GetValue()) - static_cast<u32>(InstructionCode::CompareEqual8);
+        emit_compare(Type::CompareMemory, conditions[condition_index], inst.address, inst.value8, sizeof(u8),
+                     cc.GetNextNonConditionalInstruction(index));
+      }
+      break;
+
+      case InstructionCode::CompareEqual16:
+      case InstructionCode::CompareNotEqual16:
+      case InstructionCode::CompareLess16:
+      case InstructionCode::CompareGreater16:
+      {
+        static constexpr Condition conditions[] = {Condition::Equal, Condition::NotEqual, Condition::Less,
+                                                   Condition::Greater};
+        const u32 condition_index =
+          static_cast<u32>(inst.code.GetValue()) - static_cast<u32>(InstructionCode::CompareEqual16);
+        emit_compare(Type::CompareMemory, conditions[condition_index], inst.address, inst.value16, sizeof(u16),
+                     cc.GetNextNonConditionalInstruction(index));
+      }
+      break;
+
+      case InstructionCode::ExtCompareEqual32:
+      case InstructionCode::ExtCompareNotEqual32:
+      case InstructionCode::ExtCompareLess32:
+      case InstructionCode::ExtCompareGreater32:
+      {
+        static constexpr Condition conditions[] = {Condition::Equal, Condition::NotEqual, Condition::Less,
+                                                   Condition::Greater};
+        const u32 condition_index =
+          static_cast<u32>(inst.code.GetValue()) - static_cast<u32>(InstructionCode::ExtCompareEqual32);
+        emit_compare(Type::CompareMemory, conditions[condition_index], inst.address, inst.value32, sizeof(u32),
+                     cc.GetNextNonConditionalInstruction(index));
+      }
+      break;
+
+      case InstructionCode::CompareButtons: // D4
+        emit_compare(Type::CompareButtons, Condition::Equal, 0, inst.value16, 0,
+                     cc.GetNextNonConditionalInstruction(index));
+        break;
+
+      case InstructionCode::SkipIfNotEqual16: // C0
+        emit_compare(Type::CompareMemory, Condition::Equal, inst.address, inst.value16, sizeof(u16),
+                     GetSkipToSeparatorTarget(cc.instructions, index + 1));
+        break;
+
+      case InstructionCode::ExtSkipIfNotEqual32: // A4
+        emit_compare(Type::CompareMemory, Condition::Equal, inst.address, inst.value32, sizeof(u32),
+                     GetSkipToSeparatorTarget(cc.instructions, index + 1));
+        break;
+
+      case InstructionCode::SkipIfButtonsNotEqual: // D5
+        emit_compare(Type::CompareButtons, Condition::Equal, 0, inst.value16, 0,
+                     GetSkipToSeparatorTarget(cc.instructions, index + 1));
+        break;
+
+      case InstructionCode::SkipIfButtonsEqual: // D6
+        emit_compare(Type::CompareButtons, Condition::NotEqual, 0, inst.value16, 0,
+                     GetSkipToSeparatorTarget(cc.instructions, index + 1));
+        break;
+
+      case InstructionCode::DelayActivation: // C1
+        emit_compare(Type::CompareDelay, Condition::Equal, 0, inst.value16, 0, count);
+        break;
+
+      default:
+      {
+        // slides, copies, range clamps etc. are rare enough to leave to the interpreter
+        m_program.resize(program_start);
+        m_program_data.resize(data_start);
+        return false;
+      }
+    }
+  }
+
+  instruction_op_index[count] = static_cast<u32>(m_program.size());
+  for (const auto& [op_index, target] : jumps)
+    m_program[op_index].target = instruction_op_index[target];
+
+  return true;
+}
+
+static void StoreCompiledBytes(u8* ptr, const void* data, u32 length, bool in_ram)
+{
+  if (std::memcmp(ptr, data, length) == 0)
+    return;
+
+  std::memcpy(ptr, data, length);
+
+  // Only invalidate code when it changes.
+  if (in_ram)
+  {
+    const u32 offset = static_cast<u32>(ptr - Bus::g_ram);
+    const u32 last_page = Bus::GetRAMCodePageIndex(offset + length - 1);
+    for (u32 page = Bus::GetRAMCodePageIndex(offset); page <= last_page; page++)
+    {
+      if (Bus::IsRAMCodePage(page))
+        CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+    }
+  }
+}
+
+void CheatList::ExecuteProgram()
+{
+  using Type = CompiledOp::Type;
+  using Condition = CompiledOp::Condition;
+
+  const u32 count = static_cast<u32>(m_program.size());
+  u32 pc = 0;
+  while (pc < count)
+  {
+    const CompiledOp& op = m_program[pc++];
+    switch (op.type)
+    {
+      case Type::Write:
+        StoreCompiledBytes(op.ptr, &m_program_data[op.value], op.length, op.in_ram);
+        break;
+
+      case Type::BitSet:
+      case Type::BitClear:
+      case Type::Increment:
+      case Type::Decrement:
+      {
+        u32 value = 0;
+        std::memcpy(&value, op.ptr, op.size);
+        if (op.type == Type::BitSet)
+          value |= op.value;
+        else if (op.type == Type::BitClear)
+          value &= ~op.value;
+        else if (op.type == Type::Increment)
+          value += op.value;
+        else
+          value -= op.value;
+
+        StoreCompiledBytes(op.ptr, &value, op.size, op.in_ram);
+      }
+      break;
+
+      case Type::CompareDelay:
+      {
+        // same timing as the interpreter, see DelayActivation
+        if (((System::GetFrameNumber() * 10) / 3) < op.value)
+          pc = op.target;
+      }
+      break;
+
+      case Type::CompareMemory:
+      case Type::CompareButtons:
+      {
+        u32 value = 0;
+        if (op.type == Type::CompareMemory)
+          std::memcpy(&value, op.ptr, op.size);
+        else
+          value = GetControllerButtonBits();
+
+        bool result;
+        switch (op.condition)
+        {
+          case Condition::Equal:
+            result = (value == op.value);
+            break;
+          case Condition::NotEqual:
+            result = (value != op.value);
+            break;
+          case Condition::Less:
+            result = (value < op.value);
+            break;
+          case Condition::Greater:
+          default:
+            result = (value > op.value);
+            break;
+        }
+
+        if (!result)
+          pc = op.target;
+      }
+      break;
+
+      case Type::Interpret:
+        m_codes[op.value].Apply();
+        break;
+    }
+  }
+}
+
 std::string CheatCode::GetInstructionsAsString() const
 {
   std::stringstream ss;
@@ -1675,146 +2100,10 @@ MemoryScan::MemoryScan() = default;
 
 MemoryScan::~MemoryScan() = default;
 
-void MemoryScan::ResetSearch()
-{
-  m_results.clear();
-}
-
-void MemoryScan::Search()
-{
-  m_results.clear();
-
-  switch (m_size)
-  {
-    case MemoryAccessSize::Byte:
-      SearchBytes();
-      break;
-
-    case MemoryAccessSize::HalfWord:
-      SearchHalfwords();
-      break;
-
-    case MemoryAccessSize::Word:
-      SearchWords();
-      break;
-
-    default:
-      break;
-  }
-}
-
-void MemoryScan::SearchBytes()
-{
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address++)
-  {
-    if (!IsValidScanAddress(address))
-      continue;
-
-    const u8 bvalue = DoMemoryRead<u8>(address);
-
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
-
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
-  }
-}
-
-void MemoryScan::SearchHalfwords()
-{
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 2)
-  {
-    if (!IsValidScanAddress(address))
-      continue;
-
-    const u16 bvalue = DoMemoryRead<u16>(address);
-
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
-
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
-  }
-}
-
-void MemoryScan::SearchWords()
-{
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 4)
-  {
-    if (!IsValidScanAddress(address))
-      continue;
-
-    Result res;
-    res.address = address;
-    res.value = DoMemoryRead<u32>(address);
-    res.last_value = res.value;
-    res.value_changed = false;
-
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
-  }
-}
-
-void MemoryScan::SearchAgain()
-{
-  ResultVector new_results;
-  new_results.reserve(m_results.size());
-  for (Result& res : m_results)
-  {
-    res.UpdateValue(m_size, m_signed);
-
-    if (res.Filter(m_operator, m_value, m_signed))
-    {
-      res.last_value = res.value;
-      new_results.push_back(res);
-    }
-  }
-
-  m_results.swap(new_results);
-}
-
-void MemoryScan::UpdateResultsValues()
-{
-  for (Result& res : m_results)
-    res.UpdateValue(m_size, m_signed);
-}
-
-void MemoryScan::SetResultValue(u32 index, u32 value)
+static bool FilterScanValue(MemoryScan::Operator op, u32 value, u32 last_value, u32 comp_value, bool is_signed)
 {
-  if (index >= m_results.size())
-    return;
-
-  Result& res = m_results[index];
-  if (res.value == value)
-    return;
+  using Operator = MemoryScan::Operator;
 
-  switch (m_size)
-  {
-    case MemoryAccessSize::Byte:
-      DoMemoryWrite<u8>(res.address, Truncate8(value));
-      break;
-
-    case MemoryAccessSize::HalfWord:
-      DoMemoryWrite<u16>(res.address, Truncate16(value));
-      break;
-
-    case MemoryAccessSize::Word:
-      CPU::SafeWriteMemoryWord(res.address, value);
-      break;
-  }
-
-  res.value = value;
-  res.value_changed = true;
-}
-
-bool MemoryScan::Result::Filter(Operator op, u32 comp_value, bool is_signed) const
-{
   switch (op)
   {
     case Operator::Equal:
@@ -1905,34 +2194,434 @@ bool MemoryScan::Result::Filter(Operator op, u32 comp_value, bool is_signed) con
   }
 }
 
-void MemoryScan::Result::UpdateValue(MemoryAccessSize size, bool is_signed)
+template<typename T>
+ALWAYS_INLINE static u32 ExtendScanValue(T value, bool is_signed)
+{
+  if constexpr (sizeof(T) == sizeof(u32))
+    return value;
+  else
+    return is_signed ? SignExtend32(value) : ZeroExtend32(value);
+}
+
+template<typename T>
+ALWAYS_INLINE static u32 ReadScanValue(const u8* ptr, bool is_signed)
+{
+  T value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return ExtendScanValue(value, is_signed);
+}
+
+/// Returns the number of contiguous readable bytes at the address, and where they are.
+static u32 GetScanSegment(PhysicalMemoryAddress address, PhysicalMemoryAddress end, const u8** ptr)
 {
-  const u32 old_value = value;
+  if ((address & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION &&
+      (address & CPU::DCACHE_OFFSET_MASK) < CPU::DCACHE_SIZE)
+  {
+    *ptr = &CPU::g_state.dcache[address & CPU::DCACHE_OFFSET_MASK];
+    return std::min<u32>(end - address, CPU::DCACHE_SIZE - (address & CPU::DCACHE_OFFSET_MASK));
+  }
 
-  switch (size)
+  const PhysicalMemoryAddress phys_address = address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+  if (phys_address < Bus::RAM_MIRROR_END)
   {
-    case MemoryAccessSize::Byte:
+    *ptr = &Bus::g_ram[phys_address & Bus::RAM_MASK];
+    return std::min<u32>(end - address, Bus::RAM_SIZE - (phys_address & Bus::RAM_MASK));
+  }
+
+  if (phys_address >= Bus::BIOS_BASE && phys_address < (Bus::BIOS_BASE + Bus::BIOS_SIZE))
+  {
+    *ptr = &Bus::g_bios[phys_address & Bus::BIOS_MASK];
+    return std::min<u32>(end - address, Bus::BIOS_SIZE - (phys_address & Bus::BIOS_MASK));
+  }
+
+  return 0;
+}
+
+/// Copies memory which may span several readable regions. Returns false if any of it isn't readable, in which case
+/// the corresponding bytes of the destination are left untouched.
+static bool ReadScanMemory(PhysicalMemoryAddress address, u8* dst, u32 size)
+{
+  while (size > 0)
+  {
+    const u8* ptr = nullptr;
+    const u32 length = GetScanSegment(address, address + size, &ptr);
+    if (length == 0)
+      return false;
+
+    std::memcpy(dst, ptr, length);
+    address += length;
+    dst += length;
+    size -= length;
+  }
+
+  return true;
+}
+
+#if defined(CPU_X64)
+static constexpr u64 SCAN_BLOCK_ALL_EQUAL = 0xFFFF;
+#else
+static constexpr u64 SCAN_BLOCK_ALL_EQUAL = ~UINT64_C(0);
+#endif
+
+/// Compares two 16-byte blocks element-wise. Returns zero if no elements are equal, SCAN_BLOCK_ALL_EQUAL if they all
+/// are, and something in between otherwise.
+template<typename T>
+ALWAYS_INLINE static u64 CompareScanBlock(const u8* lhs, const u8* rhs)
+{
+#if defined(CPU_X64)
+  const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs));
+  const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs));
+  __m128i eq;
+  if constexpr (sizeof(T) == sizeof(u8))
+    eq = _mm_cmpeq_epi8(a, b);
+  else if constexpr (sizeof(T) == sizeof(u16))
+    eq = _mm_cmpeq_epi16(a, b);
+  else
+    eq = _mm_cmpeq_epi32(a, b);
+
+  return static_cast<u64>(_mm_movemask_epi8(eq));
+#elif defined(CPU_AARCH64)
+  uint8x16_t eq;
+  if constexpr (sizeof(T) == sizeof(u8))
+    eq = vceqq_u8(vld1q_u8(lhs), vld1q_u8(rhs));
+  else if constexpr (sizeof(T) == sizeof(u16))
+    eq = vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(vld1q_u8(lhs)), vreinterpretq_u16_u8(vld1q_u8(rhs))));
+  else
+    eq = vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(lhs)), vreinterpretq_u32_u8(vld1q_u8(rhs))));
+
+  // four bits per byte
+  return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+#else
+  u64 mask = 0;
+  for (u32 i = 0; i < 16; i += sizeof(T))
+  {
+    if (std::memcmp(lhs + i, rhs + i, sizeof(T)) == 0)
+      mask |= ((UINT64_C(1) << sizeof(T)) - 1) << i;
+  }
+
+  return (mask == 0xFFFF) ? SCAN_BLOCK_ALL_EQUAL : mask;
+#endif
+}
+
+template<typename T>
+static void ScanElements(const u8* values, const u8* last_values, u32 start_offset, u32 end_offset,
+                         MemoryScan::Operator op, u32 comp_value, bool is_signed, PhysicalMemoryAddress base_address,
+                         std::vector<PhysicalMemoryAddress>* results)
+{
+  using Operator = MemoryScan::Operator;
+
+  u32 offset = start_offset;
+
+  // Equality tests can discard whole blocks at a time. Comparison values which don't fit in the element size can't
+  // compare equal to anything.
+  const T narrow_comp_value = static_cast<T>(comp_value);
+  const bool comp_value_fits = (ExtendScanValue(narrow_comp_value, is_signed) == comp_value);
+  if ((op == Operator::Equal || op == Operator::NotEqual) && comp_value_fits)
+  {
+    alignas(16) u8 comp_block[16];
+    for (u32 i = 0; i < sizeof(comp_block); i += sizeof(T))
+      std::memcpy(&comp_block[i], &narrow_comp_value, sizeof(T));
+
+    const u64 skip_mask = (op == Operator::Equal) ? 0 : SCAN_BLOCK_ALL_EQUAL;
+    for (; (offset + 16) <= end_offset; offset += 16)
     {
-      u8 bvalue = DoMemoryRead<u8>(address);
-      value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
+      if (CompareScanBlock<T>(values + offset, comp_block) == skip_mask)
+        continue;
+
+      for (u32 i = 0; i < 16; i += sizeof(T))
+      {
+        if (FilterScanValue(op, ReadScanValue<T>(values + offset + i, is_signed), 0, comp_value, is_signed))
+          results->push_back(base_address + offset + i);
+      }
     }
-    break;
+  }
+  else if (op == Operator::EqualLast || op == Operator::NotEqualLast)
+  {
+    const u64 skip_mask = (op == Operator::EqualLast) ? 0 : SCAN_BLOCK_ALL_EQUAL;
+    for (; (offset + 16) <= end_offset; offset += 16)
+    {
+      const u64 mask = CompareScanBlock<T>(values + offset, last_values + offset);
+      if (mask == skip_mask)
+        continue;
+
+      for (u32 i = 0; i < 16; i += sizeof(T))
+      {
+        if ((std::memcmp(values + offset + i, last_values + offset + i, sizeof(T)) == 0) == (op == Operator::EqualLast))
+          results->push_back(base_address + offset + i);
+      }
+    }
+  }
+  else if (op == Operator::Equal && !comp_value_fits)
+  {
+    return;
+  }
+
+  for (; offset < end_offset; offset += sizeof(T))
+  {
+    const u32 value = ReadScanValue<T>(values + offset, is_signed);
+    const u32 last_value = ReadScanValue<T>(last_values + offset, is_signed);
+    if (FilterScanValue(op, value, last_value, comp_value, is_signed))
+      results->push_back(base_address + offset);
+  }
+}
+
+void MemoryScan::ResetSearch()
+{
+  m_snapshot_segments.clear();
+  m_values = {};
+  m_last_values = {};
+  m_result_addresses = {};
+  m_result_changed = {};
+}
+
+void MemoryScan::TakeSnapshot(std::vector<u8>* snapshot) const
+{
+  // padded, so the last element can always be read in full
+  u32 size = 0;
+  if (!m_snapshot_segments.empty())
+    size = m_snapshot_segments.back().data_offset + m_snapshot_segments.back().length;
+  snapshot->resize(size + sizeof(u32));
+
+  for (const Segment& segment : m_snapshot_segments)
+  {
+    if (!ReadScanMemory(m_snapshot_start + segment.offset, snapshot->data() + segment.data_offset, segment.length))
+      Log_WarningPrintf("Failed to read memory scan segment at 0x%08X", m_snapshot_start + segment.offset);
+  }
+}
+
+void MemoryScan::ReadResultValues(std::vector<u8>* snapshot) const
+{
+  const u32 element_size = 1u << static_cast<u32>(m_size);
+  for (const PhysicalMemoryAddress address : m_result_addresses)
+    ReadScanMemory(address, snapshot->data() + GetSnapshotOffset(address), element_size);
+}
+
+u32 MemoryScan::GetSnapshotOffset(PhysicalMemoryAddress address) const
+{
+  // results only ever lie inside a segment
+  const u32 offset = address - m_snapshot_start;
+  auto iter = std::upper_bound(m_snapshot_segments.begin(), m_snapshot_segments.end(), offset,
+                               [](u32 value, const Segment& segment) { return value < segment.offset; });
+  DebugAssert(iter != m_snapshot_segments.begin());
+  --iter;
+  return iter->data_offset + (offset - iter->offset);
+}
+
+u32 MemoryScan::ReadSnapshotValue(const std::vector<u8>& snapshot, PhysicalMemoryAddress address) const
+{
+  const u8* ptr = snapshot.data() + GetSnapshotOffset(address);
+  switch (m_size)
+  {
+    case MemoryAccessSize::Byte:
+      return ReadScanValue<u8>(ptr, m_signed);
 
     case MemoryAccessSize::HalfWord:
+      return ReadScanValue<u16>(ptr, m_signed);
+
+    case MemoryAccessSize::Word:
+    default:
+      return ReadScanValue<u32>(ptr, m_signed);
+  }
+}
+
+u32 MemoryScan::GetElementCount() const
+{
+  const u32 element_size = 1u << static_cast<u32>(m_size);
+  u32 count = 0;
+  for (const Segment& segment : m_snapshot_segments)
+  {
+    const u32 first = Common::AlignUp(segment.offset, element_size);
+    const u32 end = std::min(segment.offset + segment.length, m_snapshot_end - m_snapshot_start);
+    if (first < end)
+      count += ((end - first) + (element_size - 1)) / element_size;
+  }
+
+  return count;
+}
+
+void MemoryScan::ScanSegments()
+{
+  const u32 element_size = 1u << static_cast<u32>(m_size);
+  for (const Segment& segment : m_snapshot_segments)
+  {
+    const u32 start = Common::AlignUp(segment.offset, element_size);
+    const u32 end = std::min(segment.offset + segment.length, m_snapshot_end - m_snapshot_start);
+    if (start >= end)
+      continue;
+
+    // ScanElements() works on offsets from the start of the segment
+    const u8* values = m_values.data() + segment.data_offset;
+    const u8* last_values = m_last_values.data() + segment.data_offset;
+    const u32 local_start = start - segment.offset;
+    const u32 local_end = end - segment.offset;
+    const PhysicalMemoryAddress base_address = m_snapshot_start + segment.offset;
+
+    switch (m_size)
     {
-      u16 bvalue = DoMemoryRead<u16>(address);
-      value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
+      case MemoryAccessSize::Byte:
+        ScanElements<u8>(values, last_values, local_start, local_end, m_operator, m_value, m_signed, base_address,
+                         &m_result_addresses);
+        break;
+
+      case MemoryAccessSize::HalfWord:
+        ScanElements<u16>(values, last_values, local_start, local_end, m_operator, m_value, m_signed, base_address,
+                          &m_result_addresses);
+        break;
+
+      case MemoryAccessSize::Word:
+        ScanElements<u32>(values, last_values, local_start, local_end, m_operator, m_value, m_signed, base_address,
+                          &m_result_addresses);
+        break;
     }
-    break;
+  }
+}
 
-    case MemoryAccessSize::Word:
+void MemoryScan::Search()
+{
+  ResetSearch();
+
+  m_snapshot_start = m_start_address;
+  m_snapshot_end = std::max(m_start_address, m_end_address);
+
+  // elements starting before the end address are read in full
+  const PhysicalMemoryAddress capture_end = static_cast<PhysicalMemoryAddress>(
+    std::min<u64>(static_cast<u64>(m_snapshot_end) + (sizeof(u32) - 1), UINT32_C(0xFFFFFFFF)));
+  u32 data_offset = 0;
+  for (PhysicalMemoryAddress address = m_snapshot_start; address < capture_end;)
+  {
+    const u8* ptr = nullptr;
+    const u32 length = GetScanSegment(address, capture_end, &ptr);
+    if (length == 0)
     {
-      CPU::SafeReadMemoryWord(address, &value);
+      // readable regions all start on a 1KB boundary
+      address = static_cast<PhysicalMemoryAddress>(
+        std::min<u64>(capture_end, Common::AlignDownPow2(static_cast<u64>(address), 0x400) + 0x400));
+      continue;
     }
-    break;
+
+    m_snapshot_segments.push_back(Segment{address - m_snapshot_start, length, data_offset});
+    data_offset += length;
+    address += length;
+  }
+
+  TakeSnapshot(&m_values);
+  m_last_values = m_values;
+  ScanSegments();
+  m_result_changed.resize(m_result_addresses.size());
+}
+
+void MemoryScan::SearchAgain()
+{
+  if (m_result_addresses.empty())
+    return;
+
+  // results are flagged as changed if the value differs from the last search or update
+  if (m_result_addresses.size() == GetElementCount())
+  {
+    // nothing has been filtered out yet, so compare the snapshots in one pass
+    std::vector<u8> old_values;
+    old_values.swap(m_values);
+    TakeSnapshot(&m_values);
+    m_result_addresses.clear();
+    ScanSegments();
+
+    m_result_changed.resize(m_result_addresses.size());
+    for (size_t i = 0; i < m_result_addresses.size(); i++)
+    {
+      const PhysicalMemoryAddress address = m_result_addresses[i];
+      m_result_changed[i] = (ReadSnapshotValue(m_values, address) != ReadSnapshotValue(old_values, address));
+    }
+
+    m_last_values = m_values;
+  }
+  else
+  {
+    // only the remaining results are looked at from here on, so there's no need to read anything else
+    std::vector<u32> old_values;
+    old_values.reserve(m_result_addresses.size());
+    for (const PhysicalMemoryAddress address : m_result_addresses)
+      old_values.push_back(ReadSnapshotValue(m_values, address));
+
+    ReadResultValues(&m_values);
+
+    const u32 element_size = 1u << static_cast<u32>(m_size);
+    std::vector<PhysicalMemoryAddress> new_results;
+    std::vector<bool> new_changed;
+    new_results.reserve(m_result_addresses.size());
+    new_changed.reserve(m_result_addresses.size());
+    for (size_t i = 0; i < m_result_addresses.size(); i++)
+    {
+      const PhysicalMemoryAddress address = m_result_addresses[i];
+      const u32 value = ReadSnapshotValue(m_values, address);
+      const u32 last_value = ReadSnapshotValue(m_last_values, address);
+      if (!FilterScanValue(m_operator, value, last_value, m_value, m_signed))
+        continue;
+
+      const u32 offset = GetSnapshotOffset(address);
+      std::memcpy(&m_last_values[offset], &m_values[offset], element_size);
+      new_results.push_back(address);
+      new_changed.push_back(value != old_values[i]);
+    }
+
+    m_result_addresses.swap(new_results);
+    m_result_changed.swap(new_changed);
+  }
+}
+
+void MemoryScan::UpdateResultsValues()
+{
+  if (m_result_addresses.empty())
+    return;
+
+  const u32 element_size = 1u << static_cast<u32>(m_size);
+  for (size_t i = 0; i < m_result_addresses.size(); i++)
+  {
+    const PhysicalMemoryAddress address = m_result_addresses[i];
+    u8* value = &m_values[GetSnapshotOffset(address)];
+    u8 new_value[sizeof(u32)];
+    std::memcpy(new_value, value, element_size);
+    ReadScanMemory(address, new_value, element_size);
+    m_result_changed[i] = (std::memcmp(new_value, value, element_size) != 0);
+    std::memcpy(value, new_value, element_size);
+  }
+}
+
+MemoryScan::Result MemoryScan::GetResult(u32 index) const
+{
+  Result res;
+  res.address = m_result_addresses[index];
+  res.value = ReadSnapshotValue(m_values, res.address);
+  res.last_value = ReadSnapshotValue(m_last_values, res.address);
+  res.value_changed = m_result_changed[index];
+  return res;
+}
+
+void MemoryScan::SetResultValue(u32 index, u32 value)
+{
+  if (index >= m_result_addresses.size())
+    return;
+
+  const PhysicalMemoryAddress address = m_result_addresses[index];
+  if (ReadSnapshotValue(m_values, address) == value)
+    return;
+
+  switch (m_size)
+  {
+    case MemoryAccessSize::Byte:
+      DoMemoryWrite<u8>(address, Truncate8(value));
+      break;
+
+    case MemoryAccessSize::HalfWord:
+      DoMemoryWrite<u16>(address, Truncate16(value));
+      break;
+
+    case MemoryAccessSize::Word:
+      CPU::SafeWriteMemoryWord(address, value);
+      break;
   }
 
-  value_changed = (value != old_value);
+  std::memcpy(&m_values[GetSnapshotOffset(address)], &value, 1u << static_cast<u32>(m_size));
+  m_result_changed[index] = true;
 }
 
 MemoryWatchList::MemoryWatchList() = default;
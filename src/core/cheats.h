@@ -176,8 +176,55 @@ public:
   void MergeList(const CheatList& cl);
 
 private:
+  // Enabled codes are compiled to a flat list of operations with the addresses already resolved to host pointers, so
+  // applying them each frame doesn't go through the interpreter. Conditionals become jumps within the list, and runs of
+  // constant writes to consecutive addresses are merged into a single copy. Codes using instructions which can't be
+  // compiled are left to the interpreter.
+  struct CompiledOp
+  {
+    enum class Type : u8
+    {
+      Write, // copies length bytes starting at value in the data pool
+      BitSet,
+      BitClear,
+      Increment,
+      Decrement,
+      CompareMemory, // jumps to target when the condition doesn't hold
+      CompareButtons,
+      CompareDelay,
+      Interpret, // value is the code index
+    };
+
+    enum class Condition : u8
+    {
+      Equal,
+      NotEqual,
+      Less,
+      Greater
+    };
+
+    Type type;
+    Condition condition;
+    u8 size;
+    bool in_ram;
+    u32 value;
+    u32 length;
+    u32 target;
+    u8* ptr;
+  };
+
+  void InvalidateProgram();
+  void CompileProgram();
+  bool CompileCode(u32 code_index);
+  void ExecuteProgram();
+
   std::vector<CheatCode> m_codes;
   bool m_master_enable = true;
+
+  std::vector<CompiledOp> m_program;
+  std::vector<u8> m_program_data;
+  const u8* m_program_ram = nullptr;
+  bool m_program_valid = false;
 };
 
 class MemoryScan
@@ -209,13 +256,8 @@ public:
     u32 value;
     u32 last_value;
     bool value_changed;
-
-    bool Filter(Operator op, u32 comp_value, bool is_signed) const;
-    void UpdateValue(MemoryAccessSize size, bool is_signed);
   };
 
-  using ResultVector = std::vector<Result>;
-
   MemoryScan();
   ~MemoryScan();
 
@@ -225,9 +267,8 @@ public:
   Operator GetOperator() const { return m_operator; }
   PhysicalMemoryAddress GetStartAddress() const { return m_start_address; }
   PhysicalMemoryAddress GetEndAddress() const { return m_end_address; }
-  const ResultVector& GetResults() const { return m_results; }
-  const Result& GetResult(u32 index) const { return m_results[index]; }
-  u32 GetResultCount() const { return static_cast<u32>(m_results.size()); }
+  u32 GetResultCount() const { return static_cast<u32>(m_result_addresses.size()); }
+  Result GetResult(u32 index) const;
 
   void SetValue(u32 value) { m_value = value; }
   void SetValueSigned(bool s) { m_signed = s; }
@@ -244,17 +285,41 @@ public:
   void SetResultValue(u32 index, u32 value);
 
 private:
-  void SearchBytes();
-  void SearchHalfwords();
-  void SearchWords();
+  // Searches work on snapshots of the readable parts of the range rather than reading each address through the bus.
+  // Snapshots are packed, segment after segment, so unmapped gaps in the range cost nothing. Results are kept as a list
+  // of addresses, their values are looked up in the snapshots. m_values holds the memory as of the last search or
+  // update, m_last_values as of the previous search. Once the results have been narrowed down, only their values are
+  // re-read.
+  struct Segment
+  {
+    u32 offset;      // from m_snapshot_start
+    u32 length;      // in bytes
+    u32 data_offset; // in the snapshot
+  };
+
+  void TakeSnapshot(std::vector<u8>* snapshot) const;
+  void ReadResultValues(std::vector<u8>* snapshot) const;
+  u32 GetSnapshotOffset(PhysicalMemoryAddress address) const;
+  u32 ReadSnapshotValue(const std::vector<u8>& snapshot, PhysicalMemoryAddress address) const;
+  u32 GetElementCount() const;
+  void ScanSegments();
 
   u32 m_value = 0;
   MemoryAccessSize m_size = MemoryAccessSize::HalfWord;
   Operator m_operator = Operator::Equal;
   PhysicalMemoryAddress m_start_address = 0;
   PhysicalMemoryAddress m_end_address = 0x200000;
-  ResultVector m_results;
   bool m_signed = false;
+
+  // range the snapshots were taken over, fixed until the search is reset
+  PhysicalMemoryAddress m_snapshot_start = 0;
+  PhysicalMemoryAddress m_snapshot_end = 0;
+  std::vector<Segment> m_snapshot_segments;
+  std::vector<u8> m_values;
+  std::vector<u8> m_last_values;
+
+  std::vector<PhysicalMemoryAddress> m_result_addresses;
+  std::vector<bool> m_result_changed;
 };
 
 class MemoryWatchList
@@ -18,6 +18,8 @@ bool Controller::DoState(StateWrapper& sw, bool apply_input_state)
   return !sw.HasError();
 }
 
+void Controller::DoInputState(StateWrapper& sw) {}
+
 void Controller::ResetTransferState() {}
 
 bool Controller::Transfer(const u8 data_in, u8* data_out)
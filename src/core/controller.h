@@ -39,6 +39,9 @@ public:
   virtual void Reset();
   virtual bool DoState(StateWrapper& sw, bool apply_input_state);
 
+  /// Serializes only the host-driven input state (buttons, axes, pointer positions), for input movies.
+  virtual void DoInputState(StateWrapper& sw);
+
   // Resets all state for the transferring to/from the device.
   virtual void ResetTransferState();
 
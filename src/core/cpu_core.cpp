@@ -7,6 +7,7 @@
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
 #include "cpu_recompiler_thunks.h"
+#include "cpu_trace.h"
 #include "gte.h"
 #include "host_interface.h"
 #include "pgxp.h"
@@ -32,6 +33,7 @@ bool TRACE_EXECUTION = false;
 static std::FILE* s_log_file = nullptr;
 static bool s_log_file_opened = false;
 static bool s_trace_to_log = false;
+static Trace::Writer s_trace_writer;
 
 static constexpr u32 INVALID_BREAKPOINT_PC = UINT32_C(0xFFFFFFFF);
 static std::vector<Breakpoint> s_breakpoints;
@@ -49,6 +51,9 @@ void StartTrace()
   if (s_trace_to_log)
     return;
 
+  if (!s_trace_writer.Open("cpu_trace.bin", g_state.regs))
+    return;
+
   s_trace_to_log = true;
   UpdateDebugDispatcherFlag();
 }
@@ -58,6 +63,8 @@ void StopTrace()
   if (!s_trace_to_log)
     return;
 
+  s_trace_writer.Close();
+
   if (s_log_file)
     std::fclose(s_log_file);
 
@@ -489,21 +496,19 @@ static void PrintInstruction(u32 bits, u32 pc, Registers* regs)
   std::printf("%08x: %08x %s\n", pc, bits, instr.GetCharArray());
 }
 
-static void LogInstruction(u32 bits, u32 pc, Registers* regs)
+static void TraceInstruction()
 {
-  TinyString instr;
-  TinyString comment;
-  DisassembleInstruction(&instr, pc, bits);
-  DisassembleInstructionComment(&comment, pc, bits, regs);
-  if (!comment.IsEmpty())
-  {
-    for (u32 i = instr.GetLength(); i < 30; i++)
-      instr.AppendCharacter(' ');
-    instr.AppendString("; ");
-    instr.AppendString(comment);
-  }
+  const Instruction inst = g_state.current_instruction;
+
+  // GPR loads go through the load delay slot, GPR stores are picked up from the previous state by the writer
+  u32 memory_value = 0;
+  if (inst.op == InstructionOp::lwc2 || inst.op == InstructionOp::swc2)
+    memory_value = GTE::ReadRegister(static_cast<u32>(inst.i.rt.GetValue()));
+  else if (IsMemoryLoadInstruction(inst))
+    memory_value = g_state.load_delay_value;
 
-  WriteToExecutionLog("%08x: %08x %s\n", pc, bits, instr.GetCharArray());
+  s_trace_writer.EndInstruction(g_state.current_instruction_pc, inst.bits, g_state.regs, g_state.exception_raised,
+                                memory_value);
 }
 
 ALWAYS_INLINE static constexpr bool AddOverflow(u32 old_value, u32 add_value, u32 new_value)
@@ -1791,7 +1796,7 @@ static void ExecuteImpl()
       if constexpr (debug)
       {
         if (s_trace_to_log)
-          LogInstruction(g_state.current_instruction.bits, g_state.current_instruction_pc, &g_state.regs);
+          s_trace_writer.BeginInstruction(g_state.regs);
       }
 
 #if 0 // GTE flag test debugging
@@ -1807,6 +1812,12 @@ static void ExecuteImpl()
 
       // next load delay
       UpdateLoadDelay();
+
+      if constexpr (debug)
+      {
+        if (s_trace_to_log)
+          TraceInstruction();
+      }
     }
 
     TimingEvents::RunEvents();
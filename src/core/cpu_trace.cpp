@@ -0,0 +1,433 @@
+#include "cpu_trace.h"
+#include "common/assert.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "zlib.h"
+#include <algorithm>
+Log_SetChannel(CPU::Trace);
+
+namespace CPU::Trace {
+
+ALWAYS_INLINE static u8* WriteU32(u8* ptr, u32 value)
+{
+  std::memcpy(ptr, &value, sizeof(value));
+  return ptr + sizeof(value);
+}
+
+static u32 GetMemoryAccessSizeShift(InstructionOp op)
+{
+  switch (op)
+  {
+    case InstructionOp::lb:
+    case InstructionOp::lbu:
+    case InstructionOp::sb:
+      return 0;
+
+    case InstructionOp::lh:
+    case InstructionOp::lhu:
+    case InstructionOp::sh:
+      return 1;
+
+    default:
+      return 2;
+  }
+}
+
+Writer::Writer() = default;
+
+Writer::~Writer()
+{
+  Close();
+}
+
+bool Writer::Open(const char* filename, const Registers& regs)
+{
+  Close();
+
+  m_file = FileSystem::OpenCFile(filename, "wb");
+  if (!m_file)
+  {
+    Log_ErrorPrintf("Failed to open trace file '%s'", filename);
+    return false;
+  }
+
+  FileHeader header = {};
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.start_pc = regs.pc;
+  std::memcpy(header.regs, regs.r, sizeof(header.regs));
+  if (std::fwrite(&header, sizeof(header), 1, m_file) != 1)
+  {
+    Log_ErrorPrintf("Failed to write trace header to '%s'", filename);
+    std::fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+
+  // favour speed over ratio, the record stream is highly repetitive so even level 1 does well
+  z_stream* zs = new z_stream();
+  if (deflateInit(zs, 1) != Z_OK)
+  {
+    Log_ErrorPrintf("deflateInit() failed");
+    delete zs;
+    std::fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+  m_zstream = zs;
+
+  for (std::vector<u8>& buffer : m_buffers)
+    buffer.resize(BUFFER_SIZE);
+  m_compress_buffer.resize(BUFFER_SIZE);
+  m_current_buffer = 0;
+  m_current_buffer_pos = 0;
+  m_pending_buffer = false;
+  m_shutdown = false;
+  m_next_pc = regs.pc;
+
+  m_worker_thread = std::thread(&Writer::WorkerThreadEntryPoint, this);
+  return true;
+}
+
+void Writer::Close()
+{
+  if (!m_file)
+    return;
+
+  if (m_current_buffer_pos > 0)
+    SubmitBuffer();
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [this]() { return !m_pending_buffer; });
+    m_shutdown = true;
+    m_work_cv.notify_one();
+  }
+  m_worker_thread.join();
+
+  CompressAndWrite(nullptr, 0, true);
+
+  z_stream* zs = static_cast<z_stream*>(m_zstream);
+  deflateEnd(zs);
+  delete zs;
+  m_zstream = nullptr;
+
+  std::fclose(m_file);
+  m_file = nullptr;
+
+  for (std::vector<u8>& buffer : m_buffers)
+    std::vector<u8>().swap(buffer);
+  std::vector<u8>().swap(m_compress_buffer);
+}
+
+void Writer::EndInstruction(u32 pc, u32 bits, const Registers& regs, bool exception_raised, u32 memory_value)
+{
+  u8* const start = m_buffers[m_current_buffer].data() + m_current_buffer_pos;
+  u8* out = start + 1;
+  u8 flags = 0;
+
+  if (pc != m_next_pc)
+  {
+    flags |= RECORD_FLAG_EXPLICIT_PC;
+    out = WriteU32(out, pc);
+  }
+  m_next_pc = pc + 4;
+
+  out = WriteU32(out, bits);
+
+  u8* const num_reg_writes = out++;
+  *num_reg_writes = 0;
+  for (u32 i = 0; i < NUM_TRACED_REGS; i++)
+  {
+    if (regs.r[i] == m_prev_regs.r[i])
+      continue;
+
+    *(out++) = static_cast<u8>(i);
+    out = WriteU32(out, regs.r[i]);
+    (*num_reg_writes)++;
+  }
+
+  if (exception_raised)
+  {
+    // the access (if any) didn't complete
+    flags |= RECORD_FLAG_EXCEPTION;
+  }
+  else
+  {
+    const Instruction inst{bits};
+    const bool is_load = IsMemoryLoadInstruction(inst);
+    if (is_load || IsMemoryStoreInstruction(inst))
+    {
+      flags |= (is_load ? RECORD_FLAG_MEMORY_READ : RECORD_FLAG_MEMORY_WRITE) |
+               static_cast<u8>(GetMemoryAccessSizeShift(inst.op) << RECORD_FLAG_MEMORY_SIZE_SHIFT);
+
+      // GPR store values come from the pre-execution state, since a load delay could have overwritten rt since
+      if (!is_load && inst.op != InstructionOp::swc2)
+        memory_value = m_prev_regs.r[static_cast<u8>(inst.i.rt.GetValue())];
+
+      out = WriteU32(out, GetLoadStoreEffectiveAddress(inst, &m_prev_regs).value_or(0));
+      out = WriteU32(out, memory_value);
+    }
+  }
+
+  *start = flags;
+  m_current_buffer_pos += static_cast<u32>(out - start);
+  if (m_current_buffer_pos > (BUFFER_SIZE - MAX_RECORD_SIZE))
+    SubmitBuffer();
+}
+
+void Writer::SubmitBuffer()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_pending_buffer)
+    m_done_cv.wait(lock, [this]() { return !m_pending_buffer; });
+
+  m_pending_buffer = true;
+  m_pending_size = m_current_buffer_pos;
+  m_work_cv.notify_one();
+
+  m_current_buffer ^= 1;
+  m_current_buffer_pos = 0;
+}
+
+void Writer::WorkerThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    m_work_cv.wait(lock, [this]() { return m_pending_buffer || m_shutdown; });
+    if (!m_pending_buffer)
+      break;
+
+    // the buffer being filled was flipped on submit, so the pending one is the other
+    const u8* data = m_buffers[m_current_buffer ^ 1].data();
+    const u32 size = m_pending_size;
+    lock.unlock();
+    CompressAndWrite(data, size, false);
+    lock.lock();
+
+    m_pending_buffer = false;
+    m_done_cv.notify_one();
+  }
+}
+
+bool Writer::CompressAndWrite(const u8* data, u32 size, bool finish)
+{
+  z_stream* zs = static_cast<z_stream*>(m_zstream);
+  zs->next_in = const_cast<Bytef*>(data);
+  zs->avail_in = size;
+
+  for (;;)
+  {
+    zs->next_out = m_compress_buffer.data();
+    zs->avail_out = static_cast<uInt>(m_compress_buffer.size());
+
+    const int err = deflate(zs, finish ? Z_FINISH : Z_NO_FLUSH);
+    if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR)
+    {
+      Log_ErrorPrintf("deflate() failed: %d", err);
+      return false;
+    }
+
+    const size_t out_size = m_compress_buffer.size() - zs->avail_out;
+    if (out_size > 0 && std::fwrite(m_compress_buffer.data(), out_size, 1, m_file) != 1)
+    {
+      Log_ErrorPrintf("Failed to write %zu bytes to trace file", out_size);
+      return false;
+    }
+
+    if (finish ? (err == Z_STREAM_END) : (zs->avail_out != 0))
+      return true;
+  }
+}
+
+Reader::Reader() = default;
+
+Reader::~Reader()
+{
+  Close();
+}
+
+bool Reader::Open(const char* filename)
+{
+  Close();
+
+  m_file = FileSystem::OpenCFile(filename, "rb");
+  if (!m_file)
+  {
+    Log_ErrorPrintf("Failed to open trace file '%s'", filename);
+    return false;
+  }
+
+  FileHeader header;
+  if (std::fread(&header, sizeof(header), 1, m_file) != 1 || header.magic != FILE_MAGIC ||
+      header.version != FILE_VERSION)
+  {
+    Log_ErrorPrintf("Invalid or incompatible header in trace file '%s'", filename);
+    Close();
+    return false;
+  }
+
+  z_stream* zs = new z_stream();
+  if (inflateInit(zs) != Z_OK)
+  {
+    Log_ErrorPrintf("inflateInit() failed");
+    delete zs;
+    Close();
+    return false;
+  }
+  m_zstream = zs;
+
+  m_input_buffer.resize(INPUT_BUFFER_SIZE);
+  m_output_buffer.resize(OUTPUT_BUFFER_SIZE);
+  m_output_buffer_pos = 0;
+  m_output_buffer_size = 0;
+  m_stream_end = false;
+
+  m_regs = {};
+  std::memcpy(m_regs.r, header.regs, sizeof(header.regs));
+  m_regs.pc = header.start_pc;
+  m_next_pc = header.start_pc;
+  m_has_last_record = false;
+  m_record_index = 0;
+  return true;
+}
+
+void Reader::Close()
+{
+  if (m_zstream)
+  {
+    z_stream* zs = static_cast<z_stream*>(m_zstream);
+    inflateEnd(zs);
+    delete zs;
+    m_zstream = nullptr;
+  }
+
+  if (m_file)
+  {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+
+  std::vector<u8>().swap(m_input_buffer);
+  std::vector<u8>().swap(m_output_buffer);
+}
+
+bool Reader::ReadRecord(Record* record)
+{
+  if (m_has_last_record)
+  {
+    for (u32 i = 0; i < m_last_record.num_reg_writes; i++)
+      m_regs.r[m_last_record.reg_writes[i].reg] = m_last_record.reg_writes[i].value;
+    m_record_index++;
+    m_has_last_record = false;
+  }
+
+  if (!ReadValue(&record->flags))
+    return false;
+
+  if (record->flags & RECORD_FLAG_EXPLICIT_PC)
+  {
+    if (!ReadValue(&record->pc))
+      return false;
+  }
+  else
+  {
+    record->pc = m_next_pc;
+  }
+  m_next_pc = record->pc + 4;
+
+  if (!ReadValue(&record->bits) || !ReadValue(&record->num_reg_writes) ||
+      record->num_reg_writes > NUM_TRACED_REGS)
+  {
+    return false;
+  }
+
+  for (u32 i = 0; i < record->num_reg_writes; i++)
+  {
+    RegisterWrite& rw = record->reg_writes[i];
+    if (!ReadValue(&rw.reg) || !ReadValue(&rw.value) || rw.reg >= NUM_TRACED_REGS)
+      return false;
+  }
+
+  if (record->HasMemoryAccess())
+  {
+    if (!ReadValue(&record->memory_address) || !ReadValue(&record->memory_value))
+      return false;
+  }
+  else
+  {
+    record->memory_address = 0;
+    record->memory_value = 0;
+  }
+
+  m_regs.pc = record->pc;
+  m_regs.npc = record->pc + 4;
+  m_last_record = *record;
+  m_has_last_record = true;
+  return true;
+}
+
+bool Reader::ReadBytes(void* dst, u32 size)
+{
+  u8* dst_ptr = static_cast<u8*>(dst);
+  while (size > 0)
+  {
+    if (m_output_buffer_pos == m_output_buffer_size && !RefillOutputBuffer())
+      return false;
+
+    const u32 copy_size = std::min(size, m_output_buffer_size - m_output_buffer_pos);
+    std::memcpy(dst_ptr, m_output_buffer.data() + m_output_buffer_pos, copy_size);
+    m_output_buffer_pos += copy_size;
+    dst_ptr += copy_size;
+    size -= copy_size;
+  }
+
+  return true;
+}
+
+bool Reader::RefillOutputBuffer()
+{
+  if (m_stream_end)
+    return false;
+
+  z_stream* zs = static_cast<z_stream*>(m_zstream);
+  zs->next_out = m_output_buffer.data();
+  zs->avail_out = static_cast<uInt>(m_output_buffer.size());
+
+  while (zs->avail_out == m_output_buffer.size())
+  {
+    if (zs->avail_in == 0)
+    {
+      const size_t bytes_read = std::fread(m_input_buffer.data(), 1, m_input_buffer.size(), m_file);
+      if (bytes_read == 0)
+      {
+        Log_WarningPrintf("Unexpected end of trace file, the trace was probably not closed");
+        m_stream_end = true;
+        break;
+      }
+
+      zs->next_in = m_input_buffer.data();
+      zs->avail_in = static_cast<uInt>(bytes_read);
+    }
+
+    const int err = inflate(zs, Z_NO_FLUSH);
+    if (err == Z_STREAM_END)
+    {
+      m_stream_end = true;
+      break;
+    }
+    else if (err != Z_OK)
+    {
+      Log_ErrorPrintf("inflate() failed: %d", err);
+      m_stream_end = true;
+      break;
+    }
+  }
+
+  m_output_buffer_pos = 0;
+  m_output_buffer_size = static_cast<u32>(m_output_buffer.size() - zs->avail_out);
+  return (m_output_buffer_size > 0);
+}
+
+} // namespace CPU::Trace
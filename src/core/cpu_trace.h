@@ -0,0 +1,179 @@
+#pragma once
+#include "cpu_types.h"
+#include "types.h"
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Binary CPU execution trace.
+//
+// The file consists of a small uncompressed header containing the initial register state, followed by a single
+// deflate stream of variable-length instruction records. Each record holds the instruction word, the registers it
+// modified, and the memory access it performed (if any), which is enough to reconstruct the register file at any
+// point in the trace by replaying deltas from the header.
+
+namespace CPU::Trace {
+
+enum : u32
+{
+  FILE_MAGIC = 0x52545344, // DSTR
+  FILE_VERSION = 1,
+
+  // r0-r31, hi, lo
+  NUM_TRACED_REGS = 34,
+};
+
+enum RecordFlags : u8
+{
+  RECORD_FLAG_MEMORY_READ = (1 << 0),
+  RECORD_FLAG_MEMORY_WRITE = (1 << 1),
+  RECORD_FLAG_MEMORY_SIZE_SHIFT = 2, // 2 bits, log2 of the access size
+  RECORD_FLAG_MEMORY_SIZE_MASK = (3 << 2),
+  RECORD_FLAG_EXCEPTION = (1 << 4),
+  RECORD_FLAG_EXPLICIT_PC = (1 << 5), // pc is not the previous pc + 4
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 start_pc;
+  u32 regs[NUM_TRACED_REGS];
+};
+#pragma pack(pop)
+
+struct RegisterWrite
+{
+  u8 reg;
+  u32 value;
+};
+
+struct Record
+{
+  u32 pc;
+  u32 bits;
+  u8 flags;
+  u8 num_reg_writes;
+  u32 memory_address;
+  u32 memory_value;
+  std::array<RegisterWrite, NUM_TRACED_REGS> reg_writes;
+
+  ALWAYS_INLINE bool HasMemoryAccess() const
+  {
+    return (flags & (RECORD_FLAG_MEMORY_READ | RECORD_FLAG_MEMORY_WRITE)) != 0;
+  }
+  ALWAYS_INLINE u32 GetMemoryAccessSize() const
+  {
+    return 1u << ((flags & RECORD_FLAG_MEMORY_SIZE_MASK) >> RECORD_FLAG_MEMORY_SIZE_SHIFT);
+  }
+};
+
+/// Writes trace records into one of two buffers on the calling thread, and compresses/writes the other buffer to disk
+/// on a worker thread. The calling thread only blocks if the worker falls a full buffer behind.
+class Writer
+{
+public:
+  Writer();
+  ~Writer();
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_file != nullptr); }
+
+  bool Open(const char* filename, const Registers& regs);
+  void Close();
+
+  /// Records the register state before the instruction executes.
+  ALWAYS_INLINE void BeginInstruction(const Registers& regs) { std::memcpy(&m_prev_regs, &regs, sizeof(m_prev_regs)); }
+
+  /// Writes a record for the instruction, diffing the registers against the state captured in BeginInstruction().
+  /// memory_value is the value loaded or stored, only used when the instruction accesses memory.
+  void EndInstruction(u32 pc, u32 bits, const Registers& regs, bool exception_raised, u32 memory_value);
+
+private:
+  enum : u32
+  {
+    BUFFER_SIZE = 4 * 1024 * 1024,
+
+    // flags + pc + bits + count + registers + memory access
+    MAX_RECORD_SIZE = 1 + 4 + 4 + 1 + (NUM_TRACED_REGS * 5) + 8,
+  };
+
+  void SubmitBuffer();
+  void WorkerThreadEntryPoint();
+  bool CompressAndWrite(const u8* data, u32 size, bool finish);
+
+  std::FILE* m_file = nullptr;
+  void* m_zstream = nullptr;
+
+  std::array<std::vector<u8>, 2> m_buffers;
+  u32 m_current_buffer = 0;
+  u32 m_current_buffer_pos = 0;
+  std::vector<u8> m_compress_buffer;
+
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  u32 m_pending_size = 0;
+  bool m_pending_buffer = false;
+  bool m_shutdown = false;
+
+  Registers m_prev_regs = {};
+  u32 m_next_pc = 0;
+};
+
+/// Streams records back out of a trace file, maintaining the reconstructed register state.
+class Reader
+{
+public:
+  Reader();
+  ~Reader();
+
+  ALWAYS_INLINE const Registers& GetRegisters() const { return m_regs; }
+  ALWAYS_INLINE u64 GetRecordIndex() const { return m_record_index; }
+
+  bool Open(const char* filename);
+  void Close();
+
+  /// Reads the next record. The register state returned by GetRegisters() is the state *before* the instruction
+  /// executed, i.e. what the record's instruction saw, and is updated on the following call.
+  bool ReadRecord(Record* record);
+
+private:
+  enum : u32
+  {
+    INPUT_BUFFER_SIZE = 1024 * 1024,
+    OUTPUT_BUFFER_SIZE = 4 * 1024 * 1024
+  };
+
+  bool ReadBytes(void* dst, u32 size);
+  bool RefillOutputBuffer();
+
+  template<typename T>
+  ALWAYS_INLINE bool ReadValue(T* value)
+  {
+    return ReadBytes(value, sizeof(T));
+  }
+
+  std::FILE* m_file = nullptr;
+  void* m_zstream = nullptr;
+  bool m_stream_end = false;
+
+  std::vector<u8> m_input_buffer;
+  std::vector<u8> m_output_buffer;
+  u32 m_output_buffer_pos = 0;
+  u32 m_output_buffer_size = 0;
+
+  Registers m_regs = {};
+  Record m_last_record = {};
+  bool m_has_last_record = false;
+  u32 m_next_pc = 0;
+  u64 m_record_index = 0;
+};
+
+} // namespace CPU::Trace
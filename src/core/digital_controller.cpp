@@ -41,6 +41,11 @@ bool DigitalController::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void DigitalController::DoInputState(StateWrapper& sw)
+{
+  sw.Do(&m_button_state);
+}
+
 void DigitalController::SetAxisState(s32 axis_code, float value) {}
 
 void DigitalController::SetButtonState(Button button, bool pressed)
@@ -512,6 +512,14 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
     {
       if (g_gpu->BeginDMAWrite())
       {
+        // linked list and forward block transfers can be handed over in one go
+        if (increment == sizeof(u32) && (address + (word_count * sizeof(u32))) <= Bus::RAM_SIZE)
+        {
+          g_gpu->DMAWriteBlock(address, word_count);
+          g_gpu->EndDMAWrite();
+          break;
+        }
+
         u8* ram_pointer = Bus::g_ram;
         for (u32 i = 0; i < word_count; i++)
         {
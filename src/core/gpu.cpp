@@ -4,12 +4,13 @@
 #include "common/log.h"
 #include "common/state_wrapper.h"
 #include "common/string_util.h"
+#include "bus.h"
 #include "dma.h"
 #include "host_display.h"
 #include "host_interface.h"
+#include "image_write_queue.h"
 #include "interrupt_controller.h"
 #include "settings.h"
-#include "stb_image_write.h"
 #include "system.h"
 #include "timers.h"
 #include <cmath>
@@ -80,6 +81,7 @@ void GPU::Reset()
   SoftReset();
   m_set_texture_disable_mask = false;
   m_GPUREAD_latch = 0;
+  m_display_outdated = false;
 }
 
 void GPU::SoftReset()
@@ -226,14 +228,20 @@ bool GPU::DoState(StateWrapper& sw, bool update_display)
 
     UpdateCRTCConfig();
     if (update_display)
+    {
       UpdateDisplay();
+      m_display_outdated = false;
+    }
 
     UpdateCRTCTickEvent();
     UpdateCommandTickEvent();
   }
   else
   {
-    ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    // no point downloading VRAM from the host GPU just to find out how big it is
+    if (!sw.IsMeasuring())
+      ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+
     sw.DoBytes(m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
   }
 
@@ -367,6 +375,38 @@ void GPU::DMARead(u32* words, u32 word_count)
     words[i] = ReadGPUREAD();
 }
 
+void GPU::DMAWriteBlock(u32 address, u32 word_count)
+{
+  const u32* words = reinterpret_cast<const u32*>(Bus::g_ram + address);
+
+  // Anything already queued has to execute first, and if we're inside ExecuteCommands() it'll pick the words up from
+  // the FIFO. Otherwise, decoding in place leaves the GPU in exactly the same state as pushing everything and then
+  // executing, since commands are only ever run from the front of the queue.
+  if (!m_syncing && m_fifo.IsEmpty())
+  {
+    m_syncing = true;
+    m_direct_ptr = words;
+    m_direct_address = address;
+    m_direct_size = word_count;
+    ProcessCommands();
+    m_stats.num_dma_direct_words += word_count - m_direct_size;
+
+    words = m_direct_ptr;
+    address = m_direct_address;
+    word_count = m_direct_size;
+    m_direct_ptr = nullptr;
+    m_direct_size = 0;
+    m_syncing = false;
+  }
+
+  m_stats.num_dma_fifo_words += word_count;
+  for (u32 i = 0; i < word_count; i++)
+  {
+    m_fifo.Push((ZeroExtend64(address) << 32) | ZeroExtend64(words[i]));
+    address += sizeof(u32);
+  }
+}
+
 void GPU::EndDMAWrite()
 {
   m_fifo_pushed = true;
@@ -846,9 +886,12 @@ void GPU::CRTCTickEvent(TickCount ticks)
         Log_DebugPrintf("Now in v-blank");
         g_interrupt_controller.InterruptRequest(InterruptController::IRQ::VBLANK);
 
-        // flush any pending draws and "scan out" the image
+        // flush any pending draws and "scan out" the image. the batch has to be flushed even on skipped frames, since
+        // the field switch below changes state it was built with. the display is built later if it's needed.
         FlushRender();
-        UpdateDisplay();
+        if (!System::IsFrameSkipped())
+          UpdateDisplay();
+        m_display_outdated = System::IsFrameSkipped();
         System::FrameDone();
 
         // switch fields early. this is needed so we draw to the correct one.
@@ -1234,6 +1277,15 @@ void GPU::ClearDisplay() {}
 
 void GPU::UpdateDisplay() {}
 
+void GPU::UpdateOutdatedDisplay()
+{
+  if (!m_display_outdated)
+    return;
+
+  UpdateDisplay();
+  m_display_outdated = false;
+}
+
 void GPU::ReadVRAM(u32 x, u32 y, u32 width, u32 height) {}
 
 void GPU::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
@@ -1465,7 +1517,8 @@ bool GPU::DumpVRAMToFile(const char* filename)
   const char* extension = std::strrchr(filename, '.');
   if (extension && StringUtil::Strcasecmp(extension, ".png") == 0)
   {
-    return DumpVRAMToFile(filename, VRAM_WIDTH, VRAM_HEIGHT, sizeof(u16) * VRAM_WIDTH, m_vram_ptr, true);
+    // explicitly requested, so wait for it to be written rather than reporting success for a write which may fail
+    return DumpVRAMToFile(filename, VRAM_WIDTH, VRAM_HEIGHT, sizeof(u16) * VRAM_WIDTH, m_vram_ptr, true, true);
   }
   else if (extension && StringUtil::Strcasecmp(extension, ".bin") == 0)
   {
@@ -1478,38 +1531,10 @@ bool GPU::DumpVRAMToFile(const char* filename)
   }
 }
 
-bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer, bool remove_alpha)
+bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer, bool remove_alpha,
+                         bool wait /* = false */)
 {
-  auto fp = FileSystem::OpenManagedCFile(filename, "wb");
-  if (!fp)
-  {
-    Log_ErrorPrintf("Can't open file '%s'", filename);
-    return false;
-  }
-
-  auto rgba8_buf = std::make_unique<u32[]>(width * height);
-
-  const char* ptr_in = static_cast<const char*>(buffer);
-  u32* ptr_out = rgba8_buf.get();
-  for (u32 row = 0; row < height; row++)
-  {
-    const char* row_ptr_in = ptr_in;
-
-    for (u32 col = 0; col < width; col++)
-    {
-      u16 src_col;
-      std::memcpy(&src_col, row_ptr_in, sizeof(u16));
-      row_ptr_in += sizeof(u16);
-      *(ptr_out++) = RGBA5551ToRGBA8888(remove_alpha ? (src_col | u16(0x8000)) : src_col);
-    }
-
-    ptr_in += stride;
-  }
-
-  const auto write_func = [](void* context, void* data, int size) {
-    std::fwrite(data, 1, size, static_cast<std::FILE*>(context));
-  };
-  return (stbi_write_png_to_func(write_func, fp.get(), width, height, 4, rgba8_buf.get(), sizeof(u32) * width) != 0);
+  return g_image_write_queue.QueueVRAMWrite(filename, 0, width, height, stride, buffer, remove_alpha, wait);
 }
 
 void GPU::DrawDebugStateWindow()
@@ -1543,6 +1568,11 @@ void GPU::DrawDebugStateWindow()
     ImGui::Text("%s", is_idle_frame ? "Yes" : "No");
     ImGui::NextColumn();
 
+    ImGui::TextUnformatted("DMA Words (Direct/FIFO): ");
+    ImGui::NextColumn();
+    ImGui::Text("%u / %u", stats.num_dma_direct_words, stats.num_dma_fifo_words);
+    ImGui::NextColumn();
+
     ImGui::TextUnformatted("VRAM Reads: ");
     ImGui::NextColumn();
     ImGui::Text("%u", stats.num_vram_reads);
@@ -1573,6 +1603,12 @@ void GPU::DrawDebugStateWindow()
     ImGui::Text("%u", stats.num_polygons);
     ImGui::NextColumn();
 
+    const ImageWriteQueue::Stats write_stats = g_image_write_queue.GetStats();
+    ImGui::TextUnformatted("Image Writes Queued/Dropped: ");
+    ImGui::NextColumn();
+    ImGui::Text("%u / %u", write_stats.queue_depth, write_stats.num_dropped);
+    ImGui::NextColumn();
+
     ImGui::Columns(1);
   }
 
@@ -99,6 +99,10 @@ public:
   {
     m_fifo.Push((ZeroExtend64(address) << 32) | ZeroExtend64(value));
   }
+
+  /// Writes a contiguous block of words from RAM. When nothing is queued in the FIFO, commands are decoded straight
+  /// out of RAM, and only the words which can't be executed yet are pushed to the FIFO.
+  void DMAWriteBlock(u32 address, u32 word_count);
   void EndDMAWrite();
 
   /// Returns true if no data is being sent from VRAM to the DAC or that no portion of VRAM would be visible on screen.
@@ -132,6 +136,12 @@ public:
   /// Synchronizes the CRTC, updating the hblank timer.
   void SynchronizeCRTC();
 
+  /// Returns true if the last frame was skipped, so the display hasn't been updated for it.
+  ALWAYS_INLINE bool IsDisplayOutdated() const { return m_display_outdated; }
+
+  /// Updates the display after a skipped frame. Graphics API state must be restored.
+  void UpdateOutdatedDisplay();
+
   /// Recompile shaders/recreate framebuffers when needed.
   virtual void UpdateSettings();
 
@@ -211,8 +221,10 @@ protected:
     return std::make_tuple(static_cast<u8>(rgb24), static_cast<u8>(rgb24 >> 8), static_cast<u8>(rgb24 >> 16));
   }
 
+  /// Queues the image on the background writer, returns false if it was dropped. If wait is set, waits for it to be
+  /// written, and returns false if that failed.
   static bool DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer,
-                             bool remove_alpha);
+                             bool remove_alpha, bool wait = false);
 
   void SoftReset();
 
@@ -284,6 +296,7 @@ protected:
   void WriteGP1(u32 value);
   void EndCommand();
   void ExecuteCommands();
+  void ProcessCommands();
   void HandleGetGPUInfoCommand(u32 value);
 
   // Rendering in the backend
@@ -540,6 +553,7 @@ protected:
   /// True if currently executing/syncing.
   bool m_syncing = false;
   bool m_fifo_pushed = false;
+  bool m_display_outdated = false;
 
   struct VRAMTransfer
   {
@@ -556,9 +570,39 @@ protected:
   u32 m_blit_remaining_words;
   GPURenderCommand m_render_command{};
 
-  ALWAYS_INLINE u32 FifoPop() { return Truncate32(m_fifo.Pop()); }
-  ALWAYS_INLINE u32 FifoPeek() { return Truncate32(m_fifo.Peek()); }
-  ALWAYS_INLINE u32 FifoPeek(u32 i) { return Truncate32(m_fifo.Peek(i)); }
+  // While decoding a DMA block in place, command words are read from RAM instead of the FIFO.
+  const u32* m_direct_ptr = nullptr;
+  u32 m_direct_address = 0;
+  u32 m_direct_size = 0;
+
+  ALWAYS_INLINE u32 FifoGetSize() const { return m_direct_ptr ? m_direct_size : m_fifo.GetSize(); }
+  ALWAYS_INLINE bool FifoIsEmpty() const { return (FifoGetSize() == 0); }
+  ALWAYS_INLINE u32 FifoPop()
+  {
+    if (m_direct_ptr)
+    {
+      m_direct_address += sizeof(u32);
+      m_direct_size--;
+      return *(m_direct_ptr++);
+    }
+
+    return Truncate32(m_fifo.Pop());
+  }
+  ALWAYS_INLINE u32 FifoPeek() { return m_direct_ptr ? m_direct_ptr[0] : Truncate32(m_fifo.Peek()); }
+  ALWAYS_INLINE u32 FifoPeek(u32 i) { return m_direct_ptr ? m_direct_ptr[i] : Truncate32(m_fifo.Peek(i)); }
+  ALWAYS_INLINE void FifoRemoveOne() { FifoPop(); }
+
+  /// Returns the memory address of the word in the upper 32 bits, for PGXP.
+  ALWAYS_INLINE u64 FifoPopWithAddress()
+  {
+    if (m_direct_ptr)
+    {
+      const u64 address = m_direct_address;
+      return (address << 32) | ZeroExtend64(FifoPop());
+    }
+
+    return m_fifo.Pop();
+  }
 
   TickCount m_max_run_ahead = 128;
   u32 m_fifo_size = 128;
@@ -571,6 +615,8 @@ protected:
     u32 num_vram_copies;
     u32 num_vertices;
     u32 num_polygons;
+    u32 num_dma_direct_words;
+    u32 num_dma_fifo_words;
   };
   Stats m_stats = {};
   Stats m_last_stats = {};
@@ -8,7 +8,7 @@
 Log_SetChannel(GPU);
 
 #define CHECK_COMMAND_SIZE(num_words)                                                                                  \
-  if (m_fifo.GetSize() < num_words)                                                                                    \
+  if (FifoGetSize() < num_words)                                                                                       \
   {                                                                                                                    \
     m_command_total_words = num_words;                                                                                 \
     return false;                                                                                                      \
@@ -28,88 +28,103 @@ void GPU::ExecuteCommands()
 
   for (;;)
   {
-    if (m_pending_command_ticks <= m_max_run_ahead && !m_fifo.IsEmpty())
+    ProcessCommands();
+
+    m_fifo_pushed = false;
+    UpdateDMARequest();
+    if (!m_fifo_pushed)
+      break;
+  }
+
+  UpdateGPUIdle();
+  m_syncing = false;
+}
+
+void GPU::ProcessCommands()
+{
+  for (;;)
+  {
+    if (m_pending_command_ticks > m_max_run_ahead || FifoIsEmpty())
+      return;
+
+    switch (m_blitter_state)
     {
-      switch (m_blitter_state)
+      case BlitterState::Idle:
+      {
+        const u32 command = FifoPeek(0) >> 24;
+        if ((this->*s_GP0_command_handler_table[command])())
+          continue;
+        else
+          return;
+      }
+
+      case BlitterState::WritingVRAM:
       {
-        case BlitterState::Idle:
+        DebugAssert(m_blit_remaining_words > 0);
+        const u32 words_to_copy = std::min(m_blit_remaining_words, FifoGetSize());
+        if (m_direct_ptr)
         {
-          const u32 command = FifoPeek(0) >> 24;
-          if ((this->*s_GP0_command_handler_table[command])())
-            continue;
-          else
-            goto batch_done;
+          m_blit_buffer.insert(m_blit_buffer.end(), m_direct_ptr, m_direct_ptr + words_to_copy);
+          m_direct_ptr += words_to_copy;
+          m_direct_address += words_to_copy * sizeof(u32);
+          m_direct_size -= words_to_copy;
         }
-
-        case BlitterState::WritingVRAM:
+        else
         {
-          DebugAssert(m_blit_remaining_words > 0);
-          const u32 words_to_copy = std::min(m_blit_remaining_words, m_fifo.GetSize());
           m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
           for (u32 i = 0; i < words_to_copy; i++)
             m_blit_buffer.push_back(FifoPop());
-          m_blit_remaining_words -= words_to_copy;
+        }
+        m_blit_remaining_words -= words_to_copy;
 
-          Log_DebugPrintf("VRAM write burst of %u words, %u words remaining", words_to_copy, m_blit_remaining_words);
-          if (m_blit_remaining_words == 0)
-            FinishVRAMWrite();
+        Log_DebugPrintf("VRAM write burst of %u words, %u words remaining", words_to_copy, m_blit_remaining_words);
+        if (m_blit_remaining_words == 0)
+          FinishVRAMWrite();
 
-          continue;
-        }
+        continue;
+      }
+
+      case BlitterState::ReadingVRAM:
+      {
+        return;
+      }
 
-        case BlitterState::ReadingVRAM:
+      case BlitterState::DrawingPolyLine:
+      {
+        const u32 words_per_vertex = m_render_command.shading_enable ? 2 : 1;
+        u32 terminator_index =
+          m_render_command.shading_enable ? ((static_cast<u32>(m_blit_buffer.size()) & 1u) ^ 1u) : 0u;
+        for (; terminator_index < FifoGetSize(); terminator_index += words_per_vertex)
         {
-          goto batch_done;
+          // polyline must have at least two vertices, and the terminator is (word & 0xf000f000) == 0x50005000.
+          // terminator is on the first word for the vertex
+          if ((FifoPeek(terminator_index) & UINT32_C(0xF000F000)) == UINT32_C(0x50005000))
+            break;
         }
-        break;
 
-        case BlitterState::DrawingPolyLine:
+        const bool found_terminator = (terminator_index < FifoGetSize());
+        const u32 words_to_copy = std::min(terminator_index, FifoGetSize());
+        if (words_to_copy > 0)
         {
-          const u32 words_per_vertex = m_render_command.shading_enable ? 2 : 1;
-          u32 terminator_index =
-            m_render_command.shading_enable ? ((static_cast<u32>(m_blit_buffer.size()) & 1u) ^ 1u) : 0u;
-          for (; terminator_index < m_fifo.GetSize(); terminator_index += words_per_vertex)
-          {
-            // polyline must have at least two vertices, and the terminator is (word & 0xf000f000) == 0x50005000.
-            // terminator is on the first word for the vertex
-            if ((FifoPeek(terminator_index) & UINT32_C(0xF000F000)) == UINT32_C(0x50005000))
-              break;
-          }
-
-          const bool found_terminator = (terminator_index < m_fifo.GetSize());
-          const u32 words_to_copy = std::min(terminator_index, m_fifo.GetSize());
-          if (words_to_copy > 0)
-          {
-            m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
-            for (u32 i = 0; i < words_to_copy; i++)
-              m_blit_buffer.push_back(FifoPop());
-          }
-
-          Log_DebugPrintf("Added %u words to polyline", words_to_copy);
-          if (found_terminator)
-          {
-            // drop terminator
-            m_fifo.RemoveOne();
-            Log_DebugPrintf("Drawing poly-line with %u vertices", GetPolyLineVertexCount());
-            DispatchRenderCommand();
-            m_blit_buffer.clear();
-            EndCommand();
-            continue;
-          }
+          m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
+          for (u32 i = 0; i < words_to_copy; i++)
+            m_blit_buffer.push_back(FifoPop());
         }
-        break;
+
+        Log_DebugPrintf("Added %u words to polyline", words_to_copy);
+        if (!found_terminator)
+          return;
+
+        // drop terminator
+        FifoRemoveOne();
+        Log_DebugPrintf("Drawing poly-line with %u vertices", GetPolyLineVertexCount());
+        DispatchRenderCommand();
+        m_blit_buffer.clear();
+        EndCommand();
+        continue;
       }
     }
-
-  batch_done:
-    m_fifo_pushed = false;
-    UpdateDMARequest();
-    if (!m_fifo_pushed)
-      break;
   }
-
-  UpdateGPUIdle();
-  m_syncing = false;
 }
 
 void GPU::EndCommand()
@@ -174,18 +189,18 @@ bool GPU::HandleUnknownGP0Command()
   Log_ErrorPrintf("Unimplemented GP0 command 0x%02X", command);
 
   SmallString dump;
-  for (u32 i = 0; i < m_fifo.GetSize(); i++)
+  for (u32 i = 0; i < FifoGetSize(); i++)
     dump.AppendFormattedString("%s0x%08X", (i > 0) ? " " : "", FifoPeek(i));
   Log_ErrorPrintf("FIFO: %s", dump.GetCharArray());
 
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
   EndCommand();
   return true;
 }
 
 bool GPU::HandleNOPCommand()
 {
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
   EndCommand();
   return true;
 }
@@ -193,7 +208,7 @@ bool GPU::HandleNOPCommand()
 bool GPU::HandleClearCacheCommand()
 {
   Log_DebugPrintf("GP0 clear cache");
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
   AddCommandTicks(1);
   EndCommand();
   return true;
@@ -208,7 +223,7 @@ bool GPU::HandleInterruptRequestCommand()
     g_interrupt_controller.InterruptRequest(InterruptController::IRQ::GPU);
   }
 
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
   AddCommandTicks(1);
   EndCommand();
   return true;
@@ -349,7 +364,7 @@ bool GPU::HandleRenderPolygonCommand()
   m_stats.num_vertices += num_vertices;
   m_stats.num_polygons++;
   m_render_command.bits = rc.bits;
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   DispatchRenderCommand();
   EndCommand();
@@ -381,7 +396,7 @@ bool GPU::HandleRenderRectangleCommand()
   m_stats.num_vertices++;
   m_stats.num_polygons++;
   m_render_command.bits = rc.bits;
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   DispatchRenderCommand();
   EndCommand();
@@ -403,7 +418,7 @@ bool GPU::HandleRenderLineCommand()
   m_stats.num_vertices += 2;
   m_stats.num_polygons++;
   m_render_command.bits = rc.bits;
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   DispatchRenderCommand();
   EndCommand();
@@ -427,7 +442,7 @@ bool GPU::HandleRenderPolyLineCommand()
                   rc.shading_enable ? "shaded" : "monochrome", setup_ticks);
 
   m_render_command.bits = rc.bits;
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   const u32 words_to_pop = min_words - 1;
   // m_blit_buffer.resize(words_to_pop);
@@ -471,7 +486,7 @@ bool GPU::HandleFillRectangleCommand()
 bool GPU::HandleCopyRectangleCPUToVRAMCommand()
 {
   CHECK_COMMAND_SIZE(3);
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   const u32 dst_x = FifoPeek() & VRAM_WIDTH_MASK;
   const u32 dst_y = (FifoPop() >> 16) & VRAM_HEIGHT_MASK;
@@ -556,7 +571,7 @@ void GPU::FinishVRAMWrite()
 bool GPU::HandleCopyRectangleVRAMToCPUCommand()
 {
   CHECK_COMMAND_SIZE(3);
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   m_vram_transfer.x = Truncate16(FifoPeek() & VRAM_WIDTH_MASK);
   m_vram_transfer.y = Truncate16((FifoPop() >> 16) & VRAM_HEIGHT_MASK);
@@ -590,7 +605,7 @@ bool GPU::HandleCopyRectangleVRAMToCPUCommand()
 bool GPU::HandleCopyRectangleVRAMToVRAMCommand()
 {
   CHECK_COMMAND_SIZE(4);
-  m_fifo.RemoveOne();
+  FifoRemoveOne();
 
   const u32 src_x = FifoPeek() & VRAM_WIDTH_MASK;
   const u32 src_y = (FifoPop() >> 16) & VRAM_HEIGHT_MASK;
@@ -1,8 +1,12 @@
 #include "gpu_hw.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
+#include "common/file_system.h"
 #include "common/log.h"
 #include "common/state_wrapper.h"
+#include "common/string_util.h"
 #include "cpu_core.h"
+#include "host_interface.h"
 #include "pgxp.h"
 #include "settings.h"
 #include "system.h"
@@ -34,7 +38,10 @@ GPU_HW::GPU_HW() : GPU()
   m_vram_ptr = m_vram_shadow.data();
 }
 
-GPU_HW::~GPU_HW() = default;
+GPU_HW::~GPU_HW()
+{
+  SavePipelineUsageList();
+}
 
 bool GPU_HW::IsHardwareRenderer() const
 {
@@ -87,6 +94,17 @@ bool GPU_HW::Initialize(HostDisplay* host_display)
   }
 
   m_pgxp_depth_buffer = g_settings.UsingPGXPDepthBuffer();
+  m_async_pipeline_compilation = g_settings.gpu_async_pipeline_compilation && m_supports_async_pipeline_compilation;
+  m_sprite_instancing = g_settings.gpu_sprite_instancing && m_supports_sprite_instancing;
+  m_batch_sprites.reserve(MAX_BATCH_VERTEX_COUNT);
+  m_pipeline_usage_game_code = System::GetRunningCode();
+  LoadPipelineUsageList();
+
+  m_palette_texture_cache = g_settings.gpu_palette_texture_cache && m_supports_palette_texture_cache;
+  if (g_settings.gpu_palette_texture_cache && !m_supports_palette_texture_cache)
+    Log_WarningPrintf("Palette texture cache is not supported by this renderer, disabling.");
+  ResetPaletteTextureCache();
+
   PrintSettingsToLog();
   return true;
 }
@@ -96,8 +114,11 @@ void GPU_HW::Reset()
   GPU::Reset();
 
   m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+  m_batch_sprites.clear();
+  m_batch_sprite_tiles.fill(0);
 
   m_vram_shadow.fill(0);
+  m_vram_shadow_dirty_tiles.fill(0);
 
   m_batch = {};
   m_batch_ubo_data = {};
@@ -105,6 +126,7 @@ void GPU_HW::Reset()
   m_current_depth = 1;
 
   SetFullVRAMDirtyRectangle();
+  ResetPaletteTextureCache();
 }
 
 bool GPU_HW::DoState(StateWrapper& sw, bool update_display)
@@ -116,6 +138,8 @@ bool GPU_HW::DoState(StateWrapper& sw, bool update_display)
   if (sw.IsReading())
   {
     m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+    m_batch_sprites.clear();
+    m_batch_sprite_tiles.fill(0);
     SetFullVRAMDirtyRectangle();
     ResetBatchVertexDepth();
   }
@@ -130,15 +154,22 @@ void GPU_HW::UpdateHWSettings(bool* framebuffer_changed, bool* shaders_changed)
   const bool per_sample_shading = g_settings.gpu_per_sample_shading && m_supports_per_sample_shading;
   const GPUDownsampleMode downsample_mode = GetDownsampleMode(resolution_scale);
   const bool use_uv_limits = ShouldUseUVLimits();
+  const bool async_pipeline_compilation =
+    g_settings.gpu_async_pipeline_compilation && m_supports_async_pipeline_compilation;
+  const bool palette_texture_cache = g_settings.gpu_palette_texture_cache && m_supports_palette_texture_cache;
+  const bool sprite_instancing = g_settings.gpu_sprite_instancing && m_supports_sprite_instancing;
 
   *framebuffer_changed =
-    (m_resolution_scale != resolution_scale || m_multisamples != multisamples || m_downsample_mode != downsample_mode);
+    (m_resolution_scale != resolution_scale || m_multisamples != multisamples || m_downsample_mode != downsample_mode ||
+     m_palette_texture_cache != palette_texture_cache);
   *shaders_changed =
     (m_resolution_scale != resolution_scale || m_multisamples != multisamples ||
      m_true_color != g_settings.gpu_true_color || m_per_sample_shading != per_sample_shading ||
      m_scaled_dithering != g_settings.gpu_scaled_dithering || m_texture_filtering != g_settings.gpu_texture_filter ||
      m_using_uv_limits != use_uv_limits || m_chroma_smoothing != g_settings.gpu_24bit_chroma_smoothing ||
-     m_downsample_mode != downsample_mode || m_pgxp_depth_buffer != g_settings.UsingPGXPDepthBuffer());
+     m_downsample_mode != downsample_mode || m_pgxp_depth_buffer != g_settings.UsingPGXPDepthBuffer() ||
+     m_async_pipeline_compilation != async_pipeline_compilation ||
+     m_palette_texture_cache != palette_texture_cache || m_sprite_instancing != sprite_instancing);
 
   if (m_resolution_scale != resolution_scale)
   {
@@ -174,6 +205,15 @@ void GPU_HW::UpdateHWSettings(bool* framebuffer_changed, bool* shaders_changed)
   m_chroma_smoothing = g_settings.gpu_24bit_chroma_smoothing;
   m_downsample_mode = downsample_mode;
 
+  m_async_pipeline_compilation = async_pipeline_compilation;
+  m_sprite_instancing = sprite_instancing;
+
+  if (m_palette_texture_cache != palette_texture_cache)
+  {
+    m_palette_texture_cache = palette_texture_cache;
+    ResetPaletteTextureCache();
+  }
+
   if (!m_supports_dual_source_blend && TextureFilterRequiresDualSourceBlend(m_texture_filtering))
     m_texture_filtering = GPUTextureFilter::Nearest;
 
@@ -253,14 +293,171 @@ void GPU_HW::PrintSettingsToLog()
   Log_InfoPrintf("Using UV limits: %s", m_using_uv_limits ? "YES" : "NO");
   Log_InfoPrintf("Depth buffer: %s", m_pgxp_depth_buffer ? "YES" : "NO");
   Log_InfoPrintf("Downsampling: %s", Settings::GetDownsampleModeDisplayName(m_downsample_mode));
+  Log_InfoPrintf("Async pipeline compilation: %s", m_async_pipeline_compilation ? "YES" : "NO");
+  Log_InfoPrintf("Palette texture cache: %s", m_palette_texture_cache ? "YES" : "NO");
+  Log_InfoPrintf("GPU sprite expansion: %s", m_sprite_instancing ? "YES" : "NO");
+}
+
+std::string GPU_HW::GetPipelineUsageListPath() const
+{
+  return g_host_interface->GetUserDirectoryRelativePath("cache/pipelines-%s.txt", m_pipeline_usage_game_code.c_str());
+}
+
+void GPU_HW::LoadPipelineUsageList()
+{
+  if (m_pipeline_usage_game_code.empty())
+    return;
+
+  std::optional<std::string> list = FileSystem::ReadFileToString(GetPipelineUsageListPath().c_str());
+  if (!list.has_value())
+    return;
+
+  // Kept in the order they were first used, so the earliest pipelines are compiled first.
+  std::string_view remaining(list.value());
+  while (!remaining.empty())
+  {
+    const std::string_view::size_type pos = remaining.find('\n');
+    std::string_view line = remaining.substr(0, pos);
+    remaining = (pos != std::string_view::npos) ? remaining.substr(pos + 1) : std::string_view();
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+      line.remove_suffix(1);
+
+    const std::optional<u32> bits = StringUtil::FromChars<u32>(line, 16);
+    if (!bits.has_value() || bits.value() >= NUM_BATCH_PIPELINE_KEYS || m_used_batch_pipelines.test(bits.value()))
+      continue;
+
+    BatchPipelineKey key;
+    key.bits = bits.value();
+    if (!IsValidBatchPipelineKey(key))
+      continue;
+
+    m_used_batch_pipelines.set(bits.value());
+    m_batch_pipeline_use_order.push_back(bits.value());
+  }
+
+  Log_InfoPrintf("Loaded %zu pipelines from '%s'", m_batch_pipeline_use_order.size(),
+                 GetPipelineUsageListPath().c_str());
+}
+
+void GPU_HW::SavePipelineUsageList()
+{
+  if (!m_batch_pipeline_use_order_changed || m_pipeline_usage_game_code.empty())
+    return;
+
+  std::string list;
+  list.reserve(m_batch_pipeline_use_order.size() * 5);
+  for (const u32 bits : m_batch_pipeline_use_order)
+    list.append(StringUtil::StdStringFromFormat("%04x\n", bits));
+
+  const std::string path = GetPipelineUsageListPath();
+  if (!FileSystem::WriteFileToString(path.c_str(), list))
+    Log_WarningPrintf("Failed to write pipeline usage list to '%s'", path.c_str());
+
+  m_batch_pipeline_use_order_changed = false;
 }
 
 void GPU_HW::UpdateVRAMReadTexture()
 {
   m_renderer_stats.num_vram_read_texture_updates++;
+
+  if (m_palette_texture_cache && m_vram_dirty_rect.Valid())
+    InvalidatePaletteTextureCache(m_vram_dirty_rect);
+
   ClearVRAMDirtyRectangle();
 }
 
+void GPU_HW::DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites)
+{
+  // m_sprite_instancing is only ever set when the backend supports it
+  Panic("Sprite expansion is not implemented by this backend");
+}
+
+void GPU_HW::DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms)
+{
+  // m_palette_texture_cache is only ever set when the backend supports it
+  Panic("Palette texture cache is not implemented by this backend");
+}
+
+u32 GPU_HW::GetPaletteTextureCacheSlot()
+{
+  const bool palette_8bit = (m_draw_mode.mode_reg.texture_mode == GPUTextureMode::Palette8Bit);
+  const u32 key = (ZeroExtend32(m_draw_mode.mode_reg.bits) & 0x1Fu) | (BoolToUInt32(palette_8bit) << 5) |
+                  (ZeroExtend32(m_draw_mode.palette_reg) << 6);
+
+  // consecutive draws usually use the same texture
+  PaletteTextureCacheEntry& current = m_palette_texture_cache_entries[m_current_palette_texture_cache_slot];
+  if (current.key == key)
+  {
+    current.last_used = ++m_palette_texture_cache_counter;
+    m_renderer_stats.num_palette_cache_hits++;
+    return m_current_palette_texture_cache_slot;
+  }
+
+  u32 slot = 0;
+  for (u32 i = 0; i < NUM_PALETTE_TEXTURE_CACHE_SLOTS; i++)
+  {
+    PaletteTextureCacheEntry& entry = m_palette_texture_cache_entries[i];
+    if (entry.key == key)
+    {
+      entry.last_used = ++m_palette_texture_cache_counter;
+      m_renderer_stats.num_palette_cache_hits++;
+      return i;
+    }
+
+    if (entry.last_used < m_palette_texture_cache_entries[slot].last_used)
+      slot = i;
+  }
+
+  // the slot we're about to overwrite could be in use by the current batch
+  FlushRender();
+
+  PaletteTextureCacheEntry& entry = m_palette_texture_cache_entries[slot];
+  entry.key = key;
+  entry.last_used = ++m_palette_texture_cache_counter;
+  entry.page_rect = m_draw_mode.mode_reg.GetTexturePageRectangle();
+  entry.palette_rect = m_draw_mode.GetTexturePaletteRectangle();
+
+  PaletteDecodeUBOData uniforms;
+  uniforms.u_texpage[0] = m_draw_mode.mode_reg.GetTexturePageBaseX() * m_resolution_scale;
+  uniforms.u_texpage[1] = m_draw_mode.mode_reg.GetTexturePageBaseY() * m_resolution_scale;
+  uniforms.u_texpage[2] = m_draw_mode.texture_palette_x * m_resolution_scale;
+  uniforms.u_texpage[3] = m_draw_mode.texture_palette_y * m_resolution_scale;
+  std::tie(uniforms.u_slot_origin[0], uniforms.u_slot_origin[1]) = GetPaletteTextureCacheSlotOrigin(slot);
+  DecodePaletteTexture(slot, uniforms);
+
+  m_renderer_stats.num_palette_cache_misses++;
+  return slot;
+}
+
+void GPU_HW::InvalidatePaletteTextureCache(const Common::Rectangle<u32>& rect)
+{
+  for (PaletteTextureCacheEntry& entry : m_palette_texture_cache_entries)
+  {
+    if (entry.key == INVALID_PALETTE_TEXTURE_CACHE_KEY ||
+        (!entry.page_rect.Intersects(rect) && !entry.palette_rect.Intersects(rect)))
+    {
+      continue;
+    }
+
+    entry.key = INVALID_PALETTE_TEXTURE_CACHE_KEY;
+    entry.last_used = 0;
+    m_renderer_stats.num_palette_cache_invalidations++;
+  }
+}
+
+void GPU_HW::ResetPaletteTextureCache()
+{
+  for (PaletteTextureCacheEntry& entry : m_palette_texture_cache_entries)
+  {
+    entry.key = INVALID_PALETTE_TEXTURE_CACHE_KEY;
+    entry.last_used = 0;
+  }
+
+  m_palette_texture_cache_counter = 0;
+  m_current_palette_texture_cache_slot = 0;
+  m_using_palette_texture_cache_slot = false;
+}
+
 void GPU_HW::HandleFlippedQuadTextureCoordinates(BatchVertex* vertices)
 {
   // Taken from beetle-psx gpu_polygon.cpp
@@ -533,7 +730,10 @@ void GPU_HW::LoadVertices()
     m_current_depth++;
 
   const GPURenderCommand rc{m_render_command.bits};
-  const u32 texpage = ZeroExtend32(m_draw_mode.mode_reg.bits) | (ZeroExtend32(m_draw_mode.palette_reg) << 16);
+  const u32 texpage =
+    m_using_palette_texture_cache_slot ?
+      (PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG | m_current_palette_texture_cache_slot) :
+      (ZeroExtend32(m_draw_mode.mode_reg.bits) | (ZeroExtend32(m_draw_mode.palette_reg) << 16));
   const float depth = GetCurrentNormalizedVertexDepth();
 
   switch (rc.primitive)
@@ -554,7 +754,7 @@ void GPU_HW::LoadVertices()
       for (u32 i = 0; i < num_vertices; i++)
       {
         const u32 color = (shaded && i > 0) ? (FifoPop() & UINT32_C(0x00FFFFFF)) : first_color;
-        const u64 maddr_and_pos = m_fifo.Pop();
+        const u64 maddr_and_pos = FifoPopWithAddress();
         const GPUVertexPosition vp{Truncate32(maddr_and_pos)};
         const u16 texcoord = textured ? Truncate16(FifoPop()) : 0;
         const s32 native_x = m_drawing_offset.x + vp.x;
@@ -617,7 +817,8 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        CheckForSpriteOverlap(min_x, max_x, min_y, max_y, pgxp ? 1 : 0);
+        IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawTriangleTicks(native_vertex_positions[0][0], native_vertex_positions[0][1],
                              native_vertex_positions[1][0], native_vertex_positions[1][1],
                              native_vertex_positions[2][0], native_vertex_positions[2][1], rc.shading_enable,
@@ -651,7 +852,8 @@ void GPU_HW::LoadVertices()
           const u32 clip_bottom =
             static_cast<u32>(std::clamp<s32>(max_y_123, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-          m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+          CheckForSpriteOverlap(min_x_123, max_x_123, min_y_123, max_y_123, pgxp ? 1 : 0);
+          IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
           AddDrawTriangleTicks(native_vertex_positions[2][0], native_vertex_positions[2][1],
                                native_vertex_positions[1][0], native_vertex_positions[1][1],
                                native_vertex_positions[3][0], native_vertex_positions[3][1], rc.shading_enable,
@@ -732,13 +934,21 @@ void GPU_HW::LoadVertices()
           const u16 tex_right = tex_left + static_cast<u16>(quad_width);
           const u32 uv_limits = BatchVertex::PackUVLimits(tex_left, tex_right - 1, tex_top, tex_bottom - 1);
 
-          AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, texpage, tex_left, tex_top, uv_limits);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
+          if (m_sprite_instancing)
+          {
+            AddNewSprite(quad_start_x, quad_start_y, depth, static_cast<u32>(quad_width), static_cast<u32>(quad_height),
+                         color, texpage, tex_left, tex_top, uv_limits);
+          }
+          else
+          {
+            AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, texpage, tex_left, tex_top, uv_limits);
+            AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
+            AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
 
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
-          AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, texpage, tex_right, tex_bottom, uv_limits);
+            AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
+            AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
+            AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, texpage, tex_right, tex_bottom, uv_limits);
+          }
 
           x_offset += quad_width;
           tex_left = 0;
@@ -755,7 +965,9 @@ void GPU_HW::LoadVertices()
       const u32 clip_bottom =
         static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-      m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+      IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
+      if (m_sprite_instancing)
+        IncludeBatchSpriteArea(pos_x, pos_x + rectangle_width, pos_y, pos_y + rectangle_height);
       AddDrawRectangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.texture_enable, rc.transparency_enable);
     }
     break;
@@ -805,7 +1017,8 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        CheckForSpriteOverlap(min_x, max_x + 1, min_y, max_y + 1, 1);
+        IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
         // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -851,7 +1064,8 @@ void GPU_HW::LoadVertices()
             const u32 clip_bottom =
               static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-            m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+            CheckForSpriteOverlap(min_x, max_x + 1, min_y, max_y + 1, 1);
+            IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
             AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
             // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -950,6 +1164,7 @@ GPU_HW::VRAMCopyUBOData GPU_HW::GetVRAMCopyUBOData(u32 src_x, u32 src_y, u32 dst
 void GPU_HW::IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect)
 {
   m_vram_dirty_rect.Include(rect);
+  SetVRAMShadowDirty(rect);
 
   // the vram area can include the texture page, but the game can leave it as-is. in this case, set it as dirty so the
   // shadow texture is updated
@@ -961,6 +1176,112 @@ void GPU_HW::IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect)
   }
 }
 
+static u64 GetVRAMShadowTileMask(u32 first_tile, u32 last_tile)
+{
+  const u32 count = last_tile - first_tile + 1;
+  return ((count >= 64) ? ~UINT64_C(0) : ((UINT64_C(1) << count) - 1)) << first_tile;
+}
+
+void GPU_HW::SetVRAMShadowDirty(const Common::Rectangle<u32>& rect)
+{
+  if (rect.left >= rect.right || rect.top >= rect.bottom)
+    return;
+
+  const u64 mask =
+    GetVRAMShadowTileMask(rect.left / VRAM_SHADOW_TILE_SIZE, (rect.right - 1) / VRAM_SHADOW_TILE_SIZE);
+  const u32 last_row = (rect.bottom - 1) / VRAM_SHADOW_TILE_SIZE;
+  for (u32 row = rect.top / VRAM_SHADOW_TILE_SIZE; row <= last_row; row++)
+    m_vram_shadow_dirty_tiles[row] |= mask;
+}
+
+void GPU_HW::IncludeBatchSpriteArea(s32 left, s32 right, s32 top, s32 bottom)
+{
+  left = std::max<s32>(left, static_cast<s32>(m_drawing_area.left));
+  right = std::min<s32>(right, static_cast<s32>(m_drawing_area.right) + 1);
+  top = std::max<s32>(top, static_cast<s32>(m_drawing_area.top));
+  bottom = std::min<s32>(bottom, static_cast<s32>(m_drawing_area.bottom) + 1);
+  if (left >= right || top >= bottom)
+    return;
+
+  const u64 mask = GetVRAMShadowTileMask(static_cast<u32>(left) / VRAM_SHADOW_TILE_SIZE,
+                                         static_cast<u32>(right - 1) / VRAM_SHADOW_TILE_SIZE);
+  const u32 last_row = static_cast<u32>(bottom - 1) / VRAM_SHADOW_TILE_SIZE;
+  for (u32 row = static_cast<u32>(top) / VRAM_SHADOW_TILE_SIZE; row <= last_row; row++)
+    m_batch_sprite_tiles[row] |= mask;
+}
+
+bool GPU_HW::IsBatchSpriteArea(s32 left, s32 right, s32 top, s32 bottom, s32 padding) const
+{
+  left = std::max<s32>(left - padding, static_cast<s32>(m_drawing_area.left));
+  right = std::min<s32>(right + padding, static_cast<s32>(m_drawing_area.right) + 1);
+  top = std::max<s32>(top - padding, static_cast<s32>(m_drawing_area.top));
+  bottom = std::min<s32>(bottom + padding, static_cast<s32>(m_drawing_area.bottom) + 1);
+  if (left >= right || top >= bottom)
+    return false;
+
+  const u64 mask = GetVRAMShadowTileMask(static_cast<u32>(left) / VRAM_SHADOW_TILE_SIZE,
+                                         static_cast<u32>(right - 1) / VRAM_SHADOW_TILE_SIZE);
+  const u32 last_row = static_cast<u32>(bottom - 1) / VRAM_SHADOW_TILE_SIZE;
+  for (u32 row = static_cast<u32>(top) / VRAM_SHADOW_TILE_SIZE; row <= last_row; row++)
+  {
+    if (m_batch_sprite_tiles[row] & mask)
+      return true;
+  }
+
+  return false;
+}
+
+void GPU_HW::SetVRAMShadowValid(const Common::Rectangle<u32>& rect)
+{
+  // partially covered tiles still have pixels which weren't read
+  const u32 first_col = (rect.left + (VRAM_SHADOW_TILE_SIZE - 1)) / VRAM_SHADOW_TILE_SIZE;
+  const u32 end_col = rect.right / VRAM_SHADOW_TILE_SIZE;
+  const u32 first_row = (rect.top + (VRAM_SHADOW_TILE_SIZE - 1)) / VRAM_SHADOW_TILE_SIZE;
+  const u32 end_row = rect.bottom / VRAM_SHADOW_TILE_SIZE;
+  if (first_col >= end_col || first_row >= end_row)
+    return;
+
+  const u64 mask = GetVRAMShadowTileMask(first_col, end_col - 1);
+  for (u32 row = first_row; row < end_row; row++)
+    m_vram_shadow_dirty_tiles[row] &= ~mask;
+}
+
+bool GPU_HW::GetVRAMReadbackRectangle(Common::Rectangle<u32>* rect)
+{
+  const u64 mask =
+    GetVRAMShadowTileMask(rect->left / VRAM_SHADOW_TILE_SIZE, (rect->right - 1) / VRAM_SHADOW_TILE_SIZE);
+  const u32 last_row = (rect->bottom - 1) / VRAM_SHADOW_TILE_SIZE;
+  u32 first_dirty_row = VRAM_SHADOW_TILES_Y;
+  u32 last_dirty_row = 0;
+  u64 dirty_cols = 0;
+  for (u32 row = rect->top / VRAM_SHADOW_TILE_SIZE; row <= last_row; row++)
+  {
+    const u64 bits = m_vram_shadow_dirty_tiles[row] & mask;
+    if (bits == 0)
+      continue;
+
+    first_dirty_row = std::min(first_dirty_row, row);
+    last_dirty_row = row;
+    dirty_cols |= bits;
+  }
+
+  if (dirty_cols == 0)
+  {
+    m_renderer_stats.num_vram_readbacks_skipped++;
+    return false;
+  }
+
+  const u32 first_dirty_col = CountTrailingZeros(dirty_cols);
+  const u32 last_dirty_col = 63u - CountLeadingZeros(dirty_cols);
+  rect->left = std::max(rect->left, first_dirty_col * VRAM_SHADOW_TILE_SIZE);
+  rect->right = std::min(rect->right, (last_dirty_col + 1) * VRAM_SHADOW_TILE_SIZE);
+  rect->top = std::max(rect->top, first_dirty_row * VRAM_SHADOW_TILE_SIZE);
+  rect->bottom = std::min(rect->bottom, (last_dirty_row + 1) * VRAM_SHADOW_TILE_SIZE);
+  SetVRAMShadowValid(*rect);
+  m_renderer_stats.num_vram_readbacks++;
+  return true;
+}
+
 void GPU_HW::EnsureVertexBufferSpace(u32 required_vertices)
 {
   if (m_batch_current_vertex_ptr)
@@ -1029,7 +1350,16 @@ void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask)
 {
   DebugAssert((x + width) <= VRAM_WIDTH && (y + height) <= VRAM_HEIGHT);
-  IncludeVRAMDityRectangle(Common::Rectangle<u32>::FromExtents(x, y, width, height));
+  const Common::Rectangle<u32> rect = Common::Rectangle<u32>::FromExtents(x, y, width, height);
+  IncludeVRAMDityRectangle(rect);
+
+  // uploading the shadow copy itself (state loads, CPU round trips) leaves the GPU matching it
+  const u16* data_ptr = static_cast<const u16*>(data);
+  if (!set_mask && !check_mask && data_ptr >= m_vram_shadow.data() &&
+      data_ptr < (m_vram_shadow.data() + m_vram_shadow.size()))
+  {
+    SetVRAMShadowValid(rect);
+  }
 
   if (check_mask)
   {
@@ -1079,16 +1409,22 @@ void GPU_HW::DispatchRenderCommand()
       texture_mode =
         static_cast<GPUTextureMode>(static_cast<u8>(texture_mode) | static_cast<u8>(GPUTextureMode::RawTextureBit));
     }
+
+    m_using_palette_texture_cache_slot = (m_palette_texture_cache && m_draw_mode.mode_reg.IsUsingPalette());
+    if (m_using_palette_texture_cache_slot)
+      m_current_palette_texture_cache_slot = GetPaletteTextureCacheSlot();
   }
   else
   {
     texture_mode = GPUTextureMode::Disabled;
+    m_using_palette_texture_cache_slot = false;
   }
 
   // has any state changed which requires a new batch?
   const GPUTransparencyMode transparency_mode =
     rc.transparency_enable ? m_draw_mode.mode_reg.transparency_mode : GPUTransparencyMode::Disabled;
   const bool dithering_enable = (!m_true_color && rc.IsDitheringEnabled()) ? m_GPUSTAT.dither_enable : false;
+
   if (texture_mode != m_batch.texture_mode || transparency_mode != m_batch.transparency_mode ||
       transparency_mode == GPUTransparencyMode::BackgroundMinusForeground || dithering_enable != m_batch.dithering)
   {
@@ -1147,12 +1483,23 @@ void GPU_HW::FlushRender()
   if (!m_batch_current_vertex_ptr)
     return;
 
-  const u32 vertex_count = GetBatchVertexCount();
-  UnmapBatchVertexPointer(vertex_count);
+  const u32 vertex_count = static_cast<u32>(m_batch_current_vertex_ptr - m_batch_start_vertex_ptr);
+  const u32 sprite_count = static_cast<u32>(m_batch_sprites.size());
+  if (sprite_count > 0)
+  {
+    std::memcpy(m_batch_current_vertex_ptr, m_batch_sprites.data(), sizeof(BatchVertex) * sprite_count);
+    m_batch_sprites.clear();
+    m_batch_sprite_tiles.fill(0);
+  }
+
+  UnmapBatchVertexPointer(vertex_count + sprite_count);
 
-  if (vertex_count == 0)
+  if (vertex_count == 0 && sprite_count == 0)
     return;
 
+  m_renderer_stats.num_batch_vertices += vertex_count;
+  m_renderer_stats.num_sprites += sprite_count;
+
   if (m_drawing_area_changed)
   {
     m_drawing_area_changed = false;
@@ -1168,16 +1515,30 @@ void GPU_HW::FlushRender()
     m_batch_ubo_dirty = false;
   }
 
+  m_renderer_stats.num_batches++;
   if (m_batch.NeedsTwoPassRendering())
   {
-    m_renderer_stats.num_batches += 2;
-    DrawBatchVertices(BatchRenderMode::OnlyOpaque, m_batch_base_vertex, vertex_count);
-    DrawBatchVertices(BatchRenderMode::OnlyTransparent, m_batch_base_vertex, vertex_count);
+    DrawCurrentBatch(BatchRenderMode::OnlyOpaque, vertex_count, sprite_count);
+    DrawCurrentBatch(BatchRenderMode::OnlyTransparent, vertex_count, sprite_count);
   }
   else
   {
-    m_renderer_stats.num_batches++;
-    DrawBatchVertices(m_batch.GetRenderMode(), m_batch_base_vertex, vertex_count);
+    DrawCurrentBatch(m_batch.GetRenderMode(), vertex_count, sprite_count);
+  }
+}
+
+void GPU_HW::DrawCurrentBatch(BatchRenderMode render_mode, u32 num_vertices, u32 num_sprites)
+{
+  // sprites are after the triangles in the buffer, and are drawn after them
+  if (num_vertices > 0)
+  {
+    m_renderer_stats.num_draws++;
+    DrawBatchVertices(render_mode, m_batch_base_vertex, num_vertices);
+  }
+  if (num_sprites > 0)
+  {
+    m_renderer_stats.num_draws++;
+    DrawBatchSprites(render_mode, m_batch_base_vertex + num_vertices, num_sprites);
   }
 }
 
@@ -1185,6 +1546,8 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
 {
   if (!is_idle_frame)
   {
+    m_renderer_stats.num_pipeline_fallbacks = m_pipeline_fallbacks.exchange(0, std::memory_order_relaxed);
+    m_renderer_stats.num_pipeline_stalls = m_pipeline_stalls.exchange(0, std::memory_order_relaxed);
     m_last_renderer_stats = m_renderer_stats;
     m_renderer_stats = {};
   }
@@ -1241,9 +1604,15 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
                        "Cache");
     ImGui::NextColumn();
 
-    ImGui::TextUnformatted("Batches Drawn:");
+    ImGui::TextUnformatted("Batches/Draw Calls:");
+    ImGui::NextColumn();
+    ImGui::Text("%u / %u", stats.num_batches, stats.num_draws);
+    ImGui::NextColumn();
+
+    ImGui::TextUnformatted("Vertices/Sprites:");
     ImGui::NextColumn();
-    ImGui::Text("%u", stats.num_batches);
+    ImGui::Text("%u (%u KB) / %u", stats.num_batch_vertices,
+                static_cast<u32>((stats.num_batch_vertices * sizeof(BatchVertex)) / 1024u), stats.num_sprites);
     ImGui::NextColumn();
 
     ImGui::TextUnformatted("VRAM Read Texture Updates:");
@@ -1256,6 +1625,37 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
     ImGui::Text("%u", stats.num_uniform_buffer_updates);
     ImGui::NextColumn();
 
+    ImGui::TextUnformatted("VRAM Readbacks/Skipped:");
+    ImGui::NextColumn();
+    ImGui::Text("%u / %u", stats.num_vram_readbacks, stats.num_vram_readbacks_skipped);
+    ImGui::NextColumn();
+
+    ImGui::TextUnformatted("Pipelines Used:");
+    ImGui::NextColumn();
+    ImGui::Text("%zu", m_batch_pipeline_use_order.size());
+    ImGui::NextColumn();
+
+    if (m_async_pipeline_compilation)
+    {
+      ImGui::TextUnformatted("Pipeline Fallbacks/Stalls:");
+      ImGui::NextColumn();
+      ImGui::Text("%u / %u", stats.num_pipeline_fallbacks, stats.num_pipeline_stalls);
+      ImGui::NextColumn();
+    }
+
+    if (m_palette_texture_cache)
+    {
+      ImGui::TextUnformatted("Palette Cache Hits/Misses:");
+      ImGui::NextColumn();
+      ImGui::Text("%u / %u", stats.num_palette_cache_hits, stats.num_palette_cache_misses);
+      ImGui::NextColumn();
+
+      ImGui::TextUnformatted("Palette Cache Invalidations:");
+      ImGui::NextColumn();
+      ImGui::Text("%u", stats.num_palette_cache_invalidations);
+      ImGui::NextColumn();
+    }
+
     ImGui::Columns(1);
   }
 #endif
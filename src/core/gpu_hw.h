@@ -1,7 +1,11 @@
 #pragma once
+#include "common/bitfield.h"
 #include "common/heap_array.h"
 #include "gpu.h"
 #include "host_display.h"
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -26,6 +30,18 @@ public:
     SeparateFields
   };
 
+  enum : u32
+  {
+    // decoded palette textures are stored at native resolution, in an 8x8 grid of texture pages
+    PALETTE_TEXTURE_CACHE_SLOT_SIZE = TEXTURE_PAGE_WIDTH,
+    PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW = 8,
+    NUM_PALETTE_TEXTURE_CACHE_SLOTS = PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW * PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW,
+    PALETTE_TEXTURE_CACHE_SIZE = PALETTE_TEXTURE_CACHE_SLOT_SIZE * PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW,
+
+    // set in the vertex texpage field when it holds a cache slot instead of the page and palette
+    PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG = 0x80000000u
+  };
+
   GPU_HW();
   virtual ~GPU_HW();
 
@@ -46,7 +62,26 @@ protected:
     UNIFORM_BUFFER_SIZE = 512 * 1024,
     MAX_BATCH_VERTEX_COUNTER_IDS = 65536 - 2,
     MAX_VERTICES_FOR_RECTANGLE = 6 * (((MAX_PRIMITIVE_WIDTH + (TEXTURE_PAGE_WIDTH - 1)) / TEXTURE_PAGE_WIDTH) + 1u) *
-                                 (((MAX_PRIMITIVE_HEIGHT + (TEXTURE_PAGE_HEIGHT - 1)) / TEXTURE_PAGE_HEIGHT) + 1u)
+                                 (((MAX_PRIMITIVE_HEIGHT + (TEXTURE_PAGE_HEIGHT - 1)) / TEXTURE_PAGE_HEIGHT) + 1u),
+    NUM_BATCH_PIPELINE_KEYS = 1 << 13,
+    INVALID_PALETTE_TEXTURE_CACHE_KEY = 0xFFFFFFFFu,
+    VRAM_SHADOW_TILE_SIZE = 16,
+    VRAM_SHADOW_TILES_X = VRAM_WIDTH / VRAM_SHADOW_TILE_SIZE,
+    VRAM_SHADOW_TILES_Y = VRAM_HEIGHT / VRAM_SHADOW_TILE_SIZE
+  };
+
+  /// Identifies a batch pipeline variant, this is what gets recorded in the per-game pipeline usage list.
+  /// depth_test is check_mask | (use_depth_buffer << 1), backends ignore the fields they don't specialize on.
+  union BatchPipelineKey
+  {
+    BitField<u32, u8, 0, 2> depth_test;
+    BitField<u32, BatchRenderMode, 2, 2> render_mode;
+    BitField<u32, GPUTextureMode, 4, 4> texture_mode;
+    BitField<u32, GPUTransparencyMode, 8, 3> transparency_mode;
+    BitField<u32, bool, 11, 1> dithering;
+    BitField<u32, bool, 12, 1> interlacing;
+
+    u32 bits;
   };
 
   struct BatchVertex
@@ -81,6 +116,16 @@ protected:
       uv_limits = uv_limits_;
     }
 
+    /// Sprites are stored as a single record for the top-left corner, with the size of the quad in place of w.
+    /// The vertex shader expands them to two triangles.
+    ALWAYS_INLINE void SetSprite(float x_, float y_, float z_, u32 width, u32 height, u32 color_, u32 texpage_, u16 u_,
+                                 u16 v_, u32 uv_limits_)
+    {
+      const u32 size = width | (height << 16);
+      Set(x_, y_, z_, 0.0f, color_, texpage_, u_, v_, uv_limits_);
+      std::memcpy(&w, &size, sizeof(size));
+    }
+
     ALWAYS_INLINE static u32 PackUVLimits(u32 min_u, u32 max_u, u32 min_v, u32 max_v)
     {
       return min_u | (min_v << 8) | (max_u << 16) | (max_v << 24);
@@ -164,8 +209,24 @@ protected:
   struct RendererStats
   {
     u32 num_batches;
+    u32 num_draws;
     u32 num_vram_read_texture_updates;
     u32 num_uniform_buffer_updates;
+    u32 num_pipeline_fallbacks;
+    u32 num_pipeline_stalls;
+    u32 num_palette_cache_hits;
+    u32 num_palette_cache_misses;
+    u32 num_palette_cache_invalidations;
+    u32 num_vram_readbacks;
+    u32 num_vram_readbacks_skipped;
+    u32 num_batch_vertices;
+    u32 num_sprites;
+  };
+
+  struct PaletteDecodeUBOData
+  {
+    u32 u_texpage[4];
+    u32 u_slot_origin[2];
   };
 
   static constexpr std::tuple<float, float, float, float> RGBA8ToFloat(u32 rgba)
@@ -187,6 +248,13 @@ protected:
   virtual void UploadUniformBuffer(const void* uniforms, u32 uniforms_size) = 0;
   virtual void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) = 0;
 
+  /// Draws sprite records with the current batch state, only called when m_sprite_instancing is set.
+  virtual void DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites);
+
+  /// Decodes the current texture page with the current palette into the palette texture cache. Backends which
+  /// implement this set m_supports_palette_texture_cache, the cache is never enabled otherwise.
+  virtual void DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms);
+
   u32 CalculateResolutionScale() const;
   GPUDownsampleMode GetDownsampleMode(u32 resolution_scale) const;
 
@@ -203,11 +271,33 @@ protected:
   }
   void ClearVRAMDirtyRectangle() { m_vram_dirty_rect.SetInvalid(); }
   void IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect);
+  ALWAYS_INLINE void IncludeDrawnVRAMRectangle(u32 left, u32 right, u32 top, u32 bottom)
+  {
+    m_vram_dirty_rect.Include(left, right, top, bottom);
+    SetVRAMShadowDirty(Common::Rectangle<u32>(left, top, right, bottom));
+  }
+
+  /// Marks VRAM written on the GPU, which the shadow copy doesn't have until it's read back.
+  void SetVRAMShadowDirty(const Common::Rectangle<u32>& rect);
+
+  /// Marks the tiles which are entirely within the rectangle as matching the GPU's copy.
+  void SetVRAMShadowValid(const Common::Rectangle<u32>& rect);
 
-  bool IsFlushed() const { return m_batch_current_vertex_ptr == m_batch_start_vertex_ptr; }
+  /// Shrinks a readback to the tiles which the GPU has written since they were last read, and marks them as valid.
+  /// Returns false if the shadow copy is already up to date, in which case there's nothing to read back.
+  bool GetVRAMReadbackRectangle(Common::Rectangle<u32>* rect);
 
-  u32 GetBatchVertexSpace() const { return static_cast<u32>(m_batch_end_vertex_ptr - m_batch_current_vertex_ptr); }
-  u32 GetBatchVertexCount() const { return static_cast<u32>(m_batch_current_vertex_ptr - m_batch_start_vertex_ptr); }
+  bool IsFlushed() const { return (m_batch_current_vertex_ptr == m_batch_start_vertex_ptr && m_batch_sprites.empty()); }
+
+  /// Sprite records are copied in after the triangles when the batch is flushed, so they take space from it.
+  u32 GetBatchVertexSpace() const
+  {
+    return static_cast<u32>(m_batch_end_vertex_ptr - m_batch_current_vertex_ptr - m_batch_sprites.size());
+  }
+  u32 GetBatchVertexCount() const
+  {
+    return static_cast<u32>(m_batch_current_vertex_ptr - m_batch_start_vertex_ptr + m_batch_sprites.size());
+  }
   void EnsureVertexBufferSpace(u32 required_vertices);
   void EnsureVertexBufferSpaceForCurrentCommand();
   void ResetBatchVertexDepth();
@@ -288,6 +378,60 @@ protected:
   /// Computes polygon U/V boundaries.
   static void ComputePolygonUVLimits(BatchVertex* vertices, u32 num_vertices);
 
+  /// Returns the key naming the pipeline variant which draws the specified batch.
+  ALWAYS_INLINE static BatchPipelineKey GetBatchPipelineKey(const BatchConfig& batch, BatchRenderMode render_mode)
+  {
+    BatchPipelineKey key;
+    key.bits = 0;
+    key.depth_test = BoolToUInt8(batch.check_mask_before_draw) | (BoolToUInt8(batch.use_depth_buffer) << 1);
+    key.render_mode = render_mode;
+    key.texture_mode = batch.texture_mode;
+    key.transparency_mode = batch.transparency_mode;
+    key.dithering = batch.dithering;
+    key.interlacing = batch.interlacing;
+    return key;
+  }
+  ALWAYS_INLINE BatchPipelineKey GetBatchPipelineKey(BatchRenderMode render_mode) const
+  {
+    return GetBatchPipelineKey(m_batch, render_mode);
+  }
+
+  /// Returns false for keys which don't name a variant, e.g. from a damaged usage list.
+  static ALWAYS_INLINE bool IsValidBatchPipelineKey(BatchPipelineKey key)
+  {
+    return (key.depth_test < 3 && key.texture_mode.GetValue() <= GPUTextureMode::Disabled &&
+            key.transparency_mode.GetValue() <= GPUTransparencyMode::Disabled);
+  }
+
+  /// Adds the variant to the running game's pipeline usage list, if it isn't already there.
+  ALWAYS_INLINE void RecordBatchPipelineUse(BatchPipelineKey key)
+  {
+    if (m_used_batch_pipelines.test(key.bits))
+      return;
+
+    m_used_batch_pipelines.set(key.bits);
+    m_batch_pipeline_use_order.push_back(key.bits);
+    m_batch_pipeline_use_order_changed = true;
+  }
+
+  std::string GetPipelineUsageListPath() const;
+  void LoadPipelineUsageList();
+  void SavePipelineUsageList();
+
+  /// Returns the top-left of the slot in the palette texture cache.
+  ALWAYS_INLINE static std::tuple<u32, u32> GetPaletteTextureCacheSlotOrigin(u32 slot)
+  {
+    return std::make_tuple((slot % PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW) * PALETTE_TEXTURE_CACHE_SLOT_SIZE,
+                           (slot / PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW) * PALETTE_TEXTURE_CACHE_SLOT_SIZE);
+  }
+
+  /// Returns the slot holding the current texture page decoded with the current palette, decoding it if needed.
+  u32 GetPaletteTextureCacheSlot();
+
+  /// Drops decoded textures which were read from the specified area of VRAM.
+  void InvalidatePaletteTextureCache(const Common::Rectangle<u32>& rect);
+  void ResetPaletteTextureCache();
+
   /// Sets the depth test flag for PGXP depth buffering.
   void SetBatchDepthBuffer(bool enabled);
   void CheckForDepthClear(const BatchVertex* vertices, u32 num_vertices);
@@ -314,6 +458,12 @@ protected:
   BatchVertex* m_batch_current_vertex_ptr = nullptr;
   u32 m_batch_base_vertex = 0;
   s32 m_current_depth = 0;
+
+  // Rectangles are expanded on the GPU when m_sprite_instancing is set. Their records are kept aside and drawn after
+  // the batch's triangles, so triangles which overlap a sprite already in the batch have to go in the next one.
+  // The area covered by the batch's sprites is tracked in VRAM_SHADOW_TILE_SIZE tiles, one row per element.
+  std::vector<BatchVertex> m_batch_sprites;
+  std::array<u64, VRAM_SHADOW_TILES_Y> m_batch_sprite_tiles = {};
   float m_last_depth_z = 1.0f;
 
   u32 m_resolution_scale = 1;
@@ -325,20 +475,48 @@ protected:
 
   union
   {
-    BitField<u8, bool, 0, 1> m_supports_per_sample_shading;
-    BitField<u8, bool, 1, 1> m_supports_dual_source_blend;
-    BitField<u8, bool, 2, 1> m_supports_adaptive_downsampling;
-    BitField<u8, bool, 3, 1> m_per_sample_shading;
-    BitField<u8, bool, 4, 1> m_scaled_dithering;
-    BitField<u8, bool, 5, 1> m_chroma_smoothing;
-
-    u8 bits = 0;
+    BitField<u16, bool, 0, 1> m_supports_per_sample_shading;
+    BitField<u16, bool, 1, 1> m_supports_dual_source_blend;
+    BitField<u16, bool, 2, 1> m_supports_adaptive_downsampling;
+    BitField<u16, bool, 3, 1> m_per_sample_shading;
+    BitField<u16, bool, 4, 1> m_scaled_dithering;
+    BitField<u16, bool, 5, 1> m_chroma_smoothing;
+    BitField<u16, bool, 6, 1> m_supports_async_pipeline_compilation;
+    BitField<u16, bool, 7, 1> m_supports_palette_texture_cache;
+    BitField<u16, bool, 8, 1> m_supports_sprite_instancing;
+
+    u16 bits = 0;
   };
 
   GPUTextureFilter m_texture_filtering = GPUTextureFilter::Nearest;
   GPUDownsampleMode m_downsample_mode = GPUDownsampleMode::Disabled;
   bool m_using_uv_limits = false;
   bool m_pgxp_depth_buffer = false;
+  bool m_sprite_instancing = false;
+
+  // Pipelines are compiled on first use, rather than all up front. Backends precompile the variants in
+  // m_batch_pipeline_use_order, which starts with the ones the game used last time it was run. The usage list is
+  // recorded either way, so it's ready when async compilation is switched on, and orders the startup compile.
+  bool m_async_pipeline_compilation = false;
+  std::string m_pipeline_usage_game_code;
+  std::bitset<NUM_BATCH_PIPELINE_KEYS> m_used_batch_pipelines;
+  std::vector<u32> m_batch_pipeline_use_order;
+  bool m_batch_pipeline_use_order_changed = false;
+
+  // Palette textures are decoded from the VRAM read texture, so entries only go stale when it is updated. Slots are
+  // reused least recently used first.
+  struct PaletteTextureCacheEntry
+  {
+    u32 key;
+    u32 last_used;
+    Common::Rectangle<u32> page_rect;
+    Common::Rectangle<u32> palette_rect;
+  };
+  bool m_palette_texture_cache = false;
+  std::array<PaletteTextureCacheEntry, NUM_PALETTE_TEXTURE_CACHE_SLOTS> m_palette_texture_cache_entries;
+  u32 m_palette_texture_cache_counter = 0;
+  u32 m_current_palette_texture_cache_slot = 0;
+  bool m_using_palette_texture_cache_slot = false;
 
   BatchConfig m_batch = {};
   BatchUBOData m_batch_ubo_data = {};
@@ -346,10 +524,17 @@ protected:
   // Bounding box of VRAM area that the GPU has drawn into.
   Common::Rectangle<u32> m_vram_dirty_rect;
 
+  // VRAM_SHADOW_TILE_SIZE tiles which have been written on the GPU since they were last read back, one row per element.
+  std::array<u64, VRAM_SHADOW_TILES_Y> m_vram_shadow_dirty_tiles = {};
+
   // Statistics
   RendererStats m_renderer_stats = {};
   RendererStats m_last_renderer_stats = {};
 
+  // Pipelines are looked up on the render thread with some backends, so these are moved into the stats each frame.
+  std::atomic<u32> m_pipeline_fallbacks{0};
+  std::atomic<u32> m_pipeline_stalls{0};
+
   // Changed state
   bool m_batch_ubo_dirty = true;
 
@@ -375,5 +560,28 @@ private:
     m_batch_current_vertex_ptr++;
   }
 
+  template<typename... Args>
+  ALWAYS_INLINE void AddNewSprite(Args&&... args)
+  {
+    m_batch_sprites.emplace_back().SetSprite(std::forward<Args>(args)...);
+  }
+
+  /// Starts a new batch if triangles covering this area would be drawn before a sprite they should be drawn after.
+  /// Coordinates are native and unclipped with exclusive right/bottom edges. The padding covers vertices which can
+  /// land outside the native positions, i.e. PGXP and lines expanded at higher resolutions.
+  ALWAYS_INLINE void CheckForSpriteOverlap(s32 left, s32 right, s32 top, s32 bottom, s32 padding)
+  {
+    if (!m_batch_sprites.empty() && IsBatchSpriteArea(left, right, top, bottom, padding))
+    {
+      FlushRender();
+      EnsureVertexBufferSpaceForCurrentCommand();
+    }
+  }
+
+  void IncludeBatchSpriteArea(s32 left, s32 right, s32 top, s32 bottom);
+  bool IsBatchSpriteArea(s32 left, s32 right, s32 top, s32 bottom, s32 padding) const;
+
+  void DrawCurrentBatch(BatchRenderMode render_mode, u32 num_vertices, u32 num_sprites);
+
   void PrintSettingsToLog();
 };
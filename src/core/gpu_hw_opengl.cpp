@@ -125,6 +125,12 @@ void GPU_HW_OpenGL::RestoreGraphicsAPIState()
   glBindVertexArray(m_vao_id);
   m_uniform_stream_buffer->Bind();
   m_vram_read_texture.Bind();
+  if (m_palette_texture_cache)
+  {
+    glActiveTexture(GL_TEXTURE1);
+    m_palette_texture_cache_texture.Bind();
+    glActiveTexture(GL_TEXTURE0);
+  }
   SetBlendMode();
   m_current_depth_test = 0;
   SetDepthFunc();
@@ -261,6 +267,30 @@ void GPU_HW_OpenGL::SetCapabilities(HostDisplay* host_display)
   if (!m_supports_dual_source_blend)
     Log_WarningPrintf("Dual-source blending is not supported, this may break some mask effects.");
 
+  m_supports_async_pipeline_compilation = true;
+  m_supports_palette_texture_cache = true;
+
+  // Let the driver spread shader compilation over its own threads, as many as it likes. Batch programs are linked
+  // without waiting, then either all waited on together on boot, or polled for completion when compiled async.
+  m_supports_parallel_shader_compile = (GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile);
+  if (GLAD_GL_KHR_parallel_shader_compile)
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+  else if (GLAD_GL_ARB_parallel_shader_compile)
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+  if (!m_supports_parallel_shader_compile)
+    Log_InfoPrintf("Parallel shader compile is not supported, async batch programs will be compiled on first use.");
+
+  // Sprites are expanded from records in the vertex buffer, which the vertex shader reads as a SSBO.
+  GLint max_vertex_ssbos = 0;
+  if ((GLAD_GL_VERSION_4_3 || GLAD_GL_ES_VERSION_3_1 || GLAD_GL_ARB_shader_storage_buffer_object) &&
+      GPU_HW_ShaderGen::UseGLSLBindingLayout())
+  {
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_vertex_ssbos);
+  }
+  m_supports_sprite_instancing = (max_vertex_ssbos > 0);
+  if (!m_supports_sprite_instancing)
+    Log_InfoPrintf("Vertex shader storage buffers are not supported, rectangles will be expanded on the CPU.");
+
   m_supports_geometry_shaders =
     GLAD_GL_VERSION_3_2 || GLAD_GL_ARB_geometry_shader4 || GLAD_GL_OES_geometry_shader || GLAD_GL_ES_VERSION_3_2;
   if (!m_supports_geometry_shaders)
@@ -311,6 +341,20 @@ bool GPU_HW_OpenGL::CreateFramebuffer()
                          m_vram_depth_texture.GetGLId(), 0);
   Assert(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
 
+  if (m_palette_texture_cache)
+  {
+    if (!m_palette_texture_cache_texture.Create(PALETTE_TEXTURE_CACHE_SIZE, PALETTE_TEXTURE_CACHE_SIZE, 1, GL_RGBA8,
+                                                GL_RGBA, GL_UNSIGNED_BYTE, nullptr, false) ||
+        !m_palette_texture_cache_texture.CreateFramebuffer())
+    {
+      return false;
+    }
+  }
+  else
+  {
+    m_palette_texture_cache_texture.Destroy();
+  }
+
   if (m_downsample_mode == GPUDownsampleMode::Box)
   {
     if (!m_downsample_texture.Create(VRAM_WIDTH, VRAM_HEIGHT, 1, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE) ||
@@ -398,13 +442,17 @@ bool GPU_HW_OpenGL::CreateTextureBuffer()
 
 bool GPU_HW_OpenGL::CompilePrograms()
 {
-  GL::ShaderCache shader_cache;
-  shader_cache.Open(IsGLES(), g_host_interface->GetShaderCacheBasePath(), SHADER_CACHE_VERSION);
+  // kept open when compiling asynchronously, since batch programs get compiled later
+  m_pending_batch_programs.clear();
+  m_shader_cache = std::make_unique<GL::ShaderCache>();
+  m_shader_cache->Open(IsGLES(), g_host_interface->GetShaderCacheBasePath(), SHADER_CACHE_VERSION);
+  GL::ShaderCache& shader_cache = *m_shader_cache;
 
   const bool use_binding_layout = GPU_HW_ShaderGen::UseGLSLBindingLayout();
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
                              m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_supports_dual_source_blend);
+                             m_pgxp_depth_buffer, m_palette_texture_cache, m_sprite_instancing,
+                             m_supports_dual_source_blend);
 
   Common::Timer compile_time;
   const int progress_total = (4 * 9 * 2 * 2) + (2 * 3) + 6;
@@ -420,67 +468,97 @@ bool GPU_HW_OpenGL::CompilePrograms()
     }                                                                                                                  \
   } while (0)
 
-  for (u32 render_mode = 0; render_mode < 4; render_mode++)
+  for (auto& programs_for_render_mode : m_render_programs)
+  {
+    for (auto& programs_for_texture_mode : programs_for_render_mode)
+    {
+      for (auto& programs_for_dithering : programs_for_texture_mode)
+      {
+        for (GL::Program& prog : programs_for_dithering)
+          prog.Destroy();
+      }
+    }
+  }
+
+  if (m_async_pipeline_compilation)
   {
-    for (u32 texture_mode = 0; texture_mode < 9; texture_mode++)
+    // Batch programs are compiled when they're first used, apart from the ones the game used last time.
+    // With parallel shader compile these are only started here, and finish in the background.
+    m_batch_shadergen = std::make_unique<GPU_HW_ShaderGen>(shadergen);
+    for (const u32 bits : m_batch_pipeline_use_order)
     {
-      for (u8 dithering = 0; dithering < 2; dithering++)
+      BatchPipelineKey key;
+      key.bits = bits;
+      if (GetBatchProgram(key).IsVaild())
+        continue;
+
+      if (!CompileBatchProgram(shadergen, key, true))
+        return false;
+
+      UPDATE_PROGRESS();
+    }
+  }
+  else
+  {
+    // Everything is built up front, starting with the programs the game used last time.
+    m_batch_shadergen.reset();
+    std::vector<BatchPipelineKey> keys;
+    keys.reserve(m_batch_pipeline_use_order.size() + (4 * 9 * 2 * 2));
+    for (const u32 bits : m_batch_pipeline_use_order)
+    {
+      BatchPipelineKey key;
+      key.bits = bits;
+      keys.push_back(key);
+    }
+    for (u8 render_mode = 0; render_mode < 4; render_mode++)
+    {
+      for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
       {
-        for (u8 interlacing = 0; interlacing < 2; interlacing++)
+        for (u8 dithering = 0; dithering < 2; dithering++)
         {
-          const bool textured = (static_cast<GPUTextureMode>(texture_mode) != GPUTextureMode::Disabled);
-          const std::string batch_vs = shadergen.GenerateBatchVertexShader(textured);
-          const std::string fs = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
-
-          const auto link_callback = [this, textured, use_binding_layout](GL::Program& prog) {
-            if (!use_binding_layout)
-            {
-              prog.BindAttribute(0, "a_pos");
-              prog.BindAttribute(1, "a_col0");
-              if (textured)
-              {
-                prog.BindAttribute(2, "a_texcoord");
-                prog.BindAttribute(3, "a_texpage");
-                prog.BindAttribute(4, "a_uv_limits");
-              }
-
-              if (!IsGLES() || m_supports_dual_source_blend)
-              {
-                if (m_supports_dual_source_blend)
-                {
-                  prog.BindFragDataIndexed(0, "o_col0");
-                  prog.BindFragDataIndexed(1, "o_col1");
-                }
-                else
-                {
-                  prog.BindFragData(0, "o_col0");
-                }
-              }
-            }
-          };
-
-          std::optional<GL::Program> prog = shader_cache.GetProgram(batch_vs, {}, fs, link_callback);
-          if (!prog)
-            return false;
-
-          if (!use_binding_layout)
+          for (u8 interlacing = 0; interlacing < 2; interlacing++)
           {
-            prog->BindUniformBlock("UBOBlock", 1);
-            if (textured)
-            {
-              prog->Bind();
-              prog->Uniform1i("samp0", 0);
-            }
+            BatchPipelineKey key;
+            key.bits = 0;
+            key.render_mode = static_cast<BatchRenderMode>(render_mode);
+            key.texture_mode = static_cast<GPUTextureMode>(texture_mode);
+            key.dithering = ConvertToBoolUnchecked(dithering);
+            key.interlacing = ConvertToBoolUnchecked(interlacing);
+            keys.push_back(key);
           }
-
-          m_render_programs[render_mode][texture_mode][dithering][interlacing] = std::move(*prog);
-
-          UPDATE_PROGRESS();
         }
       }
     }
+
+    // With parallel shader compile, every link is started before any is waited on, so the driver's compiler threads
+    // work through them together. Otherwise each one is compiled in turn.
+    for (const BatchPipelineKey key : keys)
+    {
+      GL::Program& prog = GetBatchProgram(key);
+      if (prog.IsVaild() ||
+          std::any_of(m_pending_batch_programs.begin(), m_pending_batch_programs.end(),
+                      [this, &prog](const PendingBatchProgram& pending) {
+                        return &GetBatchProgram(pending.key_bits) == &prog;
+                      }))
+      {
+        continue;
+      }
+
+      if (!CompileBatchProgram(shadergen, key, true))
+        return false;
+
+      if (prog.IsVaild())
+        UPDATE_PROGRESS();
+    }
+
+    for (PendingBatchProgram& pending : m_pending_batch_programs)
+    {
+      if (!FinishPendingBatchProgram(pending))
+        return false;
+
+      UPDATE_PROGRESS();
+    }
+    m_pending_batch_programs.clear();
   }
 
   for (u8 depth_24bit = 0; depth_24bit < 2; depth_24bit++)
@@ -571,6 +649,34 @@ bool GPU_HW_OpenGL::CompilePrograms()
   m_vram_update_depth_program = std::move(*prog);
   UPDATE_PROGRESS();
 
+  if (m_palette_texture_cache)
+  {
+    for (u8 palette_8bit = 0; palette_8bit < 2; palette_8bit++)
+    {
+      const std::string fs = shadergen.GeneratePaletteDecodeFragmentShader(ConvertToBoolUnchecked(palette_8bit));
+      prog = shader_cache.GetProgram(shadergen.GenerateScreenQuadVertexShader(), {}, fs,
+                                     [this, use_binding_layout](GL::Program& prog) {
+                                       if (!IsGLES() && !use_binding_layout)
+                                         prog.BindFragData(0, "o_col0");
+                                     });
+      if (!prog)
+        return false;
+
+      if (!use_binding_layout)
+      {
+        prog->BindUniformBlock("UBOBlock", 1);
+        prog->Bind();
+        prog->Uniform1i("samp0", 0);
+      }
+      m_palette_decode_programs[palette_8bit] = std::move(*prog);
+    }
+  }
+  else
+  {
+    for (GL::Program& decode_prog : m_palette_decode_programs)
+      decode_prog.Destroy();
+  }
+
   if (m_supports_texture_buffer || m_use_ssbo_for_vram_writes)
   {
     prog = shader_cache.GetProgram(shadergen.GenerateScreenQuadVertexShader(), {},
@@ -616,14 +722,176 @@ bool GPU_HW_OpenGL::CompilePrograms()
   UPDATE_PROGRESS();
 #undef UPDATE_PROGRESS
 
+  if (!m_async_pipeline_compilation)
+    m_shader_cache.reset();
+
   return true;
 }
 
-void GPU_HW_OpenGL::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices)
+bool GPU_HW_OpenGL::CompileBatchProgram(GPU_HW_ShaderGen& shadergen, BatchPipelineKey key, bool async)
 {
-  const GL::Program& prog = m_render_programs[static_cast<u8>(render_mode)][static_cast<u8>(m_batch.texture_mode)]
-                                             [BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)];
-  prog.Bind();
+  const bool use_binding_layout = GPU_HW_ShaderGen::UseGLSLBindingLayout();
+  const bool textured = (key.texture_mode != GPUTextureMode::Disabled);
+  std::string batch_vs = shadergen.GenerateBatchVertexShader(textured);
+  std::string fs =
+    shadergen.GenerateBatchFragmentShader(key.render_mode, key.texture_mode, key.dithering, key.interlacing);
+
+  const auto link_callback = [this, textured, use_binding_layout](GL::Program& prog) {
+    if (!use_binding_layout)
+    {
+      prog.BindAttribute(0, "a_pos");
+      prog.BindAttribute(1, "a_col0");
+      if (textured)
+      {
+        prog.BindAttribute(2, "a_texcoord");
+        prog.BindAttribute(3, "a_texpage");
+        prog.BindAttribute(4, "a_uv_limits");
+      }
+
+      if (!IsGLES() || m_supports_dual_source_blend)
+      {
+        if (m_supports_dual_source_blend)
+        {
+          prog.BindFragDataIndexed(0, "o_col0");
+          prog.BindFragDataIndexed(1, "o_col1");
+        }
+        else
+        {
+          prog.BindFragData(0, "o_col0");
+        }
+      }
+    }
+  };
+
+  bool pending = false;
+  std::optional<GL::Program> prog =
+    (async && m_supports_parallel_shader_compile) ?
+      m_shader_cache->GetProgramAsync(batch_vs, {}, fs, link_callback, &pending) :
+      m_shader_cache->GetProgram(batch_vs, {}, fs, link_callback);
+  if (!prog)
+    return false;
+
+  if (pending)
+  {
+    m_pending_batch_programs.push_back(
+      PendingBatchProgram{key.bits, std::move(*prog), std::move(batch_vs), std::move(fs)});
+    return true;
+  }
+
+  SetupBatchProgram(*prog, textured);
+  GetBatchProgram(key) = std::move(*prog);
+  return true;
+}
+
+void GPU_HW_OpenGL::SetupBatchProgram(GL::Program& prog, bool textured)
+{
+  if (GPU_HW_ShaderGen::UseGLSLBindingLayout())
+    return;
+
+  prog.BindUniformBlock("UBOBlock", 1);
+  if (textured)
+  {
+    prog.Bind();
+    prog.Uniform1i("samp0", 0);
+    if (m_palette_texture_cache)
+      prog.Uniform1i("samp1", 1);
+  }
+}
+
+bool GPU_HW_OpenGL::FinishPendingBatchProgram(PendingBatchProgram& pending)
+{
+  if (!m_shader_cache->FinishProgram(pending.program, pending.vertex_shader, {}, pending.fragment_shader))
+    return false;
+
+  BatchPipelineKey key;
+  key.bits = pending.key_bits;
+  SetupBatchProgram(pending.program, key.texture_mode != GPUTextureMode::Disabled);
+  GetBatchProgram(key) = std::move(pending.program);
+  return true;
+}
+
+void GPU_HW_OpenGL::CollectPendingBatchPrograms()
+{
+  for (auto it = m_pending_batch_programs.begin(); it != m_pending_batch_programs.end();)
+  {
+    if (!it->program.IsLinkComplete())
+    {
+      ++it;
+      continue;
+    }
+
+    if (!FinishPendingBatchProgram(*it))
+      Log_ErrorPrintf("Failed to compile batch program %08X", it->key_bits);
+
+    it = m_pending_batch_programs.erase(it);
+  }
+}
+
+GL::Program* GPU_HW_OpenGL::GetAsyncBatchProgram(BatchPipelineKey key)
+{
+  if (!m_pending_batch_programs.empty())
+    CollectPendingBatchPrograms();
+
+  GL::Program& prog = GetBatchProgram(key);
+  if (prog.IsVaild())
+    return &prog;
+
+  // the key has fields which GL doesn't specialize on, so compare the programs they map to
+  const auto find_pending = [this, &prog]() {
+    return std::find_if(
+      m_pending_batch_programs.begin(), m_pending_batch_programs.end(),
+      [this, &prog](const PendingBatchProgram& pending) { return &GetBatchProgram(pending.key_bits) == &prog; });
+  };
+
+  if (m_supports_parallel_shader_compile)
+  {
+    if (find_pending() == m_pending_batch_programs.end())
+    {
+      if (!CompileBatchProgram(*m_batch_shadergen, key, true))
+        return nullptr;
+      else if (prog.IsVaild())
+        return &prog;
+    }
+
+    // Dithering makes the least visible difference, so draw with the other variant until this one is ready.
+    BatchPipelineKey fallback_key;
+    fallback_key.bits = key.bits;
+    fallback_key.dithering = !key.dithering;
+    GL::Program& fallback = GetBatchProgram(fallback_key);
+    if (fallback.IsVaild())
+    {
+      m_pipeline_fallbacks.fetch_add(1, std::memory_order_relaxed);
+      return &fallback;
+    }
+  }
+
+  // GL programs have to be compiled on the thread which owns the context, so wait for it
+  m_pipeline_stalls.fetch_add(1, std::memory_order_relaxed);
+  auto it = find_pending();
+  if (it != m_pending_batch_programs.end())
+  {
+    const bool result = FinishPendingBatchProgram(*it);
+    m_pending_batch_programs.erase(it);
+    return result ? &prog : nullptr;
+  }
+
+  return CompileBatchProgram(*m_batch_shadergen, key, false) ? &prog : nullptr;
+}
+
+bool GPU_HW_OpenGL::SetBatchDrawState(BatchRenderMode render_mode)
+{
+  const BatchPipelineKey key = GetBatchPipelineKey(render_mode);
+  RecordBatchPipelineUse(key);
+
+  GL::Program* prog = &GetBatchProgram(key);
+  if (m_async_pipeline_compilation && !prog->IsVaild())
+  {
+    prog = GetAsyncBatchProgram(key);
+    if (!prog)
+      return false;
+  }
+
+  prog->Bind();
 
   if (m_current_transparency_mode != m_batch.transparency_mode || m_current_render_mode != render_mode)
   {
@@ -633,8 +901,30 @@ void GPU_HW_OpenGL::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vert
   }
 
   SetDepthFunc();
+  return true;
+}
+
+void GPU_HW_OpenGL::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices)
+{
+  if (!SetBatchDrawState(render_mode))
+    return;
+
+  // zero tells the vertex shader that these are triangles
+  if (m_sprite_instancing)
+    glVertexAttribI4ui(GPU_HW_ShaderGen::SPRITE_BASE_ATTRIBUTE_LOCATION, 0, 0, 0, 0);
 
-  glDrawArrays(GL_TRIANGLES, m_batch_base_vertex, num_vertices);
+  glDrawArrays(GL_TRIANGLES, base_vertex, num_vertices);
+}
+
+void GPU_HW_OpenGL::DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites)
+{
+  if (!SetBatchDrawState(render_mode))
+    return;
+
+  // gl_InstanceID doesn't include the base instance, so the first record is passed in a constant attribute
+  glVertexAttribI4ui(GPU_HW_ShaderGen::SPRITE_BASE_ATTRIBUTE_LOCATION, base_vertex + 1, 0, 0, 0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_vertex_stream_buffer->GetGLBufferId());
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 6, num_sprites);
 }
 
 void GPU_HW_OpenGL::SetBlendMode()
@@ -854,8 +1144,11 @@ void GPU_HW_OpenGL::UpdateDisplay()
 
 void GPU_HW_OpenGL::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 {
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+  // Get bounds with wrap-around handled, and only read back what the shadow copy is missing.
+  Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+  if (!GetVRAMReadbackRectangle(&copy_rect))
+    return;
+
   const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
   const u32 encoded_height = copy_rect.GetHeight();
 
@@ -1155,6 +1448,27 @@ void GPU_HW_OpenGL::UpdateVRAMReadTexture()
   GPU_HW::UpdateVRAMReadTexture();
 }
 
+void GPU_HW_OpenGL::DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms)
+{
+  UploadUniformBuffer(&uniforms, sizeof(uniforms));
+
+  glDisable(GL_SCISSOR_TEST);
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+
+  // the cache is only ever sampled with texelFetch, so the lower-left origin doesn't matter here
+  const bool palette_8bit = (m_draw_mode.mode_reg.texture_mode == GPUTextureMode::Palette8Bit);
+  m_palette_texture_cache_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
+  glViewport(uniforms.u_slot_origin[0], uniforms.u_slot_origin[1], PALETTE_TEXTURE_CACHE_SLOT_SIZE,
+             PALETTE_TEXTURE_CACHE_SLOT_SIZE);
+  m_vram_read_texture.Bind();
+  m_palette_decode_programs[BoolToUInt8(palette_8bit)].Bind();
+  glBindVertexArray(m_attributeless_vao_id);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+
+  RestoreGraphicsAPIState();
+}
+
 void GPU_HW_OpenGL::UpdateDepthBufferFromMaskBit()
 {
   if (m_pgxp_depth_buffer)
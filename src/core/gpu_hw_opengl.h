@@ -10,6 +10,8 @@
 #include <memory>
 #include <tuple>
 
+class GPU_HW_ShaderGen;
+
 class GPU_HW_OpenGL : public GPU_HW
 {
 public:
@@ -38,6 +40,8 @@ protected:
   void UnmapBatchVertexPointer(u32 used_vertices) override;
   void UploadUniformBuffer(const void* data, u32 data_size) override;
   void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) override;
+  void DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites) override;
+  void DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms) override;
 
 private:
   struct GLStats
@@ -55,6 +59,9 @@ private:
   std::tuple<s32, s32> ConvertToFramebufferCoordinates(s32 x, s32 y);
 
   void SetCapabilities(HostDisplay* host_display);
+
+  /// Binds the batch program and blend/depth state, returns false if the program isn't ready yet.
+  bool SetBatchDrawState(BatchRenderMode render_mode);
   bool CreateFramebuffer();
   void ClearFramebuffer();
 
@@ -62,7 +69,32 @@ private:
   bool CreateUniformBuffer();
   bool CreateTextureBuffer();
 
+  struct PendingBatchProgram
+  {
+    u32 key_bits;
+    GL::Program program;
+    std::string vertex_shader;
+    std::string fragment_shader;
+  };
+
+  ALWAYS_INLINE GL::Program& GetBatchProgram(BatchPipelineKey key)
+  {
+    return m_render_programs[static_cast<u8>(key.render_mode.GetValue())][static_cast<u8>(key.texture_mode.GetValue())]
+                            [BoolToUInt8(key.dithering)][BoolToUInt8(key.interlacing)];
+  }
+  ALWAYS_INLINE GL::Program& GetBatchProgram(u32 key_bits)
+  {
+    BatchPipelineKey key;
+    key.bits = key_bits;
+    return GetBatchProgram(key);
+  }
+
   bool CompilePrograms();
+  bool CompileBatchProgram(GPU_HW_ShaderGen& shadergen, BatchPipelineKey key, bool async);
+  void SetupBatchProgram(GL::Program& prog, bool textured);
+  bool FinishPendingBatchProgram(PendingBatchProgram& pending);
+  void CollectPendingBatchPrograms();
+  GL::Program* GetAsyncBatchProgram(BatchPipelineKey key);
 
   void SetDepthFunc();
   void SetDepthFunc(GLenum func);
@@ -79,6 +111,7 @@ private:
   GL::Texture m_vram_encoding_texture;
   GL::Texture m_display_texture;
   GL::Texture m_vram_write_replacement_texture;
+  GL::Texture m_palette_texture_cache_texture;
 
   std::unique_ptr<GL::StreamBuffer> m_vertex_stream_buffer;
   GLuint m_vram_fbo_id = 0;
@@ -98,6 +131,13 @@ private:
   GL::Program m_vram_write_program;
   GL::Program m_vram_copy_program;
   GL::Program m_vram_update_depth_program;
+  std::array<GL::Program, 2> m_palette_decode_programs; // [palette_8bit]
+
+  // async pipeline compilation - batch programs are compiled on first use. with parallel shader compile, they're
+  // linked by the driver in the background, and draws use the variant with the other dithering setting meanwhile.
+  std::unique_ptr<GL::ShaderCache> m_shader_cache;
+  std::unique_ptr<GPU_HW_ShaderGen> m_batch_shadergen;
+  std::vector<PendingBatchProgram> m_pending_batch_programs;
 
   u32 m_uniform_buffer_alignment = 1;
   u32 m_max_texture_buffer_size = 0;
@@ -105,6 +145,7 @@ private:
   bool m_supports_texture_buffer = false;
   bool m_supports_geometry_shaders = false;
   bool m_use_ssbo_for_vram_writes = false;
+  bool m_supports_parallel_shader_compile = false;
 
   GLenum m_current_depth_test = 0;
   GPUTransparencyMode m_current_transparency_mode = GPUTransparencyMode::Disabled;
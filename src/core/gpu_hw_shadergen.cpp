@@ -6,11 +6,12 @@
 GPU_HW_ShaderGen::GPU_HW_ShaderGen(HostDisplay::RenderAPI render_api, u32 resolution_scale, u32 multisamples,
                                    bool per_sample_shading, bool true_color, bool scaled_dithering,
                                    GPUTextureFilter texture_filtering, bool uv_limits, bool pgxp_depth,
+                                   bool palette_texture_cache, bool sprite_instancing,
                                    bool supports_dual_source_blend)
   : ShaderGen(render_api, supports_dual_source_blend), m_resolution_scale(resolution_scale),
     m_multisamples(multisamples), m_true_color(true_color), m_per_sample_shading(per_sample_shading),
     m_scaled_dithering(scaled_dithering), m_texture_filter(texture_filtering), m_uv_limits(uv_limits),
-    m_pgxp_depth(pgxp_depth)
+    m_pgxp_depth(pgxp_depth), m_palette_texture_cache(palette_texture_cache), m_sprite_instancing(sprite_instancing)
 {
 }
 
@@ -82,10 +83,45 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
   DefineMacro(ss, "TEXTURED", textured);
   DefineMacro(ss, "UV_LIMITS", m_uv_limits);
   DefineMacro(ss, "PGXP_DEPTH", m_pgxp_depth);
+  DefineMacro(ss, "PALETTE_TEXTURE_CACHE", m_palette_texture_cache);
+  DefineMacro(ss, "SPRITE_INSTANCING", m_sprite_instancing);
 
   WriteCommonFunctions(ss);
   WriteBatchUniformBuffer(ss);
 
+  if (m_sprite_instancing)
+  {
+    // Sprite records are BatchVertex structs, read straight out of the vertex buffer.
+    ss << "layout(std430";
+    if (IsVulkan())
+      ss << ", set = 0, binding = 3";
+    else
+      ss << ", binding = 1";
+
+    ss << ") readonly buffer SpriteSSBO {\n";
+    ss << "  uint4 sprite_records[];\n";
+    ss << "};\n\n";
+
+    // Triangles and sprites share a batch, so the draw says which one it is. The first record is offset by one so
+    // that zero means triangles: in the instance index on Vulkan, and in a constant attribute on GL, where
+    // gl_InstanceID doesn't include the base instance.
+    if (IsVulkan())
+    {
+      ss << "#define SPRITE_DRAW (gl_InstanceIndex != 0)\n";
+      ss << "#define SPRITE_INDEX uint(gl_InstanceIndex - 1)\n";
+    }
+    else
+    {
+      ss << "layout(location = " << SPRITE_BASE_ATTRIBUTE_LOCATION << ") in uint a_sprite_base;\n";
+      ss << "#define SPRITE_DRAW (a_sprite_base != 0u)\n";
+      ss << "#define SPRITE_INDEX (a_sprite_base - 1u + uint(gl_InstanceID))\n";
+    }
+  }
+
+  ss << "CONSTANT uint PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG = " << GPU_HW::PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG << "u;\n";
+  ss << "CONSTANT uint PALETTE_TEXTURE_CACHE_SLOT_SIZE = " << GPU_HW::PALETTE_TEXTURE_CACHE_SLOT_SIZE << "u;\n";
+  ss << "CONSTANT uint PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW = " << GPU_HW::PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW
+     << "u;\n";
   ss << R"(
 
 // OpenGL seems to be off by one pixel in the Y direction due to lower-left origin, but only on
@@ -105,40 +141,76 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
     {
       DeclareVertexEntryPoint(
         ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage", "float4 a_uv_limits"}, 1, 1,
-        {{"nointerpolation", "uint4 v_texpage"}, {"nointerpolation", "float4 v_uv_limits"}}, false, "", UsingMSAA(),
-        UsingPerSampleShading());
+        {{"nointerpolation", "uint4 v_texpage"}, {"nointerpolation", "float4 v_uv_limits"}}, m_sprite_instancing, "",
+        UsingMSAA(), UsingPerSampleShading());
     }
     else
     {
       DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage"}, 1, 1,
-                              {{"nointerpolation", "uint4 v_texpage"}}, false, "", UsingMSAA(),
+                              {{"nointerpolation", "uint4 v_texpage"}}, m_sprite_instancing, "", UsingMSAA(),
                               UsingPerSampleShading());
     }
   }
   else
   {
-    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0"}, 1, 0, {}, false, "", UsingMSAA(),
+    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0"}, 1, 0, {}, m_sprite_instancing, "", UsingMSAA(),
                             UsingPerSampleShading());
   }
 
   ss << R"(
 {
+  float4 pos = a_pos;
+  float4 col0 = a_col0;
+#if TEXTURED
+  uint texcoord = a_texcoord;
+  uint texpage = a_texpage;
+#if UV_LIMITS
+  float4 uv_limits = a_uv_limits;
+#endif
+#endif
+
+#if SPRITE_INSTANCING
+  if (SPRITE_DRAW)
+  {
+    // x, y, z, width | height << 16, color, texpage, u | v << 16, uv_limits
+    uint4 record0 = sprite_records[SPRITE_INDEX * 2u];
+    uint4 record1 = sprite_records[SPRITE_INDEX * 2u + 1u];
+
+    // two triangles, (0,0) (1,0) (0,1) (0,1) (1,0) (1,1)
+    uint2 size = uint2(record0.w & 0xFFFFu, record0.w >> 16);
+    uint2 offset = uint2((0x32u >> v_id) & 1u, (0x2Cu >> v_id) & 1u) * size;
+    pos = float4(uintBitsToFloat(record0.x) + float(offset.x), uintBitsToFloat(record0.y) + float(offset.y),
+                 uintBitsToFloat(record0.z), 1.0);
+    col0 = float4(float(record1.x & 0xFFu), float((record1.x >> 8) & 0xFFu), float((record1.x >> 16) & 0xFFu),
+                  float(record1.x >> 24)) / 255.0;
+#if TEXTURED
+    texcoord = ((record1.z & 0xFFFFu) + offset.x) | (((record1.z >> 16) + offset.y) << 16);
+    texpage = record1.y;
+#if UV_LIMITS
+    // scaled back up below
+    uv_limits = float4(float(record1.w & 0xFFu), float((record1.w >> 8) & 0xFFu), float((record1.w >> 16) & 0xFFu),
+                       float(record1.w >> 24)) / 255.0;
+#endif
+#endif
+  }
+#endif
+
   // Offset the vertex position by 0.5 to ensure correct interpolation of texture coordinates
   // at 1x resolution scale. This doesn't work at >1x, we adjust the texture coordinates before
   // uploading there instead.
   float vertex_offset = (RESOLUTION_SCALE == 1u) ? 0.5 : 0.0;
 
   // 0..+1023 -> -1..1
-  float pos_x = ((a_pos.x + vertex_offset) / 512.0) - 1.0;
-  float pos_y = ((a_pos.y + vertex_offset) / -256.0) + 1.0;
+  float pos_x = ((pos.x + vertex_offset) / 512.0) - 1.0;
+  float pos_y = ((pos.y + vertex_offset) / -256.0) + 1.0;
 
 #if PGXP_DEPTH
   // Ignore mask Z when using PGXP depth.
-  float pos_z = a_pos.w;
-  float pos_w = a_pos.w;
+  float pos_z = pos.w;
+  float pos_w = pos.w;
 #else
-  float pos_z = a_pos.z;
-  float pos_w = a_pos.w;
+  float pos_z = pos.z;
+  float pos_w = pos.w;
 #endif
 
 #if API_OPENGL || API_OPENGL_ES
@@ -155,19 +227,33 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
 
   v_pos = float4(pos_x * pos_w, pos_y * pos_w, pos_z * pos_w, pos_w);
 
-  v_col0 = a_col0;
+  v_col0 = col0;
   #if TEXTURED
-    v_tex0 = float2(float((a_texcoord & 0xFFFFu) * RESOLUTION_SCALE),
-                    float((a_texcoord >> 16) * RESOLUTION_SCALE));
+    v_tex0 = float2(float((texcoord & 0xFFFFu) * RESOLUTION_SCALE),
+                    float((texcoord >> 16) * RESOLUTION_SCALE));
 
-    // base_x,base_y,palette_x,palette_y
-    v_texpage.x = (a_texpage & 15u) * 64u * RESOLUTION_SCALE;
-    v_texpage.y = ((a_texpage >> 4) & 1u) * 256u * RESOLUTION_SCALE;
-    v_texpage.z = ((a_texpage >> 16) & 63u) * 16u * RESOLUTION_SCALE;
-    v_texpage.w = ((a_texpage >> 22) & 511u) * RESOLUTION_SCALE;
+    #if PALETTE_TEXTURE_CACHE
+    if ((texpage & PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG) != 0u)
+    {
+      // slot_x,slot_y,flag,unused
+      uint slot = texpage & ~PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG;
+      v_texpage.x = (slot % PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW) * PALETTE_TEXTURE_CACHE_SLOT_SIZE;
+      v_texpage.y = (slot / PALETTE_TEXTURE_CACHE_SLOTS_PER_ROW) * PALETTE_TEXTURE_CACHE_SLOT_SIZE;
+      v_texpage.z = PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG;
+      v_texpage.w = 0u;
+    }
+    else
+    #endif
+    {
+      // base_x,base_y,palette_x,palette_y
+      v_texpage.x = (texpage & 15u) * 64u * RESOLUTION_SCALE;
+      v_texpage.y = ((texpage >> 4) & 1u) * 256u * RESOLUTION_SCALE;
+      v_texpage.z = ((texpage >> 16) & 63u) * 16u * RESOLUTION_SCALE;
+      v_texpage.w = ((texpage >> 22) & 511u) * RESOLUTION_SCALE;
+    }
 
     #if UV_LIMITS
-      v_uv_limits = a_uv_limits * float4(255.0, 255.0, 255.0, 255.0);
+      v_uv_limits = uv_limits * float4(255.0, 255.0, 255.0, 255.0);
     #endif
   #endif
 }
@@ -176,6 +262,43 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
   return ss.str();
 }
 
+void GPU_HW_ShaderGen::WritePaletteDecodeFunction(std::stringstream& ss)
+{
+  ss << R"(
+#if PALETTE
+float4 DecodePaletteTexel(uint4 texpage, uint2 icoord)
+{
+  uint2 index_coord = icoord;
+  #if PALETTE_4_BIT
+    index_coord.x /= 4u;
+  #elif PALETTE_8_BIT
+    index_coord.x /= 2u;
+  #endif
+
+  // fixup coords
+  uint2 vicoord = uint2(texpage.x + index_coord.x * RESOLUTION_SCALE, fixYCoord(texpage.y + index_coord.y * RESOLUTION_SCALE));
+
+  // load colour/palette
+  float4 texel = SAMPLE_TEXTURE(samp0, float2(vicoord) * RCP_VRAM_SIZE);
+  uint vram_value = RGBA8ToRGBA5551(texel);
+
+  // apply palette
+  #if PALETTE_4_BIT
+    uint subpixel = icoord.x & 3u;
+    uint palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
+  #elif PALETTE_8_BIT
+    uint subpixel = icoord.x & 1u;
+    uint palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
+  #endif
+
+  // sample palette
+  uint2 palette_icoord = uint2(texpage.z + (palette_index * RESOLUTION_SCALE), fixYCoord(texpage.w));
+  return SAMPLE_TEXTURE(samp0, float2(palette_icoord) * RCP_VRAM_SIZE);
+}
+#endif
+)";
+}
+
 void GPU_HW_ShaderGen::WriteBatchTextureFilter(std::stringstream& ss, GPUTextureFilter texture_filter)
 {
   // JINC2 and xBRZ shaders originally from beetle-psx, modified to support filtering mask channel.
@@ -691,10 +814,17 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   DefineMacro(ss, "UV_LIMITS", m_uv_limits);
   DefineMacro(ss, "USE_DUAL_SOURCE", use_dual_source);
   DefineMacro(ss, "PGXP_DEPTH", m_pgxp_depth);
+  DefineMacro(ss, "PALETTE_TEXTURE_CACHE", m_palette_texture_cache);
 
   WriteCommonFunctions(ss);
   WriteBatchUniformBuffer(ss);
   DeclareTexture(ss, "samp0", 0);
+  if (m_palette_texture_cache)
+  {
+    DeclareTexture(ss, "samp1", 1);
+    ss << "CONSTANT uint PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG = " << GPU_HW::PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG
+       << "u;\n";
+  }
 
   if (m_glsl)
     ss << "CONSTANT int[16] s_dither_values = int[16]( ";
@@ -751,37 +881,23 @@ uint2 FloatToIntegerCoords(float2 coords)
   // Floor them otherwise, as it currently breaks when upscaling as the vertex offset is not applied.
   return uint2((RESOLUTION_SCALE == 1u) ? roundEven(coords) : floor(coords));
 }
+)";
+
+  WritePaletteDecodeFunction(ss);
 
+  ss << R"(
 float4 SampleFromVRAM(uint4 texpage, float2 coords)
 {
   #if PALETTE
     uint2 icoord = ApplyTextureWindow(FloatToIntegerCoords(coords));
-    uint2 index_coord = icoord;
-    #if PALETTE_4_BIT
-      index_coord.x /= 4u;
-    #elif PALETTE_8_BIT
-      index_coord.x /= 2u;
-    #endif
 
-    // fixup coords
-    uint2 vicoord = uint2(texpage.x + index_coord.x * RESOLUTION_SCALE, fixYCoord(texpage.y + index_coord.y * RESOLUTION_SCALE));
-
-    // load colour/palette
-    float4 texel = SAMPLE_TEXTURE(samp0, float2(vicoord) * RCP_VRAM_SIZE);
-    uint vram_value = RGBA8ToRGBA5551(texel);
-
-    // apply palette
-    #if PALETTE_4_BIT
-      uint subpixel = icoord.x & 3u;
-      uint palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
-    #elif PALETTE_8_BIT
-      uint subpixel = icoord.x & 1u;
-      uint palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
+    #if PALETTE_TEXTURE_CACHE
+      // already decoded, texpage.xy is the slot in the cache texture
+      if (texpage.z == PALETTE_TEXTURE_CACHE_TEXPAGE_FLAG)
+        return LOAD_TEXTURE(samp1, int2(texpage.xy + min(icoord, uint2(255u, 255u))), 0);
     #endif
 
-    // sample palette
-    uint2 palette_icoord = uint2(texpage.z + (palette_index * RESOLUTION_SCALE), fixYCoord(texpage.w));
-    return SAMPLE_TEXTURE(samp0, float2(palette_icoord) * RCP_VRAM_SIZE);
+    return DecodePaletteTexel(texpage, icoord);
   #else
     // Direct texturing. Render-to-texture effects. Use upscaled coordinates.
     uint2 icoord = ApplyUpscaledTextureWindow(FloatToIntegerCoords(coords));    
@@ -1337,6 +1453,30 @@ std::string GPU_HW_ShaderGen::GenerateVRAMUpdateDepthFragmentShader()
   return ss.str();
 }
 
+std::string GPU_HW_ShaderGen::GeneratePaletteDecodeFragmentShader(bool palette_8bit)
+{
+  std::stringstream ss;
+  WriteHeader(ss);
+  DefineMacro(ss, "PALETTE", true);
+  DefineMacro(ss, "PALETTE_4_BIT", !palette_8bit);
+  DefineMacro(ss, "PALETTE_8_BIT", palette_8bit);
+  WriteCommonFunctions(ss);
+  DeclareUniformBuffer(ss, {"uint4 u_texpage", "uint2 u_slot_origin"}, true);
+  DeclareTexture(ss, "samp0", 0);
+  WritePaletteDecodeFunction(ss);
+  DeclareFragmentEntryPoint(ss, 0, 1, {}, true, 1);
+
+  ss << R"(
+{
+  // one texel per fragment, at native resolution
+  uint2 icoord = uint2(v_pos.xy) - u_slot_origin;
+  o_col0 = DecodePaletteTexel(u_texpage, icoord);
+}
+)";
+
+  return ss.str();
+}
+
 std::string GPU_HW_ShaderGen::GenerateAdaptiveDownsampleMipFragmentShader(bool first_pass)
 {
   std::stringstream ss;
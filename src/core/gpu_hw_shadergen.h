@@ -5,9 +5,16 @@
 class GPU_HW_ShaderGen : public ShaderGen
 {
 public:
+  enum : u32
+  {
+    // GL attribute holding the first sprite record of a draw plus one, it's set as a constant rather than an array.
+    SPRITE_BASE_ATTRIBUTE_LOCATION = 5
+  };
+
   GPU_HW_ShaderGen(HostDisplay::RenderAPI render_api, u32 resolution_scale, u32 multisamples, bool per_sample_shading,
                    bool true_color, bool scaled_dithering, GPUTextureFilter texture_filtering, bool uv_limits,
-                   bool pgxp_depth, bool supports_dual_source_blend);
+                   bool pgxp_depth, bool palette_texture_cache, bool sprite_instancing,
+                   bool supports_dual_source_blend);
   ~GPU_HW_ShaderGen();
 
   std::string GenerateBatchVertexShader(bool textured);
@@ -20,6 +27,7 @@ public:
   std::string GenerateVRAMWriteFragmentShader(bool use_ssbo);
   std::string GenerateVRAMCopyFragmentShader();
   std::string GenerateVRAMUpdateDepthFragmentShader();
+  std::string GeneratePaletteDecodeFragmentShader(bool palette_8bit);
 
   std::string GenerateAdaptiveDownsampleMipFragmentShader(bool first_pass);
   std::string GenerateAdaptiveDownsampleBlurFragmentShader();
@@ -33,6 +41,7 @@ private:
   void WriteCommonFunctions(std::stringstream& ss);
   void WriteBatchUniformBuffer(std::stringstream& ss);
   void WriteBatchTextureFilter(std::stringstream& ss, GPUTextureFilter texture_filter);
+  void WritePaletteDecodeFunction(std::stringstream& ss);
 
   u32 m_resolution_scale;
   u32 m_multisamples;
@@ -42,4 +51,6 @@ private:
   GPUTextureFilter m_texture_filter;
   bool m_uv_limits;
   bool m_pgxp_depth;
+  bool m_palette_texture_cache;
+  bool m_sprite_instancing;
 };
@@ -11,12 +11,15 @@
 #include "host_display.h"
 #include "host_interface.h"
 #include "system.h"
+#include <algorithm>
 Log_SetChannel(GPU_HW_Vulkan);
 
 GPU_HW_Vulkan::GPU_HW_Vulkan() = default;
 
 GPU_HW_Vulkan::~GPU_HW_Vulkan()
 {
+  StopRenderThread();
+
   if (m_host_display)
   {
     m_host_display->ClearDisplayTexture();
@@ -84,6 +87,10 @@ bool GPU_HW_Vulkan::Initialize(HostDisplay* host_display)
 
   UpdateDepthBufferFromMaskBit();
   RestoreGraphicsAPIState();
+
+  if (g_settings.gpu_vulkan_render_thread)
+    StartRenderThread();
+
   return true;
 }
 
@@ -91,6 +98,7 @@ void GPU_HW_Vulkan::Reset()
 {
   GPU_HW::Reset();
 
+  SyncRenderThread();
   EndRenderPass();
   ClearFramebuffer();
 }
@@ -99,10 +107,21 @@ void GPU_HW_Vulkan::ResetGraphicsAPIState()
 {
   GPU_HW::ResetGraphicsAPIState();
 
+  SyncRenderThread();
   EndRenderPass();
 }
 
 void GPU_HW_Vulkan::RestoreGraphicsAPIState()
+{
+  SyncRenderThread();
+
+  int left, top, right, bottom;
+  CalcScissorRect(&left, &top, &right, &bottom);
+  m_current_scissor.Set(left, top, right, bottom);
+  RestoreBatchState();
+}
+
+void GPU_HW_Vulkan::RestoreBatchState()
 {
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -112,13 +131,30 @@ void GPU_HW_Vulkan::RestoreGraphicsAPIState()
   Vulkan::Util::SetViewport(cmdbuf, 0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
   vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_batch_pipeline_layout, 0, 1,
                           &m_batch_descriptor_set, 1, &m_current_uniform_buffer_offset);
-  SetScissorFromDrawingArea();
+  SetScissor(m_current_scissor);
+}
+
+void GPU_HW_Vulkan::SetScissor(const Common::Rectangle<s32>& rc)
+{
+  Vulkan::Util::SetScissor(g_vulkan_context->GetCurrentCommandBuffer(), rc.left, rc.top, rc.GetWidth(),
+                           rc.GetHeight());
 }
 
 void GPU_HW_Vulkan::UpdateSettings()
 {
   GPU_HW::UpdateSettings();
 
+  // batches in the staging buffer can't be drawn once the render thread is gone, and vice versa
+  if (g_settings.gpu_vulkan_render_thread != IsUsingRenderThread())
+    FlushRender();
+
+  SyncRenderThread();
+  if (!g_settings.gpu_vulkan_render_thread)
+    StopRenderThread();
+
+  // the compile threads use the current settings, so they can't be running while they change
+  StopPipelineCompileThreads(false);
+
   bool framebuffer_changed, shaders_changed;
   UpdateHWSettings(&framebuffer_changed, &shaders_changed);
 
@@ -142,6 +178,10 @@ void GPU_HW_Vulkan::UpdateSettings()
     DestroyPipelines();
     CompilePipelines();
   }
+  else if (m_async_pipeline_compilation)
+  {
+    StartPipelineCompileThreads();
+  }
 
   // this has to be done here, because otherwise we're using destroyed pipelines in the same cmdbuffer
   if (framebuffer_changed)
@@ -152,11 +192,19 @@ void GPU_HW_Vulkan::UpdateSettings()
     UpdateDisplay();
     ResetGraphicsAPIState();
   }
+
+  if (g_settings.gpu_vulkan_render_thread)
+    StartRenderThread();
 }
 
 void GPU_HW_Vulkan::MapBatchVertexPointer(u32 required_vertices)
 {
   DebugAssert(!m_batch_start_vertex_ptr);
+  if (IsUsingRenderThread())
+  {
+    MapRenderThreadVertices(required_vertices);
+    return;
+  }
 
   const u32 required_space = required_vertices * sizeof(BatchVertex);
   if (!m_vertex_stream_buffer.ReserveMemory(required_space, sizeof(BatchVertex)))
@@ -164,7 +212,7 @@ void GPU_HW_Vulkan::MapBatchVertexPointer(u32 required_vertices)
     Log_PerfPrintf("Executing command buffer while waiting for %u bytes in vertex stream buffer", required_space);
     EndRenderPass();
     g_vulkan_context->ExecuteCommandBuffer(false);
-    RestoreGraphicsAPIState();
+    RestoreBatchState();
     if (!m_vertex_stream_buffer.ReserveMemory(required_space, sizeof(BatchVertex)))
       Panic("Failed to reserve vertex stream buffer memory");
   }
@@ -178,8 +226,24 @@ void GPU_HW_Vulkan::MapBatchVertexPointer(u32 required_vertices)
 void GPU_HW_Vulkan::UnmapBatchVertexPointer(u32 used_vertices)
 {
   DebugAssert(m_batch_start_vertex_ptr);
-  if (used_vertices > 0)
+  if (IsUsingRenderThread())
+  {
+    if (used_vertices > 0)
+    {
+      m_render_thread_vertex_write += used_vertices;
+
+      RenderThreadCommand cmd = {};
+      cmd.type = RenderThreadCommandType::UploadVertices;
+      cmd.first_vertex = static_cast<u32>(m_batch_start_vertex_ptr - m_render_thread_vertices.get());
+      cmd.num_vertices = used_vertices;
+      cmd.vertex_counter = m_render_thread_vertex_write;
+      QueueRenderThreadCommand(cmd);
+    }
+  }
+  else if (used_vertices > 0)
+  {
     m_vertex_stream_buffer.CommitMemory(used_vertices * sizeof(BatchVertex));
+  }
 
   m_batch_start_vertex_ptr = nullptr;
   m_batch_end_vertex_ptr = nullptr;
@@ -187,6 +251,22 @@ void GPU_HW_Vulkan::UnmapBatchVertexPointer(u32 used_vertices)
 }
 
 void GPU_HW_Vulkan::UploadUniformBuffer(const void* data, u32 data_size)
+{
+  if (IsUsingRenderThread())
+  {
+    DebugAssert(data_size == sizeof(BatchUBOData));
+
+    RenderThreadCommand cmd = {};
+    cmd.type = RenderThreadCommandType::UploadUniforms;
+    std::memcpy(&cmd.uniforms, data, sizeof(cmd.uniforms));
+    QueueRenderThreadCommand(cmd);
+    return;
+  }
+
+  WriteUniformBuffer(data, data_size);
+}
+
+void GPU_HW_Vulkan::WriteUniformBuffer(const void* data, u32 data_size)
 {
   const u32 alignment = static_cast<u32>(g_vulkan_context->GetUniformBufferAlignment());
   if (!m_uniform_stream_buffer.ReserveMemory(data_size, alignment))
@@ -194,7 +274,7 @@ void GPU_HW_Vulkan::UploadUniformBuffer(const void* data, u32 data_size)
     Log_PerfPrintf("Executing command buffer while waiting for %u bytes in uniform stream buffer", data_size);
     EndRenderPass();
     g_vulkan_context->ExecuteCommandBuffer(false);
-    RestoreGraphicsAPIState();
+    RestoreBatchState();
     if (!m_uniform_stream_buffer.ReserveMemory(data_size, alignment))
       Panic("Failed to reserve uniform stream buffer memory");
   }
@@ -244,6 +324,9 @@ void GPU_HW_Vulkan::SetCapabilities()
   m_supports_dual_source_blend = g_vulkan_context->GetDeviceFeatures().dualSrcBlend;
   m_supports_per_sample_shading = g_vulkan_context->GetDeviceFeatures().sampleRateShading;
   m_supports_adaptive_downsampling = true;
+  m_supports_async_pipeline_compilation = true;
+  m_supports_palette_texture_cache = true;
+  m_supports_sprite_instancing = true;
 
   Log_InfoPrintf("Dual-source blend: %s", m_supports_dual_source_blend ? "supported" : "not supported");
   Log_InfoPrintf("Per-sample shading: %s", m_supports_per_sample_shading ? "supported" : "not supported");
@@ -337,6 +420,9 @@ bool GPU_HW_Vulkan::CreatePipelineLayouts()
   dslbuilder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1,
                         VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
   dslbuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+  dslbuilder.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+  if (m_supports_sprite_instancing)
+    dslbuilder.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
   m_batch_descriptor_set_layout = dslbuilder.Create(device);
   if (m_batch_descriptor_set_layout == VK_NULL_HANDLE)
     return false;
@@ -500,6 +586,29 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
   m_vram_depth_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
+  if (m_palette_texture_cache)
+  {
+    if (!m_palette_texture_cache_texture.Create(PALETTE_TEXTURE_CACHE_SIZE, PALETTE_TEXTURE_CACHE_SIZE, 1, 1,
+                                                texture_format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D,
+                                                VK_IMAGE_TILING_OPTIMAL,
+                                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT))
+    {
+      return false;
+    }
+
+    m_palette_texture_cache_render_pass = g_vulkan_context->GetRenderPass(
+      texture_format, VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_LOAD);
+    if (m_palette_texture_cache_render_pass == VK_NULL_HANDLE)
+      return false;
+
+    m_palette_texture_cache_framebuffer =
+      m_palette_texture_cache_texture.CreateFramebuffer(m_palette_texture_cache_render_pass);
+    if (m_palette_texture_cache_framebuffer == VK_NULL_HANDLE)
+      return false;
+
+    m_palette_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+
   Vulkan::DescriptorSetUpdateBuilder dsubuilder;
 
   m_batch_descriptor_set = g_vulkan_context->AllocateGlobalDescriptorSet(m_batch_descriptor_set_layout);
@@ -516,6 +625,15 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
                                       m_uniform_stream_buffer.GetBuffer(), 0, sizeof(BatchUBOData));
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_batch_descriptor_set, 1, m_vram_read_texture.GetView(),
                                                     m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  dsubuilder.AddCombinedImageSamplerDescriptorWrite(
+    m_batch_descriptor_set, 2,
+    m_palette_texture_cache ? m_palette_texture_cache_texture.GetView() : m_vram_read_texture.GetView(),
+    m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  if (m_supports_sprite_instancing)
+  {
+    dsubuilder.AddBufferDescriptorWrite(m_batch_descriptor_set, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                        m_vertex_stream_buffer.GetBuffer(), 0, VERTEX_BUFFER_SIZE);
+  }
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_vram_copy_descriptor_set, 1, m_vram_read_texture.GetView(),
                                                     m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_vram_read_descriptor_set, 1, m_vram_texture.GetView(),
@@ -674,7 +792,9 @@ void GPU_HW_Vulkan::DestroyFramebuffer()
   Vulkan::Util::SafeDestroyFramebuffer(m_vram_update_depth_framebuffer);
   Vulkan::Util::SafeDestroyFramebuffer(m_vram_readback_framebuffer);
   Vulkan::Util::SafeDestroyFramebuffer(m_display_framebuffer);
+  Vulkan::Util::SafeDestroyFramebuffer(m_palette_texture_cache_framebuffer);
 
+  m_palette_texture_cache_texture.Destroy(false);
   m_vram_read_texture.Destroy(false);
   m_vram_depth_texture.Destroy(false);
   m_vram_texture.Destroy(false);
@@ -685,7 +805,12 @@ void GPU_HW_Vulkan::DestroyFramebuffer()
 
 bool GPU_HW_Vulkan::CreateVertexBuffer()
 {
-  return m_vertex_stream_buffer.Create(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VERTEX_BUFFER_SIZE);
+  // sprite records are read from the same buffer by the vertex shader
+  VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+  if (m_supports_sprite_instancing)
+    usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+  return m_vertex_stream_buffer.Create(usage, VERTEX_BUFFER_SIZE);
 }
 
 bool GPU_HW_Vulkan::CreateUniformBuffer()
@@ -742,10 +867,11 @@ bool GPU_HW_Vulkan::CompilePipelines()
 
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
                              m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_supports_dual_source_blend);
+                             m_pgxp_depth_buffer, m_palette_texture_cache, m_sprite_instancing,
+                             m_supports_dual_source_blend);
 
   Common::Timer compile_time;
-  const int progress_total = 2 + (4 * 9 * 2 * 2) + (2 * 4 * 5 * 9 * 2 * 2) + 1 + 2 + 2 + 2 + 2 + (2 * 3) + 1;
+  const int progress_total = 2 + (4 * 9 * 2 * 2) + (2 * 4 * 5 * 9 * 2 * 2) + 1 + 2 + 2 + 2 + 2 + 2 + (2 * 3) + 1;
   int progress_value = 0;
 #define UPDATE_PROGRESS()                                                                                              \
   do                                                                                                                   \
@@ -759,13 +885,9 @@ bool GPU_HW_Vulkan::CompilePipelines()
   } while (0)
 
   // vertex shaders - [textured]
-  // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
   DimensionalArray<VkShaderModule, 2> batch_vertex_shaders{};
-  DimensionalArray<VkShaderModule, 2, 2, 9, 4> batch_fragment_shaders{};
-  Common::ScopeGuard batch_shader_guard([&batch_vertex_shaders, &batch_fragment_shaders]() {
-    batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
-    batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
-  });
+  Common::ScopeGuard batch_shader_guard(
+    [&batch_vertex_shaders]() { batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule); });
 
   for (u8 textured = 0; textured < 2; textured++)
   {
@@ -778,106 +900,105 @@ bool GPU_HW_Vulkan::CompilePipelines()
     UPDATE_PROGRESS();
   }
 
-  for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  // Batch pipelines are created by the compile threads, so the shaders are kept around for them.
+  m_batch_vertex_shaders = batch_vertex_shaders;
+  batch_vertex_shaders = {};
+  m_batch_shadergen = std::make_unique<GPU_HW_ShaderGen>(shadergen);
+
+  // every variant, when they're all created up front
+  std::vector<u32> batch_pipeline_keys;
+
+  // the boot compile threads use the batch shaders, so they have to be stopped before anything fails out
+  Common::ScopeGuard compile_threads_guard([this]() {
+    StopPipelineCompileThreads(true);
+    CollectCompiledBatchPipelines();
+  });
+
+  if (m_async_pipeline_compilation)
+  {
+    // Fragment shaders and batch pipelines are compiled when they're first used, or by the compile threads.
+    progress_value += (4 * 9 * 2 * 2) + (2 * 4 * 5 * 9 * 2 * 2);
+  }
+  else
   {
-    for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
+    // The shader cache isn't thread safe, so the fragment shaders are compiled here. The pipelines are then created
+    // across the compile threads while the remaining pipelines are built below.
+    for (u8 render_mode = 0; render_mode < 4; render_mode++)
     {
-      for (u8 dithering = 0; dithering < 2; dithering++)
+      for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
       {
-        for (u8 interlacing = 0; interlacing < 2; interlacing++)
+        for (u8 dithering = 0; dithering < 2; dithering++)
         {
-          const std::string fs = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
+          for (u8 interlacing = 0; interlacing < 2; interlacing++)
+          {
+            const std::string fs = shadergen.GenerateBatchFragmentShader(
+              static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
+              ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
 
-          VkShaderModule shader = g_vulkan_shader_cache->GetFragmentShader(fs);
-          if (shader == VK_NULL_HANDLE)
-            return false;
+            VkShaderModule shader = g_vulkan_shader_cache->GetFragmentShader(fs);
+            if (shader == VK_NULL_HANDLE)
+              return false;
 
-          batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] = shader;
-          UPDATE_PROGRESS();
+            m_batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] = shader;
+            UPDATE_PROGRESS();
+          }
         }
       }
     }
-  }
-
-  Vulkan::GraphicsPipelineBuilder gpbuilder;
 
-  // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  for (u8 depth_test = 0; depth_test < 3; depth_test++)
-  {
-    for (u8 render_mode = 0; render_mode < 4; render_mode++)
+    // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
+    batch_pipeline_keys.reserve(3 * 4 * 5 * 9 * 2 * 2);
+    for (u8 depth_test = 0; depth_test < 3; depth_test++)
     {
-      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+      for (u8 render_mode = 0; render_mode < 4; render_mode++)
       {
-        for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
+        for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
         {
-          for (u8 dithering = 0; dithering < 2; dithering++)
+          for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
           {
-            for (u8 interlacing = 0; interlacing < 2; interlacing++)
+            for (u8 dithering = 0; dithering < 2; dithering++)
             {
-              static constexpr std::array<VkCompareOp, 3> depth_test_values = {
-                VK_COMPARE_OP_ALWAYS, VK_COMPARE_OP_GREATER_OR_EQUAL, VK_COMPARE_OP_LESS_OR_EQUAL};
-              const bool textured = (static_cast<GPUTextureMode>(texture_mode) != GPUTextureMode::Disabled);
-
-              gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
-              gpbuilder.SetRenderPass(m_vram_render_pass, 0);
-
-              gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
-              gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
-              gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
-              if (textured)
-              {
-                gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
-                gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
-                if (m_using_uv_limits)
-                  gpbuilder.AddVertexAttribute(4, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, uv_limits));
-              }
-
-              gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-              gpbuilder.SetVertexShader(batch_vertex_shaders[BoolToUInt8(textured)]);
-              gpbuilder.SetFragmentShader(batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]);
-
-              gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
-              gpbuilder.SetDepthState(true, true, depth_test_values[depth_test]);
-              gpbuilder.SetNoBlendingState();
-              gpbuilder.SetMultisamples(m_multisamples, m_per_sample_shading);
-
-              if ((static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
-                   (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                    static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
-                  m_texture_filtering != GPUTextureFilter::Nearest)
+              for (u8 interlacing = 0; interlacing < 2; interlacing++)
               {
-                gpbuilder.SetBlendAttachment(
-                  0, true, VK_BLEND_FACTOR_ONE,
-                  m_supports_dual_source_blend ? VK_BLEND_FACTOR_SRC1_ALPHA : VK_BLEND_FACTOR_SRC_ALPHA,
-                  (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                     GPUTransparencyMode::BackgroundMinusForeground &&
-                   static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                   static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                    VK_BLEND_OP_REVERSE_SUBTRACT :
-                    VK_BLEND_OP_ADD,
-                  VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+                BatchPipelineKey key;
+                key.bits = 0;
+                key.depth_test = depth_test;
+                key.render_mode = static_cast<BatchRenderMode>(render_mode);
+                key.texture_mode = static_cast<GPUTextureMode>(texture_mode);
+                key.transparency_mode = static_cast<GPUTransparencyMode>(transparency_mode);
+                key.dithering = ConvertToBoolUnchecked(dithering);
+                key.interlacing = ConvertToBoolUnchecked(interlacing);
+                batch_pipeline_keys.push_back(key.bits);
               }
-
-              gpbuilder.SetDynamicViewportAndScissorState();
-
-              VkPipeline pipeline = gpbuilder.Create(device, pipeline_cache);
-              if (pipeline == VK_NULL_HANDLE)
-                return false;
-
-              m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing] =
-                pipeline;
-              UPDATE_PROGRESS();
             }
           }
         }
       }
     }
+
+    // the variants the game used last time go first, so a slow driver gets the important ones done early
+    StartPipelineCompileThreads(true);
+    std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+    for (const u32 bits : m_batch_pipeline_use_order)
+    {
+      m_pending_batch_pipelines.set(bits);
+      m_pipeline_compile_queue.push_back(bits);
+    }
+    for (const u32 bits : batch_pipeline_keys)
+    {
+      if (m_pending_batch_pipelines.test(bits))
+        continue;
+
+      m_pending_batch_pipelines.set(bits);
+      m_pipeline_compile_queue.push_back(bits);
+    }
+    m_pipeline_compile_cv.notify_all();
   }
 
   batch_shader_guard.Exit();
 
+  Vulkan::GraphicsPipelineBuilder gpbuilder;
+
   VkShaderModule fullscreen_quad_vertex_shader =
     g_vulkan_shader_cache->GetVertexShader(shadergen.GenerateScreenQuadVertexShader());
   if (fullscreen_quad_vertex_shader == VK_NULL_HANDLE)
@@ -1025,6 +1146,29 @@ bool GPU_HW_Vulkan::CompilePipelines()
     UPDATE_PROGRESS();
   }
 
+  // Palette decode
+  if (m_palette_texture_cache)
+  {
+    gpbuilder.SetRenderPass(m_palette_texture_cache_render_pass, 0);
+
+    for (u8 palette_8bit = 0; palette_8bit < 2; palette_8bit++)
+    {
+      VkShaderModule fs = g_vulkan_shader_cache->GetFragmentShader(
+        shadergen.GeneratePaletteDecodeFragmentShader(ConvertToBoolUnchecked(palette_8bit)));
+      if (fs == VK_NULL_HANDLE)
+        return false;
+
+      gpbuilder.SetFragmentShader(fs);
+
+      m_palette_decode_pipelines[palette_8bit] = gpbuilder.Create(device, pipeline_cache, false);
+      vkDestroyShaderModule(device, fs, nullptr);
+      if (m_palette_decode_pipelines[palette_8bit] == VK_NULL_HANDLE)
+        return false;
+
+      UPDATE_PROGRESS();
+    }
+  }
+
   gpbuilder.Clear();
 
   // Display
@@ -1139,14 +1283,476 @@ bool GPU_HW_Vulkan::CompilePipelines()
 
   UPDATE_PROGRESS();
 
+  if (!m_async_pipeline_compilation)
+  {
+    const int progress_base = progress_value;
+    std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+    while (m_pending_batch_pipelines.any())
+    {
+      m_pipeline_compile_done_cv.wait(lock);
+      if (compile_time.GetTimeSeconds() >= 1.0f)
+      {
+        compile_time.Reset();
+        progress_value =
+          progress_base + static_cast<int>(batch_pipeline_keys.size() - m_pending_batch_pipelines.count());
+        lock.unlock();
+        g_host_interface->DisplayLoadingScreen("Compiling Shaders", 0, progress_total, progress_value);
+        lock.lock();
+      }
+    }
+
+    CollectCompiledBatchPipelines();
+    lock.unlock();
+    StopPipelineCompileThreads(false);
+
+    for (const u32 bits : batch_pipeline_keys)
+    {
+      BatchPipelineKey key;
+      key.bits = bits;
+      if (GetBatchPipelineRef(key) == VK_NULL_HANDLE)
+        return false;
+    }
+
+    // nothing else gets compiled, so the shaders can go
+    m_batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+    m_batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+    m_batch_shadergen.reset();
+  }
+
+  compile_threads_guard.Dismiss();
+
 #undef UPDATE_PROGRESS
 
+  if (m_async_pipeline_compilation)
+  {
+    StartPipelineCompileThreads();
+
+    // get the pipelines the game used last time going first
+    std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+    for (const u32 bits : m_batch_pipeline_use_order)
+    {
+      m_pending_batch_pipelines.set(bits);
+      m_pipeline_compile_queue.push_back(bits);
+    }
+    m_pipeline_compile_cv.notify_all();
+  }
+
   return true;
 }
 
+VkPipeline GPU_HW_Vulkan::CreateBatchPipeline(VkPipelineCache pipeline_cache, BatchPipelineKey key,
+                                              VkShaderModule vertex_shader, VkShaderModule fragment_shader)
+{
+  static constexpr std::array<VkCompareOp, 3> depth_test_values = {
+    VK_COMPARE_OP_ALWAYS, VK_COMPARE_OP_GREATER_OR_EQUAL, VK_COMPARE_OP_LESS_OR_EQUAL};
+  const bool textured = (key.texture_mode != GPUTextureMode::Disabled);
+  const bool transparency_enabled = (key.render_mode != BatchRenderMode::TransparencyDisabled &&
+                                     key.render_mode != BatchRenderMode::OnlyOpaque);
+
+  Vulkan::GraphicsPipelineBuilder gpbuilder;
+  gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
+  gpbuilder.SetRenderPass(m_vram_render_pass, 0);
+
+  gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
+  gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
+  gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
+  if (textured)
+  {
+    gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
+    gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
+    if (m_using_uv_limits)
+      gpbuilder.AddVertexAttribute(4, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, uv_limits));
+  }
+
+  gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+  gpbuilder.SetVertexShader(vertex_shader);
+  gpbuilder.SetFragmentShader(fragment_shader);
+
+  gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
+  gpbuilder.SetDepthState(true, true, depth_test_values[key.depth_test]);
+  gpbuilder.SetNoBlendingState();
+  gpbuilder.SetMultisamples(m_multisamples, m_per_sample_shading);
+
+  if ((key.transparency_mode != GPUTransparencyMode::Disabled && transparency_enabled) ||
+      m_texture_filtering != GPUTextureFilter::Nearest)
+  {
+    gpbuilder.SetBlendAttachment(
+      0, true, VK_BLEND_FACTOR_ONE, m_supports_dual_source_blend ? VK_BLEND_FACTOR_SRC1_ALPHA : VK_BLEND_FACTOR_SRC_ALPHA,
+      (key.transparency_mode == GPUTransparencyMode::BackgroundMinusForeground && transparency_enabled) ?
+        VK_BLEND_OP_REVERSE_SUBTRACT :
+        VK_BLEND_OP_ADD,
+      VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+  }
+
+  gpbuilder.SetDynamicViewportAndScissorState();
+
+  return gpbuilder.Create(g_vulkan_context->GetDevice(), pipeline_cache);
+}
+
+VkPipeline GPU_HW_Vulkan::CompileBatchPipeline(BatchPipelineKey key)
+{
+  VkPipelineCache pipeline_cache;
+  VkShaderModule vertex_shader, fragment_shader;
+  {
+    // the shader cache isn't thread safe, so only the pipeline creation itself runs in parallel
+    std::unique_lock<std::mutex> lock(m_batch_shader_mutex);
+    pipeline_cache = g_vulkan_shader_cache->GetPipelineCache();
+    vertex_shader = m_batch_vertex_shaders[BoolToUInt8(key.texture_mode != GPUTextureMode::Disabled)];
+
+    VkShaderModule& fs = m_batch_fragment_shaders[static_cast<u8>(key.render_mode.GetValue())][static_cast<u8>(
+      key.texture_mode.GetValue())][BoolToUInt8(key.dithering)][BoolToUInt8(key.interlacing)];
+    if (fs == VK_NULL_HANDLE)
+    {
+      fs = g_vulkan_shader_cache->GetFragmentShader(m_batch_shadergen->GenerateBatchFragmentShader(
+        key.render_mode, key.texture_mode, key.dithering, key.interlacing));
+      if (fs == VK_NULL_HANDLE)
+      {
+        Log_ErrorPrintf("Failed to compile batch fragment shader for pipeline %04X", key.bits);
+        return VK_NULL_HANDLE;
+      }
+    }
+
+    fragment_shader = fs;
+  }
+
+  VkPipeline pipeline = CreateBatchPipeline(pipeline_cache, key, vertex_shader, fragment_shader);
+  if (pipeline == VK_NULL_HANDLE)
+    Log_ErrorPrintf("Failed to create batch pipeline %04X", key.bits);
+
+  return pipeline;
+}
+
+VkPipeline& GPU_HW_Vulkan::GetBatchPipelineRef(BatchPipelineKey key)
+{
+  return m_batch_pipelines[key.depth_test][static_cast<u8>(key.render_mode.GetValue())][static_cast<u8>(
+    key.texture_mode.GetValue())][static_cast<u8>(key.transparency_mode.GetValue())][BoolToUInt8(key.dithering)]
+                          [BoolToUInt8(key.interlacing)];
+}
+
+void GPU_HW_Vulkan::CollectCompiledBatchPipelines()
+{
+  for (const auto& [bits, pipeline] : m_compiled_batch_pipelines)
+  {
+    BatchPipelineKey key;
+    key.bits = bits;
+
+    // the emulation thread only compiles variants which aren't queued, but don't leak it if that ever changes
+    VkPipeline& ref = GetBatchPipelineRef(key);
+    if (ref != VK_NULL_HANDLE)
+      vkDestroyPipeline(g_vulkan_context->GetDevice(), pipeline, nullptr);
+    else
+      ref = pipeline;
+  }
+
+  m_compiled_batch_pipelines.clear();
+}
+
+VkPipeline GPU_HW_Vulkan::GetAsyncBatchPipeline(BatchPipelineKey key)
+{
+  std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+  CollectCompiledBatchPipelines();
+
+  VkPipeline& pipeline = GetBatchPipelineRef(key);
+  if (pipeline != VK_NULL_HANDLE)
+    return pipeline;
+
+  // Dithering makes the least visible difference, so draw with the other variant until this one is ready.
+  BatchPipelineKey fallback_key;
+  fallback_key.bits = key.bits;
+  fallback_key.dithering = !key.dithering;
+  const VkPipeline fallback = GetBatchPipelineRef(fallback_key);
+  if (fallback != VK_NULL_HANDLE && !m_pipeline_compile_threads.empty())
+  {
+    if (!m_pending_batch_pipelines.test(key.bits))
+    {
+      m_pending_batch_pipelines.set(key.bits);
+      m_pipeline_compile_queue.push_front(key.bits);
+      m_pipeline_compile_cv.notify_one();
+    }
+
+    m_pipeline_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return fallback;
+  }
+
+  if (m_pending_batch_pipelines.test(key.bits))
+  {
+    auto it = std::find(m_pipeline_compile_queue.begin(), m_pipeline_compile_queue.end(), key.bits);
+    if (it == m_pipeline_compile_queue.end())
+    {
+      // a compile thread is already working on it, which won't take any longer than doing it ourselves
+      m_pipeline_compile_done_cv.wait(lock, [this, &key]() { return !m_pending_batch_pipelines.test(key.bits); });
+      CollectCompiledBatchPipelines();
+      m_pipeline_stalls.fetch_add(1, std::memory_order_relaxed);
+      return pipeline;
+    }
+
+    m_pipeline_compile_queue.erase(it);
+    m_pending_batch_pipelines.reset(key.bits);
+  }
+
+  lock.unlock();
+
+  m_pipeline_stalls.fetch_add(1, std::memory_order_relaxed);
+  pipeline = CompileBatchPipeline(key);
+  return pipeline;
+}
+
+void GPU_HW_Vulkan::StartPipelineCompileThreads(bool boot /* = false */)
+{
+  if (!m_pipeline_compile_threads.empty())
+    return;
+
+  // On boot the calling thread builds the utility pipelines at the same time, so leave a core for it.
+  const u32 num_cores = std::max<u32>(std::thread::hardware_concurrency(), 1);
+  const u32 num_threads = boot ? std::clamp<u32>(num_cores - 1, 1, MAX_BOOT_PIPELINE_COMPILE_THREADS) :
+                                 std::clamp<u32>(num_cores / 2, 1, MAX_PIPELINE_COMPILE_THREADS);
+  Log_DevPrintf("Starting %u pipeline compile threads", num_threads);
+
+  m_pipeline_compile_shutdown = false;
+  for (u32 i = 0; i < num_threads; i++)
+    m_pipeline_compile_threads.emplace_back(&GPU_HW_Vulkan::PipelineCompileThreadEntryPoint, this);
+}
+
+void GPU_HW_Vulkan::StopPipelineCompileThreads(bool discard_queue)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+    m_pipeline_compile_shutdown = true;
+    m_pipeline_compile_cv.notify_all();
+  }
+
+  for (std::thread& thread : m_pipeline_compile_threads)
+    thread.join();
+  m_pipeline_compile_threads.clear();
+
+  // anything which hasn't been started is picked back up when the threads are restarted
+  if (discard_queue)
+  {
+    m_pipeline_compile_queue.clear();
+    m_pending_batch_pipelines.reset();
+  }
+}
+
+void GPU_HW_Vulkan::PipelineCompileThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_pipeline_compile_mutex);
+  for (;;)
+  {
+    m_pipeline_compile_cv.wait(
+      lock, [this]() { return (m_pipeline_compile_shutdown || !m_pipeline_compile_queue.empty()); });
+    if (m_pipeline_compile_shutdown)
+      break;
+
+    BatchPipelineKey key;
+    key.bits = m_pipeline_compile_queue.front();
+    m_pipeline_compile_queue.pop_front();
+
+    lock.unlock();
+    const VkPipeline pipeline = CompileBatchPipeline(key);
+    lock.lock();
+
+    if (pipeline != VK_NULL_HANDLE)
+      m_compiled_batch_pipelines.emplace_back(key.bits, pipeline);
+
+    m_pending_batch_pipelines.reset(key.bits);
+    m_pipeline_compile_done_cv.notify_all();
+  }
+}
+
+void GPU_HW_Vulkan::StartRenderThread()
+{
+  if (IsUsingRenderThread())
+    return;
+
+  Log_DevPrintf("Starting render thread");
+  if (!m_render_thread_vertices)
+    m_render_thread_vertices = std::make_unique<BatchVertex[]>(RENDER_THREAD_VERTEX_COUNT);
+
+  m_render_thread_vertex_write = 0;
+  m_render_thread_vertex_read.store(0);
+  m_render_thread_shutdown = false;
+  m_render_thread = std::thread(&GPU_HW_Vulkan::RenderThreadEntryPoint, this);
+}
+
+void GPU_HW_Vulkan::StopRenderThread()
+{
+  if (!IsUsingRenderThread())
+    return;
+
+  SyncRenderThread();
+
+  {
+    std::unique_lock<std::mutex> lock(m_render_thread_mutex);
+    m_render_thread_shutdown = true;
+    m_render_thread_wake_cv.notify_one();
+  }
+
+  m_render_thread.join();
+  Log_DevPrintf("Render thread stopped");
+}
+
+void GPU_HW_Vulkan::SyncRenderThread()
+{
+  if (!IsUsingRenderThread())
+    return;
+
+  KickRenderThread();
+
+  std::unique_lock<std::mutex> lock(m_render_thread_mutex);
+  m_render_thread_done_cv.wait(lock, [this]() { return (m_render_thread_queue.empty() && !m_render_thread_busy); });
+
+  // everything up to the current batch has been copied out of the staging buffer
+  m_render_thread_vertex_read.store(m_render_thread_vertex_write);
+}
+
+void GPU_HW_Vulkan::QueueRenderThreadCommand(const RenderThreadCommand& cmd)
+{
+  m_render_thread_pending.push_back(cmd);
+}
+
+void GPU_HW_Vulkan::KickRenderThread()
+{
+  if (m_render_thread_pending.empty())
+    return;
+
+  std::unique_lock<std::mutex> lock(m_render_thread_mutex);
+  m_render_thread_queue.insert(m_render_thread_queue.end(), m_render_thread_pending.begin(),
+                               m_render_thread_pending.end());
+  if (m_render_thread_sleeping)
+    m_render_thread_wake_cv.notify_one();
+  lock.unlock();
+
+  m_render_thread_pending.clear();
+}
+
+void GPU_HW_Vulkan::MapRenderThreadVertices(u32 required_vertices)
+{
+  DebugAssert(required_vertices <= RENDER_THREAD_VERTEX_COUNT);
+
+  for (;;)
+  {
+    const u32 position = m_render_thread_vertex_write % RENDER_THREAD_VERTEX_COUNT;
+    const u32 contiguous = RENDER_THREAD_VERTEX_COUNT - position;
+    const u32 free = RENDER_THREAD_VERTEX_COUNT - (m_render_thread_vertex_write - m_render_thread_vertex_read.load());
+    if (contiguous < required_vertices)
+    {
+      // skip the end of the buffer, the render thread passes over the gap with the next upload
+      if (free >= contiguous)
+      {
+        m_render_thread_vertex_write += contiguous;
+        continue;
+      }
+    }
+    else if (free >= required_vertices)
+    {
+      // don't let a single batch take the whole buffer, so the render thread can keep working on the last one
+      const u32 space = std::min(std::min(contiguous, free),
+                                 std::max<u32>(required_vertices, RENDER_THREAD_MAX_BATCH_VERTICES));
+      m_batch_start_vertex_ptr = &m_render_thread_vertices[position];
+      m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+      m_batch_end_vertex_ptr = m_batch_start_vertex_ptr + space;
+      m_batch_base_vertex = 0;
+      return;
+    }
+
+    Log_PerfPrintf("Waiting for render thread to free %u vertices", required_vertices);
+    KickRenderThread();
+
+    std::unique_lock<std::mutex> lock(m_render_thread_mutex);
+    const u32 last_read = m_render_thread_vertex_read.load();
+    m_render_thread_done_cv.wait(lock, [this, last_read]() {
+      return (m_render_thread_vertex_read.load() != last_read ||
+              (m_render_thread_queue.empty() && !m_render_thread_busy));
+    });
+    if (m_render_thread_queue.empty() && !m_render_thread_busy)
+      m_render_thread_vertex_read.store(m_render_thread_vertex_write);
+  }
+}
+
+void GPU_HW_Vulkan::RenderThreadEntryPoint()
+{
+  std::vector<RenderThreadCommand> commands;
+
+  std::unique_lock<std::mutex> lock(m_render_thread_mutex);
+  for (;;)
+  {
+    m_render_thread_sleeping = true;
+    m_render_thread_wake_cv.wait(lock,
+                                 [this]() { return (m_render_thread_shutdown || !m_render_thread_queue.empty()); });
+    m_render_thread_sleeping = false;
+    if (m_render_thread_queue.empty())
+      break;
+
+    commands.swap(m_render_thread_queue);
+    m_render_thread_busy = true;
+    lock.unlock();
+
+    for (const RenderThreadCommand& cmd : commands)
+      ExecuteRenderThreadCommand(cmd);
+    commands.clear();
+
+    lock.lock();
+    m_render_thread_busy = false;
+    m_render_thread_done_cv.notify_all();
+  }
+}
+
+void GPU_HW_Vulkan::ExecuteRenderThreadCommand(const RenderThreadCommand& cmd)
+{
+  switch (cmd.type)
+  {
+    case RenderThreadCommandType::UploadVertices:
+    {
+      const u32 required_space = cmd.num_vertices * sizeof(BatchVertex);
+      if (!m_vertex_stream_buffer.ReserveMemory(required_space, sizeof(BatchVertex)))
+      {
+        Log_PerfPrintf("Executing command buffer while waiting for %u bytes in vertex stream buffer", required_space);
+        EndRenderPass();
+        g_vulkan_context->ExecuteCommandBuffer(false);
+        RestoreBatchState();
+        if (!m_vertex_stream_buffer.ReserveMemory(required_space, sizeof(BatchVertex)))
+          Panic("Failed to reserve vertex stream buffer memory");
+      }
+
+      m_render_thread_base_vertex = m_vertex_stream_buffer.GetCurrentOffset() / sizeof(BatchVertex);
+      std::memcpy(m_vertex_stream_buffer.GetCurrentHostPointer(), &m_render_thread_vertices[cmd.first_vertex],
+                  required_space);
+      m_vertex_stream_buffer.CommitMemory(required_space);
+      m_render_thread_vertex_read.store(cmd.vertex_counter);
+    }
+    break;
+
+    case RenderThreadCommandType::UploadUniforms:
+      WriteUniformBuffer(&cmd.uniforms, sizeof(cmd.uniforms));
+      break;
+
+    case RenderThreadCommandType::SetScissor:
+      m_current_scissor = cmd.scissor;
+      SetScissor(m_current_scissor);
+      break;
+
+    case RenderThreadCommandType::ClearDepthBuffer:
+      ClearDepthTexture();
+      break;
+
+    case RenderThreadCommandType::DrawBatch:
+      DrawBatch(cmd.batch, cmd.render_mode, m_render_thread_base_vertex + cmd.first_vertex, cmd.num_vertices,
+                cmd.sprites);
+      break;
+
+    default:
+      break;
+  }
+}
+
 void GPU_HW_Vulkan::DestroyPipelines()
 {
+  StopPipelineCompileThreads(true);
+  CollectCompiledBatchPipelines();
   m_batch_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
+  m_batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+  m_batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+  m_batch_shadergen.reset();
 
   for (VkPipeline& p : m_vram_fill_pipelines)
     Vulkan::Util::SafeDestroyPipeline(p);
@@ -1160,6 +1766,9 @@ void GPU_HW_Vulkan::DestroyPipelines()
   Vulkan::Util::SafeDestroyPipeline(m_vram_readback_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_vram_update_depth_pipeline);
 
+  for (VkPipeline& p : m_palette_decode_pipelines)
+    Vulkan::Util::SafeDestroyPipeline(p);
+
   Vulkan::Util::SafeDestroyPipeline(m_downsample_first_pass_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_downsample_mid_pass_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_downsample_blur_pass_pipeline);
@@ -1169,19 +1778,67 @@ void GPU_HW_Vulkan::DestroyPipelines()
 }
 
 void GPU_HW_Vulkan::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices)
+{
+  QueueOrDrawBatch(render_mode, base_vertex, num_vertices, false);
+}
+
+void GPU_HW_Vulkan::DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites)
+{
+  QueueOrDrawBatch(render_mode, base_vertex, num_sprites, true);
+}
+
+void GPU_HW_Vulkan::QueueOrDrawBatch(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices, bool sprites)
+{
+  // the usage list belongs to the emulation thread
+  RecordBatchPipelineUse(GetBatchPipelineKey(render_mode));
+
+  if (IsUsingRenderThread())
+  {
+    // the staging buffer is mapped with a base vertex of zero, so this is the offset into the upload
+    RenderThreadCommand cmd = {};
+    cmd.type = RenderThreadCommandType::DrawBatch;
+    cmd.render_mode = render_mode;
+    cmd.batch = m_batch;
+    cmd.sprites = sprites;
+    cmd.first_vertex = base_vertex;
+    cmd.num_vertices = num_vertices;
+    QueueRenderThreadCommand(cmd);
+
+    // handing over commands in groups keeps the mutex out of the per-batch path
+    if (m_render_thread_pending.size() >= RENDER_THREAD_KICK_COMMANDS)
+      KickRenderThread();
+
+    return;
+  }
+
+  DrawBatch(m_batch, render_mode, base_vertex, num_vertices, sprites);
+}
+
+void GPU_HW_Vulkan::DrawBatch(const BatchConfig& batch, BatchRenderMode render_mode, u32 base_vertex,
+                              u32 num_vertices, bool sprites)
 {
   BeginVRAMRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
 
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  const u8 depth_test = BoolToUInt8(m_batch.check_mask_before_draw) | (BoolToUInt8(m_batch.use_depth_buffer) << 1);
+  const u8 depth_test = BoolToUInt8(batch.check_mask_before_draw) | (BoolToUInt8(batch.use_depth_buffer) << 1);
   VkPipeline pipeline =
-    m_batch_pipelines[depth_test][static_cast<u8>(render_mode)][static_cast<u8>(m_batch.texture_mode)][static_cast<u8>(
-      m_batch.transparency_mode)][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)];
+    m_batch_pipelines[depth_test][static_cast<u8>(render_mode)][static_cast<u8>(batch.texture_mode)][static_cast<u8>(
+      batch.transparency_mode)][BoolToUInt8(batch.dithering)][BoolToUInt8(batch.interlacing)];
+  if (m_async_pipeline_compilation && pipeline == VK_NULL_HANDLE &&
+      (pipeline = GetAsyncBatchPipeline(GetBatchPipelineKey(batch, render_mode))) == VK_NULL_HANDLE)
+  {
+    return;
+  }
 
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-  vkCmdDraw(cmdbuf, num_vertices, 1, base_vertex, 0);
+
+  // one instance per sprite record, the instance index minus one is used to fetch it
+  if (sprites)
+    vkCmdDraw(cmdbuf, 6, num_vertices, 0, base_vertex + 1);
+  else
+    vkCmdDraw(cmdbuf, num_vertices, 1, base_vertex, 0);
 }
 
 void GPU_HW_Vulkan::SetScissorFromDrawingArea()
@@ -1189,12 +1846,23 @@ void GPU_HW_Vulkan::SetScissorFromDrawingArea()
   int left, top, right, bottom;
   CalcScissorRect(&left, &top, &right, &bottom);
 
-  Vulkan::Util::SetScissor(g_vulkan_context->GetCurrentCommandBuffer(), left, top, right - left, bottom - top);
+  RenderThreadCommand cmd = {};
+  cmd.scissor.Set(left, top, right, bottom);
+  if (IsUsingRenderThread())
+  {
+    cmd.type = RenderThreadCommandType::SetScissor;
+    QueueRenderThreadCommand(cmd);
+    return;
+  }
+
+  m_current_scissor = cmd.scissor;
+  SetScissor(m_current_scissor);
 }
 
 void GPU_HW_Vulkan::ClearDisplay()
 {
   GPU_HW::ClearDisplay();
+  SyncRenderThread();
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1208,6 +1876,7 @@ void GPU_HW_Vulkan::ClearDisplay()
 void GPU_HW_Vulkan::UpdateDisplay()
 {
   GPU_HW::UpdateDisplay();
+  SyncRenderThread();
   EndRenderPass();
 
   if (g_settings.debugging.show_vram)
@@ -1324,8 +1993,13 @@ void GPU_HW_Vulkan::UpdateDisplay()
 
 void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 {
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+  // Get bounds with wrap-around handled, and only read back what the shadow copy is missing. Queued draws mark their
+  // tiles as soon as they're batched, so the render thread only needs to catch up when something has to be read.
+  Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+  if (!GetVRAMReadbackRectangle(&copy_rect))
+    return;
+
+  SyncRenderThread();
   const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
   const u32 encoded_height = copy_rect.GetHeight();
 
@@ -1369,6 +2043,8 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 
 void GPU_HW_Vulkan::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
+  SyncRenderThread();
+
   if ((x + width) > VRAM_WIDTH || (y + height) > VRAM_HEIGHT)
   {
     // CPU round trip if oversized for now.
@@ -1402,6 +2078,8 @@ void GPU_HW_Vulkan::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 
 void GPU_HW_Vulkan::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask)
 {
+  SyncRenderThread();
+
   const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
   GPU_HW::UpdateVRAM(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight(), data, set_mask, check_mask);
 
@@ -1456,6 +2134,8 @@ void GPU_HW_Vulkan::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
 
 void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  SyncRenderThread();
+
   if (UseVRAMCopyShader(src_x, src_y, dst_x, dst_y, width, height) || IsUsingMultisampling())
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
@@ -1515,6 +2195,7 @@ void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wid
 
 void GPU_HW_Vulkan::UpdateVRAMReadTexture()
 {
+  SyncRenderThread();
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1551,11 +2232,41 @@ void GPU_HW_Vulkan::UpdateVRAMReadTexture()
   GPU_HW::UpdateVRAMReadTexture();
 }
 
+void GPU_HW_Vulkan::DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms)
+{
+  SyncRenderThread();
+  EndRenderPass();
+
+  VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
+  m_palette_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+  const u32 slot_x = uniforms.u_slot_origin[0];
+  const u32 slot_y = uniforms.u_slot_origin[1];
+  BeginRenderPass(m_palette_texture_cache_render_pass, m_palette_texture_cache_framebuffer, slot_x, slot_y,
+                  PALETTE_TEXTURE_CACHE_SLOT_SIZE, PALETTE_TEXTURE_CACHE_SLOT_SIZE);
+
+  const bool palette_8bit = (m_draw_mode.mode_reg.texture_mode == GPUTextureMode::Palette8Bit);
+  vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_palette_decode_pipelines[BoolToUInt8(palette_8bit)]);
+  vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_single_sampler_pipeline_layout, 0, 1,
+                          &m_vram_copy_descriptor_set, 0, nullptr);
+  vkCmdPushConstants(cmdbuf, m_single_sampler_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uniforms),
+                     &uniforms);
+  Vulkan::Util::SetViewportAndScissor(cmdbuf, slot_x, slot_y, PALETTE_TEXTURE_CACHE_SLOT_SIZE,
+                                      PALETTE_TEXTURE_CACHE_SLOT_SIZE);
+  vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+
+  EndRenderPass();
+  m_palette_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+  RestoreGraphicsAPIState();
+}
+
 void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
 {
   if (m_pgxp_depth_buffer)
     return;
 
+  SyncRenderThread();
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1578,6 +2289,22 @@ void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
 }
 
 void GPU_HW_Vulkan::ClearDepthBuffer()
+{
+  if (IsUsingRenderThread())
+  {
+    RenderThreadCommand cmd = {};
+    cmd.type = RenderThreadCommandType::ClearDepthBuffer;
+    QueueRenderThreadCommand(cmd);
+  }
+  else
+  {
+    ClearDepthTexture();
+  }
+
+  m_last_depth_z = 1.0f;
+}
+
+void GPU_HW_Vulkan::ClearDepthTexture()
 {
   EndRenderPass();
 
@@ -1590,7 +2317,6 @@ void GPU_HW_Vulkan::ClearDepthBuffer()
                               &dsrr);
 
   m_vram_depth_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
-  m_last_depth_z = 1.0f;
 }
 
 bool GPU_HW_Vulkan::CreateTextureReplacementStreamBuffer()
@@ -6,8 +6,17 @@
 #include "gpu_hw.h"
 #include "texture_replacements.h"
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
+
+class GPU_HW_ShaderGen;
 
 class GPU_HW_Vulkan : public GPU_HW
 {
@@ -37,16 +46,79 @@ protected:
   void UnmapBatchVertexPointer(u32 used_vertices) override;
   void UploadUniformBuffer(const void* data, u32 data_size) override;
   void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) override;
+  void DrawBatchSprites(BatchRenderMode render_mode, u32 base_vertex, u32 num_sprites) override;
+  void DecodePaletteTexture(u32 slot, const PaletteDecodeUBOData& uniforms) override;
 
 private:
   enum : u32
   {
     MAX_PUSH_CONSTANTS_SIZE = 64,
-    TEXTURE_REPLACEMENT_BUFFER_SIZE = 64 * 1024 * 1024
+    TEXTURE_REPLACEMENT_BUFFER_SIZE = 64 * 1024 * 1024,
+    MAX_PIPELINE_COMPILE_THREADS = 4,
+
+    // when every batch pipeline is built on boot, drivers serialize enough of pipeline creation internally that
+    // more threads than this mostly add memory use
+    MAX_BOOT_PIPELINE_COMPILE_THREADS = 8,
+
+    // vertices are staged in host memory for the render thread, which copies them to the stream buffer
+    RENDER_THREAD_VERTEX_COUNT = VERTEX_BUFFER_SIZE / sizeof(BatchVertex),
+    RENDER_THREAD_MAX_BATCH_VERTICES = RENDER_THREAD_VERTEX_COUNT / 4,
+
+    // draws are handed to the render thread once this many commands are pending, or when it is synced
+    RENDER_THREAD_KICK_COMMANDS = 64
   };
+
+  enum class RenderThreadCommandType : u8
+  {
+    UploadVertices,
+    UploadUniforms,
+    SetScissor,
+    ClearDepthBuffer,
+    DrawBatch
+  };
+
+  struct RenderThreadCommand
+  {
+    RenderThreadCommandType type;
+    BatchRenderMode render_mode;
+    BatchConfig batch;
+    bool sprites;
+
+    // vertex counter is the position in the staging buffer after these vertices, which the render thread publishes
+    // draws use first_vertex as the offset from the start of the last upload
+    u32 first_vertex;
+    u32 num_vertices;
+    u32 vertex_counter;
+
+    Common::Rectangle<s32> scissor;
+    BatchUBOData uniforms;
+  };
+
   void SetCapabilities();
   void DestroyResources();
 
+  /// Rebinds the batch state after the command buffer is submitted, without waiting for the render thread.
+  void RestoreBatchState();
+  void SetScissor(const Common::Rectangle<s32>& rc);
+  void WriteUniformBuffer(const void* data, u32 data_size);
+  void QueueOrDrawBatch(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices, bool sprites);
+  void DrawBatch(const BatchConfig& batch, BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices,
+                 bool sprites);
+  void ClearDepthTexture();
+
+  ALWAYS_INLINE bool IsUsingRenderThread() const { return m_render_thread.joinable(); }
+  void StartRenderThread();
+  void StopRenderThread();
+
+  /// Waits until the render thread has recorded everything queued, must be called before using the command buffer.
+  void SyncRenderThread();
+
+  void QueueRenderThreadCommand(const RenderThreadCommand& cmd);
+  void KickRenderThread();
+  void MapRenderThreadVertices(u32 required_vertices);
+  void RenderThreadEntryPoint();
+  void ExecuteRenderThreadCommand(const RenderThreadCommand& cmd);
+
   ALWAYS_INLINE bool InRenderPass() const { return (m_current_render_pass != VK_NULL_HANDLE); }
   void BeginRenderPass(VkRenderPass render_pass, VkFramebuffer framebuffer, u32 x, u32 y, u32 width, u32 height);
   void BeginVRAMRenderPass();
@@ -66,6 +138,25 @@ private:
   bool CompilePipelines();
   void DestroyPipelines();
 
+  VkPipeline CreateBatchPipeline(VkPipelineCache pipeline_cache, BatchPipelineKey key, VkShaderModule vertex_shader,
+                                 VkShaderModule fragment_shader);
+  VkPipeline& GetBatchPipelineRef(BatchPipelineKey key);
+
+  /// Compiles the fragment shader if needed, then creates the pipeline. Safe to call from any thread.
+  VkPipeline CompileBatchPipeline(BatchPipelineKey key);
+
+  /// Returns the pipeline to draw with when the variant hasn't been compiled yet. Falls back to a similar variant
+  /// while the compile threads work on it if possible, otherwise compiles it immediately.
+  VkPipeline GetAsyncBatchPipeline(BatchPipelineKey key);
+
+  /// Moves pipelines from the compile threads into m_batch_pipelines, the compile mutex must be held.
+  void CollectCompiledBatchPipelines();
+
+  /// Boot-time compiles use most cores, otherwise some are left for emulation.
+  void StartPipelineCompileThreads(bool boot = false);
+  void StopPipelineCompileThreads(bool discard_queue);
+  void PipelineCompileThreadEntryPoint();
+
   bool CreateTextureReplacementStreamBuffer();
 
   bool BlitVRAMReplacementTexture(const TextureReplacementTexture* tex, u32 dst_x, u32 dst_y, u32 width, u32 height);
@@ -80,6 +171,7 @@ private:
   VkRenderPass m_vram_update_depth_render_pass = VK_NULL_HANDLE;
   VkRenderPass m_display_render_pass = VK_NULL_HANDLE;
   VkRenderPass m_vram_readback_render_pass = VK_NULL_HANDLE;
+  VkRenderPass m_palette_texture_cache_render_pass = VK_NULL_HANDLE;
 
   VkDescriptorSetLayout m_batch_descriptor_set_layout = VK_NULL_HANDLE;
   VkDescriptorSetLayout m_single_sampler_descriptor_set_layout = VK_NULL_HANDLE;
@@ -96,12 +188,14 @@ private:
   Vulkan::Texture m_vram_readback_texture;
   Vulkan::StagingTexture m_vram_readback_staging_texture;
   Vulkan::Texture m_display_texture;
+  Vulkan::Texture m_palette_texture_cache_texture;
   bool m_use_ssbos_for_vram_writes = false;
 
   VkFramebuffer m_vram_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_vram_update_depth_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_vram_readback_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_display_framebuffer = VK_NULL_HANDLE;
+  VkFramebuffer m_palette_texture_cache_framebuffer = VK_NULL_HANDLE;
 
   VkSampler m_point_sampler = VK_NULL_HANDLE;
   VkSampler m_linear_sampler = VK_NULL_HANDLE;
@@ -118,11 +212,43 @@ private:
   Vulkan::StreamBuffer m_texture_stream_buffer;
 
   u32 m_current_uniform_buffer_offset = 0;
+  Common::Rectangle<s32> m_current_scissor{0, 0, 1, 1};
   VkBufferView m_texture_stream_buffer_view = VK_NULL_HANDLE;
 
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
   DimensionalArray<VkPipeline, 2, 2, 5, 9, 4, 3> m_batch_pipelines{};
 
+  // async pipeline compilation - shaders are kept around so the remaining variants can be created later
+  // [textured], [render_mode][texture_mode][dithering][interlacing]
+  std::unique_ptr<GPU_HW_ShaderGen> m_batch_shadergen;
+  DimensionalArray<VkShaderModule, 2> m_batch_vertex_shaders{};
+  DimensionalArray<VkShaderModule, 2, 2, 9, 4> m_batch_fragment_shaders{};
+  std::mutex m_batch_shader_mutex;
+
+  std::vector<std::thread> m_pipeline_compile_threads;
+  std::mutex m_pipeline_compile_mutex;
+  std::condition_variable m_pipeline_compile_cv;
+  std::condition_variable m_pipeline_compile_done_cv;
+  std::deque<u32> m_pipeline_compile_queue;
+  std::vector<std::pair<u32, VkPipeline>> m_compiled_batch_pipelines;
+  std::bitset<NUM_BATCH_PIPELINE_KEYS> m_pending_batch_pipelines;
+  bool m_pipeline_compile_shutdown = false;
+
+  // threaded batch submission, the emulation thread builds batches and the render thread records the draws
+  std::thread m_render_thread;
+  std::mutex m_render_thread_mutex;
+  std::condition_variable m_render_thread_wake_cv;
+  std::condition_variable m_render_thread_done_cv;
+  std::vector<RenderThreadCommand> m_render_thread_queue;
+  std::vector<RenderThreadCommand> m_render_thread_pending;
+  std::unique_ptr<BatchVertex[]> m_render_thread_vertices;
+  u32 m_render_thread_vertex_write = 0;
+  std::atomic<u32> m_render_thread_vertex_read{0};
+  u32 m_render_thread_base_vertex = 0;
+  bool m_render_thread_busy = false;
+  bool m_render_thread_sleeping = false;
+  bool m_render_thread_shutdown = false;
+
   // [interlaced]
   std::array<VkPipeline, 2> m_vram_fill_pipelines{};
 
@@ -133,6 +259,9 @@ private:
   VkPipeline m_vram_readback_pipeline = VK_NULL_HANDLE;
   VkPipeline m_vram_update_depth_pipeline = VK_NULL_HANDLE;
 
+  // [palette_8bit]
+  std::array<VkPipeline, 2> m_palette_decode_pipelines{};
+
   // [depth_24][interlace_mode]
   DimensionalArray<VkPipeline, 3, 2> m_display_pipelines{};
 
@@ -4,20 +4,14 @@
 #include "common/cpu_detect.h"
 #include "common/log.h"
 #include "common/make_array.h"
+#include "gpu_sw_copy_out.h"
 #include "host_display.h"
 #include "system.h"
 #include <algorithm>
-Log_SetChannel(GPU_SW);
-
-#if defined(CPU_X64)
-#include <emmintrin.h>
-#elif defined(CPU_AARCH64)
-#ifdef _MSC_VER
-#include <arm64_neon.h>
-#else
-#include <arm_neon.h>
-#endif
+#ifdef WITH_IMGUI
+#include "imgui.h"
 #endif
+Log_SetChannel(GPU_SW);
 
 template<typename T>
 ALWAYS_INLINE static constexpr std::tuple<T, T> MinMax(T v1, T v2)
@@ -80,154 +74,16 @@ void GPU_SW::Reset()
   GPU::Reset();
 
   m_backend.Reset();
+  m_display_dirty = true;
+  m_num_display_copies = 0;
+  m_num_display_copies_skipped = 0;
 }
 
 void GPU_SW::UpdateSettings()
 {
   GPU::UpdateSettings();
   m_backend.UpdateSettings();
-}
-
-template<HostDisplayPixelFormat out_format, typename out_type>
-static void CopyOutRow16(const u16* src_ptr, out_type* dst_ptr, u32 width);
-
-template<HostDisplayPixelFormat out_format, typename out_type>
-static out_type VRAM16ToOutput(u16 value);
-
-template<>
-ALWAYS_INLINE u16 VRAM16ToOutput<HostDisplayPixelFormat::RGBA5551, u16>(u16 value)
-{
-  return (value & 0x3E0) | ((value >> 10) & 0x1F) | ((value & 0x1F) << 10);
-}
-
-template<>
-ALWAYS_INLINE u16 VRAM16ToOutput<HostDisplayPixelFormat::RGB565, u16>(u16 value)
-{
-  return ((value & 0x3E0) << 1) | ((value & 0x20) << 1) | ((value >> 10) & 0x1F) | ((value & 0x1F) << 11);
-}
-
-template<>
-ALWAYS_INLINE u32 VRAM16ToOutput<HostDisplayPixelFormat::RGBA8, u32>(u16 value)
-{
-  u8 r = Truncate8(value & 31);
-  u8 g = Truncate8((value >> 5) & 31);
-  u8 b = Truncate8((value >> 10) & 31);
-
-  // 00012345 -> 1234545
-  b = (b << 3) | (b & 0b111);
-  g = (g << 3) | (g & 0b111);
-  r = (r << 3) | (r & 0b111);
-
-  return ZeroExtend32(r) | (ZeroExtend32(g) << 8) | (ZeroExtend32(b) << 16) | (0xFF000000u);
-}
-
-template<>
-ALWAYS_INLINE u32 VRAM16ToOutput<HostDisplayPixelFormat::BGRA8, u32>(u16 value)
-{
-  u8 r = Truncate8(value & 31);
-  u8 g = Truncate8((value >> 5) & 31);
-  u8 b = Truncate8((value >> 10) & 31);
-
-  // 00012345 -> 1234545
-  b = (b << 3) | (b & 0b111);
-  g = (g << 3) | (g & 0b111);
-  r = (r << 3) | (r & 0b111);
-
-  return ZeroExtend32(b) | (ZeroExtend32(g) << 8) | (ZeroExtend32(r) << 16) | (0xFF000000u);
-}
-
-template<>
-ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGBA5551, u16>(const u16* src_ptr, u16* dst_ptr, u32 width)
-{
-  u32 col = 0;
-
-#if defined(CPU_X64)
-  const u32 aligned_width = Common::AlignDownPow2(width, 8);
-  for (; col < aligned_width; col += 8)
-  {
-    const __m128i single_mask = _mm_set1_epi16(0x1F);
-    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
-    src_ptr += 8;
-    __m128i a = _mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x3E0))));
-    __m128i b = _mm_and_si128(_mm_srli_epi16(value, 10), single_mask);
-    __m128i c = _mm_slli_epi16(_mm_and_si128(value, single_mask), 10);
-    value = _mm_or_si128(_mm_or_si128(a, b), c);
-    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
-    dst_ptr += 8;
-  }
-#elif defined(CPU_AARCH64)
-  const u32 aligned_width = Common::AlignDownPow2(width, 8);
-  for (; col < aligned_width; col += 8)
-  {
-    const uint16x8_t single_mask = vdupq_n_u16(0x1F);
-    uint16x8_t value = vld1q_u16(src_ptr);
-    src_ptr += 8;
-    uint16x8_t a = vandq_u16(value, vdupq_n_u16(0x3E0));
-    uint16x8_t b = vandq_u16(vshrq_n_u16(value, 10), single_mask);
-    uint16x8_t c = vshlq_n_u16(vandq_u16(value, single_mask), 10);
-    value = vorrq_u16(vorrq_u16(a, b), c);
-    vst1q_u16(dst_ptr, value);
-    dst_ptr += 8;
-  }
-#endif
-
-  for (; col < width; col++)
-    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::RGBA5551, u16>(*(src_ptr++));
-}
-
-template<>
-ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGB565, u16>(const u16* src_ptr, u16* dst_ptr, u32 width)
-{
-  u32 col = 0;
-
-#if defined(CPU_X64)
-  const u32 aligned_width = Common::AlignDownPow2(width, 8);
-  for (; col < aligned_width; col += 8)
-  {
-    const __m128i single_mask = _mm_set1_epi16(0x1F);
-    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
-    src_ptr += 8;
-    __m128i a = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x3E0)))), 1);
-    __m128i b = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x20)))), 1);
-    __m128i c = _mm_and_si128(_mm_srli_epi16(value, 10), single_mask);
-    __m128i d = _mm_slli_epi16(_mm_and_si128(value, single_mask), 11);
-    value = _mm_or_si128(_mm_or_si128(_mm_or_si128(a, b), c), d);
-    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
-    dst_ptr += 8;
-  }
-#elif defined(CPU_AARCH64)
-  const u32 aligned_width = Common::AlignDownPow2(width, 8);
-  const uint16x8_t single_mask = vdupq_n_u16(0x1F);
-  for (; col < aligned_width; col += 8)
-  {
-    uint16x8_t value = vld1q_u16(src_ptr);
-    src_ptr += 8;
-    uint16x8_t a = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x3E0)), 1); // (value & 0x3E0) << 1
-    uint16x8_t b = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x20)), 1);  // (value & 0x20) << 1
-    uint16x8_t c = vandq_u16(vshrq_n_u16(value, 10), single_mask);       // ((value >> 10) & 0x1F)
-    uint16x8_t d = vshlq_n_u16(vandq_u16(value, single_mask), 11);       // ((value & 0x1F) << 11)
-    value = vorrq_u16(vorrq_u16(vorrq_u16(a, b), c), d);
-    vst1q_u16(dst_ptr, value);
-    dst_ptr += 8;
-  }
-#endif
-
-  for (; col < width; col++)
-    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::RGB565, u16>(*(src_ptr++));
-}
-
-template<>
-ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGBA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
-{
-  for (u32 col = 0; col < width; col++)
-    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::RGBA8, u32>(*(src_ptr++));
-}
-
-template<>
-ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::BGRA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
-{
-  for (u32 col = 0; col < width; col++)
-    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::BGRA8, u32>(*(src_ptr++));
+  m_display_dirty = true;
 }
 
 template<HostDisplayPixelFormat display_format>
@@ -277,15 +133,10 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
     const u32 rows = height >> interlaced_shift;
     dst_stride <<= interlaced_shift;
 
-    const u32 end_x = src_x + width;
     for (u32 row = 0; row < rows; row++)
     {
       const u16* src_row_ptr = &m_vram_ptr[(src_y % VRAM_HEIGHT) * VRAM_WIDTH];
-      OutputPixelType* dst_row_ptr = reinterpret_cast<OutputPixelType*>(dst_ptr);
-
-      for (u32 col = src_x; col < end_x; col++)
-        *(dst_row_ptr++) = VRAM16ToOutput<display_format, OutputPixelType>(src_row_ptr[col % VRAM_WIDTH]);
-
+      CopyOutRow16Wrapped<display_format>(src_row_ptr, src_x, reinterpret_cast<OutputPixelType*>(dst_ptr), width);
       src_y += (1 << interleaved_shift);
       dst_ptr += dst_stride;
     }
@@ -359,54 +210,7 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
     const u32 src_stride = (VRAM_WIDTH << interleaved_shift) * sizeof(u16);
     for (u32 row = 0; row < rows; row++)
     {
-      if constexpr (display_format == HostDisplayPixelFormat::RGBA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = 0xFF;
-        }
-      }
-      else if constexpr (display_format == HostDisplayPixelFormat::BGRA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = src_row_ptr[2];
-          *(dst_row_ptr++) = src_row_ptr[1];
-          *(dst_row_ptr++) = src_row_ptr[0];
-          *(dst_row_ptr++) = 0xFF;
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == HostDisplayPixelFormat::RGB565)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 11) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 2) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == HostDisplayPixelFormat::RGBA5551)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 10) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 3) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-
+      CopyOutRow24<display_format>(src_ptr, reinterpret_cast<OutputPixelType*>(dst_ptr), width);
       src_ptr += src_stride;
       dst_ptr += dst_stride;
     }
@@ -416,34 +220,8 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
     for (u32 row = 0; row < rows; row++)
     {
       const u16* src_row_ptr = &m_vram_ptr[(src_y % VRAM_HEIGHT) * VRAM_WIDTH];
-      OutputPixelType* dst_row_ptr = reinterpret_cast<OutputPixelType*>(dst_ptr);
-
-      for (u32 col = 0; col < width; col++)
-      {
-        const u32 offset = (src_x + (((skip_x + col) * 3) / 2));
-        const u16 s0 = src_row_ptr[offset % VRAM_WIDTH];
-        const u16 s1 = src_row_ptr[(offset + 1) % VRAM_WIDTH];
-        const u8 shift = static_cast<u8>(col & 1u) * 8;
-        const u32 rgb = (((ZeroExtend32(s1) << 16) | ZeroExtend32(s0)) >> shift);
-
-        if constexpr (display_format == HostDisplayPixelFormat::RGBA8)
-        {
-          *(dst_row_ptr++) = rgb | 0xFF000000u;
-        }
-        else if constexpr (display_format == HostDisplayPixelFormat::BGRA8)
-        {
-          *(dst_row_ptr++) = (rgb & 0x00FF00) | ((rgb & 0xFF) << 16) | ((rgb >> 16) & 0xFF) | 0xFF000000u;
-        }
-        else if constexpr (display_format == HostDisplayPixelFormat::RGB565)
-        {
-          *(dst_row_ptr++) = ((rgb >> 3) & 0x1F) | (((rgb >> 10) << 5) & 0x7E0) | (((rgb >> 19) << 11) & 0x3E0000);
-        }
-        else if constexpr (display_format == HostDisplayPixelFormat::RGBA5551)
-        {
-          *(dst_row_ptr++) = ((rgb >> 3) & 0x1F) | (((rgb >> 11) << 5) & 0x3E0) | (((rgb >> 19) << 10) & 0x1F0000);
-        }
-      }
-
+      CopyOutRow24Wrapped<display_format>(src_row_ptr, src_x, skip_x, reinterpret_cast<OutputPixelType*>(dst_ptr),
+                                          width);
       src_y += (1 << interleaved_shift);
       dst_ptr += dst_stride;
     }
@@ -482,9 +260,56 @@ void GPU_SW::CopyOut24Bit(HostDisplayPixelFormat display_format, u32 src_x, u32
   }
 }
 
+bool GPU_SW::DisplayCopyParameters::operator==(const DisplayCopyParameters& rhs) const
+{
+  return (src_x == rhs.src_x && src_y == rhs.src_y && skip_x == rhs.skip_x && width == rhs.width &&
+          height == rhs.height && field == rhs.field && color_depth_24 == rhs.color_depth_24 &&
+          interlaced == rhs.interlaced && interleaved == rhs.interleaved && show_vram == rhs.show_vram);
+}
+
 void GPU_SW::ClearDisplay()
 {
   std::memset(m_display_texture_buffer.data(), 0, m_display_texture_buffer.size());
+  m_display_dirty = true;
+}
+
+static bool RangesOverlapWrapped(u32 a_start, u32 a_size, u32 b_start, u32 b_size, u32 wrap)
+{
+  if (a_size >= wrap || b_size >= wrap)
+    return true;
+
+  // b overlaps a if it starts inside it, or starts after it and wraps around into it
+  const u32 b_offset = ((b_start % wrap) + wrap - (a_start % wrap)) % wrap;
+  return (b_offset < a_size || (b_offset + b_size) > wrap);
+}
+
+void GPU_SW::InvalidateDisplay(u32 x, u32 y, u32 width, u32 height)
+{
+  // copies are only skipped when the parameters match the last one, so that's the area which has to be checked
+  const DisplayCopyParameters& params = m_last_display_copy;
+  if (m_display_dirty || width == 0 || height == 0)
+    return;
+
+  // 24-bit pixels are packed from src_x, so convert the end to halfwords
+  const u32 display_width = params.color_depth_24 ? (((params.skip_x + params.width) * 3 + 1) / 2) : params.width;
+
+  // interlaced copies start at the field's line, but cover the whole height
+  m_display_dirty = RangesOverlapWrapped(params.src_x, display_width, x, width, VRAM_WIDTH) &&
+                    RangesOverlapWrapped(params.src_y - params.field, params.height, y, height, VRAM_HEIGHT);
+}
+
+bool GPU_SW::IsDisplayCopyNeeded(const DisplayCopyParameters& params)
+{
+  if (!m_display_dirty && params == m_last_display_copy)
+  {
+    m_num_display_copies_skipped++;
+    return false;
+  }
+
+  m_last_display_copy = params;
+  m_display_dirty = false;
+  m_num_display_copies++;
+  return true;
 }
 
 void GPU_SW::UpdateDisplay()
@@ -497,40 +322,34 @@ void GPU_SW::UpdateDisplay()
     if (IsDisplayDisabled())
     {
       m_host_display->ClearDisplayTexture();
+      m_display_dirty = true;
       return;
     }
 
-    const u32 vram_offset_y = m_crtc_state.display_vram_top;
-    const u32 display_width = m_crtc_state.display_vram_width;
-    const u32 display_height = m_crtc_state.display_vram_height;
-
-    if (IsInterlacedDisplayEnabled())
-    {
-      const u32 field = GetInterlacedDisplayField();
-      if (m_GPUSTAT.display_area_color_depth_24)
-      {
-        CopyOut24Bit(m_24bit_display_format, m_crtc_state.regs.X, vram_offset_y + field,
-                     m_crtc_state.display_vram_left - m_crtc_state.regs.X, display_width, display_height, field, true,
-                     m_GPUSTAT.vertical_resolution);
-      }
-      else
-      {
-        CopyOut15Bit(m_16bit_display_format, m_crtc_state.display_vram_left, vram_offset_y + field, display_width,
-                     display_height, field, true, m_GPUSTAT.vertical_resolution);
-      }
-    }
-    else
+    const bool interlaced = IsInterlacedDisplayEnabled();
+    DisplayCopyParameters params;
+    params.field = interlaced ? GetInterlacedDisplayField() : 0;
+    params.src_x = m_GPUSTAT.display_area_color_depth_24 ? m_crtc_state.regs.X : m_crtc_state.display_vram_left;
+    params.src_y = m_crtc_state.display_vram_top + params.field;
+    params.skip_x = m_GPUSTAT.display_area_color_depth_24 ? (m_crtc_state.display_vram_left - m_crtc_state.regs.X) : 0;
+    params.width = m_crtc_state.display_vram_width;
+    params.height = m_crtc_state.display_vram_height;
+    params.color_depth_24 = m_GPUSTAT.display_area_color_depth_24;
+    params.interlaced = interlaced;
+    params.interleaved = interlaced && m_GPUSTAT.vertical_resolution;
+    params.show_vram = false;
+
+    if (IsDisplayCopyNeeded(params))
     {
-      if (m_GPUSTAT.display_area_color_depth_24)
+      if (params.color_depth_24)
       {
-        CopyOut24Bit(m_24bit_display_format, m_crtc_state.regs.X, vram_offset_y,
-                     m_crtc_state.display_vram_left - m_crtc_state.regs.X, display_width, display_height, 0, false,
-                     false);
+        CopyOut24Bit(m_24bit_display_format, params.src_x, params.src_y, params.skip_x, params.width, params.height,
+                     params.field, params.interlaced, params.interleaved);
       }
       else
       {
-        CopyOut15Bit(m_16bit_display_format, m_crtc_state.display_vram_left, vram_offset_y, display_width,
-                     display_height, 0, false, false);
+        CopyOut15Bit(m_16bit_display_format, params.src_x, params.src_y, params.width, params.height, params.field,
+                     params.interlaced, params.interleaved);
       }
     }
 
@@ -541,7 +360,10 @@ void GPU_SW::UpdateDisplay()
   }
   else
   {
-    CopyOut15Bit(m_16bit_display_format, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, 0, false, false);
+    const DisplayCopyParameters params = {0, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, 0, false, false, false, true};
+    if (IsDisplayCopyNeeded(params))
+      CopyOut15Bit(m_16bit_display_format, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, 0, false, false);
+
     m_host_display->SetDisplayParameters(VRAM_WIDTH, VRAM_HEIGHT, 0, 0, VRAM_WIDTH, VRAM_HEIGHT,
                                          static_cast<float>(VRAM_WIDTH) / static_cast<float>(VRAM_HEIGHT));
   }
@@ -575,6 +397,13 @@ void GPU_SW::DispatchRenderCommand()
     m_drawing_area_changed = false;
   }
 
+  // primitives are clipped to the drawing area, which is inclusive
+  if (m_drawing_area.right >= m_drawing_area.left && m_drawing_area.bottom >= m_drawing_area.top)
+  {
+    InvalidateDisplay(m_drawing_area.left, m_drawing_area.top, m_drawing_area.right - m_drawing_area.left + 1,
+                      m_drawing_area.bottom - m_drawing_area.top + 1);
+  }
+
   const GPURenderCommand rc{m_render_command.bits};
   const bool dithering_enable = rc.IsDitheringEnabled() && m_GPUSTAT.dither_enable;
 
@@ -593,7 +422,7 @@ void GPU_SW::DispatchRenderCommand()
       {
         GPUBackendDrawPolygonCommand::Vertex* vert = &cmd->vertices[i];
         vert->color = (shaded && i > 0) ? (FifoPop() & UINT32_C(0x00FFFFFF)) : first_color;
-        const u64 maddr_and_pos = m_fifo.Pop();
+        const u64 maddr_and_pos = FifoPopWithAddress();
         const GPUVertexPosition vp{Truncate32(maddr_and_pos)};
         vert->x = m_drawing_offset.x + vp.x;
         vert->y = m_drawing_offset.y + vp.y;
@@ -838,6 +667,8 @@ void GPU_SW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 
 void GPU_SW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
+  InvalidateDisplay(x, y, width, height);
+
   GPUBackendFillVRAMCommand* cmd = m_backend.NewFillVRAMCommand();
   FillBackendCommandParameters(cmd);
   cmd->x = static_cast<u16>(x);
@@ -850,6 +681,8 @@ void GPU_SW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 
 void GPU_SW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask)
 {
+  InvalidateDisplay(x, y, width, height);
+
   const u32 num_words = width * height;
   GPUBackendUpdateVRAMCommand* cmd = m_backend.NewUpdateVRAMCommand(num_words);
   FillBackendCommandParameters(cmd);
@@ -865,6 +698,8 @@ void GPU_SW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, b
 
 void GPU_SW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  InvalidateDisplay(dst_x, dst_y, width, height);
+
   GPUBackendCopyVRAMCommand* cmd = m_backend.NewCopyVRAMCommand();
   FillBackendCommandParameters(cmd);
   cmd->src_x = static_cast<u16>(src_x);
@@ -876,6 +711,24 @@ void GPU_SW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
   m_backend.PushCommand(cmd);
 }
 
+void GPU_SW::DrawRendererStats(bool is_idle_frame)
+{
+#ifdef WITH_IMGUI
+  if (ImGui::CollapsingHeader("Renderer Statistics", ImGuiTreeNodeFlags_DefaultOpen))
+  {
+    ImGui::Columns(2);
+    ImGui::SetColumnWidth(0, 200.0f * ImGui::GetIO().DisplayFramebufferScale.x);
+
+    ImGui::TextUnformatted("Display Copies/Skipped:");
+    ImGui::NextColumn();
+    ImGui::Text("%u / %u", m_num_display_copies, m_num_display_copies_skipped);
+    ImGui::NextColumn();
+
+    ImGui::Columns(1);
+  }
+#endif
+}
+
 std::unique_ptr<GPU> GPU::CreateSoftwareRenderer()
 {
   return std::make_unique<GPU_SW>();
@@ -22,6 +22,22 @@ public:
   void UpdateSettings() override;
 
 protected:
+  struct DisplayCopyParameters
+  {
+    u32 src_x;
+    u32 src_y;
+    u32 skip_x;
+    u32 width;
+    u32 height;
+    u32 field;
+    bool color_depth_24;
+    bool interlaced;
+    bool interleaved;
+    bool show_vram;
+
+    bool operator==(const DisplayCopyParameters& rhs) const;
+  };
+
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask) override;
@@ -41,6 +57,14 @@ protected:
   void ClearDisplay() override;
   void UpdateDisplay() override;
 
+  /// Marks the display as needing to be copied out again if the VRAM rectangle overlaps the last area copied.
+  void InvalidateDisplay(u32 x, u32 y, u32 width, u32 height);
+
+  /// Returns false if the display has not changed since it was last copied out with the same parameters.
+  bool IsDisplayCopyNeeded(const DisplayCopyParameters& params);
+
+  void DrawRendererStats(bool is_idle_frame) override;
+
   void DispatchRenderCommand() override;
 
   void FillBackendCommandParameters(GPUBackendCommand* cmd);
@@ -50,5 +74,10 @@ protected:
   HostDisplayPixelFormat m_16bit_display_format = HostDisplayPixelFormat::RGB565;
   HostDisplayPixelFormat m_24bit_display_format = HostDisplayPixelFormat::RGBA8;
 
+  DisplayCopyParameters m_last_display_copy = {};
+  bool m_display_dirty = true;
+  u32 m_num_display_copies = 0;
+  u32 m_num_display_copies_skipped = 0;
+
   GPU_SW_Backend m_backend;
 };
@@ -0,0 +1,460 @@
+#pragma once
+#include "common/align.h"
+#include "common/cpu_detect.h"
+#include "gpu_types.h"
+#include "host_display.h"
+#include <algorithm>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+// Row conversions from VRAM to the host display formats, used by the software renderer's display copy-out. The SIMD
+// paths are checked against the per-pixel conversions in common-tests.
+
+template<HostDisplayPixelFormat out_format, typename out_type>
+static void CopyOutRow16(const u16* src_ptr, out_type* dst_ptr, u32 width);
+
+template<HostDisplayPixelFormat out_format, typename out_type>
+static out_type VRAM16ToOutput(u16 value);
+
+template<>
+ALWAYS_INLINE u16 VRAM16ToOutput<HostDisplayPixelFormat::RGBA5551, u16>(u16 value)
+{
+  return (value & 0x3E0) | ((value >> 10) & 0x1F) | ((value & 0x1F) << 10);
+}
+
+template<>
+ALWAYS_INLINE u16 VRAM16ToOutput<HostDisplayPixelFormat::RGB565, u16>(u16 value)
+{
+  return ((value & 0x3E0) << 1) | ((value & 0x20) << 1) | ((value >> 10) & 0x1F) | ((value & 0x1F) << 11);
+}
+
+template<>
+ALWAYS_INLINE u32 VRAM16ToOutput<HostDisplayPixelFormat::RGBA8, u32>(u16 value)
+{
+  u8 r = Truncate8(value & 31);
+  u8 g = Truncate8((value >> 5) & 31);
+  u8 b = Truncate8((value >> 10) & 31);
+
+  // 00012345 -> 1234545
+  b = (b << 3) | (b & 0b111);
+  g = (g << 3) | (g & 0b111);
+  r = (r << 3) | (r & 0b111);
+
+  return ZeroExtend32(r) | (ZeroExtend32(g) << 8) | (ZeroExtend32(b) << 16) | (0xFF000000u);
+}
+
+template<>
+ALWAYS_INLINE u32 VRAM16ToOutput<HostDisplayPixelFormat::BGRA8, u32>(u16 value)
+{
+  u8 r = Truncate8(value & 31);
+  u8 g = Truncate8((value >> 5) & 31);
+  u8 b = Truncate8((value >> 10) & 31);
+
+  // 00012345 -> 1234545
+  b = (b << 3) | (b & 0b111);
+  g = (g << 3) | (g & 0b111);
+  r = (r << 3) | (r & 0b111);
+
+  return ZeroExtend32(b) | (ZeroExtend32(g) << 8) | (ZeroExtend32(r) << 16) | (0xFF000000u);
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGBA5551, u16>(const u16* src_ptr, u16* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const __m128i single_mask = _mm_set1_epi16(0x1F);
+    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+    src_ptr += 8;
+    __m128i a = _mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x3E0))));
+    __m128i b = _mm_and_si128(_mm_srli_epi16(value, 10), single_mask);
+    __m128i c = _mm_slli_epi16(_mm_and_si128(value, single_mask), 10);
+    value = _mm_or_si128(_mm_or_si128(a, b), c);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8_t single_mask = vdupq_n_u16(0x1F);
+    uint16x8_t value = vld1q_u16(src_ptr);
+    src_ptr += 8;
+    uint16x8_t a = vandq_u16(value, vdupq_n_u16(0x3E0));
+    uint16x8_t b = vandq_u16(vshrq_n_u16(value, 10), single_mask);
+    uint16x8_t c = vshlq_n_u16(vandq_u16(value, single_mask), 10);
+    value = vorrq_u16(vorrq_u16(a, b), c);
+    vst1q_u16(dst_ptr, value);
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::RGBA5551, u16>(*(src_ptr++));
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGB565, u16>(const u16* src_ptr, u16* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const __m128i single_mask = _mm_set1_epi16(0x1F);
+    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+    src_ptr += 8;
+    __m128i a = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x3E0)))), 1);
+    __m128i b = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0x20)))), 1);
+    __m128i c = _mm_and_si128(_mm_srli_epi16(value, 10), single_mask);
+    __m128i d = _mm_slli_epi16(_mm_and_si128(value, single_mask), 11);
+    value = _mm_or_si128(_mm_or_si128(_mm_or_si128(a, b), c), d);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  const uint16x8_t single_mask = vdupq_n_u16(0x1F);
+  for (; col < aligned_width; col += 8)
+  {
+    uint16x8_t value = vld1q_u16(src_ptr);
+    src_ptr += 8;
+    uint16x8_t a = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x3E0)), 1); // (value & 0x3E0) << 1
+    uint16x8_t b = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x20)), 1);  // (value & 0x20) << 1
+    uint16x8_t c = vandq_u16(vshrq_n_u16(value, 10), single_mask);       // ((value >> 10) & 0x1F)
+    uint16x8_t d = vshlq_n_u16(vandq_u16(value, single_mask), 11);       // ((value & 0x1F) << 11)
+    value = vorrq_u16(vorrq_u16(vorrq_u16(a, b), c), d);
+    vst1q_u16(dst_ptr, value);
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+    *(dst_ptr++) = VRAM16ToOutput<HostDisplayPixelFormat::RGB565, u16>(*(src_ptr++));
+}
+
+#if defined(CPU_X64)
+
+// 00012345 -> 12345345, in each 16-bit lane.
+ALWAYS_INLINE static __m128i Expand5To8(__m128i value)
+{
+  return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_and_si128(value, _mm_set1_epi16(0x7)));
+}
+
+// Gathers four packed 24-bit pixels into the low three bytes of each 32-bit lane. Reads 16 bytes.
+ALWAYS_INLINE static __m128i Load24BitPixels(const u8* ptr)
+{
+  const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+  const __m128i p01 = _mm_unpacklo_epi32(value, _mm_srli_si128(value, 3));
+  const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(value, 6), _mm_srli_si128(value, 9));
+  return _mm_unpacklo_epi64(p01, p23);
+}
+
+// SSE2 only has a signed 32->16 pack, so sign-extend the low halves first to pass them through unsaturated.
+ALWAYS_INLINE static __m128i PackLow16(__m128i lo, __m128i hi)
+{
+  return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+#elif defined(CPU_AARCH64)
+
+// 00012345 -> 12345345, in each 16-bit lane.
+ALWAYS_INLINE static uint16x8_t Expand5To8(uint16x8_t value)
+{
+  return vorrq_u16(vshlq_n_u16(value, 3), vandq_u16(value, vdupq_n_u16(0x7)));
+}
+
+#endif
+
+template<HostDisplayPixelFormat out_format>
+ALWAYS_INLINE static void CopyOutRow16To32(const u16* src_ptr, u32* dst_ptr, u32 width)
+{
+  constexpr bool bgra = (out_format == HostDisplayPixelFormat::BGRA8);
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  const __m128i single_mask = _mm_set1_epi16(0x1F);
+  const __m128i alpha = _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xFF00)));
+  for (; col < aligned_width; col += 8)
+  {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+    src_ptr += 8;
+    const __m128i r = Expand5To8(_mm_and_si128(value, single_mask));
+    const __m128i g = Expand5To8(_mm_and_si128(_mm_srli_epi16(value, 5), single_mask));
+    const __m128i b = Expand5To8(_mm_and_si128(_mm_srli_epi16(value, 10), single_mask));
+
+    // interleave (r | g << 8) and (b | 0xFF00) to form the 32-bit pixels
+    const __m128i low = _mm_or_si128(bgra ? b : r, _mm_slli_epi16(g, 8));
+    const __m128i high = _mm_or_si128(bgra ? r : b, alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_unpacklo_epi16(low, high));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), _mm_unpackhi_epi16(low, high));
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  const uint16x8_t single_mask = vdupq_n_u16(0x1F);
+  const uint16x8_t alpha = vdupq_n_u16(0xFF00);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8_t value = vld1q_u16(src_ptr);
+    src_ptr += 8;
+    const uint16x8_t r = Expand5To8(vandq_u16(value, single_mask));
+    const uint16x8_t g = Expand5To8(vandq_u16(vshrq_n_u16(value, 5), single_mask));
+    const uint16x8_t b = Expand5To8(vandq_u16(vshrq_n_u16(value, 10), single_mask));
+
+    uint16x8x2_t out;
+    out.val[0] = vorrq_u16(bgra ? b : r, vshlq_n_u16(g, 8));
+    out.val[1] = vorrq_u16(bgra ? r : b, alpha);
+    vst2q_u16(reinterpret_cast<u16*>(dst_ptr), out);
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+    *(dst_ptr++) = VRAM16ToOutput<out_format, u32>(*(src_ptr++));
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::RGBA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
+{
+  CopyOutRow16To32<HostDisplayPixelFormat::RGBA8>(src_ptr, dst_ptr, width);
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow16<HostDisplayPixelFormat::BGRA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
+{
+  CopyOutRow16To32<HostDisplayPixelFormat::BGRA8>(src_ptr, dst_ptr, width);
+}
+
+template<HostDisplayPixelFormat out_format, typename out_type>
+static void CopyOutRow24(const u8* src_ptr, out_type* dst_ptr, u32 width);
+
+template<HostDisplayPixelFormat out_format, typename out_type>
+static out_type RGB24ToOutput(const u8* src_ptr);
+
+template<>
+ALWAYS_INLINE u16 RGB24ToOutput<HostDisplayPixelFormat::RGBA5551, u16>(const u8* src_ptr)
+{
+  return ((static_cast<u16>(src_ptr[0]) >> 3) << 10) | ((static_cast<u16>(src_ptr[1]) >> 3) << 5) |
+         (static_cast<u16>(src_ptr[2]) >> 3);
+}
+
+template<>
+ALWAYS_INLINE u16 RGB24ToOutput<HostDisplayPixelFormat::RGB565, u16>(const u8* src_ptr)
+{
+  return ((static_cast<u16>(src_ptr[0]) >> 3) << 11) | ((static_cast<u16>(src_ptr[1]) >> 2) << 5) |
+         (static_cast<u16>(src_ptr[2]) >> 3);
+}
+
+template<>
+ALWAYS_INLINE u32 RGB24ToOutput<HostDisplayPixelFormat::RGBA8, u32>(const u8* src_ptr)
+{
+  return ZeroExtend32(src_ptr[0]) | (ZeroExtend32(src_ptr[1]) << 8) | (ZeroExtend32(src_ptr[2]) << 16) | 0xFF000000u;
+}
+
+template<>
+ALWAYS_INLINE u32 RGB24ToOutput<HostDisplayPixelFormat::BGRA8, u32>(const u8* src_ptr)
+{
+  return ZeroExtend32(src_ptr[2]) | (ZeroExtend32(src_ptr[1]) << 8) | (ZeroExtend32(src_ptr[0]) << 16) | 0xFF000000u;
+}
+
+template<HostDisplayPixelFormat out_format>
+ALWAYS_INLINE static void CopyOutRow24To32(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  constexpr bool bgra = (out_format == HostDisplayPixelFormat::BGRA8);
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  // The second load reads four bytes past the 24 consumed. Stop early enough to stay within the row, which may be the
+  // last one in VRAM.
+  const __m128i alpha = _mm_set1_epi32(static_cast<s32>(0xFF000000u));
+  for (; (col + 10) <= width; col += 8)
+  {
+    __m128i p0 = _mm_or_si128(Load24BitPixels(src_ptr), alpha);
+    __m128i p1 = _mm_or_si128(Load24BitPixels(src_ptr + 12), alpha);
+    src_ptr += 24;
+    if constexpr (bgra)
+    {
+      const __m128i ag_mask = _mm_set1_epi32(static_cast<s32>(0xFF00FF00u));
+      const __m128i byte_mask = _mm_set1_epi32(0xFF);
+      p0 = _mm_or_si128(_mm_or_si128(_mm_and_si128(p0, ag_mask), _mm_and_si128(_mm_srli_epi32(p0, 16), byte_mask)),
+                        _mm_slli_epi32(_mm_and_si128(p0, byte_mask), 16));
+      p1 = _mm_or_si128(_mm_or_si128(_mm_and_si128(p1, ag_mask), _mm_and_si128(_mm_srli_epi32(p1, 16), byte_mask)),
+                        _mm_slli_epi32(_mm_and_si128(p1, byte_mask), 16));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), p0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), p1);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 16);
+  for (; col < aligned_width; col += 16)
+  {
+    const uint8x16x3_t rgb = vld3q_u8(src_ptr);
+    src_ptr += 48;
+
+    uint8x16x4_t out;
+    out.val[0] = rgb.val[bgra ? 2 : 0];
+    out.val[1] = rgb.val[1];
+    out.val[2] = rgb.val[bgra ? 0 : 2];
+    out.val[3] = vdupq_n_u8(0xFF);
+    vst4q_u8(reinterpret_cast<u8*>(dst_ptr), out);
+    dst_ptr += 16;
+  }
+#endif
+
+  for (; col < width; col++)
+  {
+    *(dst_ptr++) = RGB24ToOutput<out_format, u32>(src_ptr);
+    src_ptr += 3;
+  }
+}
+
+template<HostDisplayPixelFormat out_format>
+ALWAYS_INLINE static void CopyOutRow24To16(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  constexpr bool rgb565 = (out_format == HostDisplayPixelFormat::RGB565);
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  // See CopyOutRow24To32() for the loop bound.
+  const __m128i r_mask = _mm_set1_epi32(0xF8);
+  const __m128i g_mask = _mm_set1_epi32(rgb565 ? 0x7E0 : 0x3E0);
+  const __m128i b_mask = _mm_set1_epi32(0x1F);
+  for (; (col + 10) <= width; col += 8)
+  {
+    const __m128i p0 = Load24BitPixels(src_ptr);
+    const __m128i p1 = Load24BitPixels(src_ptr + 12);
+    src_ptr += 24;
+
+    // r in bits 0-7, g in 8-15, b in 16-23
+    __m128i r0, r1, g0, g1;
+    if constexpr (rgb565)
+    {
+      r0 = _mm_slli_epi32(_mm_and_si128(p0, r_mask), 8);
+      r1 = _mm_slli_epi32(_mm_and_si128(p1, r_mask), 8);
+      g0 = _mm_and_si128(_mm_srli_epi32(p0, 5), g_mask);
+      g1 = _mm_and_si128(_mm_srli_epi32(p1, 5), g_mask);
+    }
+    else
+    {
+      r0 = _mm_slli_epi32(_mm_and_si128(p0, r_mask), 7);
+      r1 = _mm_slli_epi32(_mm_and_si128(p1, r_mask), 7);
+      g0 = _mm_and_si128(_mm_srli_epi32(p0, 6), g_mask);
+      g1 = _mm_and_si128(_mm_srli_epi32(p1, 6), g_mask);
+    }
+    const __m128i b0 = _mm_and_si128(_mm_srli_epi32(p0, 19), b_mask);
+    const __m128i b1 = _mm_and_si128(_mm_srli_epi32(p1, 19), b_mask);
+
+    const __m128i value = PackLow16(_mm_or_si128(_mm_or_si128(r0, g0), b0), _mm_or_si128(_mm_or_si128(r1, g1), b1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint8x8x3_t rgb = vld3_u8(src_ptr);
+    src_ptr += 24;
+
+    const uint16x8_t r = vshlq_n_u16(vmovl_u8(vshr_n_u8(rgb.val[0], 3)), rgb565 ? 11 : 10);
+    const uint16x8_t g = rgb565 ? vshlq_n_u16(vmovl_u8(vshr_n_u8(rgb.val[1], 2)), 5) :
+                                  vshlq_n_u16(vmovl_u8(vshr_n_u8(rgb.val[1], 3)), 5);
+    const uint16x8_t b = vmovl_u8(vshr_n_u8(rgb.val[2], 3));
+    vst1q_u16(dst_ptr, vorrq_u16(vorrq_u16(r, g), b));
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+  {
+    *(dst_ptr++) = RGB24ToOutput<out_format, u16>(src_ptr);
+    src_ptr += 3;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<HostDisplayPixelFormat::RGBA5551, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  CopyOutRow24To16<HostDisplayPixelFormat::RGBA5551>(src_ptr, dst_ptr, width);
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<HostDisplayPixelFormat::RGB565, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  CopyOutRow24To16<HostDisplayPixelFormat::RGB565>(src_ptr, dst_ptr, width);
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<HostDisplayPixelFormat::RGBA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  CopyOutRow24To32<HostDisplayPixelFormat::RGBA8>(src_ptr, dst_ptr, width);
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<HostDisplayPixelFormat::BGRA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  CopyOutRow24To32<HostDisplayPixelFormat::BGRA8>(src_ptr, dst_ptr, width);
+}
+
+/// Copies a 15-bit row which wraps around the right edge of VRAM, as the contiguous spans either side of the wrap.
+template<HostDisplayPixelFormat out_format, typename out_type>
+ALWAYS_INLINE static void CopyOutRow16Wrapped(const u16* src_row_ptr, u32 src_x, out_type* dst_ptr, u32 width)
+{
+  const u32 end_x = src_x + width;
+  for (u32 col = src_x; col < end_x;)
+  {
+    const u32 vram_x = col % VRAM_WIDTH;
+    const u32 count = std::min(end_x - col, VRAM_WIDTH - vram_x);
+    CopyOutRow16<out_format>(src_row_ptr + vram_x, dst_ptr, count);
+    dst_ptr += count;
+    col += count;
+  }
+}
+
+/// Copies a 24-bit row which wraps around the right edge of VRAM. Pixels can straddle the wrap, so this goes a pixel
+/// at a time.
+template<HostDisplayPixelFormat out_format, typename out_type>
+ALWAYS_INLINE static void CopyOutRow24Wrapped(const u16* src_row_ptr, u32 src_x, u32 skip_x, out_type* dst_ptr,
+                                              u32 width)
+{
+  for (u32 col = 0; col < width; col++)
+  {
+    const u32 offset = (src_x + (((skip_x + col) * 3) / 2));
+    const u16 s0 = src_row_ptr[offset % VRAM_WIDTH];
+    const u16 s1 = src_row_ptr[(offset + 1) % VRAM_WIDTH];
+    const u8 shift = static_cast<u8>((skip_x + col) & 1u) * 8;
+    const u32 rgb = (((ZeroExtend32(s1) << 16) | ZeroExtend32(s0)) >> shift);
+
+    if constexpr (out_format == HostDisplayPixelFormat::RGBA8)
+    {
+      *(dst_ptr++) = rgb | 0xFF000000u;
+    }
+    else if constexpr (out_format == HostDisplayPixelFormat::BGRA8)
+    {
+      *(dst_ptr++) = (rgb & 0x00FF00) | ((rgb & 0xFF) << 16) | ((rgb >> 16) & 0xFF) | 0xFF000000u;
+    }
+    else if constexpr (out_format == HostDisplayPixelFormat::RGB565)
+    {
+      *(dst_ptr++) = Truncate16(((rgb & 0xF8) << 8) | ((rgb >> 5) & 0x7E0) | ((rgb >> 19) & 0x1F));
+    }
+    else if constexpr (out_format == HostDisplayPixelFormat::RGBA5551)
+    {
+      *(dst_ptr++) = Truncate16(((rgb & 0xF8) << 7) | ((rgb >> 6) & 0x3E0) | ((rgb >> 19) & 0x1F));
+    }
+  }
+}
@@ -6,13 +6,15 @@
 #include "common/string_util.h"
 #include "common/timer.h"
 #include "host_interface.h"
+#include "image_write_queue.h"
 #include "stb_image.h"
 #include "stb_image_resize.h"
 #include "stb_image_write.h"
+#include "xxhash.h"
 #include <cerrno>
 #include <cmath>
 #include <cstring>
-#include <thread>
+#include <memory>
 #include <vector>
 Log_SetChannel(HostDisplay);
 
@@ -86,11 +88,90 @@ bool HostDisplay::SetDisplayPixels(HostDisplayPixelFormat format, u32 width, u32
   return true;
 }
 
+bool HostDisplay::BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x,
+                                     u32 y, u32 width, u32 height)
+{
+  DebugAssert(slot < MAX_ASYNC_DOWNLOAD_SLOTS);
+  AsyncDownloadBuffer& buffer = m_async_download_buffers[slot];
+  buffer.row_size = width * GetDisplayPixelFormatSize(texture_format);
+  buffer.stride = Common::AlignUpPow2(buffer.row_size, 4);
+  buffer.height = height;
+  buffer.data.resize(buffer.stride * height);
+  if (!DownloadTexture(texture_handle, texture_format, x, y, width, height, buffer.data.data(), buffer.stride))
+  {
+    buffer.height = 0;
+    return false;
+  }
+
+  return true;
+}
+
+bool HostDisplay::EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride)
+{
+  DebugAssert(slot < MAX_ASYNC_DOWNLOAD_SLOTS);
+  AsyncDownloadBuffer& buffer = m_async_download_buffers[slot];
+  if (buffer.height == 0)
+    return false;
+
+  const u8* src_ptr = buffer.data.data();
+  u8* dst_ptr = static_cast<u8*>(out_data);
+  for (u32 row = 0; row < buffer.height; row++)
+  {
+    std::memcpy(dst_ptr, src_ptr, buffer.row_size);
+    src_ptr += buffer.stride;
+    dst_ptr += out_data_stride;
+  }
+
+  buffer.height = 0;
+  return true;
+}
+
+void HostDisplay::DestroyAsyncDownloads()
+{
+  for (AsyncDownloadBuffer& buffer : m_async_download_buffers)
+    buffer = {};
+}
+
+bool HostDisplay::DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height)
+{
+  return false;
+}
+
+bool HostDisplay::GetHeadlessOutputHash(u64* hash)
+{
+  std::vector<u32> pixels;
+  u32 width, height;
+  if (!DownloadHeadlessOutput(&pixels, &width, &height))
+    return false;
+
+  // include the size, otherwise a resize which happens to produce the same data would go unnoticed
+  *hash = XXH3_64bits_withSeed(pixels.data(), pixels.size() * sizeof(u32), (static_cast<u64>(width) << 32) | height);
+  return true;
+}
+
 bool HostDisplay::GetHostRefreshRate(float* refresh_rate)
 {
+  // what the display actually does beats a rounded mode from the OS
+  const float measured_refresh_rate = GetMeasuredRefreshRate();
+  if (measured_refresh_rate > 0.0f)
+  {
+    *refresh_rate = measured_refresh_rate;
+    return true;
+  }
+
   return g_host_interface->GetMainDisplayRefreshRate(refresh_rate);
 }
 
+float HostDisplay::GetMeasuredRefreshRate() const
+{
+  return 0.0f;
+}
+
+bool HostDisplay::GetPresentedFrames(std::vector<FrameTimestamps>* frames)
+{
+  return false;
+}
+
 void HostDisplay::SetSoftwareCursor(std::unique_ptr<HostDisplayTexture> texture, float scale /*= 1.0f*/)
 {
   m_cursor_texture = std::move(texture);
@@ -289,8 +370,8 @@ std::tuple<float, float> HostDisplay::ConvertWindowCoordinatesToDisplayCoordinat
   return std::make_tuple(display_x, display_y);
 }
 
-static bool ConvertTextureDataToRGBA8(u32 width, u32 height, std::vector<u32>& texture_data, u32& texture_data_stride,
-                                      HostDisplayPixelFormat format)
+bool HostDisplay::ConvertTextureDataToRGBA8(u32 width, u32 height, std::vector<u32>& texture_data,
+                                            u32& texture_data_stride, HostDisplayPixelFormat format)
 {
   switch (format)
   {
@@ -372,7 +453,7 @@ static bool ConvertTextureDataToRGBA8(u32 width, u32 height, std::vector<u32>& t
   }
 }
 
-static bool CompressAndWriteTextureToFile(u32 width, u32 height, std::string filename, FileSystem::ManagedCFilePtr fp,
+static bool CompressAndWriteTextureToFile(u32 width, u32 height, const std::string& filename, std::FILE* fp,
                                           bool clear_alpha, bool flip_y, u32 resize_width, u32 resize_height,
                                           std::vector<u32> texture_data, u32 texture_data_stride,
                                           HostDisplayPixelFormat texture_format)
@@ -385,7 +466,7 @@ static bool CompressAndWriteTextureToFile(u32 width, u32 height, std::string fil
     return false;
   }
 
-  if (!ConvertTextureDataToRGBA8(width, height, texture_data, texture_data_stride, texture_format))
+  if (!HostDisplay::ConvertTextureDataToRGBA8(width, height, texture_data, texture_data_stride, texture_format))
     return false;
 
   if (clear_alpha)
@@ -433,19 +514,19 @@ static bool CompressAndWriteTextureToFile(u32 width, u32 height, std::string fil
   if (StringUtil::Strcasecmp(extension, ".png") == 0)
   {
     result =
-      (stbi_write_png_to_func(write_func, fp.get(), width, height, 4, texture_data.data(), texture_data_stride) != 0);
+      (stbi_write_png_to_func(write_func, fp, width, height, 4, texture_data.data(), texture_data_stride) != 0);
   }
   else if (StringUtil::Strcasecmp(extension, ".jpg") == 0)
   {
-    result = (stbi_write_jpg_to_func(write_func, fp.get(), width, height, 4, texture_data.data(), 95) != 0);
+    result = (stbi_write_jpg_to_func(write_func, fp, width, height, 4, texture_data.data(), 95) != 0);
   }
   else if (StringUtil::Strcasecmp(extension, ".tga") == 0)
   {
-    result = (stbi_write_tga_to_func(write_func, fp.get(), width, height, 4, texture_data.data()) != 0);
+    result = (stbi_write_tga_to_func(write_func, fp, width, height, 4, texture_data.data()) != 0);
   }
   else if (StringUtil::Strcasecmp(extension, ".bmp") == 0)
   {
-    result = (stbi_write_bmp_to_func(write_func, fp.get(), width, height, 4, texture_data.data()) != 0);
+    result = (stbi_write_bmp_to_func(write_func, fp, width, height, 4, texture_data.data()) != 0);
   }
 
   if (!result)
@@ -479,16 +560,18 @@ bool HostDisplay::WriteTextureToFile(const void* texture_handle, u32 x, u32 y, u
 
   if (!compress_on_thread)
   {
-    return CompressAndWriteTextureToFile(width, height, std::move(filename), std::move(fp), clear_alpha, flip_y,
-                                         resize_width, resize_height, std::move(texture_data), texture_data_stride,
-                                         format);
+    return CompressAndWriteTextureToFile(width, height, filename, fp.get(), clear_alpha, flip_y, resize_width,
+                                         resize_height, std::move(texture_data), texture_data_stride, format);
   }
 
-  std::thread compress_thread(CompressAndWriteTextureToFile, width, height, std::move(filename), std::move(fp),
-                              clear_alpha, flip_y, resize_width, resize_height, std::move(texture_data),
-                              texture_data_stride, format);
-  compress_thread.detach();
-  return true;
+  // screenshots are explicitly requested, so wait for space in the queue rather than dropping them
+  const u32 size = static_cast<u32>(texture_data.size() * sizeof(u32));
+  std::shared_ptr<std::FILE> shared_fp(fp.release(), std::fclose);
+  auto compress_function = [=, texture_data = std::move(texture_data)]() mutable {
+    return CompressAndWriteTextureToFile(width, height, filename, shared_fp.get(), clear_alpha, flip_y, resize_width,
+                                         resize_height, std::move(texture_data), texture_data_stride, format);
+  };
+  return g_image_write_queue.QueueWrite(std::move(filename), 0, size, std::move(compress_function), true);
 }
 
 bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_resolution /* = true */,
@@ -535,6 +618,28 @@ bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_reso
                             static_cast<u32>(resize_width), static_cast<u32>(resize_height), compress_on_thread);
 }
 
+bool HostDisplay::BeginDisplayTextureAsyncDownload(u32 slot, u32* width, u32* height, HostDisplayPixelFormat* format,
+                                                   bool* flip_y)
+{
+  if (!m_display_texture_handle || m_display_texture_view_width <= 0 || m_display_texture_view_height == 0)
+    return false;
+
+  *flip_y = (m_display_texture_view_height < 0);
+  s32 read_height = m_display_texture_view_height;
+  s32 read_y = m_display_texture_view_y;
+  if (*flip_y)
+  {
+    read_height = -m_display_texture_view_height;
+    read_y = (m_display_texture_height - read_height) - (m_display_texture_height - m_display_texture_view_y);
+  }
+
+  *width = static_cast<u32>(m_display_texture_view_width);
+  *height = static_cast<u32>(read_height);
+  *format = m_display_texture_format;
+  return BeginAsyncDownload(slot, m_display_texture_handle, m_display_texture_format,
+                            static_cast<u32>(m_display_texture_view_x), static_cast<u32>(read_y), *width, *height);
+}
+
 bool HostDisplay::WriteDisplayTextureToBuffer(std::vector<u32>* buffer, u32 resize_width /* = 0 */,
                                               u32 resize_height /* = 0 */, bool clear_alpha /* = true */)
 {
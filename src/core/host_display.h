@@ -2,6 +2,9 @@
 #include "common/rectangle.h"
 #include "common/window_info.h"
 #include "types.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <memory>
 #include <string_view>
 #include <tuple>
@@ -50,6 +53,23 @@ public:
     RightOrBottom
   };
 
+  /// Times a frame went through emulation and presentation at, as Common::Timer values.
+  struct FrameTimestamps
+  {
+    u64 frame_start_time;
+    u64 frame_end_time;
+    u64 present_time;
+  };
+
+  enum : u32
+  {
+    MAX_ASYNC_DOWNLOAD_SLOTS = 4,
+
+    // size of the offscreen output when rendering without a window, if the caller didn't give one
+    DEFAULT_HEADLESS_WIDTH = 640,
+    DEFAULT_HEADLESS_HEIGHT = 480
+  };
+
   virtual ~HostDisplay();
 
   ALWAYS_INLINE s32 GetWindowWidth() const { return static_cast<s32>(m_window_info.surface_width); }
@@ -100,9 +120,24 @@ public:
   virtual bool DownloadTexture(const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y,
                                u32 width, u32 height, void* out_data, u32 out_data_stride) = 0;
 
+  /// Starts downloading a texture region into a slot without waiting for it. The data is retrieved with
+  /// EndAsyncDownload(), ideally a few frames later so the GPU has finished the copy. The default implementation
+  /// downloads synchronously.
+  virtual bool BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x,
+                                  u32 y, u32 width, u32 height);
+  virtual bool EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride);
+  virtual void DestroyAsyncDownloads();
+
   /// Returns false if the window was completely occluded.
   virtual bool Render() = 0;
 
+  /// Reads back what the last Render() drew when there is no window, as top-down RGBA8 rows. Returns false when
+  /// presenting to a window, since there is nothing to read back.
+  virtual bool DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height);
+
+  /// Hashes the last headless frame, so runs can be compared without keeping the images around.
+  bool GetHeadlessOutputHash(u64* hash);
+
   virtual void SetVSync(bool enabled) = 0;
 
   const s32 GetDisplayTopMargin() const { return m_display_top_margin; }
@@ -110,6 +145,16 @@ public:
   const s32 GetDisplayHeight() const { return m_display_height; }
   const float GetDisplayAspectRatio() const { return m_display_aspect_ratio; }
 
+  /// Size of the visible part of the display texture, i.e. what WriteDisplayTextureToBuffer() produces unscaled.
+  u32 GetDisplayTextureViewWidth() const
+  {
+    return m_display_texture_handle ? static_cast<u32>(std::max(m_display_texture_view_width, 0)) : 0;
+  }
+  u32 GetDisplayTextureViewHeight() const
+  {
+    return m_display_texture_handle ? static_cast<u32>(std::abs(m_display_texture_view_height)) : 0;
+  }
+
   void SetDisplayMaxFPS(float max_fps);
   bool ShouldSkipDisplayingFrame();
 
@@ -171,8 +216,24 @@ public:
   virtual void EndSetDisplayPixels() = 0;
   virtual bool SetDisplayPixels(HostDisplayPixelFormat format, u32 width, u32 height, const void* buffer, u32 pitch);
 
+  /// Prefers the refresh rate measured by the display, falling back to what the host interface reports.
   virtual bool GetHostRefreshRate(float* refresh_rate);
 
+  /// Host refresh rate measured from presents which were held back by vsync, or zero when the display presents from
+  /// Render() or hasn't seen enough of them yet.
+  virtual float GetMeasuredRefreshRate() const;
+
+  /// Stamps the frame which the next Render() shows, so its latency can be followed through to the present.
+  void SetFrameTimestamps(u64 frame_start_time, u64 frame_end_time)
+  {
+    m_next_frame_timestamps.frame_start_time = frame_start_time;
+    m_next_frame_timestamps.frame_end_time = frame_end_time;
+  }
+
+  /// Moves the timestamps of the frames presented since the last call into frames. Returns false if Render() presents
+  /// by itself, in which case the caller should take the present time when it returns.
+  virtual bool GetPresentedFrames(std::vector<FrameTimestamps>* frames);
+
   void SetDisplayLinearFiltering(bool enabled) { m_display_linear_filtering = enabled; }
   void SetDisplayTopMargin(s32 height) { m_display_top_margin = height; }
   void SetDisplayIntegerScaling(bool enabled) { m_display_integer_scaling = enabled; }
@@ -212,6 +273,15 @@ public:
   bool WriteDisplayTextureToBuffer(std::vector<u32>* buffer, u32 resize_width = 0, u32 resize_height = 0,
                                    bool clear_alpha = true);
 
+  /// Starts an asynchronous download of the visible part of the display texture. If flip_y is set, the rows come
+  /// back bottom-up.
+  bool BeginDisplayTextureAsyncDownload(u32 slot, u32* width, u32* height, HostDisplayPixelFormat* format,
+                                        bool* flip_y);
+
+  /// Converts downloaded texture data to RGBA8 in place, the stride is updated if the data is reallocated.
+  static bool ConvertTextureDataToRGBA8(u32 width, u32 height, std::vector<u32>& texture_data,
+                                        u32& texture_data_stride, HostDisplayPixelFormat format);
+
 protected:
   ALWAYS_INLINE bool HasSoftwareCursor() const { return static_cast<bool>(m_cursor_texture); }
   ALWAYS_INLINE bool HasDisplayTexture() const { return (m_display_texture_handle != nullptr); }
@@ -227,6 +297,9 @@ protected:
 
   u64 m_last_frame_displayed_time = 0;
 
+  // stamped by the emulation, taken by the next Render() so frames shown again while paused aren't timed twice
+  FrameTimestamps m_next_frame_timestamps = {};
+
   s32 m_mouse_position_x = 0;
   s32 m_mouse_position_y = 0;
 
@@ -257,4 +330,16 @@ protected:
   bool m_display_linear_filtering = false;
   bool m_display_changed = false;
   bool m_display_integer_scaling = false;
+
+private:
+  // used by the default (synchronous) async download implementation
+  struct AsyncDownloadBuffer
+  {
+    std::vector<u8> data;
+    u32 row_size = 0;
+    u32 stride = 0;
+    u32 height = 0;
+  };
+
+  std::array<AsyncDownloadBuffer, MAX_ASYNC_DOWNLOAD_SLOTS> m_async_download_buffers;
 };
@@ -142,6 +142,10 @@ void HostInterface::PauseSystem(bool paused)
   if (paused == System::IsPaused() || System::IsShutdown())
     return;
 
+  // the paused image should be the current frame, not the last one which was rendered
+  if (paused)
+    System::UpdateSkippedFrameDisplay();
+
   System::SetState(paused ? System::State::Paused : System::State::Running);
   if (!paused)
     m_audio_stream->EmptyBuffers();
@@ -466,6 +470,21 @@ void HostInterface::OnRunningGameChanged() {}
 
 void HostInterface::OnControllerTypeChanged(u32 slot) {}
 
+void HostInterface::OnMoviePlaybackStopped(u32 frame_count, u32 desync_count)
+{
+  if (desync_count > 0)
+  {
+    AddFormattedOSDMessage(10.0f,
+                           TranslateString("OSDMessage", "Movie playback stopped after %u frames, %u frames desynced."),
+                           frame_count, desync_count);
+  }
+  else
+  {
+    AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Movie playback stopped after %u frames."),
+                           frame_count);
+  }
+}
+
 std::string HostInterface::GetShaderCacheBasePath() const
 {
   return GetUserDirectoryRelativePath("cache/");
@@ -535,6 +554,7 @@ void HostInterface::SetDefaultSettings(SettingsInterface& si)
   si.SetBoolValue("Display", "ShowVPS", false);
   si.SetBoolValue("Display", "ShowSpeed", false);
   si.SetBoolValue("Display", "ShowResolution", false);
+  si.SetBoolValue("Display", "ShowPresentLatency", false);
   si.SetBoolValue("Display", "Fullscreen", false);
   si.SetBoolValue("Display", "VSync", true);
   si.SetStringValue("Display", "PostProcessChain", "");
@@ -748,6 +768,10 @@ void HostInterface::CheckForSettingsChanges(const Settings& old_settings)
         g_settings.gpu_force_ntsc_timings != old_settings.gpu_force_ntsc_timings ||
         g_settings.gpu_24bit_chroma_smoothing != old_settings.gpu_24bit_chroma_smoothing ||
         g_settings.gpu_downsample_mode != old_settings.gpu_downsample_mode ||
+        g_settings.gpu_async_pipeline_compilation != old_settings.gpu_async_pipeline_compilation ||
+        g_settings.gpu_palette_texture_cache != old_settings.gpu_palette_texture_cache ||
+        g_settings.gpu_vulkan_render_thread != old_settings.gpu_vulkan_render_thread ||
+        g_settings.gpu_sprite_instancing != old_settings.gpu_sprite_instancing ||
         g_settings.display_crop_mode != old_settings.display_crop_mode ||
         g_settings.display_aspect_ratio != old_settings.display_aspect_ratio ||
         g_settings.gpu_pgxp_enable != old_settings.gpu_pgxp_enable ||
@@ -795,7 +819,10 @@ void HostInterface::CheckForSettingsChanges(const Settings& old_settings)
 
     if (g_settings.texture_replacements.enable_vram_write_replacements !=
           old_settings.texture_replacements.enable_vram_write_replacements ||
-        g_settings.texture_replacements.preload_textures != old_settings.texture_replacements.preload_textures)
+        g_settings.texture_replacements.preload_textures != old_settings.texture_replacements.preload_textures ||
+        g_settings.texture_replacements.async_loading != old_settings.texture_replacements.async_loading ||
+        g_settings.texture_replacements.prefetch_textures != old_settings.texture_replacements.prefetch_textures ||
+        g_settings.texture_replacements.memory_budget_mb != old_settings.texture_replacements.memory_budget_mb)
     {
       g_texture_replacements.Reload();
     }
@@ -74,6 +74,9 @@ public:
   virtual void AddOSDMessage(std::string message, float duration = 2.0f);
   void AddFormattedOSDMessage(float duration, const char* format, ...);
 
+  /// Queues a callback to run on the emulation thread. Can be called from any thread.
+  virtual void RunLater(std::function<void()> callback) = 0;
+
   /// Returns the base user directory path.
   ALWAYS_INLINE const std::string& GetUserDirectory() const { return m_user_directory; }
 
@@ -145,6 +148,7 @@ public:
 
   virtual void OnRunningGameChanged();
   virtual void OnSystemPerformanceCountersUpdated();
+  virtual void OnMoviePlaybackStopped(u32 frame_count, u32 desync_count);
 
 protected:
   virtual bool AcquireHostDisplay() = 0;
@@ -0,0 +1,189 @@
+#include "image_write_queue.h"
+#include "common/image.h"
+#include "common/log.h"
+#include "gpu_types.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+Log_SetChannel(ImageWriteQueue);
+
+ImageWriteQueue g_image_write_queue;
+
+ImageWriteQueue::ImageWriteQueue() = default;
+
+ImageWriteQueue::~ImageWriteQueue()
+{
+  Shutdown();
+}
+
+bool ImageWriteQueue::HasQueuedHash(u64 hash)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return (m_queued_hashes.find(hash) != m_queued_hashes.end());
+}
+
+bool ImageWriteQueue::CanQueue(u32 size) const
+{
+  // always let one write through, no matter how large it is
+  return m_queue.empty() || (m_queue.size() < MAX_QUEUED_WRITES && (m_queued_bytes + size) <= MAX_QUEUED_BYTES);
+}
+
+bool ImageWriteQueue::QueueWrite(std::string filename, u64 hash, u32 size, WriteFunction function,
+                                 bool wait_if_full /* = false */)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (hash != 0 && !m_queued_hashes.insert(hash).second)
+  {
+    m_stats.num_duplicates++;
+    return false;
+  }
+
+  if (!CanQueue(size))
+  {
+    if (!wait_if_full)
+    {
+      // forget the hash, so the image can be dumped next time it's seen
+      if (hash != 0)
+        m_queued_hashes.erase(hash);
+
+      m_stats.num_dropped++;
+      if ((m_stats.num_dropped % 100) == 1)
+      {
+        Log_WarningPrintf("Image write queue is full, dropping '%s' (%u dropped so far)", filename.c_str(),
+                          m_stats.num_dropped);
+      }
+
+      return false;
+    }
+
+    m_done_cv.wait(lock, [this, size]() { return CanQueue(size); });
+  }
+
+  if (!m_worker_thread.joinable())
+  {
+    m_shutdown = false;
+    m_worker_thread = std::thread(&ImageWriteQueue::WorkerThreadEntryPoint, this);
+  }
+
+  m_queue.push_back(QueuedWrite{std::move(filename), std::move(function), size});
+  m_queued_bytes += size;
+  m_stats.queue_depth = static_cast<u32>(m_queue.size());
+  m_stats.max_queue_depth = std::max(m_stats.max_queue_depth, m_stats.queue_depth);
+  m_work_cv.notify_one();
+  return true;
+}
+
+bool ImageWriteQueue::QueueVRAMWrite(std::string filename, u64 hash, u32 width, u32 height, u32 stride,
+                                     const void* pixels, bool force_opaque, bool wait /* = false */)
+{
+  if (hash != 0 && HasQueuedHash(hash))
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stats.num_duplicates++;
+    return false;
+  }
+
+  // only the copy happens here, the conversion is left to the worker
+  std::vector<u16> data(width * height);
+  const u8* src_ptr = static_cast<const u8*>(pixels);
+  for (u32 row = 0; row < height; row++)
+  {
+    std::memcpy(&data[row * width], src_ptr, sizeof(u16) * width);
+    src_ptr += stride;
+  }
+
+  const u32 size = static_cast<u32>(data.size() * sizeof(u16));
+  auto function = [filename, data = std::move(data), width, height, force_opaque]() {
+    Common::RGBA8Image image;
+    image.SetSize(width, height);
+
+    const u16 alpha_mask = force_opaque ? 0x8000 : 0;
+    u32* dst_ptr = image.GetPixels();
+    for (const u16 pixel : data)
+      *(dst_ptr++) = RGBA5551ToRGBA8888(pixel | alpha_mask);
+
+    return Common::WriteImageToFile(image, filename.c_str());
+  };
+
+  if (!wait)
+    return QueueWrite(std::move(filename), hash, size, std::move(function));
+
+  // the function outlives the write, since we don't return until it's done
+  bool result = false;
+  if (!QueueWrite(std::move(filename), hash, size, [&function, &result]() { return (result = function()); }, true))
+    return false;
+
+  Flush();
+  return result;
+}
+
+void ImageWriteQueue::Flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done_cv.wait(lock, [this]() { return m_queue.empty() && !m_write_in_progress; });
+}
+
+ImageWriteQueue::Stats ImageWriteQueue::GetStats()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void ImageWriteQueue::Shutdown()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_worker_thread.joinable())
+  {
+    m_shutdown = true;
+    m_work_cv.notify_one();
+    lock.unlock();
+    m_worker_thread.join();
+    lock.lock();
+  }
+
+  if (m_stats.num_written > 0 || m_stats.num_failed > 0 || m_stats.num_dropped > 0)
+  {
+    Log_InfoPrintf("Image writes: %u written, %u failed, %u dropped, %u duplicates, max queue depth %u",
+                   m_stats.num_written, m_stats.num_failed, m_stats.num_dropped, m_stats.num_duplicates,
+                   m_stats.max_queue_depth);
+  }
+
+  m_queued_hashes.clear();
+  m_stats = {};
+}
+
+void ImageWriteQueue::WorkerThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    // pending writes are still completed on shutdown
+    m_work_cv.wait(lock, [this]() { return m_shutdown || !m_queue.empty(); });
+    if (m_queue.empty())
+      break;
+
+    QueuedWrite write = std::move(m_queue.front());
+    m_queue.pop_front();
+    m_write_in_progress = true;
+    lock.unlock();
+
+    Log_DevPrintf("Writing image '%s'", write.filename.c_str());
+    const bool result = write.function();
+    if (!result)
+      Log_ErrorPrintf("Failed to write image '%s'", write.filename.c_str());
+
+    // release the pixel data before the space is handed back
+    write.function = {};
+
+    lock.lock();
+    m_write_in_progress = false;
+    m_queued_bytes -= write.size;
+    m_stats.queue_depth = static_cast<u32>(m_queue.size());
+    if (result)
+      m_stats.num_written++;
+    else
+      m_stats.num_failed++;
+
+    m_done_cv.notify_all();
+  }
+}
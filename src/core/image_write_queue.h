@@ -0,0 +1,87 @@
+#pragma once
+#include "types.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+// Encodes and writes images on a background thread, so dumping textures or VRAM doesn't stall emulation.
+//
+// The queue is bounded both by the number of writes and by the size of the pixel data they hold. When it's full,
+// new writes are dropped (unless the caller asks to wait), rather than letting the emulation thread run ahead and
+// buffer an unbounded amount of image data. Writes can carry a hash, and a hash which has already been queued is
+// skipped, which means repeated uploads of the same texture only get encoded once.
+
+class ImageWriteQueue
+{
+public:
+  enum : u32
+  {
+    MAX_QUEUED_WRITES = 64,
+    MAX_QUEUED_BYTES = 128 * 1024 * 1024
+  };
+
+  /// Performs the encode and write, runs on the worker thread.
+  using WriteFunction = std::function<bool()>;
+
+  struct Stats
+  {
+    u32 queue_depth;
+    u32 max_queue_depth;
+    u32 num_written;
+    u32 num_failed;
+    u32 num_dropped;
+    u32 num_duplicates;
+  };
+
+  ImageWriteQueue();
+  ~ImageWriteQueue();
+
+  /// Returns true if a write with the specified hash has already been queued since the last shutdown.
+  bool HasQueuedHash(u64 hash);
+
+  /// Queues a write. A non-zero hash which was already queued is skipped. size is the amount of memory held by the
+  /// write function, and counts towards the queue limit. Returns false if the write was dropped or skipped.
+  bool QueueWrite(std::string filename, u64 hash, u32 size, WriteFunction function, bool wait_if_full = false);
+
+  /// Queues a write of 16-bit VRAM data, the conversion to RGBA8 is done on the worker thread. If wait is set, waits
+  /// for space in the queue and for the write to complete, and returns whether the image was written.
+  bool QueueVRAMWrite(std::string filename, u64 hash, u32 width, u32 height, u32 stride, const void* pixels,
+                      bool force_opaque, bool wait = false);
+
+  /// Waits for all queued writes to complete.
+  void Flush();
+
+  Stats GetStats();
+
+  /// Completes all queued writes, stops the worker thread and forgets queued hashes.
+  void Shutdown();
+
+private:
+  struct QueuedWrite
+  {
+    std::string filename;
+    WriteFunction function;
+    u32 size;
+  };
+
+  bool CanQueue(u32 size) const;
+  void WorkerThreadEntryPoint();
+
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  std::deque<QueuedWrite> m_queue;
+  std::unordered_set<u64> m_queued_hashes;
+  u64 m_queued_bytes = 0;
+  bool m_write_in_progress = false;
+  bool m_shutdown = false;
+
+  Stats m_stats = {};
+};
+
+extern ImageWriteQueue g_image_write_queue;
@@ -0,0 +1,370 @@
+#include "media_capture.h"
+#include "common/align.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include "host_display.h"
+#include "system.h"
+#include "zlib.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+Log_SetChannel(MediaCapture);
+
+namespace MediaCapture {
+
+Writer::Writer() = default;
+
+Writer::~Writer()
+{
+  Close(nullptr);
+}
+
+bool Writer::Open(const char* filename, u32 audio_sample_rate, float frame_rate)
+{
+  Close(nullptr);
+
+  // not an atomic update, so a capture which is cut short can still be decoded
+  m_stream = FileSystem::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                              BYTESTREAM_OPEN_SEEKABLE | BYTESTREAM_OPEN_STREAMED);
+  if (!m_stream)
+  {
+    Log_ErrorPrintf("Failed to open capture file '%s'", filename);
+    return false;
+  }
+
+  m_header = {};
+  m_header.magic = FILE_MAGIC;
+  m_header.version = FILE_VERSION;
+  m_header.audio_sample_rate = audio_sample_rate;
+  m_header.audio_channels = 2;
+  m_header.frame_rate = frame_rate;
+  StringUtil::Strlcpy(m_header.game_code, System::GetRunningCode().c_str(), sizeof(m_header.game_code));
+
+  // header gets rewritten on close with the frame counts
+  if (!m_stream->Write2(&m_header, sizeof(m_header)))
+  {
+    Log_ErrorPrintf("Failed to write capture header to '%s'", filename);
+    m_stream.reset();
+    return false;
+  }
+
+  m_readback_slots = {};
+  m_next_readback_slot = 0;
+  m_last_frame_number = 0;
+  m_audio_buffer.clear();
+  m_audio_sample_position = 0;
+  m_previous_frame.clear();
+  m_previous_width = 0;
+  m_previous_height = 0;
+  m_frames_since_keyframe = 0;
+  m_write_error = false;
+  m_queued_video_frames = 0;
+  m_stats = {};
+
+  m_shutdown = false;
+  m_worker_thread = std::thread(&Writer::WorkerThreadEntryPoint, this);
+  Log_InfoPrintf("Capturing to '%s'", filename);
+  return true;
+}
+
+void Writer::Close(HostDisplay* display)
+{
+  if (!m_stream)
+    return;
+
+  // the remaining frames come back in order, and there's no reason to drop them now
+  for (u32 i = 0; i < NUM_READBACK_SLOTS; i++)
+  {
+    ReadbackSlot& slot = m_readback_slots[(m_next_readback_slot + i) % NUM_READBACK_SLOTS];
+    if (slot.in_use)
+      CompleteReadback(display, slot, true);
+  }
+  QueueAudio(m_last_frame_number);
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+    m_work_cv.notify_one();
+  }
+  m_worker_thread.join();
+
+  m_header.frame_count = m_stats.frames_captured;
+  m_header.dropped_frame_count = m_stats.frames_dropped;
+  if (m_write_error || !m_stream->SeekAbsolute(0) || !m_stream->Write2(&m_header, sizeof(m_header)) ||
+      !m_stream->Flush())
+  {
+    Log_ErrorPrintf("Failed to write capture, it may be incomplete");
+  }
+
+  Log_InfoPrintf("Captured %u frames (%u dropped), %" PRIu64 " bytes, max queue depth %u", m_stats.frames_captured,
+                 m_stats.frames_dropped, m_stats.bytes_written, m_stats.max_queue_depth);
+
+  m_stream.reset();
+  m_audio_buffer = {};
+  m_previous_frame = {};
+  m_compress_buffer = {};
+}
+
+void Writer::CaptureFrame(HostDisplay* display, u32 frame_number)
+{
+  // audio generated up to the end of this frame
+  QueueAudio(frame_number);
+  m_last_frame_number = frame_number;
+
+  const u32 slot_index = m_next_readback_slot;
+  m_next_readback_slot = (m_next_readback_slot + 1) % NUM_READBACK_SLOTS;
+
+  // the oldest readback has had a few frames to complete by now
+  ReadbackSlot& slot = m_readback_slots[slot_index];
+  if (slot.in_use)
+    CompleteReadback(display, slot, false);
+
+  slot.frame_number = frame_number;
+  slot.in_use = true;
+  slot.has_data = (display && display->BeginDisplayTextureAsyncDownload(slot_index, &slot.width, &slot.height,
+                                                                        &slot.format, &slot.flip_y));
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_stats.frames_captured++;
+}
+
+void Writer::AddAudioFrames(const s16* frames, u32 num_frames)
+{
+  const size_t offset = m_audio_buffer.size();
+  m_audio_buffer.resize(offset + num_frames);
+  std::memcpy(&m_audio_buffer[offset], frames, sizeof(u32) * num_frames);
+}
+
+Writer::Stats Writer::GetStats()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void Writer::CompleteReadback(HostDisplay* display, ReadbackSlot& slot, bool wait_if_full)
+{
+  const u32 slot_index = static_cast<u32>(&slot - m_readback_slots.data());
+  slot.in_use = false;
+
+  QueuedChunk chunk = {};
+  chunk.type = CHUNK_TYPE_VIDEO;
+  chunk.frame_number = slot.frame_number;
+  chunk.repeat = true;
+
+  bool queue_full;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    queue_full = (m_queued_video_frames >= MAX_QUEUED_FRAMES);
+  }
+
+  if (!slot.has_data || !display)
+  {
+    // nothing being displayed, keep the last frame up
+  }
+  else if (queue_full && !wait_if_full)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stats.frames_dropped++;
+    if ((m_stats.frames_dropped % 100) == 1)
+      Log_WarningPrintf("Capture is falling behind, %u frames dropped so far", m_stats.frames_dropped);
+  }
+  else
+  {
+    chunk.width = slot.width;
+    chunk.height = slot.height;
+    chunk.format = slot.format;
+    chunk.flip_y = slot.flip_y;
+    chunk.stride = Common::AlignUpPow2(slot.width * HostDisplay::GetDisplayPixelFormatSize(slot.format), 4);
+    chunk.data.resize((chunk.stride / sizeof(u32)) * slot.height);
+    if (display->EndAsyncDownload(slot_index, chunk.data.data(), chunk.stride))
+    {
+      chunk.repeat = false;
+    }
+    else
+    {
+      Log_ErrorPrintf("Failed to read back frame %u", slot.frame_number);
+      chunk.data = {};
+    }
+  }
+
+  QueueChunk(std::move(chunk), wait_if_full);
+}
+
+void Writer::QueueAudio(u32 frame_number)
+{
+  if (m_audio_buffer.empty())
+    return;
+
+  QueuedChunk chunk = {};
+  chunk.type = CHUNK_TYPE_AUDIO;
+  chunk.frame_number = frame_number;
+  chunk.sample_position = m_audio_sample_position;
+  chunk.data = std::move(m_audio_buffer);
+  m_audio_sample_position += chunk.data.size();
+  m_audio_buffer = {};
+  m_audio_buffer.reserve(chunk.data.size());
+  QueueChunk(std::move(chunk), false);
+}
+
+void Writer::QueueChunk(QueuedChunk chunk, bool wait_if_full)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (chunk.type == CHUNK_TYPE_VIDEO && !chunk.repeat)
+  {
+    // only images count towards the limit, repeats and audio are small
+    if (wait_if_full)
+      m_done_cv.wait(lock, [this]() { return m_queued_video_frames < MAX_QUEUED_FRAMES; });
+
+    m_queued_video_frames++;
+  }
+
+  m_queue.push_back(std::move(chunk));
+  m_stats.queue_depth = static_cast<u32>(m_queue.size());
+  m_stats.max_queue_depth = std::max(m_stats.max_queue_depth, m_stats.queue_depth);
+  m_work_cv.notify_one();
+}
+
+void Writer::WorkerThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    // pending chunks are still written on shutdown
+    m_work_cv.wait(lock, [this]() { return m_shutdown || !m_queue.empty(); });
+    if (m_queue.empty())
+      break;
+
+    QueuedChunk chunk = std::move(m_queue.front());
+    m_queue.pop_front();
+    lock.unlock();
+
+    const bool is_image = (chunk.type == CHUNK_TYPE_VIDEO && !chunk.repeat);
+    if (!m_write_error)
+    {
+      const bool result = (chunk.type == CHUNK_TYPE_VIDEO) ? WriteVideoChunk(chunk) : WriteAudioChunk(chunk);
+      if (!result)
+      {
+        Log_ErrorPrintf("Failed to write capture chunk for frame %u, stopping writes", chunk.frame_number);
+        m_write_error = true;
+      }
+    }
+
+    chunk.data = {};
+
+    lock.lock();
+    if (is_image)
+      m_queued_video_frames--;
+    if (chunk.type == CHUNK_TYPE_VIDEO)
+      m_stats.frames_written++;
+
+    m_stats.queue_depth = static_cast<u32>(m_queue.size());
+    m_stats.bytes_written = m_stream->GetPosition();
+    m_done_cv.notify_all();
+  }
+}
+
+bool Writer::WriteVideoChunk(QueuedChunk& chunk)
+{
+  VideoFrameHeader vh = {};
+  vh.frame_number = chunk.frame_number;
+
+  if (!chunk.repeat &&
+      !HostDisplay::ConvertTextureDataToRGBA8(chunk.width, chunk.height, chunk.data, chunk.stride, chunk.format))
+  {
+    chunk.repeat = true;
+  }
+
+  if (chunk.repeat)
+  {
+    vh.width = m_previous_width;
+    vh.height = m_previous_height;
+    vh.flags = VIDEO_FRAME_FLAG_REPEAT;
+    return WriteChunk(CHUNK_TYPE_VIDEO, &vh, sizeof(vh), nullptr, 0);
+  }
+
+  // pack the rows, and put them top-down
+  const u32 width = chunk.width;
+  const u32 height = chunk.height;
+  const u32 pitch = chunk.stride / sizeof(u32);
+  std::vector<u32>& pixels = chunk.data;
+  if (pitch != width)
+  {
+    for (u32 row = 1; row < height; row++)
+      std::memmove(&pixels[row * width], &pixels[row * pitch], sizeof(u32) * width);
+  }
+  pixels.resize(width * height);
+
+  if (chunk.flip_y)
+  {
+    for (u32 row = 0; row < (height / 2); row++)
+      std::swap_ranges(&pixels[row * width], &pixels[(row + 1) * width], &pixels[(height - 1 - row) * width]);
+  }
+
+  const bool keyframe = (m_previous_frame.empty() || width != m_previous_width || height != m_previous_height ||
+                         m_frames_since_keyframe >= KEYFRAME_INTERVAL);
+  if (keyframe)
+  {
+    for (u32& pixel : pixels)
+      pixel |= 0xFF000000u;
+
+    m_previous_frame = pixels;
+    m_previous_width = width;
+    m_previous_height = height;
+    m_frames_since_keyframe = 0;
+    vh.flags = VIDEO_FRAME_FLAG_KEYFRAME;
+  }
+  else
+  {
+    // unchanged pixels become zero, which compresses to almost nothing
+    u32* previous = m_previous_frame.data();
+    for (u32& pixel : pixels)
+    {
+      const u32 value = pixel | 0xFF000000u;
+      pixel = value ^ *previous;
+      *(previous++) = value;
+    }
+
+    m_frames_since_keyframe++;
+  }
+
+  const u32 size = static_cast<u32>(pixels.size() * sizeof(u32));
+  const uLong bound = compressBound(static_cast<uLong>(size));
+  if (m_compress_buffer.size() < bound)
+    m_compress_buffer.resize(bound);
+
+  uLongf compressed_size = static_cast<uLongf>(m_compress_buffer.size());
+  if (compress2(m_compress_buffer.data(), &compressed_size, reinterpret_cast<const Bytef*>(pixels.data()),
+                static_cast<uLong>(size), Z_BEST_SPEED) != Z_OK)
+  {
+    Log_ErrorPrintf("Failed to compress frame %u", chunk.frame_number);
+    return false;
+  }
+
+  vh.width = width;
+  vh.height = height;
+  vh.uncompressed_size = size;
+  return WriteChunk(CHUNK_TYPE_VIDEO, &vh, sizeof(vh), m_compress_buffer.data(), static_cast<u32>(compressed_size));
+}
+
+bool Writer::WriteAudioChunk(const QueuedChunk& chunk)
+{
+  AudioChunkHeader ah = {};
+  ah.frame_number = chunk.frame_number;
+  ah.num_frames = static_cast<u32>(chunk.data.size());
+  ah.sample_position = chunk.sample_position;
+  return WriteChunk(CHUNK_TYPE_AUDIO, &ah, sizeof(ah), chunk.data.data(),
+                    static_cast<u32>(chunk.data.size() * sizeof(u32)));
+}
+
+bool Writer::WriteChunk(u32 type, const void* header, u32 header_size, const void* data, u32 data_size)
+{
+  ChunkHeader ch;
+  ch.type = type;
+  ch.size = header_size + data_size;
+  return (m_stream->Write2(&ch, sizeof(ch)) && m_stream->Write2(header, header_size) &&
+          (data_size == 0 || m_stream->Write2(data, data_size)));
+}
+
+} // namespace MediaCapture
@@ -0,0 +1,180 @@
+#pragma once
+#include "types.h"
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Lossless audio/video capture.
+//
+// Every frame is read back from the host display and written, along with the SPU output, to a simple container.
+// Readbacks are spread over a few frames so the GPU is never waited on, and frames are encoded on a worker thread.
+// When the worker falls behind, frames are dropped rather than stalling emulation. A dropped frame is still recorded,
+// as a repeat of the previous frame, so the video keeps its timing relative to the audio.
+//
+// The file is the header followed by chunks. Video chunks hold a zlib-compressed RGBA8 image, which outside of
+// keyframes is XORed with the previous image first. Audio chunks hold uncompressed stereo 16-bit samples at the SPU
+// sample rate. Each chunk carries the frame it belongs to, so the file can be decoded even if it was never closed.
+
+class ByteStream;
+class HostDisplay;
+enum class HostDisplayPixelFormat : u32;
+
+namespace MediaCapture {
+
+enum : u32
+{
+  FILE_MAGIC = 0x56414344, // DCAV
+  FILE_VERSION = 1,
+
+  CHUNK_TYPE_VIDEO = 0x44495656, // VVID
+  CHUNK_TYPE_AUDIO = 0x44554141, // AAUD
+
+  VIDEO_FRAME_FLAG_KEYFRAME = (1 << 0),
+  VIDEO_FRAME_FLAG_REPEAT = (1 << 1),
+
+  KEYFRAME_INTERVAL = 120,
+  NUM_READBACK_SLOTS = 3,
+  MAX_QUEUED_FRAMES = 8,
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 audio_sample_rate;
+  u32 audio_channels;
+  float frame_rate;
+  u32 frame_count;
+  u32 dropped_frame_count;
+  u32 reserved;
+  char game_code[32];
+};
+
+// followed by size bytes of chunk data
+struct ChunkHeader
+{
+  u32 type;
+  u32 size;
+};
+
+// followed by the compressed image, if the frame isn't a repeat
+struct VideoFrameHeader
+{
+  u32 frame_number;
+  u32 width;
+  u32 height;
+  u32 flags;
+  u32 uncompressed_size;
+};
+
+// followed by the samples
+struct AudioChunkHeader
+{
+  u32 frame_number;
+  u32 num_frames;
+  u64 sample_position;
+};
+#pragma pack(pop)
+
+class Writer
+{
+public:
+  struct Stats
+  {
+    u32 frames_captured;
+    u32 frames_written;
+    u32 frames_dropped;
+    u32 queue_depth;
+    u32 max_queue_depth;
+    u64 bytes_written;
+  };
+
+  Writer();
+  ~Writer();
+
+  /// Creates the file. frame_rate is informational, frames carry their own numbers.
+  bool Open(const char* filename, u32 audio_sample_rate, float frame_rate);
+
+  /// Completes outstanding readbacks and writes everything which is queued.
+  void Close(HostDisplay* display);
+
+  /// Starts the readback of the frame which was just presented, and queues older frames which have come back.
+  void CaptureFrame(HostDisplay* display, u32 frame_number);
+
+  /// Adds SPU output, which is written with the next frame.
+  void AddAudioFrames(const s16* frames, u32 num_frames);
+
+  Stats GetStats();
+
+private:
+  struct ReadbackSlot
+  {
+    u32 frame_number;
+    u32 width;
+    u32 height;
+    HostDisplayPixelFormat format;
+    bool flip_y;
+    bool in_use;
+    bool has_data;
+  };
+
+  struct QueuedChunk
+  {
+    u32 type;
+    u32 frame_number;
+    u32 width;
+    u32 height;
+    u32 stride;
+    HostDisplayPixelFormat format;
+    bool flip_y;
+    bool repeat;
+    u64 sample_position;
+
+    // pixels for video, one stereo sample pair per element for audio
+    std::vector<u32> data;
+  };
+
+  void CompleteReadback(HostDisplay* display, ReadbackSlot& slot, bool wait_if_full);
+  void QueueAudio(u32 frame_number);
+  void QueueChunk(QueuedChunk chunk, bool wait_if_full);
+
+  void WorkerThreadEntryPoint();
+  bool WriteVideoChunk(QueuedChunk& chunk);
+  bool WriteAudioChunk(const QueuedChunk& chunk);
+  bool WriteChunk(u32 type, const void* header, u32 header_size, const void* data, u32 data_size);
+
+  std::unique_ptr<ByteStream> m_stream;
+  FileHeader m_header = {};
+
+  // emulation thread state
+  std::array<ReadbackSlot, NUM_READBACK_SLOTS> m_readback_slots = {};
+  u32 m_next_readback_slot = 0;
+  u32 m_last_frame_number = 0;
+  std::vector<u32> m_audio_buffer;
+  u64 m_audio_sample_position = 0;
+
+  // worker thread state
+  std::vector<u32> m_previous_frame;
+  u32 m_previous_width = 0;
+  u32 m_previous_height = 0;
+  u32 m_frames_since_keyframe = 0;
+  std::vector<u8> m_compress_buffer;
+  bool m_write_error = false;
+
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  std::deque<QueuedChunk> m_queue;
+  u32 m_queued_video_frames = 0;
+  bool m_shutdown = false;
+
+  Stats m_stats = {};
+};
+
+} // namespace MediaCapture
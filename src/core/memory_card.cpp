@@ -6,9 +6,135 @@
 #include "common/string_util.h"
 #include "host_interface.h"
 #include "system.h"
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
 Log_SetChannel(MemoryCard);
 
+namespace {
+
+// Writes card images on a background thread, so slow storage doesn't stall emulation. Cards are snapshotted when
+// the save is queued, and a newer snapshot of a card which hasn't been written yet replaces the older one.
+class MemoryCardWriter
+{
+public:
+  ~MemoryCardWriter() { Shutdown(); }
+
+  void QueueSave(const std::string& filename, const MemoryCardImage::DataArray& data, bool display_osd_message);
+  void Flush();
+  void Shutdown();
+
+private:
+  struct PendingSave
+  {
+    std::string filename;
+    std::unique_ptr<MemoryCardImage::DataArray> data;
+    bool display_osd_message;
+  };
+
+  void WorkerThreadEntryPoint();
+
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  std::vector<PendingSave> m_pending_saves;
+  bool m_save_in_progress = false;
+  bool m_shutdown = false;
+};
+
+void MemoryCardWriter::QueueSave(const std::string& filename, const MemoryCardImage::DataArray& data,
+                                 bool display_osd_message)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto iter = std::find_if(m_pending_saves.begin(), m_pending_saves.end(),
+                           [&filename](const PendingSave& save) { return save.filename == filename; });
+  if (iter != m_pending_saves.end())
+  {
+    Log_DevPrintf("Coalescing save of memory card '%s'", filename.c_str());
+    *iter->data = data;
+    iter->display_osd_message |= display_osd_message;
+  }
+  else
+  {
+    m_pending_saves.push_back(
+      PendingSave{filename, std::make_unique<MemoryCardImage::DataArray>(data), display_osd_message});
+  }
+
+  if (!m_worker_thread.joinable())
+  {
+    m_shutdown = false;
+    m_worker_thread = std::thread(&MemoryCardWriter::WorkerThreadEntryPoint, this);
+  }
+
+  m_work_cv.notify_one();
+}
+
+void MemoryCardWriter::Flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done_cv.wait(lock, [this]() { return m_pending_saves.empty() && !m_save_in_progress; });
+}
+
+void MemoryCardWriter::Shutdown()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_worker_thread.joinable())
+    return;
+
+  m_shutdown = true;
+  m_work_cv.notify_one();
+  lock.unlock();
+  m_worker_thread.join();
+}
+
+void MemoryCardWriter::WorkerThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    // pending saves are still written on shutdown
+    m_work_cv.wait(lock, [this]() { return m_shutdown || !m_pending_saves.empty(); });
+    if (m_pending_saves.empty())
+      break;
+
+    PendingSave save = std::move(m_pending_saves.front());
+    m_pending_saves.erase(m_pending_saves.begin());
+    m_save_in_progress = true;
+    lock.unlock();
+
+    const bool result = MemoryCardImage::SaveToFile(*save.data, save.filename.c_str());
+    if (save.display_osd_message)
+    {
+      // the host isn't safe to use from here, so report it from the emulation thread
+      g_host_interface->RunLater([filename = std::move(save.filename), result]() {
+        if (result)
+        {
+          g_host_interface->AddFormattedOSDMessage(
+            2.0f, g_host_interface->TranslateString("OSDMessage", "Saved memory card to '%s'"), filename.c_str());
+        }
+        else
+        {
+          g_host_interface->AddFormattedOSDMessage(
+            20.0f, g_host_interface->TranslateString("OSDMessage", "Failed to save memory card to '%s'"),
+            filename.c_str());
+        }
+      });
+    }
+
+    lock.lock();
+    m_save_in_progress = false;
+    m_done_cv.notify_all();
+  }
+}
+
+} // namespace
+
+static MemoryCardWriter s_writer;
+
 MemoryCard::MemoryCard()
 {
   m_FLAG.no_write_yet = true;
@@ -276,38 +402,29 @@ void MemoryCard::Format()
 
 bool MemoryCard::LoadFromFile()
 {
+  // make sure we don't read the card while an older copy of it is still being written
+  s_writer.Flush();
   return MemoryCardImage::LoadFromFile(&m_data, m_filename.c_str());
 }
 
-bool MemoryCard::SaveIfChanged(bool display_osd_message)
+void MemoryCard::SaveIfChanged(bool display_osd_message)
 {
   m_save_event->Deactivate();
 
   if (!m_changed)
-    return true;
+    return;
 
   m_changed = false;
 
   if (m_filename.empty())
-    return false;
-
-  if (!MemoryCardImage::SaveToFile(m_data, m_filename.c_str()))
-  {
-    if (display_osd_message)
-    {
-      g_host_interface->AddFormattedOSDMessage(
-        20.0f, g_host_interface->TranslateString("OSDMessage", "Failed to save memory card to '%s'"),
-        m_filename.c_str());
-    }
-
-    return false;
-  }
+    return;
 
-  if (display_osd_message)
-    g_host_interface->AddFormattedOSDMessage(
-      2.0f, g_host_interface->TranslateString("OSDMessage", "Saved memory card to '%s'"), m_filename.c_str());
+  s_writer.QueueSave(m_filename, m_data, display_osd_message);
+}
 
-  return true;
+void MemoryCard::FlushPendingSaves()
+{
+  s_writer.Flush();
 }
 
 void MemoryCard::QueueFileSave()
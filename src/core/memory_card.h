@@ -30,6 +30,9 @@ public:
 
   void Format();
 
+  /// Waits for queued card saves to reach the disk.
+  static void FlushPendingSaves();
+
 private:
   enum : u32
   {
@@ -76,7 +79,7 @@ private:
   static TickCount GetSaveDelayInTicks();
 
   bool LoadFromFile();
-  bool SaveIfChanged(bool display_osd_message);
+  void SaveIfChanged(bool display_osd_message);
   void QueueFileSave();
 
   std::unique_ptr<TimingEvent> m_save_event;
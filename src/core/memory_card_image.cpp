@@ -111,7 +111,8 @@ bool SaveToFile(const DataArray& data, const char* filename)
 {
   std::unique_ptr<ByteStream> stream =
     FileSystem::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE |
-                                     BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+                                     BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED |
+                                     BYTESTREAM_OPEN_SYNC_ON_COMMIT);
   if (!stream)
   {
     Log_ErrorPrintf("Failed to open '%s' for writing.", filename);
@@ -0,0 +1,495 @@
+#include "movie.h"
+#include "bus.h"
+#include "common/assert.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/state_wrapper.h"
+#include "common/string_util.h"
+#include "controller.h"
+#include "cpu_core.h"
+#include "pad.h"
+#include "save_state_version.h"
+#include "settings.h"
+#include "system.h"
+#include "timing_event.h"
+#include "xxhash.h"
+#include "zlib.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+Log_SetChannel(Movie);
+
+namespace Movie {
+
+u64 GetFrameHash()
+{
+  // RAM and the CPU state cover pretty much everything the game can observe, and the tick counter catches timing
+  // differences which haven't made it into memory yet
+  const u64 ram_hash = XXH3_64bits(Bus::g_ram, Bus::RAM_SIZE);
+  return XXH3_64bits_withSeed(&CPU::g_state.regs, sizeof(CPU::g_state.regs),
+                              ram_hash ^ static_cast<u64>(TimingEvents::GetGlobalTickCounter()));
+}
+
+static Controller* GetController(u32 port)
+{
+  return g_pad.GetController(port);
+}
+
+FileWriter::FileWriter() = default;
+
+FileWriter::~FileWriter() = default;
+
+bool FileWriter::Open(ByteStream* stream, const FileHeader& header)
+{
+  m_stream = stream;
+  m_header = header;
+  m_header.frame_count = 0;
+  m_header.keyframe_count = 0;
+  m_frames.clear();
+  m_keyframes.clear();
+  return m_stream->Write2(&m_header, sizeof(m_header));
+}
+
+bool FileWriter::WriteKeyframe(u32 frame, const void* data, u32 size)
+{
+  const uLong bound = compressBound(static_cast<uLong>(size));
+  if (m_compress_buffer.size() < bound)
+    m_compress_buffer.resize(bound);
+
+  // favour speed, this happens while the game is running
+  uLongf compressed_size = static_cast<uLongf>(m_compress_buffer.size());
+  if (compress2(m_compress_buffer.data(), &compressed_size, static_cast<const Bytef*>(data), static_cast<uLong>(size),
+                1) != Z_OK)
+  {
+    Log_ErrorPrintf("Failed to compress keyframe at frame %u", frame);
+    return false;
+  }
+
+  KeyframeEntry entry = {};
+  entry.frame = frame;
+  entry.compressed_size = static_cast<u32>(compressed_size);
+  entry.uncompressed_size = size;
+  entry.offset = m_stream->GetPosition();
+  if (!m_stream->Write2(m_compress_buffer.data(), entry.compressed_size))
+    return false;
+
+  m_keyframes.push_back(entry);
+  return true;
+}
+
+u8* FileWriter::BeginFrame()
+{
+  const size_t record_offset = m_frames.size();
+  m_frames.resize(record_offset + m_header.frame_record_size);
+  return m_frames.data() + record_offset + sizeof(FrameRecordHeader);
+}
+
+void FileWriter::EndFrame(u64 hash)
+{
+  FrameRecordHeader rec;
+  rec.hash = hash;
+  std::memcpy(m_frames.data() + (m_frames.size() - m_header.frame_record_size), &rec, sizeof(rec));
+  m_header.frame_count++;
+}
+
+bool FileWriter::Finish()
+{
+  m_header.keyframe_count = static_cast<u32>(m_keyframes.size());
+  m_header.offset_to_frames = m_stream->GetPosition();
+  m_header.offset_to_keyframe_index = m_header.offset_to_frames + m_frames.size();
+
+  const u32 keyframe_index_size = static_cast<u32>(sizeof(KeyframeEntry) * m_keyframes.size());
+  return m_stream->Write2(m_frames.data(), static_cast<u32>(m_frames.size())) &&
+         m_stream->Write2(m_keyframes.data(), keyframe_index_size) && m_stream->SeekAbsolute(0) &&
+         m_stream->Write2(&m_header, sizeof(m_header)) && m_stream->Flush();
+}
+
+FileReader::FileReader() = default;
+
+FileReader::~FileReader() = default;
+
+bool FileReader::Open(ByteStream* stream, const char* name)
+{
+  m_stream = stream;
+  if (!m_stream->Read2(&m_header, sizeof(m_header)) || m_header.magic != FILE_MAGIC ||
+      m_header.version != FILE_VERSION)
+  {
+    Log_ErrorPrintf("'%s' is not a movie file, or is an unsupported version", name);
+    return false;
+  }
+
+  if (m_header.save_state_version != SAVE_STATE_VERSION)
+  {
+    Log_ErrorPrintf("Movie '%s' was recorded with save state version %u, this build uses %u", name,
+                    m_header.save_state_version, SAVE_STATE_VERSION);
+    return false;
+  }
+
+  // the frame records need room for at least the hash
+  const u64 stream_size = m_stream->GetSize();
+  const u64 frames_size = static_cast<u64>(m_header.frame_count) * m_header.frame_record_size;
+  const u64 keyframe_index_size = static_cast<u64>(m_header.keyframe_count) * sizeof(KeyframeEntry);
+  if (m_header.frame_record_size < sizeof(FrameRecordHeader) || m_header.keyframe_count == 0 ||
+      m_header.offset_to_frames > stream_size || frames_size > (stream_size - m_header.offset_to_frames) ||
+      m_header.offset_to_keyframe_index > stream_size ||
+      keyframe_index_size > (stream_size - m_header.offset_to_keyframe_index))
+  {
+    Log_ErrorPrintf("Movie '%s' is truncated", name);
+    return false;
+  }
+
+  m_frames.resize(static_cast<size_t>(frames_size));
+  m_keyframes.resize(m_header.keyframe_count);
+  if (!m_stream->SeekAbsolute(m_header.offset_to_frames) ||
+      !m_stream->Read2(m_frames.data(), static_cast<u32>(m_frames.size())) ||
+      !m_stream->SeekAbsolute(m_header.offset_to_keyframe_index) ||
+      !m_stream->Read2(m_keyframes.data(), static_cast<u32>(keyframe_index_size)) || m_keyframes[0].frame != 0)
+  {
+    Log_ErrorPrintf("Movie '%s' is truncated", name);
+    return false;
+  }
+
+  return true;
+}
+
+const KeyframeEntry* FileReader::FindKeyframe(u32 frame) const
+{
+  // keyframes are in frame order
+  auto iter = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame,
+                               [](u32 frame, const KeyframeEntry& entry) { return frame < entry.frame; });
+  return (iter != m_keyframes.begin()) ? &(*(--iter)) : nullptr;
+}
+
+bool FileReader::ReadKeyframe(const KeyframeEntry& entry, std::vector<u8>* data)
+{
+  m_compressed_buffer.resize(entry.compressed_size);
+  data->resize(entry.uncompressed_size);
+
+  uLongf uncompressed_size = static_cast<uLongf>(entry.uncompressed_size);
+  if (!m_stream->SeekAbsolute(entry.offset) || !m_stream->Read2(m_compressed_buffer.data(), entry.compressed_size) ||
+      uncompress(data->data(), &uncompressed_size, m_compressed_buffer.data(),
+                 static_cast<uLong>(entry.compressed_size)) != Z_OK ||
+      uncompressed_size != entry.uncompressed_size)
+  {
+    Log_ErrorPrintf("Failed to read keyframe for frame %u", entry.frame);
+    return false;
+  }
+
+  return true;
+}
+
+const u8* FileReader::GetFrameInputs(u32 frame) const
+{
+  DebugAssert(frame < m_header.frame_count);
+  return m_frames.data() + (static_cast<size_t>(frame) * m_header.frame_record_size) + sizeof(FrameRecordHeader);
+}
+
+u64 FileReader::GetFrameHash(u32 frame) const
+{
+  DebugAssert(frame < m_header.frame_count);
+  FrameRecordHeader rec;
+  std::memcpy(&rec, m_frames.data() + (static_cast<size_t>(frame) * m_header.frame_record_size), sizeof(rec));
+  return rec.hash;
+}
+
+Recorder::Recorder() = default;
+
+Recorder::~Recorder()
+{
+  Close();
+}
+
+bool Recorder::Open(const char* filename, u32 keyframe_interval)
+{
+  Close();
+
+  m_stream = FileSystem::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                              BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_SEEKABLE);
+  if (!m_stream)
+  {
+    Log_ErrorPrintf("Failed to open movie file '%s'", filename);
+    return false;
+  }
+
+  FileHeader header = {};
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.save_state_version = SAVE_STATE_VERSION;
+  header.keyframe_interval = std::max<u32>(keyframe_interval, 1);
+  StringUtil::Strlcpy(header.game_code, System::GetRunningCode().c_str(), sizeof(header.game_code));
+
+  // input sizes are fixed for each controller type
+  header.frame_record_size = sizeof(FrameRecordHeader);
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    Controller* controller = GetController(i);
+    if (!controller)
+      continue;
+
+    StateWrapper sw(nullptr, 0, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+    controller->DoInputState(sw);
+    header.controller_types[i] = static_cast<u8>(controller->GetType());
+    header.input_sizes[i] = static_cast<u8>(sw.GetBufferPosition());
+    header.frame_record_size += sw.GetBufferPosition();
+  }
+
+  if (!m_writer.Open(m_stream.get(), header))
+  {
+    Close();
+    return false;
+  }
+
+  // the first keyframe is a full save state, so it can bring the media with it
+  std::unique_ptr<GrowableMemoryByteStream> state_stream = ByteStream_CreateGrowableMemoryStream();
+  if (!System::SaveState(state_stream.get(), 0) ||
+      !m_writer.WriteKeyframe(0, state_stream->GetMemoryPointer(), static_cast<u32>(state_stream->GetSize())))
+  {
+    Log_ErrorPrintf("Failed to write starting state to movie");
+    Close();
+    return false;
+  }
+
+  m_shutdown = false;
+  m_write_error = false;
+  m_worker_thread = std::thread(&Recorder::WorkerThreadEntryPoint, this);
+  Log_InfoPrintf("Recording movie to '%s', keyframe every %u frames", filename, header.keyframe_interval);
+  return true;
+}
+
+void Recorder::Close()
+{
+  if (!m_stream)
+    return;
+
+  if (m_worker_thread.joinable())
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_shutdown = true;
+      m_work_cv.notify_one();
+    }
+    m_worker_thread.join();
+  }
+
+  if (!m_write_error && m_writer.Finish())
+  {
+    m_stream->Commit();
+    Log_InfoPrintf("Recorded %u frames (%u keyframes)", m_writer.GetFrameCount(), m_writer.GetHeader().keyframe_count);
+  }
+  else
+  {
+    Log_ErrorPrintf("Failed to write movie");
+    m_stream->Discard();
+  }
+
+  m_stream.reset();
+  m_writer = {};
+  m_keyframe_buffer = {};
+}
+
+void Recorder::BeginFrame()
+{
+  const FileHeader& header = m_writer.GetHeader();
+  const u32 frame = header.frame_count;
+  if (frame > 0 && (frame % header.keyframe_interval) == 0)
+  {
+    // only one keyframe can be in flight, but the previous one has had a whole interval to finish
+    WaitForKeyframe();
+
+    const u32 size = System::GetStateDataSize();
+    if (m_keyframe_buffer.size() < size)
+      m_keyframe_buffer.resize(size);
+
+    if (size == 0 || System::SaveStateToBuffer(m_keyframe_buffer.data(), size) != size)
+    {
+      Log_ErrorPrintf("Failed to save keyframe at frame %u", frame);
+    }
+    else
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_keyframe_frame = frame;
+      m_keyframe_size = size;
+      m_keyframe_pending = true;
+      m_work_cv.notify_one();
+    }
+  }
+
+  u8* inputs = m_writer.BeginFrame();
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    Controller* controller = GetController(i);
+    if (!controller || header.input_sizes[i] == 0)
+      continue;
+
+    StateWrapper sw(inputs, header.input_sizes[i], StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+    controller->DoInputState(sw);
+    inputs += header.input_sizes[i];
+  }
+}
+
+void Recorder::EndFrame()
+{
+  m_writer.EndFrame(GetFrameHash());
+}
+
+void Recorder::WaitForKeyframe()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done_cv.wait(lock, [this]() { return !m_keyframe_pending; });
+}
+
+void Recorder::WorkerThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    m_work_cv.wait(lock, [this]() { return m_keyframe_pending || m_shutdown; });
+    if (m_keyframe_pending)
+    {
+      // the buffer isn't touched by the emulation thread until we signal completion
+      lock.unlock();
+      const bool result = m_writer.WriteKeyframe(m_keyframe_frame, m_keyframe_buffer.data(), m_keyframe_size);
+      lock.lock();
+
+      m_write_error |= !result;
+      m_keyframe_pending = false;
+      m_done_cv.notify_one();
+      continue;
+    }
+
+    if (m_shutdown)
+      break;
+  }
+}
+
+Player::Player() = default;
+
+Player::~Player()
+{
+  Close();
+}
+
+bool Player::Open(const char* filename)
+{
+  std::unique_ptr<ByteStream> stream = FileSystem::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_SEEKABLE);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open movie file '%s'", filename);
+    return false;
+  }
+
+  return Open(std::move(stream), filename);
+}
+
+bool Player::Open(std::unique_ptr<ByteStream> stream, const char* name)
+{
+  Close();
+
+  m_stream = std::move(stream);
+  if (!m_reader.Open(m_stream.get(), name))
+  {
+    Close();
+    return false;
+  }
+
+  const FileHeader& header = m_reader.GetHeader();
+  Log_InfoPrintf("Opened movie '%s' for '%s', %u frames (%u keyframes)", name, header.game_code, header.frame_count,
+                 header.keyframe_count);
+  return true;
+}
+
+void Player::Close()
+{
+  m_reader = {};
+  m_stream.reset();
+  m_state_buffer = {};
+  m_current_frame = 0;
+  m_desync_count = 0;
+  m_first_desync_frame = 0;
+}
+
+bool Player::Seek(u32 frame)
+{
+  const KeyframeEntry* entry = m_reader.FindKeyframe(frame);
+  if (!entry || !m_reader.ReadKeyframe(*entry, &m_state_buffer))
+    return false;
+
+  bool result;
+  if (entry->frame == 0)
+  {
+    std::unique_ptr<ReadOnlyMemoryByteStream> stream =
+      ByteStream_CreateReadOnlyMemoryStream(m_state_buffer.data(), entry->uncompressed_size);
+    result = System::LoadState(stream.get());
+  }
+  else
+  {
+    result = System::LoadStateFromBuffer(m_state_buffer.data(), entry->uncompressed_size);
+  }
+
+  if (!result || !CheckControllers())
+    return false;
+
+  Log_DevPrintf("Seeked to keyframe at frame %u for frame %u", entry->frame, frame);
+  m_current_frame = entry->frame;
+  return true;
+}
+
+bool Player::CheckControllers()
+{
+  const FileHeader& header = m_reader.GetHeader();
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    const Controller* controller = GetController(i);
+    const ControllerType type = controller ? controller->GetType() : ControllerType::None;
+    if (header.input_sizes[i] > 0 && static_cast<u8>(type) != header.controller_types[i])
+    {
+      Log_ErrorPrintf("Movie was recorded with a %s in port %u, but %s is connected",
+                      Settings::GetControllerTypeName(static_cast<ControllerType>(header.controller_types[i])),
+                      i + 1u, Settings::GetControllerTypeName(type));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Player::BeginFrame()
+{
+  DebugAssert(!IsFinished());
+
+  const FileHeader& header = m_reader.GetHeader();
+  const u8* inputs = m_reader.GetFrameInputs(m_current_frame);
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    if (header.input_sizes[i] == 0)
+      continue;
+
+    // only reads from the buffer
+    StateWrapper sw(const_cast<u8*>(inputs), header.input_sizes[i], StateWrapper::Mode::Read, SAVE_STATE_VERSION);
+    if (Controller* controller = GetController(i); controller)
+      controller->DoInputState(sw);
+
+    inputs += header.input_sizes[i];
+  }
+}
+
+void Player::EndFrame(u64 hash)
+{
+  const u64 expected_hash = m_reader.GetFrameHash(m_current_frame);
+  if (hash != expected_hash)
+  {
+    if (m_desync_count == 0)
+    {
+      Log_ErrorPrintf("Movie desynced at frame %u (expected hash %016" PRIX64 ", got %016" PRIX64 ")",
+                      m_current_frame, expected_hash, hash);
+      m_first_desync_frame = m_current_frame;
+    }
+
+    m_desync_count++;
+  }
+
+  m_current_frame++;
+}
+
+} // namespace Movie
@@ -0,0 +1,213 @@
+#pragma once
+#include "types.h"
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Input movies.
+//
+// A movie is a starting save state followed by the host input state of every controller for each frame, along with
+// a hash of the emulated state at the end of the frame for detecting desyncs. Keyframe states are embedded at a fixed
+// interval, so seeking only has to replay at most one interval's worth of frames.
+//
+// The file consists of the header, the compressed keyframe states, the frame records, and finally the keyframe index.
+// Keyframe 0 is a complete save state (including the media filename), the remainder are raw state data, which is why
+// movies are tied to the save state version they were recorded with.
+
+class ByteStream;
+
+namespace Movie {
+
+enum : u32
+{
+  FILE_MAGIC = 0x564D5344, // DSMV
+  FILE_VERSION = 1,
+
+  DEFAULT_KEYFRAME_INTERVAL = 600,
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 save_state_version;
+  u32 frame_count;
+  u32 keyframe_interval;
+  u32 keyframe_count;
+  u32 frame_record_size;
+  std::array<u8, NUM_CONTROLLER_AND_CARD_PORTS> controller_types;
+  std::array<u8, NUM_CONTROLLER_AND_CARD_PORTS> input_sizes;
+  u64 offset_to_frames;
+  u64 offset_to_keyframe_index;
+  char game_code[32];
+};
+
+struct KeyframeEntry
+{
+  u32 frame;
+  u32 compressed_size;
+  u32 uncompressed_size;
+  u32 reserved;
+  u64 offset;
+};
+
+// followed by the input state of each port
+struct FrameRecordHeader
+{
+  u64 hash;
+};
+#pragma pack(pop)
+
+/// Returns a hash of the emulated state, taken at the end of each frame.
+u64 GetFrameHash();
+
+/// Writes the file layout. Keyframes go to the stream as they arrive, the frame records and keyframe index are kept
+/// in memory until Finish().
+class FileWriter
+{
+public:
+  FileWriter();
+  ~FileWriter();
+
+  ALWAYS_INLINE const FileHeader& GetHeader() const { return m_header; }
+  ALWAYS_INLINE u32 GetFrameCount() const { return m_header.frame_count; }
+
+  /// Writes the header, which is rewritten by Finish(). The stream must be seekable, and outlive the writer.
+  bool Open(ByteStream* stream, const FileHeader& header);
+
+  /// Compresses and appends a keyframe state. Can be called on a different thread to the frame functions, but not
+  /// concurrently with itself or Finish().
+  bool WriteKeyframe(u32 frame, const void* data, u32 size);
+
+  /// Adds a record for the next frame, returning where its input data goes.
+  u8* BeginFrame();
+
+  /// Completes the frame record started by BeginFrame().
+  void EndFrame(u64 hash);
+
+  /// Writes the frame records and keyframe index, and rewrites the header.
+  bool Finish();
+
+private:
+  ByteStream* m_stream = nullptr;
+  FileHeader m_header = {};
+  std::vector<u8> m_frames;
+  std::vector<KeyframeEntry> m_keyframes;
+  std::vector<u8> m_compress_buffer;
+};
+
+/// Reads and validates the file layout.
+class FileReader
+{
+public:
+  FileReader();
+  ~FileReader();
+
+  ALWAYS_INLINE const FileHeader& GetHeader() const { return m_header; }
+  ALWAYS_INLINE u32 GetFrameCount() const { return m_header.frame_count; }
+  ALWAYS_INLINE const std::vector<KeyframeEntry>& GetKeyframes() const { return m_keyframes; }
+
+  /// Reads the header, frame records and keyframe index. The stream must outlive the reader, keyframes are read from
+  /// it on demand.
+  bool Open(ByteStream* stream, const char* name);
+
+  /// Returns the last keyframe at or before the specified frame.
+  const KeyframeEntry* FindKeyframe(u32 frame) const;
+
+  /// Reads and decompresses a keyframe state.
+  bool ReadKeyframe(const KeyframeEntry& entry, std::vector<u8>* data);
+
+  const u8* GetFrameInputs(u32 frame) const;
+  u64 GetFrameHash(u32 frame) const;
+
+private:
+  ByteStream* m_stream = nullptr;
+  FileHeader m_header = {};
+  std::vector<u8> m_frames;
+  std::vector<KeyframeEntry> m_keyframes;
+  std::vector<u8> m_compressed_buffer;
+};
+
+class Recorder
+{
+public:
+  Recorder();
+  ~Recorder();
+
+  ALWAYS_INLINE u32 GetFrameCount() const { return m_writer.GetFrameCount(); }
+
+  /// Creates the file and captures the starting state. The system must be running.
+  bool Open(const char* filename, u32 keyframe_interval);
+  void Close();
+
+  /// Captures a keyframe if one is due, and the input for the frame about to run.
+  void BeginFrame();
+
+  /// Records the hash of the frame which just ran.
+  void EndFrame();
+
+private:
+  void WaitForKeyframe();
+  void WorkerThreadEntryPoint();
+
+  std::unique_ptr<ByteStream> m_stream;
+  FileWriter m_writer;
+
+  // keyframes are compressed and written on a worker thread, since a full state takes a while to compress
+  std::vector<u8> m_keyframe_buffer;
+  u32 m_keyframe_frame = 0;
+  u32 m_keyframe_size = 0;
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  bool m_keyframe_pending = false;
+  bool m_shutdown = false;
+  bool m_write_error = false;
+};
+
+class Player
+{
+public:
+  Player();
+  ~Player();
+
+  ALWAYS_INLINE u32 GetFrameCount() const { return m_reader.GetFrameCount(); }
+  ALWAYS_INLINE u32 GetKeyframeInterval() const { return m_reader.GetHeader().keyframe_interval; }
+  ALWAYS_INLINE u32 GetCurrentFrame() const { return m_current_frame; }
+  ALWAYS_INLINE u32 GetDesyncCount() const { return m_desync_count; }
+  ALWAYS_INLINE u32 GetFirstDesyncFrame() const { return m_first_desync_frame; }
+  ALWAYS_INLINE bool IsFinished() const { return (m_current_frame >= m_reader.GetFrameCount()); }
+
+  bool Open(const char* filename);
+  bool Open(std::unique_ptr<ByteStream> stream, const char* name);
+  void Close();
+
+  /// Loads the keyframe at or before the specified frame. The caller should run frames until the current frame
+  /// reaches the target. The system must be running.
+  bool Seek(u32 frame);
+
+  /// Applies the input for the frame about to run.
+  void BeginFrame();
+
+  /// Checks the hash of the frame which just ran, from GetFrameHash(), against the recording.
+  void EndFrame(u64 hash);
+
+private:
+  bool CheckControllers();
+
+  std::unique_ptr<ByteStream> m_stream;
+  FileReader m_reader;
+  std::vector<u8> m_state_buffer;
+
+  u32 m_current_frame = 0;
+  u32 m_desync_count = 0;
+  u32 m_first_desync_frame = 0;
+};
+
+} // namespace Movie
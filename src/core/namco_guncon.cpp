@@ -56,6 +56,17 @@ bool NamcoGunCon::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void NamcoGunCon::DoInputState(StateWrapper& sw)
+{
+  // the position depends on the host window, so record where it mapped to rather than the mouse position
+  if (sw.IsWriting())
+    UpdatePosition();
+
+  sw.Do(&m_button_state);
+  sw.Do(&m_position_x);
+  sw.Do(&m_position_y);
+}
+
 void NamcoGunCon::SetAxisState(s32 axis_code, float value) {}
 
 void NamcoGunCon::SetButtonState(Button button, bool pressed)
@@ -132,7 +143,10 @@ bool NamcoGunCon::Transfer(const u8 data_in, u8* data_out)
 
     case TransferState::XLSB:
     {
-      UpdatePosition();
+      // when recording/playing a movie, the position is latched at the start of the frame
+      if (!System::IsMovieActive())
+        UpdatePosition();
+
       *data_out = Truncate8(m_position_x);
       m_transfer_state = TransferState::XMSB;
       return true;
@@ -48,6 +48,12 @@ bool NeGcon::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void NeGcon::DoInputState(StateWrapper& sw)
+{
+  sw.Do(&m_button_state);
+  sw.Do(&m_axis_state);
+}
+
 void NeGcon::SetAxisState(s32 axis_code, float value)
 {
   if (axis_code < 0 || axis_code >= static_cast<s32>(Axis::Count))
@@ -59,6 +59,16 @@ bool PlayStationMouse::DoState(StateWrapper& sw, bool apply_input_state)
   return true;
 }
 
+void PlayStationMouse::DoInputState(StateWrapper& sw)
+{
+  if (sw.IsWriting())
+    UpdatePosition();
+
+  sw.Do(&m_button_state);
+  sw.Do(&m_delta_x);
+  sw.Do(&m_delta_y);
+}
+
 void PlayStationMouse::SetAxisState(s32 axis_code, float value) {}
 
 void PlayStationMouse::SetButtonState(Button button, bool pressed)
@@ -128,7 +138,10 @@ bool PlayStationMouse::Transfer(const u8 data_in, u8* data_out)
 
     case TransferState::DeltaX:
     {
-      UpdatePosition();
+      // when recording/playing a movie, the movement is latched at the start of the frame
+      if (!System::IsMovieActive())
+        UpdatePosition();
+
       *data_out = static_cast<u8>(m_delta_x);
       m_transfer_state = TransferState::DeltaY;
       return true;
@@ -138,6 +151,14 @@ bool PlayStationMouse::Transfer(const u8 data_in, u8* data_out)
     {
       *data_out = static_cast<u8>(m_delta_y);
       m_transfer_state = TransferState::Idle;
+
+      // only report the latched movement once, same as the host would
+      if (System::IsMovieActive())
+      {
+        m_delta_x = 0;
+        m_delta_y = 0;
+      }
+
       return false;
     }
 
@@ -144,6 +144,10 @@ void Settings::Load(SettingsInterface& si)
   gpu_resolution_scale = static_cast<u32>(si.GetIntValue("GPU", "ResolutionScale", 1));
   gpu_multisamples = static_cast<u32>(si.GetIntValue("GPU", "Multisamples", 1));
   gpu_use_debug_device = si.GetBoolValue("GPU", "UseDebugDevice", false);
+  gpu_async_pipeline_compilation = si.GetBoolValue("GPU", "AsyncPipelineCompilation", false);
+  gpu_palette_texture_cache = si.GetBoolValue("GPU", "PaletteTextureCache", false);
+  gpu_vulkan_render_thread = si.GetBoolValue("GPU", "VulkanRenderThread", false);
+  gpu_sprite_instancing = si.GetBoolValue("GPU", "SpriteInstancing", true);
   gpu_per_sample_shading = si.GetBoolValue("GPU", "PerSampleShading", false);
   gpu_use_thread = si.GetBoolValue("GPU", "UseThread", true);
   gpu_threaded_presentation = si.GetBoolValue("GPU", "ThreadedPresentation", true);
@@ -192,9 +196,11 @@ void Settings::Load(SettingsInterface& si)
   display_show_vps = si.GetBoolValue("Display", "ShowVPS", false);
   display_show_speed = si.GetBoolValue("Display", "ShowSpeed", false);
   display_show_resolution = si.GetBoolValue("Display", "ShowResolution", false);
+  display_show_present_latency = si.GetBoolValue("Display", "ShowPresentLatency", false);
   video_sync_enabled = si.GetBoolValue("Display", "VSync", true);
   display_post_process_chain = si.GetStringValue("Display", "PostProcessChain", "");
   display_max_fps = si.GetFloatValue("Display", "MaxFPS", 0.0f);
+  display_frame_skip = static_cast<u32>(si.GetIntValue("Display", "FrameSkip", 0));
 
   cdrom_read_thread = si.GetBoolValue("CDROM", "ReadThread", true);
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", true);
@@ -252,6 +258,7 @@ void Settings::Load(SettingsInterface& si)
   log_to_debug = si.GetBoolValue("Logging", "LogToDebug", false);
   log_to_window = si.GetBoolValue("Logging", "LogToWindow", false);
   log_to_file = si.GetBoolValue("Logging", "LogToFile", false);
+  log_async = si.GetBoolValue("Logging", "LogAsync", false);
 
   debugging.show_vram = si.GetBoolValue("Debug", "ShowVRAM");
   debugging.dump_cpu_to_vram_copies = si.GetBoolValue("Debug", "DumpCPUToVRAMCopies");
@@ -268,6 +275,10 @@ void Settings::Load(SettingsInterface& si)
   texture_replacements.enable_vram_write_replacements =
     si.GetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements", false);
   texture_replacements.preload_textures = si.GetBoolValue("TextureReplacements", "PreloadTextures", false);
+  texture_replacements.async_loading = si.GetBoolValue("TextureReplacements", "AsyncLoading", false);
+  texture_replacements.prefetch_textures = si.GetBoolValue("TextureReplacements", "PrefetchTextures", false);
+  texture_replacements.memory_budget_mb = static_cast<u32>(
+    si.GetIntValue("TextureReplacements", "MemoryBudget", DEFAULT_TEXTURE_REPLACEMENT_MEMORY_BUDGET));
   texture_replacements.dump_vram_writes = si.GetBoolValue("TextureReplacements", "DumpVRAMWrites", false);
   texture_replacements.dump_vram_write_force_alpha_channel =
     si.GetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel", true);
@@ -309,6 +320,10 @@ void Settings::Save(SettingsInterface& si) const
   si.SetIntValue("GPU", "ResolutionScale", static_cast<long>(gpu_resolution_scale));
   si.SetIntValue("GPU", "Multisamples", static_cast<long>(gpu_multisamples));
   si.SetBoolValue("GPU", "UseDebugDevice", gpu_use_debug_device);
+  si.SetBoolValue("GPU", "AsyncPipelineCompilation", gpu_async_pipeline_compilation);
+  si.SetBoolValue("GPU", "PaletteTextureCache", gpu_palette_texture_cache);
+  si.SetBoolValue("GPU", "VulkanRenderThread", gpu_vulkan_render_thread);
+  si.SetBoolValue("GPU", "SpriteInstancing", gpu_sprite_instancing);
   si.SetBoolValue("GPU", "PerSampleShading", gpu_per_sample_shading);
   si.SetBoolValue("GPU", "UseThread", gpu_use_thread);
   si.SetBoolValue("GPU", "ThreadedPresentation", gpu_threaded_presentation);
@@ -345,12 +360,14 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Display", "ShowVPS", display_show_vps);
   si.SetBoolValue("Display", "ShowSpeed", display_show_speed);
   si.SetBoolValue("Display", "ShowResolution", display_show_speed);
+  si.SetBoolValue("Display", "ShowPresentLatency", display_show_present_latency);
   si.SetBoolValue("Display", "VSync", video_sync_enabled);
   if (display_post_process_chain.empty())
     si.DeleteValue("Display", "PostProcessChain");
   else
     si.SetStringValue("Display", "PostProcessChain", display_post_process_chain.c_str());
   si.SetFloatValue("Display", "MaxFPS", display_max_fps);
+  si.SetIntValue("Display", "FrameSkip", static_cast<int>(display_frame_skip));
 
   si.SetBoolValue("CDROM", "ReadThread", cdrom_read_thread);
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
@@ -397,6 +414,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Logging", "LogToDebug", log_to_debug);
   si.SetBoolValue("Logging", "LogToWindow", log_to_window);
   si.SetBoolValue("Logging", "LogToFile", log_to_file);
+  si.SetBoolValue("Logging", "LogAsync", log_async);
 
   si.SetBoolValue("Debug", "ShowVRAM", debugging.show_vram);
   si.SetBoolValue("Debug", "DumpCPUToVRAMCopies", debugging.dump_cpu_to_vram_copies);
@@ -411,6 +429,9 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements",
                   texture_replacements.enable_vram_write_replacements);
   si.SetBoolValue("TextureReplacements", "PreloadTextures", texture_replacements.preload_textures);
+  si.SetBoolValue("TextureReplacements", "AsyncLoading", texture_replacements.async_loading);
+  si.SetBoolValue("TextureReplacements", "PrefetchTextures", texture_replacements.prefetch_textures);
+  si.SetIntValue("TextureReplacements", "MemoryBudget", static_cast<int>(texture_replacements.memory_budget_mb));
   si.SetBoolValue("TextureReplacements", "DumpVRAMWrites", texture_replacements.dump_vram_writes);
   si.SetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel",
                   texture_replacements.dump_vram_write_force_alpha_channel);
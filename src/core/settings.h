@@ -102,6 +102,10 @@ struct Settings
   bool gpu_use_thread = true;
   bool gpu_threaded_presentation = true;
   bool gpu_use_debug_device = false;
+  bool gpu_async_pipeline_compilation = false;
+  bool gpu_palette_texture_cache = false;
+  bool gpu_vulkan_render_thread = false;
+  bool gpu_sprite_instancing = true;
   bool gpu_per_sample_shading = false;
   bool gpu_true_color = true;
   bool gpu_scaled_dithering = false;
@@ -133,8 +137,10 @@ struct Settings
   bool display_show_vps = false;
   bool display_show_speed = false;
   bool display_show_resolution = false;
+  bool display_show_present_latency = false;
   bool video_sync_enabled = true;
   float display_max_fps = 0.0f;
+  u32 display_frame_skip = 0; // frames skipped between each presented frame, when running above normal speed
   float gpu_pgxp_tolerance = -1.0f;
   float gpu_pgxp_depth_clear_threshold = 300.0f / 4096.0f;
 
@@ -182,6 +188,9 @@ struct Settings
   {
     bool enable_vram_write_replacements = false;
     bool preload_textures = false;
+    bool async_loading = false;
+    bool prefetch_textures = false;
+    u32 memory_budget_mb = 1024; // 0 = unlimited
 
     bool dump_vram_writes = false;
     bool dump_vram_write_force_alpha_channel = true;
@@ -214,6 +223,7 @@ struct Settings
   bool log_to_debug = false;
   bool log_to_window = false;
   bool log_to_file = false;
+  bool log_async = false;
 
   ALWAYS_INLINE bool IsUsingCodeCache() const { return (cpu_execution_mode != CPUExecutionMode::Interpreter); }
   ALWAYS_INLINE bool IsUsingRecompiler() const { return (cpu_execution_mode == CPUExecutionMode::Recompiler); }
@@ -256,6 +266,7 @@ struct Settings
     DEFAULT_GPU_MAX_RUN_AHEAD = 128,
     DEFAULT_VRAM_WRITE_DUMP_WIDTH_THRESHOLD = 128,
     DEFAULT_VRAM_WRITE_DUMP_HEIGHT_THRESHOLD = 128,
+    DEFAULT_TEXTURE_REPLACEMENT_MEMORY_BUDGET = 1024,
   };
 
   void Load(SettingsInterface& si);
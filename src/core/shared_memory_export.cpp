@@ -0,0 +1,420 @@
+#include "shared_memory_export.h"
+#include "bus.h"
+#include "common/align.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "controller.h"
+#include "host_display.h"
+#include "media_capture.h"
+#include "pad.h"
+#include "stb_image_resize.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#if defined(WIN32)
+#include "common/windows_headers.h"
+#elif !defined(ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Log_SetChannel(SharedMemoryExport);
+
+// media capture reads back through the slots below this one
+static constexpr u32 DISPLAY_DOWNLOAD_SLOT = HostDisplay::MAX_ASYNC_DOWNLOAD_SLOTS - 1;
+static_assert(MediaCapture::NUM_READBACK_SLOTS <= DISPLAY_DOWNLOAD_SLOT, "download slots don't overlap");
+
+SharedMemoryExport::SharedMemoryExport() = default;
+
+SharedMemoryExport::~SharedMemoryExport()
+{
+  Destroy();
+}
+
+bool SharedMemoryExport::Create(const char* name, u32 audio_sample_rate)
+{
+  Destroy();
+
+#ifdef WIN32
+  m_name = name;
+#else
+  m_name = (name[0] == '/') ? std::string(name) : (std::string("/") + name);
+#endif
+
+  const u32 pixels_size = Common::AlignUpPow2(MAX_FRAME_WIDTH * MAX_FRAME_HEIGHT * sizeof(u32), REGION_ALIGNMENT);
+  const u32 audio_size = Common::AlignUpPow2(MAX_AUDIO_FRAMES * sizeof(u32), REGION_ALIGNMENT);
+  const u32 frame_slot_size =
+    Common::AlignUpPow2(static_cast<u32>(sizeof(FrameSlotHeader)) + pixels_size + audio_size + Bus::RAM_SIZE,
+                        REGION_ALIGNMENT);
+  const u32 frame_slot_offset = Common::AlignUpPow2(static_cast<u32>(sizeof(SegmentHeader)), REGION_ALIGNMENT);
+  const u32 input_offset = frame_slot_offset + frame_slot_size * NUM_FRAME_SLOTS;
+  const u32 segment_size = input_offset + Common::AlignUpPow2(static_cast<u32>(sizeof(InputBlock)), REGION_ALIGNMENT);
+  if (!MapSegment(segment_size))
+    return false;
+
+  // a segment left behind by a previous run can be reused, so don't rely on it being zeroed
+  std::memset(m_base, 0, m_size);
+
+  SegmentHeader* header = GetHeader();
+  header->version = SEGMENT_VERSION;
+  header->segment_size = segment_size;
+  header->num_frame_slots = NUM_FRAME_SLOTS;
+  header->frame_slot_offset = frame_slot_offset;
+  header->frame_slot_size = frame_slot_size;
+  header->input_offset = input_offset;
+  header->audio_sample_rate = audio_sample_rate;
+  header->max_frame_width = MAX_FRAME_WIDTH;
+  header->max_frame_height = MAX_FRAME_HEIGHT;
+  header->max_audio_frames = MAX_AUDIO_FRAMES;
+  header->ram_size = Bus::RAM_SIZE;
+  header->latest_slot.store(NUM_FRAME_SLOTS, std::memory_order_relaxed);
+
+  for (u32 i = 0; i < NUM_FRAME_SLOTS; i++)
+  {
+    FrameSlotHeader* slot_header = reinterpret_cast<FrameSlotHeader*>(GetFrameSlot(i));
+    slot_header->pixels_offset = sizeof(FrameSlotHeader);
+    slot_header->audio_offset = slot_header->pixels_offset + pixels_size;
+    slot_header->ram_offset = slot_header->audio_offset + audio_size;
+  }
+
+  // the magic goes in last, so agents which are polling for the segment see a complete header
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = SEGMENT_MAGIC;
+
+  m_next_slot = 0;
+  m_pending_slot = NUM_FRAME_SLOTS;
+  m_download_started = false;
+  m_last_input_sequence = 0;
+  m_lockstep_timed_out = false;
+  m_audio_buffer.clear();
+  m_audio_frames_dropped = 0;
+
+  Log_InfoPrintf("Exporting frames to shared memory segment '%s' (%u bytes)", m_name.c_str(), segment_size);
+  return true;
+}
+
+void SharedMemoryExport::Destroy()
+{
+  if (!m_base)
+    return;
+
+  UnmapSegment();
+  m_name = {};
+  m_frame_buffer = {};
+  m_resize_buffer = {};
+  m_audio_buffer = {};
+}
+
+#if defined(WIN32)
+
+bool SharedMemoryExport::MapSegment(u32 size)
+{
+  HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, m_name.c_str());
+  if (!mapping)
+  {
+    Log_ErrorPrintf("CreateFileMapping() for '%s' failed: %u", m_name.c_str(), GetLastError());
+    return false;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (!data)
+  {
+    Log_ErrorPrintf("MapViewOfFile() for '%s' failed: %u", m_name.c_str(), GetLastError());
+    CloseHandle(mapping);
+    return false;
+  }
+
+  m_mapping_handle = mapping;
+  m_base = static_cast<u8*>(data);
+  m_size = size;
+  return true;
+}
+
+void SharedMemoryExport::UnmapSegment()
+{
+  UnmapViewOfFile(m_base);
+  CloseHandle(m_mapping_handle);
+  m_mapping_handle = nullptr;
+  m_base = nullptr;
+  m_size = 0;
+}
+
+#elif !defined(ANDROID)
+
+bool SharedMemoryExport::MapSegment(u32 size)
+{
+  const int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0)
+  {
+    Log_ErrorPrintf("shm_open() for '%s' failed: %d", m_name.c_str(), errno);
+    return false;
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+  {
+    Log_ErrorPrintf("ftruncate(%u) for '%s' failed: %d", size, m_name.c_str(), errno);
+    close(fd);
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    Log_ErrorPrintf("mmap() for '%s' failed: %d", m_name.c_str(), errno);
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  m_base = static_cast<u8*>(data);
+  m_size = size;
+  return true;
+}
+
+void SharedMemoryExport::UnmapSegment()
+{
+  // agents which still have the segment mapped keep it alive, but it can't be opened by name anymore
+  munmap(m_base, m_size);
+  shm_unlink(m_name.c_str());
+  m_base = nullptr;
+  m_size = 0;
+}
+
+#else
+
+bool SharedMemoryExport::MapSegment(u32 size)
+{
+  Log_ErrorPrintf("Shared memory export is not supported on this platform");
+  return false;
+}
+
+void SharedMemoryExport::UnmapSegment() {}
+
+#endif
+
+bool SharedMemoryExport::ReadInput(u32* sequence, PortInputArray* ports)
+{
+  const InputBlock* input = GetInputBlock();
+  const u32 start_sequence = input->sequence.load(std::memory_order_acquire);
+  if (start_sequence == m_last_input_sequence || (start_sequence & 1u) != 0)
+    return false;
+
+  std::memcpy(ports->data(), input->ports, sizeof(input->ports));
+
+  // if the agent started writing again while we were copying, pick it up next time
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (input->sequence.load(std::memory_order_relaxed) != start_sequence)
+    return false;
+
+  *sequence = start_sequence;
+  return true;
+}
+
+void SharedMemoryExport::ApplyInput(const PortInputArray& ports)
+{
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    Controller* controller = g_pad.GetController(i);
+    if (!controller)
+      continue;
+
+    const PortInput& port = ports[i];
+    for (u32 code = 0; code < 32; code++)
+    {
+      if (port.button_mask & (1u << code))
+        controller->SetButtonState(static_cast<s32>(code), (port.buttons & (1u << code)) != 0);
+    }
+
+    for (u32 code = 0; code < MAX_INPUT_AXES; code++)
+    {
+      if (port.axis_mask & (1u << code))
+        controller->SetAxisState(static_cast<s32>(code), std::clamp(port.axes[code], -1.0f, 1.0f));
+    }
+  }
+}
+
+void SharedMemoryExport::BeginFrame(u32 frame_number)
+{
+  if (!m_base)
+    return;
+
+  InputBlock* input = GetInputBlock();
+  PortInputArray ports;
+  u32 sequence;
+  if (input->lockstep.load(std::memory_order_relaxed) != 0 && !m_lockstep_timed_out)
+  {
+    // spin rather than sleep, the agent is expected to respond well within a frame
+    Common::Timer timer;
+    while (!ReadInput(&sequence, &ports))
+    {
+      if (timer.GetTimeMilliseconds() >= LOCKSTEP_TIMEOUT_MS)
+      {
+        // don't wait again until the agent catches up, otherwise every frame takes the timeout
+        Log_WarningPrintf("No input from agent after %u ms, running frame %u without it", LOCKSTEP_TIMEOUT_MS,
+                          frame_number);
+        m_lockstep_timed_out = true;
+        return;
+      }
+
+      std::this_thread::yield();
+    }
+  }
+  else if (!ReadInput(&sequence, &ports))
+  {
+    return;
+  }
+
+  ApplyInput(ports);
+  m_last_input_sequence = sequence;
+  m_lockstep_timed_out = false;
+  input->applied_frame_number.store(frame_number, std::memory_order_relaxed);
+  input->applied_sequence.store(sequence, std::memory_order_release);
+}
+
+void SharedMemoryExport::EndFrame(HostDisplay* display, u32 frame_number)
+{
+  if (!m_base)
+    return;
+
+  // the previous frame's readback has had a whole frame to complete by now
+  if (m_pending_slot != NUM_FRAME_SLOTS)
+    CompleteFrameSlot(display);
+
+  StartFrameSlot(display, frame_number);
+
+  // holding the frame back would only add a frame of latency, the agent won't send input until it sees it
+  if (GetInputBlock()->lockstep.load(std::memory_order_relaxed) != 0)
+    CompleteFrameSlot(display);
+}
+
+void SharedMemoryExport::StartFrameSlot(HostDisplay* display, u32 frame_number)
+{
+  const u32 slot_index = m_next_slot;
+  m_next_slot = (m_next_slot + 1) % NUM_FRAME_SLOTS;
+
+  // the sequence stays odd until the image is written, the fence keeps the payload stores from moving above it
+  u8* slot = GetFrameSlot(slot_index);
+  FrameSlotHeader* slot_header = reinterpret_cast<FrameSlotHeader*>(slot);
+  m_pending_slot = slot_index;
+  m_pending_sequence = slot_header->sequence.load(std::memory_order_relaxed) + 1;
+  slot_header->sequence.store(m_pending_sequence, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot_header->frame_number.store(frame_number, std::memory_order_relaxed);
+  slot_header->num_audio_frames.store(static_cast<u32>(m_audio_buffer.size()), std::memory_order_relaxed);
+  slot_header->audio_frames_dropped.store(m_audio_frames_dropped, std::memory_order_relaxed);
+  if (!m_audio_buffer.empty())
+    std::memcpy(slot + slot_header->audio_offset, m_audio_buffer.data(), m_audio_buffer.size() * sizeof(u32));
+  std::memcpy(slot + slot_header->ram_offset, Bus::g_ram, Bus::RAM_SIZE);
+
+  m_audio_buffer.clear();
+  m_audio_frames_dropped = 0;
+
+  m_download_started =
+    (display && display->BeginDisplayTextureAsyncDownload(DISPLAY_DOWNLOAD_SLOT, &m_download_width,
+                                                          &m_download_height, &m_download_format, &m_download_flip_y));
+}
+
+void SharedMemoryExport::CompleteFrameSlot(HostDisplay* display)
+{
+  u8* slot = GetFrameSlot(m_pending_slot);
+  FrameSlotHeader* slot_header = reinterpret_cast<FrameSlotHeader*>(slot);
+
+  u32 width = 0;
+  u32 height = 0;
+  if (m_download_started && display &&
+      !ReadFrameImage(display, reinterpret_cast<u32*>(slot + slot_header->pixels_offset), &width, &height))
+  {
+    width = 0;
+    height = 0;
+  }
+
+  slot_header->width.store(width, std::memory_order_relaxed);
+  slot_header->height.store(height, std::memory_order_relaxed);
+  slot_header->stride.store(width * sizeof(u32), std::memory_order_relaxed);
+  slot_header->sequence.store(m_pending_sequence + 1, std::memory_order_release);
+
+  SegmentHeader* header = GetHeader();
+  header->latest_slot.store(m_pending_slot, std::memory_order_release);
+  header->frames_published.store(header->frames_published.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_release);
+
+  m_pending_slot = NUM_FRAME_SLOTS;
+  m_download_started = false;
+}
+
+bool SharedMemoryExport::ReadFrameImage(HostDisplay* display, u32* pixels, u32* width, u32* height)
+{
+  u32 image_width = m_download_width;
+  u32 image_height = m_download_height;
+  u32 stride = Common::AlignUpPow2(image_width * HostDisplay::GetDisplayPixelFormatSize(m_download_format), 4);
+  m_frame_buffer.resize((stride / sizeof(u32)) * image_height);
+  if (!display->EndAsyncDownload(DISPLAY_DOWNLOAD_SLOT, m_frame_buffer.data(), stride) ||
+      !HostDisplay::ConvertTextureDataToRGBA8(image_width, image_height, m_frame_buffer, stride, m_download_format))
+  {
+    Log_ErrorPrintf("Failed to read back frame image");
+    return false;
+  }
+
+  if (image_width > MAX_FRAME_WIDTH || image_height > MAX_FRAME_HEIGHT)
+  {
+    // upscaled frames are shrunk to fit, keeping the aspect ratio
+    const float scale = std::min(static_cast<float>(MAX_FRAME_WIDTH) / static_cast<float>(image_width),
+                                 static_cast<float>(MAX_FRAME_HEIGHT) / static_cast<float>(image_height));
+    const u32 resized_width =
+      std::clamp(static_cast<u32>(static_cast<float>(image_width) * scale), 1u, static_cast<u32>(MAX_FRAME_WIDTH));
+    const u32 resized_height =
+      std::clamp(static_cast<u32>(static_cast<float>(image_height) * scale), 1u, static_cast<u32>(MAX_FRAME_HEIGHT));
+    m_resize_buffer.resize(resized_width * resized_height);
+    if (!stbir_resize_uint8(reinterpret_cast<const u8*>(m_frame_buffer.data()), image_width, image_height, stride,
+                            reinterpret_cast<u8*>(m_resize_buffer.data()), resized_width, resized_height,
+                            resized_width * sizeof(u32), 4))
+    {
+      Log_ErrorPrintf("Failed to resize frame image from %ux%u to %ux%u", image_width, image_height, resized_width,
+                      resized_height);
+      return false;
+    }
+
+    m_frame_buffer.swap(m_resize_buffer);
+    image_width = resized_width;
+    image_height = resized_height;
+    stride = resized_width * sizeof(u32);
+  }
+
+  // some backends return the rows bottom-up
+  const u8* src_base = reinterpret_cast<const u8*>(m_frame_buffer.data());
+  u32* dst = pixels;
+  for (u32 row = 0; row < image_height; row++)
+  {
+    const u32 src_row = m_download_flip_y ? (image_height - 1 - row) : row;
+    const u32* src = reinterpret_cast<const u32*>(src_base + (src_row * stride));
+    for (u32 col = 0; col < image_width; col++)
+      *(dst++) = src[col] | 0xFF000000u;
+  }
+
+  *width = image_width;
+  *height = image_height;
+  return true;
+}
+
+void SharedMemoryExport::AddAudioFrames(const s16* frames, u32 num_frames)
+{
+  if (!m_base)
+    return;
+
+  // only happens when the frame rate drops far below the sample rate, e.g. the guest stops rendering
+  const u32 space = MAX_AUDIO_FRAMES - static_cast<u32>(m_audio_buffer.size());
+  const u32 frames_to_add = std::min(num_frames, space);
+  m_audio_frames_dropped += num_frames - frames_to_add;
+  if (frames_to_add == 0)
+    return;
+
+  const size_t start = m_audio_buffer.size();
+  m_audio_buffer.resize(start + frames_to_add);
+  std::memcpy(&m_audio_buffer[start], frames, frames_to_add * sizeof(u32));
+}
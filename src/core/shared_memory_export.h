@@ -0,0 +1,183 @@
+#pragma once
+#include "types.h"
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Publishes frames, audio and RAM to a named shared memory segment, and takes controller input from it, so external
+// programs (e.g. training agents) can observe and drive the emulator without screen scraping or sockets.
+//
+// The segment starts with SegmentHeader, followed by NUM_FRAME_SLOTS frame slots and the input block, at the offsets
+// given in the header. Each frame slot holds FrameSlotHeader, the RGBA8 image, the stereo s16 samples generated
+// during the frame and a copy of RAM at the end of the frame. Slots are written in turn, and latest_slot points at the
+// last one which was completed.
+//
+// Both the frame slots and the input block are seqlocks: the writer makes the sequence odd, writes the data, then
+// makes it even again with a release store. Readers load the sequence with acquire semantics, copy the data out,
+// issue an acquire fence and load the sequence again, retrying if it was odd or has changed. All fields are
+// little-endian and naturally aligned.
+//
+// Frame images are read back from the GPU asynchronously, so a slot is completed at the end of the following frame.
+// When the agent has enabled lockstep, it is completed straight away instead, since the agent is waiting for it.
+
+class HostDisplay;
+enum class HostDisplayPixelFormat : u32;
+
+class SharedMemoryExport
+{
+public:
+  enum : u32
+  {
+    SEGMENT_MAGIC = 0x4D485344, // DSHM
+    SEGMENT_VERSION = 1,
+
+    NUM_FRAME_SLOTS = 3,
+    MAX_FRAME_WIDTH = 1024,
+    MAX_FRAME_HEIGHT = 512,
+    MAX_AUDIO_FRAMES = 4096,
+    MAX_INPUT_AXES = 8,
+    REGION_ALIGNMENT = 64,
+
+    // how long to wait for the agent in lockstep mode before running the frame anyway
+    LOCKSTEP_TIMEOUT_MS = 1000,
+  };
+
+  struct SegmentHeader
+  {
+    u32 magic;
+    u32 version;
+    u32 segment_size;
+    u32 num_frame_slots;
+    u32 frame_slot_offset;
+    u32 frame_slot_size;
+    u32 input_offset;
+    u32 audio_sample_rate;
+    u32 max_frame_width;
+    u32 max_frame_height;
+    u32 max_audio_frames;
+    u32 ram_size;
+
+    // NUM_FRAME_SLOTS until the first frame is published
+    std::atomic<u32> latest_slot;
+    std::atomic<u32> frames_published;
+    u32 reserved[2];
+  };
+
+  struct FrameSlotHeader
+  {
+    std::atomic<u32> sequence;
+    std::atomic<u32> frame_number;
+    std::atomic<u32> width;
+    std::atomic<u32> height;
+    std::atomic<u32> stride;
+    std::atomic<u32> num_audio_frames;
+    std::atomic<u32> audio_frames_dropped;
+
+    // relative to the start of the slot, these never change once the segment is created
+    u32 pixels_offset;
+    u32 audio_offset;
+    u32 ram_offset;
+    u32 reserved[6];
+  };
+
+  struct PortInput
+  {
+    // only the buttons and axes with their bit set in the mask are applied, codes are the controller's own
+    u32 button_mask;
+    u32 buttons;
+    u32 axis_mask;
+    float axes[MAX_INPUT_AXES];
+  };
+
+  struct InputBlock
+  {
+    // written by the agent
+    std::atomic<u32> sequence;
+    std::atomic<u32> lockstep;
+    PortInput ports[NUM_CONTROLLER_AND_CARD_PORTS];
+
+    // written by the emulator, once the input has been applied
+    std::atomic<u32> applied_sequence;
+    std::atomic<u32> applied_frame_number;
+  };
+
+  static_assert(sizeof(std::atomic<u32>) == sizeof(u32), "atomics can be shared");
+  static_assert(sizeof(SegmentHeader) == 64 && sizeof(FrameSlotHeader) == 64, "headers are one cache line");
+
+  SharedMemoryExport();
+  ~SharedMemoryExport();
+
+  ALWAYS_INLINE bool IsValid() const { return (m_base != nullptr); }
+  ALWAYS_INLINE const std::string& GetName() const { return m_name; }
+
+  /// Creates the named segment. On POSIX systems the name is passed to shm_open(), a leading slash is added if needed.
+  bool Create(const char* name, u32 audio_sample_rate);
+  void Destroy();
+
+  /// Applies any new input from the agent, waiting for it in lockstep mode.
+  void BeginFrame(u32 frame_number);
+
+  /// Publishes the frame which was just rendered, along with its audio and RAM. The previous frame is completed first,
+  /// now its image has been read back.
+  void EndFrame(HostDisplay* display, u32 frame_number);
+
+  /// Adds SPU output, which is published with the next frame.
+  void AddAudioFrames(const s16* frames, u32 num_frames);
+
+private:
+  ALWAYS_INLINE SegmentHeader* GetHeader() const { return reinterpret_cast<SegmentHeader*>(m_base); }
+  ALWAYS_INLINE InputBlock* GetInputBlock() const
+  {
+    return reinterpret_cast<InputBlock*>(m_base + GetHeader()->input_offset);
+  }
+  ALWAYS_INLINE u8* GetFrameSlot(u32 index) const
+  {
+    return m_base + GetHeader()->frame_slot_offset + index * GetHeader()->frame_slot_size;
+  }
+
+  bool MapSegment(u32 size);
+  void UnmapSegment();
+
+  using PortInputArray = std::array<PortInput, NUM_CONTROLLER_AND_CARD_PORTS>;
+
+  /// Returns false if there's no new input, or the agent is in the middle of writing it.
+  bool ReadInput(u32* sequence, PortInputArray* ports);
+  void ApplyInput(const PortInputArray& ports);
+
+  /// Writes everything but the image to the next slot, and starts reading the image back.
+  void StartFrameSlot(HostDisplay* display, u32 frame_number);
+
+  /// Writes the image to the pending slot and publishes it.
+  void CompleteFrameSlot(HostDisplay* display);
+
+  /// Converts the image which was read back to top-down, opaque RGBA8, shrinking it to fit if needed.
+  bool ReadFrameImage(HostDisplay* display, u32* pixels, u32* width, u32* height);
+
+  std::string m_name;
+  u8* m_base = nullptr;
+  u32 m_size = 0;
+
+#ifdef WIN32
+  void* m_mapping_handle = nullptr;
+#endif
+
+  u32 m_next_slot = 0;
+  u32 m_last_input_sequence = 0;
+  bool m_lockstep_timed_out = false;
+
+  // the slot which is waiting for its image, NUM_FRAME_SLOTS if there is none
+  u32 m_pending_slot = NUM_FRAME_SLOTS;
+  u32 m_pending_sequence = 0;
+
+  bool m_download_started = false;
+  bool m_download_flip_y = false;
+  u32 m_download_width = 0;
+  u32 m_download_height = 0;
+  HostDisplayPixelFormat m_download_format = {};
+
+  std::vector<u32> m_frame_buffer;
+  std::vector<u32> m_resize_buffer;
+  std::vector<u32> m_audio_buffer;
+  u32 m_audio_frames_dropped = 0;
+};
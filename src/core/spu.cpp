@@ -7,6 +7,8 @@
 #include "dma.h"
 #include "host_interface.h"
 #include "interrupt_controller.h"
+#include "media_capture.h"
+#include "shared_memory_export.h"
 #include "system.h"
 #ifdef WITH_IMGUI
 #include "imgui.h"
@@ -1836,6 +1838,10 @@ void SPU::Execute(TickCount ticks)
 
     if (m_dump_writer)
       m_dump_writer->WriteFrames(output_frame_start, frames_in_this_batch);
+    if (m_media_capture)
+      m_media_capture->AddAudioFrames(output_frame_start, frames_in_this_batch);
+    if (m_shared_memory_export)
+      m_shared_memory_export->AddAudioFrames(output_frame_start, frames_in_this_batch);
 
     output_stream->EndWrite(frames_in_this_batch);
     remaining_frames -= frames_in_this_batch;
@@ -7,11 +7,16 @@
 #include <memory>
 
 class StateWrapper;
+class SharedMemoryExport;
 
 namespace Common {
 class WAVWriter;
 }
 
+namespace MediaCapture {
+class Writer;
+}
+
 class TimingEvent;
 
 class SPU
@@ -53,6 +58,12 @@ public:
   /// Stops dumping audio to file, if started.
   bool StopDumpingAudio();
 
+  /// Sends output to a capture as well as the audio stream, pass null to stop.
+  void SetMediaCapture(MediaCapture::Writer* capture) { m_media_capture = capture; }
+
+  /// Publishes output to a shared memory segment as well, pass null to stop.
+  void SetSharedMemoryExport(SharedMemoryExport* shm_export) { m_shared_memory_export = shm_export; }
+
   /// Access to SPU RAM.
   const std::array<u8, RAM_SIZE>& GetRAM() const { return m_ram; }
   std::array<u8, RAM_SIZE>& GetRAM() { return m_ram; }
@@ -373,6 +384,8 @@ private:
   std::unique_ptr<TimingEvent> m_tick_event;
   std::unique_ptr<TimingEvent> m_transfer_event;
   std::unique_ptr<Common::WAVWriter> m_dump_writer;
+  MediaCapture::Writer* m_media_capture = nullptr;
+  SharedMemoryExport* m_shared_memory_export = nullptr;
   TickCount m_ticks_carry = 0;
   TickCount m_cpu_ticks_per_spu_tick = 0;
   TickCount m_cpu_tick_divider = 0;
@@ -18,13 +18,17 @@
 #include "host_display.h"
 #include "host_interface.h"
 #include "host_interface_progress_callback.h"
+#include "image_write_queue.h"
 #include "interrupt_controller.h"
 #include "libcrypt_game_codes.h"
 #include "mdec.h"
+#include "media_capture.h"
 #include "memory_card.h"
+#include "movie.h"
 #include "pad.h"
 #include "psf_loader.h"
 #include "save_state_version.h"
+#include "shared_memory_export.h"
 #include "sio.h"
 #include "spu.h"
 #include "texture_replacements.h"
@@ -81,6 +85,7 @@ static std::string s_running_game_title;
 
 static float s_throttle_frequency = 60.0f;
 static float s_target_speed = 1.0f;
+static float s_requested_speed = 1.0f;
 static s32 s_throttle_period = 0;
 static u64 s_last_throttle_time = 0;
 static Common::Timer s_throttle_timer;
@@ -91,21 +96,43 @@ static float s_worst_frame_time_accumulator = 0.0f;
 
 static float s_vps = 0.0f;
 static float s_fps = 0.0f;
+static float s_skipped_fps = 0.0f;
 static float s_speed = 0.0f;
 static float s_worst_frame_time = 0.0f;
 static float s_average_frame_time = 0.0f;
 static u32 s_last_frame_number = 0;
 static u32 s_last_internal_frame_number = 0;
+static u32 s_skipped_frame_count = 0;
+static u32 s_last_skipped_frame_count = 0;
+static u32 s_frames_since_rendered = 0;
+static bool s_frame_skipped = false;
 static u32 s_last_global_tick_counter = 0;
 static Common::Timer s_fps_timer;
 static Common::Timer s_frame_timer;
 
+// filled as frames are presented, and copied out once a second with the other counters
+static LatencyStatistics s_latency_statistics;
+static LatencyStatistics s_latency_accumulator;
+static Common::Timer::Value s_frame_start_time = 0;
+static Common::Timer::Value s_frame_end_time = 0;
+static Common::Timer::Value s_last_present_time = 0;
+static std::vector<HostDisplay::FrameTimestamps> s_presented_frames;
+
 // Playlist of disc images.
 static std::vector<std::string> s_media_playlist;
 static std::string s_media_playlist_filename;
 
 static std::unique_ptr<CheatList> s_cheat_list;
 
+static std::unique_ptr<Movie::Recorder> s_movie_recorder;
+static std::unique_ptr<Movie::Player> s_movie_player;
+
+static std::unique_ptr<MediaCapture::Writer> s_media_capture;
+static std::unique_ptr<SharedMemoryExport> s_shared_memory_export;
+
+// Reused between save/load state calls so that frequent states don't go back to the heap each time.
+static std::vector<u8> s_state_arena;
+
 State GetState()
 {
   return s_state;
@@ -192,6 +219,41 @@ void IncrementInternalFrameNumber()
   s_internal_frame_number++;
 }
 
+bool IsFrameSkipped()
+{
+  return s_frame_skipped;
+}
+
+void UpdateSkippedFrameDisplay()
+{
+  if (IsShutdown() || !g_gpu->IsDisplayOutdated())
+    return;
+
+  g_gpu->RestoreGraphicsAPIState();
+  g_gpu->UpdateOutdatedDisplay();
+  g_gpu->ResetGraphicsAPIState();
+}
+
+static bool ShouldSkipFrame()
+{
+  // only worth it when fast forwarding, in turbo or unthrottled, and captures need every frame
+  if (g_settings.display_frame_skip == 0 || (s_requested_speed > 0.0f && s_requested_speed <= 1.0f) ||
+      s_media_capture || s_shared_memory_export)
+  {
+    s_frames_since_rendered = 0;
+    return false;
+  }
+
+  if (s_frames_since_rendered >= g_settings.display_frame_skip)
+  {
+    s_frames_since_rendered = 0;
+    return false;
+  }
+
+  s_frames_since_rendered++;
+  return true;
+}
+
 const std::string& GetRunningPath()
 {
   return s_running_game_path;
@@ -214,6 +276,10 @@ float GetVPS()
 {
   return s_vps;
 }
+float GetSkippedFPS()
+{
+  return s_skipped_fps;
+}
 float GetEmulationSpeed()
 {
   return s_speed;
@@ -230,6 +296,10 @@ float GetThrottleFrequency()
 {
   return s_throttle_frequency;
 }
+const LatencyStatistics& GetLatencyStatistics()
+{
+  return s_latency_statistics;
+}
 
 bool IsExeFileName(const char* path)
 {
@@ -494,8 +564,14 @@ bool RecreateGPU(GPURenderer renderer, bool update_display /* = true*/)
   g_gpu->RestoreGraphicsAPIState();
 
   // save current state
-  std::unique_ptr<ByteStream> state_stream = ByteStream_CreateGrowableMemoryStream();
-  StateWrapper sw(state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  StateWrapper measure_sw(nullptr, 0, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  g_gpu->DoState(measure_sw, false);
+  TimingEvents::DoState(measure_sw);
+  if (s_state_arena.size() < measure_sw.GetBufferPosition())
+    s_state_arena.resize(measure_sw.GetBufferPosition());
+
+  StateWrapper sw(s_state_arena.data(), static_cast<u32>(s_state_arena.size()), StateWrapper::Mode::Write,
+                  SAVE_STATE_VERSION);
   const bool state_valid = g_gpu->DoState(sw, false) && TimingEvents::DoState(sw);
   if (!state_valid)
     Log_ErrorPrintf("Failed to save old GPU state when switching renderers");
@@ -515,8 +591,7 @@ bool RecreateGPU(GPURenderer renderer, bool update_display /* = true*/)
 
   if (state_valid)
   {
-    state_stream->SeekAbsolute(0);
-    sw.SetMode(StateWrapper::Mode::Read);
+    sw.ResetBuffer(StateWrapper::Mode::Read);
     g_gpu->RestoreGraphicsAPIState();
     g_gpu->DoState(sw, update_display);
     TimingEvents::DoState(sw);
@@ -727,14 +802,24 @@ bool Initialize(bool force_software_renderer)
 
   s_vps = 0.0f;
   s_fps = 0.0f;
+  s_skipped_fps = 0.0f;
   s_speed = 0.0f;
   s_worst_frame_time = 0.0f;
   s_average_frame_time = 0.0f;
   s_last_frame_number = 0;
   s_last_internal_frame_number = 0;
+  s_skipped_frame_count = 0;
+  s_last_skipped_frame_count = 0;
+  s_frames_since_rendered = 0;
+  s_frame_skipped = false;
   s_last_global_tick_counter = 0;
   s_fps_timer.Reset();
   s_frame_timer.Reset();
+  s_latency_statistics = {};
+  s_latency_accumulator = {};
+  s_frame_start_time = 0;
+  s_frame_end_time = 0;
+  s_last_present_time = 0;
 
   TimingEvents::Initialize();
 
@@ -777,13 +862,20 @@ void Shutdown()
   if (s_state == State::Shutdown)
     return;
 
+  StopMovieRecording();
+  StopMoviePlayback();
+  StopMediaCapture();
+  StopSharedMemoryExport();
+
   g_texture_replacements.Shutdown();
+  g_image_write_queue.Shutdown();
 
   g_sio.Shutdown();
   g_mdec.Shutdown();
   g_spu.Shutdown();
   g_timers.Shutdown();
   g_pad.Shutdown();
+  MemoryCard::FlushPendingSaves();
   g_cdrom.Shutdown();
   g_gpu.reset();
   g_interrupt_controller.Shutdown();
@@ -798,6 +890,7 @@ void Shutdown()
   s_media_playlist.clear();
   s_media_playlist_filename.clear();
   s_cheat_list.reset();
+  std::vector<u8>().swap(s_state_arena);
   s_state = State::Shutdown;
 }
 
@@ -1083,9 +1176,24 @@ bool DoLoadState(ByteStream* state, bool force_software_renderer, bool update_di
   if (!state->SeekAbsolute(header.offset_to_data))
     return false;
 
-  StateWrapper sw(state, StateWrapper::Mode::Read, header.version);
-  if (!DoState(sw, update_display))
-    return false;
+  if (header.data_uncompressed_size > 0)
+  {
+    // pull the whole state in with one read, rather than going through the stream for every field
+    if (s_state_arena.size() < header.data_uncompressed_size)
+      s_state_arena.resize(header.data_uncompressed_size);
+    if (!state->Read2(s_state_arena.data(), header.data_uncompressed_size))
+      return false;
+
+    StateWrapper sw(s_state_arena.data(), header.data_uncompressed_size, StateWrapper::Mode::Read, header.version);
+    if (!DoState(sw, update_display))
+      return false;
+  }
+  else
+  {
+    StateWrapper sw(state, StateWrapper::Mode::Read, header.version);
+    if (!DoState(sw, update_display))
+      return false;
+  }
 
   if (s_state == State::Starting)
     s_state = State::Running;
@@ -1130,6 +1238,8 @@ bool SaveState(ByteStream* state, u32 screenshot_size /* = 128 */)
   // save screenshot
   if (screenshot_size > 0)
   {
+    UpdateSkippedFrameDisplay();
+
     std::vector<u32> screenshot_buffer;
     if (g_host_interface->GetDisplay()->WriteDisplayTextureToBuffer(&screenshot_buffer, screenshot_size,
                                                                     screenshot_size) &&
@@ -1148,18 +1258,21 @@ bool SaveState(ByteStream* state, u32 screenshot_size /* = 128 */)
   {
     header.offset_to_data = static_cast<u32>(state->GetPosition());
 
-    g_gpu->RestoreGraphicsAPIState();
-
-    StateWrapper sw(state, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-    const bool result = DoState(sw, false);
+    const u32 data_size = GetStateDataSize();
+    if (data_size == 0)
+      return false;
 
-    g_gpu->ResetGraphicsAPIState();
+    if (s_state_arena.size() < data_size)
+      s_state_arena.resize(data_size);
 
-    if (!result)
+    if (SaveStateToBuffer(s_state_arena.data(), data_size) != data_size ||
+        !state->Write2(s_state_arena.data(), data_size))
+    {
       return false;
+    }
 
     header.data_compression_type = 0;
-    header.data_uncompressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+    header.data_uncompressed_size = data_size;
   }
 
   // re-write header
@@ -1173,6 +1286,43 @@ bool SaveState(ByteStream* state, u32 screenshot_size /* = 128 */)
   return true;
 }
 
+u32 GetStateDataSize()
+{
+  if (IsShutdown())
+    return 0;
+
+  StateWrapper sw(nullptr, 0, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  if (!DoState(sw, false))
+    return 0;
+
+  return sw.GetBufferPosition();
+}
+
+u32 SaveStateToBuffer(void* buffer, u32 buffer_size)
+{
+  if (IsShutdown())
+    return 0;
+
+  g_gpu->RestoreGraphicsAPIState();
+
+  StateWrapper sw(buffer, buffer_size, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  const bool result = DoState(sw, false);
+
+  g_gpu->ResetGraphicsAPIState();
+
+  return result ? sw.GetBufferPosition() : 0;
+}
+
+bool LoadStateFromBuffer(const void* buffer, u32 buffer_size, bool update_display /* = true */)
+{
+  if (IsShutdown())
+    return false;
+
+  // the buffer is only ever read from in read mode
+  StateWrapper sw(const_cast<void*>(buffer), buffer_size, StateWrapper::Mode::Read, SAVE_STATE_VERSION);
+  return DoState(sw, update_display);
+}
+
 void SingleStepCPU()
 {
   const u32 old_frame_number = s_frame_number;
@@ -1194,6 +1344,21 @@ void SingleStepCPU()
 void RunFrame()
 {
   s_frame_timer.Reset();
+  s_frame_start_time = Common::Timer::GetValue();
+
+  s_frame_skipped = ShouldSkipFrame();
+  if (s_frame_skipped)
+    s_skipped_frame_count++;
+
+  // agent input goes first, so it ends up in the movie being recorded
+  if (s_shared_memory_export)
+    s_shared_memory_export->BeginFrame(s_frame_number);
+
+  // input has to be applied before the graphics state is restored, in case a keyframe is saved
+  if (s_movie_recorder)
+    s_movie_recorder->BeginFrame();
+  else if (s_movie_player)
+    s_movie_player->BeginFrame();
 
   g_gpu->RestoreGraphicsAPIState();
 
@@ -1231,6 +1396,28 @@ void RunFrame()
     s_cheat_list->Apply();
 
   g_gpu->ResetGraphicsAPIState();
+
+  if (s_media_capture)
+    s_media_capture->CaptureFrame(g_host_interface->GetDisplay(), s_frame_number);
+  if (s_shared_memory_export)
+    s_shared_memory_export->EndFrame(g_host_interface->GetDisplay(), s_frame_number);
+
+  if (s_movie_recorder)
+  {
+    s_movie_recorder->EndFrame();
+  }
+  else if (s_movie_player)
+  {
+    s_movie_player->EndFrame(Movie::GetFrameHash());
+    if (s_movie_player->IsFinished())
+      StopMoviePlayback();
+  }
+
+  s_frame_end_time = Common::Timer::GetValue();
+
+  // displays which present on a thread report these back with the present time
+  if (HostDisplay* display = g_host_interface->GetDisplay(); display)
+    display->SetFrameTimestamps(s_frame_start_time, s_frame_end_time);
 }
 
 float GetTargetSpeed()
@@ -1238,9 +1425,10 @@ float GetTargetSpeed()
   return s_target_speed;
 }
 
-void SetTargetSpeed(float speed)
+void SetTargetSpeed(float speed, float requested_speed)
 {
   s_target_speed = speed;
+  s_requested_speed = requested_speed;
   UpdateThrottlePeriod();
 }
 
@@ -1355,14 +1543,27 @@ void UpdatePerformanceCounters()
   s_last_frame_number = s_frame_number;
   s_fps = static_cast<float>(s_internal_frame_number - s_last_internal_frame_number) / time;
   s_last_internal_frame_number = s_internal_frame_number;
+  s_skipped_fps = static_cast<float>(s_skipped_frame_count - s_last_skipped_frame_count) / time;
+  s_last_skipped_frame_count = s_skipped_frame_count;
   s_speed = static_cast<float>(static_cast<double>(global_tick_counter - s_last_global_tick_counter) /
                                (static_cast<double>(g_ticks_per_second) * time)) *
             100.0f;
   s_last_global_tick_counter = global_tick_counter;
   s_fps_timer.Reset();
 
-  Log_VerbosePrintf("FPS: %.2f VPS: %.2f Average: %.2fms Worst: %.2fms", s_fps, s_vps, s_average_frame_time,
-                    s_worst_frame_time);
+  Log_VerbosePrintf("FPS: %.2f VPS: %.2f Skipped: %.2f Average: %.2fms Worst: %.2fms", s_fps, s_vps, s_skipped_fps,
+                    s_average_frame_time, s_worst_frame_time);
+
+  s_latency_statistics = s_latency_accumulator;
+  s_latency_accumulator = {};
+  Log_VerbosePrintf("Input to present: %.2fms (99%%: %.2fms) Frame to present: %.2fms (99%%: %.2fms) Present "
+                    "interval: %.2fms (99%%: %.2fms)",
+                    s_latency_statistics.input_to_present.GetAverage(),
+                    s_latency_statistics.input_to_present.GetPercentile(0.99f),
+                    s_latency_statistics.frame_to_present.GetAverage(),
+                    s_latency_statistics.frame_to_present.GetPercentile(0.99f),
+                    s_latency_statistics.present_interval.GetAverage(),
+                    s_latency_statistics.present_interval.GetPercentile(0.99f));
 
   g_host_interface->OnSystemPerformanceCountersUpdated();
 }
@@ -1371,13 +1572,55 @@ void ResetPerformanceCounters()
 {
   s_last_frame_number = s_frame_number;
   s_last_internal_frame_number = s_internal_frame_number;
+  s_last_skipped_frame_count = s_skipped_frame_count;
   s_last_global_tick_counter = TimingEvents::GetGlobalTickCounter();
   s_average_frame_time_accumulator = 0.0f;
   s_worst_frame_time_accumulator = 0.0f;
+  s_latency_accumulator = {};
+  s_last_present_time = 0;
   s_fps_timer.Reset();
   ResetThrottler();
 }
 
+static void AddPresentedFrame(const HostDisplay::FrameTimestamps& frame)
+{
+  if (frame.frame_start_time != 0)
+  {
+    s_latency_accumulator.input_to_present.AddSample(
+      static_cast<float>(Common::Timer::ConvertValueToMilliseconds(frame.present_time - frame.frame_start_time)));
+    s_latency_accumulator.frame_to_present.AddSample(
+      static_cast<float>(Common::Timer::ConvertValueToMilliseconds(frame.present_time - frame.frame_end_time)));
+  }
+
+  // not across pauses or anything else which resets the counters
+  if (s_last_present_time != 0)
+  {
+    s_latency_accumulator.present_interval.AddSample(
+      static_cast<float>(Common::Timer::ConvertValueToMilliseconds(frame.present_time - s_last_present_time)));
+  }
+
+  s_last_present_time = frame.present_time;
+}
+
+void OnFramePresented()
+{
+  HostDisplay* display = g_host_interface->GetDisplay();
+  if (display && display->GetPresentedFrames(&s_presented_frames))
+  {
+    // presented on the display's thread, possibly a frame or two behind, and repeats of a frame aren't stamped
+    for (const HostDisplay::FrameTimestamps& frame : s_presented_frames)
+    {
+      if (frame.frame_start_time != 0)
+        AddPresentedFrame(frame);
+    }
+
+    s_presented_frames.clear();
+    return;
+  }
+
+  AddPresentedFrame({s_frame_start_time, s_frame_end_time, Common::Timer::GetValue()});
+}
+
 bool LoadEXE(const char* filename)
 {
   std::FILE* fp = FileSystem::OpenCFile(filename, "rb");
@@ -1858,6 +2101,167 @@ bool SwitchMediaFromPlaylist(u32 index)
   return InsertMedia(path.c_str());
 }
 
+bool IsMovieActive()
+{
+  return (s_movie_recorder || s_movie_player);
+}
+
+bool IsRecordingMovie()
+{
+  return static_cast<bool>(s_movie_recorder);
+}
+
+bool IsPlayingMovie()
+{
+  return static_cast<bool>(s_movie_player);
+}
+
+bool StartMovieRecording(const char* filename, u32 keyframe_interval)
+{
+  if (IsShutdown() || IsMovieActive())
+    return false;
+
+  std::unique_ptr<Movie::Recorder> recorder = std::make_unique<Movie::Recorder>();
+  if (!recorder->Open(filename, keyframe_interval))
+    return false;
+
+  s_movie_recorder = std::move(recorder);
+  return true;
+}
+
+void StopMovieRecording()
+{
+  s_movie_recorder.reset();
+}
+
+bool StartMoviePlayback(const char* filename)
+{
+  if (IsShutdown() || IsMovieActive())
+    return false;
+
+  std::unique_ptr<Movie::Player> player = std::make_unique<Movie::Player>();
+  if (!player->Open(filename) || !player->Seek(0))
+    return false;
+
+  s_movie_player = std::move(player);
+  return true;
+}
+
+void StopMoviePlayback()
+{
+  if (!s_movie_player)
+    return;
+
+  const u32 frames = s_movie_player->GetCurrentFrame();
+  const u32 desyncs = s_movie_player->GetDesyncCount();
+  if (desyncs > 0)
+    Log_ErrorPrintf("Movie playback stopped after %u frames, %u frames desynced", frames, desyncs);
+  else
+    Log_InfoPrintf("Movie playback stopped after %u frames, no desyncs", frames);
+
+  s_movie_player.reset();
+  g_host_interface->OnMoviePlaybackStopped(frames, desyncs);
+}
+
+u32 GetMovieFrameNumber()
+{
+  if (s_movie_recorder)
+    return s_movie_recorder->GetFrameCount();
+  else if (s_movie_player)
+    return s_movie_player->GetCurrentFrame();
+  else
+    return 0;
+}
+
+u32 GetMovieFrameCount()
+{
+  if (s_movie_recorder)
+    return s_movie_recorder->GetFrameCount();
+  else if (s_movie_player)
+    return s_movie_player->GetFrameCount();
+  else
+    return 0;
+}
+
+u32 GetMovieKeyframeInterval()
+{
+  return s_movie_player ? s_movie_player->GetKeyframeInterval() : 0;
+}
+
+bool SeekMovie(u32 frame)
+{
+  if (!s_movie_player || frame >= s_movie_player->GetFrameCount() || !s_movie_player->Seek(frame))
+    return false;
+
+  // playback can't finish here, since the target is before the end
+  while (s_movie_player->GetCurrentFrame() < frame)
+    RunFrame();
+
+  return true;
+}
+
+bool IsCapturingMedia()
+{
+  return static_cast<bool>(s_media_capture);
+}
+
+bool StartMediaCapture(const char* filename)
+{
+  if (IsShutdown() || s_media_capture)
+    return false;
+
+  std::unique_ptr<MediaCapture::Writer> writer = std::make_unique<MediaCapture::Writer>();
+  if (!writer->Open(filename, HostInterface::AUDIO_SAMPLE_RATE, GetThrottleFrequency()))
+    return false;
+
+  s_media_capture = std::move(writer);
+  g_spu.SetMediaCapture(s_media_capture.get());
+  return true;
+}
+
+void StopMediaCapture()
+{
+  if (!s_media_capture)
+    return;
+
+  g_spu.SetMediaCapture(nullptr);
+  s_media_capture->Close(g_host_interface->GetDisplay());
+  s_media_capture.reset();
+}
+
+MediaCapture::Writer* GetMediaCapture()
+{
+  return s_media_capture.get();
+}
+
+bool IsExportingSharedMemory()
+{
+  return static_cast<bool>(s_shared_memory_export);
+}
+
+bool StartSharedMemoryExport(const char* name)
+{
+  if (IsShutdown() || s_shared_memory_export)
+    return false;
+
+  std::unique_ptr<SharedMemoryExport> shm_export = std::make_unique<SharedMemoryExport>();
+  if (!shm_export->Create(name, HostInterface::AUDIO_SAMPLE_RATE))
+    return false;
+
+  s_shared_memory_export = std::move(shm_export);
+  g_spu.SetSharedMemoryExport(s_shared_memory_export.get());
+  return true;
+}
+
+void StopSharedMemoryExport()
+{
+  if (!s_shared_memory_export)
+    return;
+
+  g_spu.SetSharedMemoryExport(nullptr);
+  s_shared_memory_export.reset();
+}
+
 bool HasCheatList()
 {
   return static_cast<bool>(s_cheat_list);
@@ -1,4 +1,5 @@
 #pragma once
+#include "common/latency_histogram.h"
 #include "common/timer.h"
 #include "host_interface.h"
 #include "settings.h"
@@ -17,6 +18,12 @@ class Controller;
 struct CheatCode;
 class CheatList;
 
+namespace MediaCapture {
+class Writer;
+}
+
+class SharedMemoryExport;
+
 struct SystemBootParameters
 {
   SystemBootParameters();
@@ -124,12 +131,19 @@ u32 GetInternalFrameNumber();
 void FrameDone();
 void IncrementInternalFrameNumber();
 
+/// Returns true if the current frame is emulated without being rendered or presented.
+bool IsFrameSkipped();
+
+/// Builds the display for the last frame if it was skipped, so it can be shown or saved.
+void UpdateSkippedFrameDisplay();
+
 const std::string& GetRunningPath();
 const std::string& GetRunningCode();
 const std::string& GetRunningTitle();
 
 float GetFPS();
 float GetVPS();
+float GetSkippedFPS();
 float GetEmulationSpeed();
 float GetAverageFrameTime();
 float GetWorstFrameTime();
@@ -142,15 +156,26 @@ void Shutdown();
 bool LoadState(ByteStream* state, bool update_display = true);
 bool SaveState(ByteStream* state, u32 screenshot_size = 128);
 
+/// Returns the size of the raw state data (i.e. without the save state header), for sizing SaveStateToBuffer().
+u32 GetStateDataSize();
+
+/// Serializes the raw state data into a caller-provided buffer. No allocations are made. Returns the size written,
+/// or zero if the buffer is too small.
+u32 SaveStateToBuffer(void* buffer, u32 buffer_size);
+
+/// Restores raw state data from SaveStateToBuffer().
+bool LoadStateFromBuffer(const void* buffer, u32 buffer_size, bool update_display = true);
+
 /// Recreates the GPU component, saving/loading the state so it is preserved. Call when the GPU renderer changes.
 bool RecreateGPU(GPURenderer renderer, bool update_display = true);
 
 void SingleStepCPU();
 void RunFrame();
 
-/// Sets target emulation speed.
+/// Sets target emulation speed. The requested speed is the one before any adjustment to sync to the host refresh rate,
+/// and decides whether frames can be skipped.
 float GetTargetSpeed();
-void SetTargetSpeed(float speed);
+void SetTargetSpeed(float speed, float requested_speed);
 
 /// Adjusts the throttle frequency, i.e. how many times we should sleep per second.
 void SetThrottleFrequency(float frequency);
@@ -165,6 +190,27 @@ void Throttle();
 void UpdatePerformanceCounters();
 void ResetPerformanceCounters();
 
+/// Frame timing histograms, in milliseconds. Latencies are measured up to the present: when the display's present
+/// thread has queued the frame to the swap chain, or when HostDisplay::Render() returns for displays without one.
+/// Compositor and scanout time is not included, so these are not input-to-photon figures.
+struct LatencyStatistics
+{
+  // from the start of the frame, which is when input is read
+  Common::LatencyHistogram input_to_present;
+
+  // from when the frame finished emulating
+  Common::LatencyHistogram frame_to_present;
+
+  // between successive presents, shows how even the frame pacing is
+  Common::LatencyHistogram present_interval;
+};
+
+/// Statistics from the last performance counter update.
+const LatencyStatistics& GetLatencyStatistics();
+
+/// Records the latency of the frames presented since the last call, call after HostDisplay::Render().
+void OnFramePresented();
+
 // Access controllers for simulating input.
 Controller* GetController(u32 slot);
 void UpdateControllers();
@@ -210,6 +256,40 @@ bool ReplaceMediaPathFromPlaylist(u32 index, const std::string_view& path);
 /// Switches to the specified media/disc playlist index.
 bool SwitchMediaFromPlaylist(u32 index);
 
+/// Input movie recording/playback.
+bool IsMovieActive();
+bool IsRecordingMovie();
+bool IsPlayingMovie();
+bool StartMovieRecording(const char* filename, u32 keyframe_interval);
+void StopMovieRecording();
+
+/// Loads the movie's starting state and begins playback.
+bool StartMoviePlayback(const char* filename);
+void StopMoviePlayback();
+
+/// Returns the current frame/frame count of the movie being played or recorded.
+u32 GetMovieFrameNumber();
+u32 GetMovieFrameCount();
+
+/// Returns the keyframe interval of the movie being played, which is the most frames a seek has to replay.
+u32 GetMovieKeyframeInterval();
+
+/// Seeks to the specified frame of the movie being played, replaying frames from the closest keyframe.
+bool SeekMovie(u32 frame);
+
+/// Lossless audio/video capture of the presented frames and SPU output.
+bool IsCapturingMedia();
+bool StartMediaCapture(const char* filename);
+void StopMediaCapture();
+
+/// Returns the active capture, for querying statistics.
+MediaCapture::Writer* GetMediaCapture();
+
+/// Publishes frames, audio and RAM to a named shared memory segment each frame, and takes input from it.
+bool IsExportingSharedMemory();
+bool StartSharedMemoryExport(const char* name);
+void StopSharedMemoryExport();
+
 /// Returns true if there is currently a cheat list.
 bool HasCheatList();
 
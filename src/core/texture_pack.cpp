@@ -0,0 +1,199 @@
+#include "texture_pack.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef WIN32
+#include "common/windows_headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Log_SetChannel(TexturePack);
+
+namespace TexturePack {
+
+Reader::Reader() = default;
+
+Reader::~Reader()
+{
+  Close();
+}
+
+bool Reader::Open(const char* filename)
+{
+  Close();
+
+  if (!MapFile(filename))
+    return false;
+
+  FileHeader header;
+  if (m_size < sizeof(header))
+  {
+    Log_ErrorPrintf("Texture pack '%s' is truncated", filename);
+    Close();
+    return false;
+  }
+
+  std::memcpy(&header, m_data, sizeof(header));
+  if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+  {
+    Log_ErrorPrintf("Texture pack '%s' has an invalid header (version %u, expected %u)", filename, header.version,
+                    static_cast<u32>(FILE_VERSION));
+    Close();
+    return false;
+  }
+
+  const u64 index_size = static_cast<u64>(header.entry_count) * sizeof(IndexEntry);
+  if (header.index_offset > m_size || index_size > (m_size - header.index_offset) ||
+      (header.index_offset % alignof(u64)) != 0)
+  {
+    Log_ErrorPrintf("Texture pack '%s' has an invalid index", filename);
+    Close();
+    return false;
+  }
+
+  m_index = reinterpret_cast<const IndexEntry*>(m_data + header.index_offset);
+  m_entry_count = header.entry_count;
+
+  // validate up front, so lookups don't have to
+  for (u32 i = 0; i < m_entry_count; i++)
+  {
+    const IndexEntry& entry = m_index[i];
+    const u64 texture_size = static_cast<u64>(entry.width) * entry.height * sizeof(u32);
+    if (entry.offset > header.index_offset || texture_size > (header.index_offset - entry.offset) ||
+        (entry.offset % DATA_ALIGNMENT) != 0 ||
+        (i > 0 && !CompareHash(m_index[i - 1].hash_low, m_index[i - 1].hash_high, entry.hash_low, entry.hash_high)))
+    {
+      Log_ErrorPrintf("Texture pack '%s' has an invalid entry at index %u", filename, i);
+      Close();
+      return false;
+    }
+  }
+
+  Log_InfoPrintf("Opened texture pack '%s' with %u textures", filename, m_entry_count);
+  return true;
+}
+
+void Reader::Close()
+{
+  UnmapFile();
+  m_index = nullptr;
+  m_entry_count = 0;
+}
+
+const IndexEntry* Reader::Find(u64 hash_low, u64 hash_high) const
+{
+  const IndexEntry* end = m_index + m_entry_count;
+  const IndexEntry* it =
+    std::lower_bound(m_index, end, std::make_pair(hash_low, hash_high),
+                     [](const IndexEntry& entry, const std::pair<u64, u64>& hash) {
+                       return CompareHash(entry.hash_low, entry.hash_high, hash.first, hash.second);
+                     });
+  if (it == end || it->hash_low != hash_low || it->hash_high != hash_high)
+    return nullptr;
+
+  return it;
+}
+
+#ifdef WIN32
+
+bool Reader::MapFile(const char* filename)
+{
+  HANDLE file = CreateFileW(StringUtil::UTF8StringToWideString(filename).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+  {
+    Log_ErrorPrintf("CreateFileMappingW() for '%s' failed: %u", filename, GetLastError());
+    CloseHandle(file);
+    return false;
+  }
+
+  const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data)
+  {
+    Log_ErrorPrintf("MapViewOfFile() for '%s' failed: %u", filename, GetLastError());
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  m_file_handle = file;
+  m_mapping_handle = mapping;
+  m_data = static_cast<const u8*>(data);
+  m_size = static_cast<u64>(size.QuadPart);
+  return true;
+}
+
+void Reader::UnmapFile()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping_handle)
+    CloseHandle(m_mapping_handle);
+  if (m_file_handle)
+    CloseHandle(m_file_handle);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_mapping_handle = nullptr;
+  m_file_handle = nullptr;
+}
+
+#else
+
+bool Reader::MapFile(const char* filename)
+{
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    Log_ErrorPrintf("mmap() for '%s' failed: %d", filename, errno);
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(data);
+  m_size = static_cast<u64>(st.st_size);
+  return true;
+}
+
+void Reader::UnmapFile()
+{
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), static_cast<size_t>(m_size));
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+#endif
+
+} // namespace TexturePack
@@ -0,0 +1,84 @@
+#pragma once
+#include "types.h"
+#include <string>
+
+// Pre-built texture replacement packs.
+//
+// A pack holds every replacement for a game already decoded to RGBA8, so at runtime there's no directory walk and no
+// image decoding. The file is the header, the pixel data for each texture (rows tightly packed, each texture aligned
+// to DATA_ALIGNMENT), then the index sorted by hash. The whole file is mapped into memory, so a lookup is a binary
+// search over the index and the pixels are used in place.
+
+namespace TexturePack {
+
+enum : u32
+{
+  FILE_MAGIC = 0x50545344, // DSTP
+  FILE_VERSION = 1,
+
+  DATA_ALIGNMENT = 64,
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 entry_count;
+  u32 reserved;
+  u64 index_offset;
+};
+
+struct IndexEntry
+{
+  u64 hash_low;
+  u64 hash_high;
+  u32 width;
+  u32 height;
+  u64 offset;
+};
+#pragma pack(pop)
+
+/// Ordering used for the index, matches TextureReplacementHash.
+ALWAYS_INLINE bool CompareHash(u64 lhs_low, u64 lhs_high, u64 rhs_low, u64 rhs_high)
+{
+  return (lhs_low < rhs_low || (lhs_low == rhs_low && lhs_high < rhs_high));
+}
+
+class Reader
+{
+public:
+  Reader();
+  ~Reader();
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_data != nullptr); }
+  ALWAYS_INLINE u32 GetEntryCount() const { return m_entry_count; }
+  ALWAYS_INLINE const IndexEntry& GetEntry(u32 index) const { return m_index[index]; }
+
+  bool Open(const char* filename);
+  void Close();
+
+  /// Returns the index entry for the specified hash, or null if the pack doesn't contain it.
+  const IndexEntry* Find(u64 hash_low, u64 hash_high) const;
+
+  ALWAYS_INLINE const u32* GetPixels(const IndexEntry& entry) const
+  {
+    return reinterpret_cast<const u32*>(m_data + entry.offset);
+  }
+
+private:
+  bool MapFile(const char* filename);
+  void UnmapFile();
+
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+  const IndexEntry* m_index = nullptr;
+  u32 m_entry_count = 0;
+
+#ifdef WIN32
+  void* m_file_handle = nullptr;
+  void* m_mapping_handle = nullptr;
+#endif
+};
+
+} // namespace TexturePack
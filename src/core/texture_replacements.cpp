@@ -5,32 +5,18 @@
 #include "common/string_util.h"
 #include "common/timer.h"
 #include "host_interface.h"
+#include "image_write_queue.h"
 #include "settings.h"
 #include "xxhash.h"
 #if defined(CPU_X86) || defined(CPU_X64)
 #include "xxh_x86dispatch.h"
 #endif
+#include <algorithm>
 #include <cinttypes>
 Log_SetChannel(TextureReplacements);
 
 TextureReplacements g_texture_replacements;
 
-static constexpr u32 RGBA5551ToRGBA8888(u16 color)
-{
-  u8 r = Truncate8(color & 31);
-  u8 g = Truncate8((color >> 5) & 31);
-  u8 b = Truncate8((color >> 10) & 31);
-  u8 a = Truncate8((color >> 15) & 1);
-
-  // 00012345 -> 1234545
-  b = (b << 3) | (b & 0b111);
-  g = (g << 3) | (g & 0b111);
-  r = (r << 3) | (r & 0b111);
-  a = a ? 255 : 0;
-
-  return ZeroExtend32(r) | (ZeroExtend32(g) << 8) | (ZeroExtend32(b) << 16) | (ZeroExtend32(a) << 24);
-}
-
 std::string TextureReplacementHash::ToString() const
 {
   return StringUtil::StdStringFromFormat("%" PRIx64 "%" PRIx64, high, low);
@@ -51,15 +37,31 @@ bool TextureReplacementHash::ParseString(const std::string_view& sv)
   return true;
 }
 
+static constexpr u32 NUM_LOADER_THREADS = 2;
+
+static u64 GetTextureMemorySize(const Common::RGBA8Image& texture)
+{
+  return static_cast<u64>(texture.GetByteStride()) * texture.GetHeight();
+}
+
+static u64 GetMemoryBudget()
+{
+  return static_cast<u64>(g_settings.texture_replacements.memory_budget_mb) * 1048576u;
+}
+
 TextureReplacements::TextureReplacements() = default;
 
-TextureReplacements::~TextureReplacements() = default;
+TextureReplacements::~TextureReplacements()
+{
+  StopLoaderThreads();
+}
 
 void TextureReplacements::SetGameID(std::string game_id)
 {
   if (m_game_id == game_id)
     return;
 
+  SavePrefetchList();
   m_game_id = game_id;
   Reload();
 }
@@ -68,51 +70,71 @@ const TextureReplacementTexture* TextureReplacements::GetVRAMWriteReplacement(u3
 {
   const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
 
+  if (m_texture_pack.IsOpen())
+  {
+    const TexturePack::IndexEntry* entry = m_texture_pack.Find(hash.low, hash.high);
+    if (!entry)
+      return nullptr;
+
+    m_texture_pack_texture = TextureReplacementTexture(entry->width, entry->height, m_texture_pack.GetPixels(*entry));
+    return &m_texture_pack_texture;
+  }
+
   const auto it = m_vram_write_replacements.find(hash);
   if (it == m_vram_write_replacements.end())
     return nullptr;
 
+  RecordTextureUse(hash);
+
+  if (!m_loader_threads.empty())
+    ProcessCompletedLoads();
+
+  auto cache_it = m_texture_cache.find(it->second);
+  if (cache_it != m_texture_cache.end())
+  {
+    m_texture_lru.splice(m_texture_lru.begin(), m_texture_lru, cache_it->second.lru_iterator);
+    return &cache_it->second.texture;
+  }
+
+  if (g_settings.texture_replacements.async_loading)
+  {
+    QueueTextureLoad(it->second);
+    return nullptr;
+  }
+
   return LoadTexture(it->second);
 }
 
 void TextureReplacements::DumpVRAMWrite(u32 width, u32 height, const void* pixels)
 {
-  std::string filename = GetVRAMWriteDumpFilename(width, height, pixels);
-  if (filename.empty())
+  if (m_game_id.empty())
     return;
 
-  Common::RGBA8Image image;
-  image.SetSize(width, height);
-
-  const u16* src_pixels = reinterpret_cast<const u16*>(pixels);
-
-  for (u32 y = 0; y < height; y++)
-  {
-    for (u32 x = 0; x < width; x++)
-    {
-      image.SetPixel(x, y, RGBA5551ToRGBA8888(*src_pixels));
-      src_pixels++;
-    }
-  }
+  // repeated uploads are common, so skip the filesystem checks if we've already dumped this one
+  const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
+  const u64 dump_hash = hash.low ^ hash.high;
+  if (g_image_write_queue.HasQueuedHash(dump_hash))
+    return;
 
-  if (g_settings.texture_replacements.dump_vram_write_force_alpha_channel)
-  {
-    for (u32 y = 0; y < height; y++)
-    {
-      for (u32 x = 0; x < width; x++)
-        image.SetPixel(x, y, image.GetPixel(x, y) | 0xFF000000u);
-    }
-  }
+  std::string filename = GetVRAMWriteDumpFilename(hash);
+  if (filename.empty())
+    return;
 
   Log_InfoPrintf("Dumping %ux%u VRAM write to '%s'", width, height, filename.c_str());
-  if (!Common::WriteImageToFile(image, filename.c_str()))
-    Log_ErrorPrintf("Failed to dump %ux%u VRAM write to '%s'", width, height, filename.c_str());
+  g_image_write_queue.QueueVRAMWrite(std::move(filename), dump_hash, width, height, sizeof(u16) * width, pixels,
+                                     g_settings.texture_replacements.dump_vram_write_force_alpha_channel);
 }
 
 void TextureReplacements::Shutdown()
 {
+  StopLoaderThreads();
+  SavePrefetchList();
+
   m_texture_cache.clear();
+  m_texture_lru.clear();
+  m_texture_cache_size = 0;
   m_vram_write_replacements.clear();
+  m_texture_pack.Close();
   m_game_id.clear();
 }
 
@@ -121,18 +143,19 @@ std::string TextureReplacements::GetSourceDirectory() const
   return g_host_interface->GetUserDirectoryRelativePath("textures/%s", m_game_id.c_str());
 }
 
+std::string TextureReplacements::GetTexturePackPath() const
+{
+  return g_host_interface->GetUserDirectoryRelativePath("textures/%s.dstp", m_game_id.c_str());
+}
+
 TextureReplacementHash TextureReplacements::GetVRAMWriteHash(u32 width, u32 height, const void* pixels) const
 {
   XXH128_hash_t hash = XXH3_128bits(pixels, width * height * sizeof(u16));
   return {hash.low64, hash.high64};
 }
 
-std::string TextureReplacements::GetVRAMWriteDumpFilename(u32 width, u32 height, const void* pixels) const
+std::string TextureReplacements::GetVRAMWriteDumpFilename(const TextureReplacementHash& hash) const
 {
-  if (m_game_id.empty())
-    return {};
-
-  const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
   std::string filename = g_host_interface->GetUserDirectoryRelativePath("dump/textures/%s/vram-write-%s.png",
                                                                         m_game_id.c_str(), hash.ToString().c_str());
 
@@ -152,28 +175,60 @@ std::string TextureReplacements::GetVRAMWriteDumpFilename(u32 width, u32 height,
 
 void TextureReplacements::Reload()
 {
+  StopLoaderThreads();
+  SavePrefetchList();
   m_vram_write_replacements.clear();
+  m_texture_pack.Close();
+  m_texture_use_order.clear();
+  m_used_textures.clear();
+  m_texture_use_order_changed = false;
+
+  if (g_settings.texture_replacements.AnyReplacementsEnabled() && !m_game_id.empty() &&
+      m_texture_pack.Open(GetTexturePackPath().c_str()))
+  {
+    // everything is already decoded and mapped, so there's nothing to preload or prefetch
+    PurgeUnreferencedTexturesFromCache();
+    return;
+  }
 
   if (g_settings.texture_replacements.AnyReplacementsEnabled())
     FindTextures(GetSourceDirectory());
 
+  PurgeUnreferencedTexturesFromCache();
+
+  // the budget may have been lowered
+  EvictTextures({});
+
+  if (m_vram_write_replacements.empty())
+    return;
+
   if (g_settings.texture_replacements.preload_textures)
     PreloadTextures();
 
-  PurgeUnreferencedTexturesFromCache();
+  if (g_settings.texture_replacements.async_loading || g_settings.texture_replacements.prefetch_textures)
+    StartLoaderThreads();
+
+  if (g_settings.texture_replacements.prefetch_textures)
+    PrefetchTextures();
 }
 
 void TextureReplacements::PurgeUnreferencedTexturesFromCache()
 {
-  TextureCache old_map = std::move(m_texture_cache);
+  std::unordered_set<std::string> referenced_filenames;
   for (const auto& it : m_vram_write_replacements)
+    referenced_filenames.insert(it.second);
+
+  for (auto it = m_texture_cache.begin(); it != m_texture_cache.end();)
   {
-    auto it2 = old_map.find(it.second);
-    if (it2 != old_map.end())
+    if (referenced_filenames.find(it->first) != referenced_filenames.end())
     {
-      m_texture_cache[it.second] = std::move(it2->second);
-      old_map.erase(it2);
+      ++it;
+      continue;
     }
+
+    m_texture_cache_size -= GetTextureMemorySize(it->second.image);
+    m_texture_lru.erase(it->second.lru_iterator);
+    it = m_texture_cache.erase(it);
   }
 }
 
@@ -263,7 +318,7 @@ const TextureReplacementTexture* TextureReplacements::LoadTexture(const std::str
 {
   auto it = m_texture_cache.find(filename);
   if (it != m_texture_cache.end())
-    return &it->second;
+    return &it->second.texture;
 
   Common::RGBA8Image image;
   if (!Common::LoadImageFromFile(&image, filename.c_str()))
@@ -273,8 +328,42 @@ const TextureReplacementTexture* TextureReplacements::LoadTexture(const std::str
   }
 
   Log_InfoPrintf("Loaded '%s': %ux%u", filename.c_str(), image.GetWidth(), image.GetHeight());
-  it = m_texture_cache.emplace(filename, std::move(image)).first;
-  return &it->second;
+  return InsertTexture(filename, std::move(image));
+}
+
+const TextureReplacementTexture* TextureReplacements::InsertTexture(const std::string& filename,
+                                                                    Common::RGBA8Image image)
+{
+  m_texture_lru.push_front(filename);
+  m_texture_cache_size += GetTextureMemorySize(image);
+
+  auto it = m_texture_cache.emplace(filename, CacheEntry{std::move(image), {}, m_texture_lru.begin()}).first;
+  CacheEntry& entry = it->second;
+  entry.texture = TextureReplacementTexture(entry.image.GetWidth(), entry.image.GetHeight(), entry.image.GetPixels());
+  EvictTextures(filename);
+  return &entry.texture;
+}
+
+bool TextureReplacements::IsCacheFull() const
+{
+  const u64 budget = GetMemoryBudget();
+  return (budget > 0 && m_texture_cache_size >= budget);
+}
+
+void TextureReplacements::EvictTextures(const std::string& keep_filename)
+{
+  const u64 budget = GetMemoryBudget();
+  if (budget == 0)
+    return;
+
+  while (m_texture_cache_size > budget && !m_texture_lru.empty() && m_texture_lru.back() != keep_filename)
+  {
+    auto it = m_texture_cache.find(m_texture_lru.back());
+    Log_DevPrintf("Evicting '%s' from replacement cache", it->first.c_str());
+    m_texture_cache_size -= GetTextureMemorySize(it->second.image);
+    m_texture_cache.erase(it);
+    m_texture_lru.pop_back();
+  }
 }
 
 void TextureReplacements::PreloadTextures()
@@ -295,6 +384,13 @@ void TextureReplacements::PreloadTextures()
 
   for (const auto& it : m_vram_write_replacements)
   {
+    if (IsCacheFull())
+    {
+      Log_WarningPrintf("Replacement cache budget reached after preloading %u of %u textures", num_textures_loaded,
+                        total_textures);
+      break;
+    }
+
     UPDATE_PROGRESS();
 
     LoadTexture(it.second);
@@ -303,3 +399,192 @@ void TextureReplacements::PreloadTextures()
 
 #undef UPDATE_PROGRESS
 }
+
+void TextureReplacements::StartLoaderThreads()
+{
+  if (!m_loader_threads.empty())
+    return;
+
+  m_loader_shutdown = false;
+  for (u32 i = 0; i < NUM_LOADER_THREADS; i++)
+    m_loader_threads.emplace_back(&TextureReplacements::LoaderThreadEntryPoint, this);
+}
+
+void TextureReplacements::StopLoaderThreads()
+{
+  if (m_loader_threads.empty())
+    return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_loader_mutex);
+    m_loader_shutdown = true;
+    m_load_queue.clear();
+    m_loader_cv.notify_all();
+  }
+
+  for (std::thread& thread : m_loader_threads)
+    thread.join();
+  m_loader_threads.clear();
+
+  // anything in flight belongs to the previous set of replacements
+  m_completed_loads.clear();
+  m_pending_loads.clear();
+  m_load_generation++;
+}
+
+void TextureReplacements::LoaderThreadEntryPoint()
+{
+  std::unique_lock<std::mutex> lock(m_loader_mutex);
+  for (;;)
+  {
+    m_loader_cv.wait(lock, [this]() { return (m_loader_shutdown || !m_load_queue.empty()); });
+    if (m_loader_shutdown)
+      break;
+
+    LoadRequest request = std::move(m_load_queue.front());
+    m_load_queue.pop_front();
+    lock.unlock();
+
+    CompletedLoad result{std::move(request.filename), request.generation, false, {}};
+    result.success = Common::LoadImageFromFile(&result.image, result.filename.c_str());
+
+    lock.lock();
+    m_completed_loads.push_back(std::move(result));
+  }
+}
+
+void TextureReplacements::QueueTextureLoad(const std::string& filename)
+{
+  if (m_pending_loads.find(filename) != m_pending_loads.end())
+    return;
+
+  m_pending_loads.insert(filename);
+
+  std::unique_lock<std::mutex> lock(m_loader_mutex);
+  m_load_queue.push_back(LoadRequest{filename, m_load_generation});
+  m_loader_cv.notify_one();
+}
+
+void TextureReplacements::ProcessCompletedLoads()
+{
+  std::vector<CompletedLoad> completed_loads;
+  {
+    std::unique_lock<std::mutex> lock(m_loader_mutex);
+    if (m_completed_loads.empty())
+      return;
+
+    completed_loads.swap(m_completed_loads);
+  }
+
+  for (CompletedLoad& cl : completed_loads)
+  {
+    if (cl.generation != m_load_generation)
+      continue;
+
+    m_pending_loads.erase(cl.filename);
+    if (!cl.success)
+    {
+      Log_ErrorPrintf("Failed to load '%s'", cl.filename.c_str());
+      continue;
+    }
+
+    // synchronous load may have beaten us to it
+    if (m_texture_cache.find(cl.filename) != m_texture_cache.end())
+      continue;
+
+    Log_InfoPrintf("Loaded '%s': %ux%u", cl.filename.c_str(), cl.image.GetWidth(), cl.image.GetHeight());
+    InsertTexture(cl.filename, std::move(cl.image));
+  }
+}
+
+std::string TextureReplacements::GetPrefetchListPath() const
+{
+  return g_host_interface->GetUserDirectoryRelativePath("cache/texture-prefetch-%s.txt", m_game_id.c_str());
+}
+
+void TextureReplacements::RecordTextureUse(const TextureReplacementHash& hash)
+{
+  if (!g_settings.texture_replacements.prefetch_textures || !m_used_textures.insert(hash).second)
+    return;
+
+  m_texture_use_order.push_back(hash);
+  m_texture_use_order_changed = true;
+}
+
+void TextureReplacements::PrefetchTextures()
+{
+  if (m_game_id.empty())
+    return;
+
+  std::optional<std::string> list = FileSystem::ReadFileToString(GetPrefetchListPath().c_str());
+  if (!list.has_value())
+    return;
+
+  // Queue in the order they were first used, so the earliest textures arrive first. The previous entries are kept,
+  // and anything new this session gets appended when the list is saved.
+  u64 queued_size = 0;
+  const u64 budget = GetMemoryBudget();
+  bool budget_reached = false;
+  u32 num_queued = 0;
+  std::string_view remaining(list.value());
+  while (!remaining.empty())
+  {
+    const std::string_view::size_type pos = remaining.find('\n');
+    std::string_view line = remaining.substr(0, pos);
+    remaining = (pos != std::string_view::npos) ? remaining.substr(pos + 1) : std::string_view();
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+      line.remove_suffix(1);
+
+    TextureReplacementHash hash;
+    if (!hash.ParseString(line) || !m_used_textures.insert(hash).second)
+      continue;
+
+    m_texture_use_order.push_back(hash);
+
+    const auto it = m_vram_write_replacements.find(hash);
+    if (budget_reached || it == m_vram_write_replacements.end() ||
+        m_texture_cache.find(it->second) != m_texture_cache.end())
+    {
+      continue;
+    }
+
+    // Count the decoded size from the image header. Anything queued past the budget would evict the textures which
+    // are needed first, so stop there, the rest get loaded on demand.
+    u32 width, height;
+    if (budget > 0 && Common::GetImageInfoFromFile(it->second.c_str(), &width, &height))
+    {
+      queued_size += static_cast<u64>(width) * height * sizeof(u32);
+      if ((m_texture_cache_size + queued_size) > budget)
+      {
+        budget_reached = true;
+        continue;
+      }
+    }
+
+    QueueTextureLoad(it->second);
+    num_queued++;
+  }
+
+  Log_InfoPrintf("Queued %u textures for prefetching from '%s'%s", num_queued, GetPrefetchListPath().c_str(),
+                 budget_reached ? ", stopped at the memory budget" : "");
+}
+
+void TextureReplacements::SavePrefetchList()
+{
+  if (!m_texture_use_order_changed || m_game_id.empty())
+    return;
+
+  std::string list;
+  list.reserve(m_texture_use_order.size() * 33);
+  for (const TextureReplacementHash& hash : m_texture_use_order)
+  {
+    // zero padded so it parses back
+    list.append(StringUtil::StdStringFromFormat("%016" PRIx64 "%016" PRIx64 "\n", hash.high, hash.low));
+  }
+
+  const std::string path = GetPrefetchListPath();
+  if (!FileSystem::WriteFileToString(path.c_str(), list))
+    Log_WarningPrintf("Failed to write texture prefetch list to '%s'", path.c_str());
+
+  m_texture_use_order_changed = false;
+}
@@ -1,10 +1,17 @@
 #pragma once
 #include "common/hash_combine.h"
 #include "common/image.h"
+#include "texture_pack.h"
 #include "types.h"
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 struct TextureReplacementHash
@@ -33,7 +40,27 @@ struct hash<TextureReplacementHash>
 };
 } // namespace std
 
-using TextureReplacementTexture = Common::RGBA8Image;
+/// RGBA8 pixels of a replacement texture. These either belong to the decoded texture cache, or point straight into a
+/// mapped texture pack.
+class TextureReplacementTexture
+{
+public:
+  TextureReplacementTexture() = default;
+  TextureReplacementTexture(u32 width, u32 height, const u32* pixels)
+    : m_pixels(pixels), m_width(width), m_height(height)
+  {
+  }
+
+  ALWAYS_INLINE u32 GetWidth() const { return m_width; }
+  ALWAYS_INLINE u32 GetHeight() const { return m_height; }
+  ALWAYS_INLINE u32 GetByteStride() const { return (m_width * sizeof(u32)); }
+  ALWAYS_INLINE const u32* GetPixels() const { return m_pixels; }
+
+private:
+  const u32* m_pixels = nullptr;
+  u32 m_width = 0;
+  u32 m_height = 0;
+};
 
 class TextureReplacements
 {
@@ -51,39 +78,99 @@ public:
 
   void Reload();
 
+  /// Returns the replacement for a VRAM write. With asynchronous loading, textures which aren't resident yet are
+  /// queued and null is returned. The pointer is valid until the next call.
   const TextureReplacementTexture* GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels);
   void DumpVRAMWrite(u32 width, u32 height, const void* pixels);
 
   void Shutdown();
 
+  static bool ParseReplacementFilename(const std::string& filename, TextureReplacementHash* replacement_hash,
+                                       ReplacmentType* replacement_type);
+
 private:
   struct ReplacementHashMapHash
   {
     size_t operator()(const TextureReplacementHash& hash);
   };
 
-  using VRAMWriteReplacementMap = std::unordered_map<TextureReplacementHash, std::string>;
-  using TextureCache = std::unordered_map<std::string, TextureReplacementTexture>;
+  struct CacheEntry
+  {
+    Common::RGBA8Image image;
+    TextureReplacementTexture texture;
+    std::list<std::string>::iterator lru_iterator;
+  };
 
-  static bool ParseReplacementFilename(const std::string& filename, TextureReplacementHash* replacement_hash,
-                                       ReplacmentType* replacement_type);
+  struct LoadRequest
+  {
+    std::string filename;
+    u32 generation;
+  };
+
+  struct CompletedLoad
+  {
+    std::string filename;
+    u32 generation;
+    bool success;
+    Common::RGBA8Image image;
+  };
+
+  using VRAMWriteReplacementMap = std::unordered_map<TextureReplacementHash, std::string>;
+  using TextureCache = std::unordered_map<std::string, CacheEntry>;
 
   std::string GetSourceDirectory() const;
+  std::string GetTexturePackPath() const;
 
   TextureReplacementHash GetVRAMWriteHash(u32 width, u32 height, const void* pixels) const;
-  std::string GetVRAMWriteDumpFilename(u32 width, u32 height, const void* pixels) const;
+  std::string GetVRAMWriteDumpFilename(const TextureReplacementHash& hash) const;
 
   void FindTextures(const std::string& dir);
 
   const TextureReplacementTexture* LoadTexture(const std::string& filename);
+  const TextureReplacementTexture* InsertTexture(const std::string& filename, Common::RGBA8Image image);
+  void EvictTextures(const std::string& keep_filename);
+  bool IsCacheFull() const;
   void PreloadTextures();
   void PurgeUnreferencedTexturesFromCache();
 
+  void StartLoaderThreads();
+  void StopLoaderThreads();
+  void LoaderThreadEntryPoint();
+  void QueueTextureLoad(const std::string& filename);
+  void ProcessCompletedLoads();
+
+  std::string GetPrefetchListPath() const;
+  void RecordTextureUse(const TextureReplacementHash& hash);
+  void PrefetchTextures();
+  void SavePrefetchList();
+
   std::string m_game_id;
 
+  // least recently used at the back
   TextureCache m_texture_cache;
+  std::list<std::string> m_texture_lru;
+  u64 m_texture_cache_size = 0;
 
   VRAMWriteReplacementMap m_vram_write_replacements;
+
+  // when a pack is present, it replaces the loose files entirely
+  TexturePack::Reader m_texture_pack;
+  TextureReplacementTexture m_texture_pack_texture;
+
+  // decode pool - the cache itself is only touched by the caller's thread
+  std::vector<std::thread> m_loader_threads;
+  std::mutex m_loader_mutex;
+  std::condition_variable m_loader_cv;
+  std::deque<LoadRequest> m_load_queue;
+  std::vector<CompletedLoad> m_completed_loads;
+  std::unordered_set<std::string> m_pending_loads;
+  u32 m_load_generation = 0;
+  bool m_loader_shutdown = false;
+
+  // hashes in the order they were first used, saved so the next session can start loading them straight away
+  std::vector<TextureReplacementHash> m_texture_use_order;
+  std::unordered_set<TextureReplacementHash> m_used_textures;
+  bool m_texture_use_order_changed = false;
 };
 
 extern TextureReplacements g_texture_replacements;
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "common/log.h"
+#include "common/string.h"
+#include "core/cpu_disasm.h"
+#include "core/cpu_trace.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace CPU;
+
+static constexpr u32 DEFAULT_DIFF_CONTEXT = 16;
+
+// Formats an instruction exactly as the old textual execution log did.
+static void FormatInstruction(const Trace::Record& rec, const Registers& regs, TinyString* line)
+{
+  TinyString instr;
+  TinyString comment;
+  DisassembleInstruction(&instr, rec.pc, rec.bits);
+  DisassembleInstructionComment(&comment, rec.pc, rec.bits, const_cast<Registers*>(&regs));
+  if (!comment.IsEmpty())
+  {
+    for (u32 i = instr.GetLength(); i < 30; i++)
+      instr.AppendCharacter(' ');
+    instr.AppendString("; ");
+    instr.AppendString(comment);
+  }
+
+  line->Format("%08x: %08x %s", rec.pc, rec.bits, instr.GetCharArray());
+}
+
+static void PrintRecordDetails(std::FILE* fp, const Trace::Record& rec)
+{
+  if (rec.flags & Trace::RECORD_FLAG_EXCEPTION)
+    std::fprintf(fp, "    exception raised\n");
+
+  for (u32 i = 0; i < rec.num_reg_writes; i++)
+  {
+    const u8 reg = rec.reg_writes[i].reg;
+    const char* reg_name = (reg < 32) ? GetRegName(static_cast<Reg>(reg)) : ((reg == 32) ? "hi" : "lo");
+    std::fprintf(fp, "    %s <- %08x\n", reg_name, rec.reg_writes[i].value);
+  }
+
+  if (rec.HasMemoryAccess())
+  {
+    std::fprintf(fp, "    %s%u [%08x] %s %08x\n", (rec.flags & Trace::RECORD_FLAG_MEMORY_READ) ? "read" : "write",
+                 rec.GetMemoryAccessSize() * 8, rec.memory_address,
+                 (rec.flags & Trace::RECORD_FLAG_MEMORY_READ) ? "->" : "<-", rec.memory_value);
+  }
+}
+
+static bool RecordsMatch(const Trace::Record& lhs, const Trace::Record& rhs)
+{
+  if (lhs.pc != rhs.pc || lhs.bits != rhs.bits || lhs.flags != rhs.flags ||
+      lhs.num_reg_writes != rhs.num_reg_writes || lhs.memory_address != rhs.memory_address ||
+      lhs.memory_value != rhs.memory_value)
+  {
+    return false;
+  }
+
+  // writes are always stored in register order, so we can compare them directly
+  for (u32 i = 0; i < lhs.num_reg_writes; i++)
+  {
+    if (lhs.reg_writes[i].reg != rhs.reg_writes[i].reg || lhs.reg_writes[i].value != rhs.reg_writes[i].value)
+      return false;
+  }
+
+  return true;
+}
+
+static int Dump(const char* trace_filename, const char* output_filename, bool verbose)
+{
+  Trace::Reader reader;
+  if (!reader.Open(trace_filename))
+    return EXIT_FAILURE;
+
+  std::FILE* fp = stdout;
+  if (output_filename && !(fp = std::fopen(output_filename, "wb")))
+  {
+    std::fprintf(stderr, "Failed to open output file '%s'\n", output_filename);
+    return EXIT_FAILURE;
+  }
+
+  Trace::Record rec;
+  TinyString line;
+  while (reader.ReadRecord(&rec))
+  {
+    FormatInstruction(rec, reader.GetRegisters(), &line);
+    std::fprintf(fp, "%s\n", line.GetCharArray());
+    if (verbose)
+      PrintRecordDetails(fp, rec);
+  }
+
+  if (fp != stdout)
+    std::fclose(fp);
+
+  return EXIT_SUCCESS;
+}
+
+static int Diff(const char* lhs_filename, const char* rhs_filename, u32 context)
+{
+  Trace::Reader lhs_reader, rhs_reader;
+  if (!lhs_reader.Open(lhs_filename) || !rhs_reader.Open(rhs_filename))
+    return EXIT_FAILURE;
+
+  // keep the last few instructions around so we can show what led up to the divergence
+  struct HistoryEntry
+  {
+    Trace::Record rec;
+    Registers regs;
+  };
+  std::vector<HistoryEntry> history(std::max<u32>(context, 1));
+  u64 history_count = 0;
+
+  Trace::Record lhs, rhs;
+  TinyString line;
+  for (;;)
+  {
+    const bool lhs_valid = lhs_reader.ReadRecord(&lhs);
+    const bool rhs_valid = rhs_reader.ReadRecord(&rhs);
+    if (!lhs_valid && !rhs_valid)
+    {
+      std::printf("Traces are identical (%llu instructions).\n",
+                  static_cast<unsigned long long>(lhs_reader.GetRecordIndex()));
+      return EXIT_SUCCESS;
+    }
+
+    if (lhs_valid && rhs_valid && RecordsMatch(lhs, rhs))
+    {
+      HistoryEntry& he = history[history_count % history.size()];
+      he.rec = lhs;
+      he.regs = lhs_reader.GetRegisters();
+      history_count++;
+      continue;
+    }
+
+    const u64 index = lhs_valid ? lhs_reader.GetRecordIndex() : rhs_reader.GetRecordIndex();
+    std::printf("Traces diverge at instruction %llu.\n\n", static_cast<unsigned long long>(index));
+
+    if (context > 0 && history_count > 0)
+    {
+      std::printf("Preceding instructions:\n");
+      const u64 count = std::min<u64>(history_count, context);
+      for (u64 i = history_count - count; i < history_count; i++)
+      {
+        const HistoryEntry& he = history[i % history.size()];
+        FormatInstruction(he.rec, he.regs, &line);
+        std::printf("  %s\n", line.GetCharArray());
+      }
+      std::printf("\n");
+    }
+
+    const auto print_side = [&line](const char* filename, bool valid, const Trace::Record& rec,
+                                    const Trace::Reader& reader) {
+      std::printf("%s:\n", filename);
+      if (!valid)
+      {
+        std::printf("  <end of trace>\n");
+        return;
+      }
+
+      FormatInstruction(rec, reader.GetRegisters(), &line);
+      std::printf("  %s\n", line.GetCharArray());
+      PrintRecordDetails(stdout, rec);
+    };
+    print_side(lhs_filename, lhs_valid, lhs, lhs_reader);
+    print_side(rhs_filename, rhs_valid, rhs, rhs_reader);
+    return EXIT_FAILURE;
+  }
+}
+
+static void PrintUsage(const char* progname)
+{
+  std::fprintf(stderr, "Usage:\n");
+  std::fprintf(stderr, "  %s dump [-v] <trace.bin> [output.txt]\n", progname);
+  std::fprintf(stderr, "    Disassembles a binary trace. -v includes register writes and memory accesses.\n");
+  std::fprintf(stderr, "  %s diff [-c <context>] <a.bin> <b.bin>\n", progname);
+  std::fprintf(stderr, "    Finds the first instruction where two traces diverge (default context: %u).\n",
+               DEFAULT_DIFF_CONTEXT);
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_WARNING);
+
+  if (argc < 3)
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool verbose = false;
+  u32 context = DEFAULT_DIFF_CONTEXT;
+  std::vector<const char*> files;
+  for (int i = 2; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "-v") == 0)
+      verbose = true;
+    else if (std::strcmp(argv[i], "-c") == 0 && (i + 1) < argc)
+      context = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+    else
+      files.push_back(argv[i]);
+  }
+
+  if (std::strcmp(argv[1], "dump") == 0 && (files.size() == 1 || files.size() == 2))
+    return Dump(files[0], (files.size() > 1) ? files[1] : nullptr, verbose);
+  else if (std::strcmp(argv[1], "diff") == 0 && files.size() == 2)
+    return Diff(files[0], files[1], context);
+
+  PrintUsage(argv[0]);
+  return EXIT_FAILURE;
+}
@@ -6,7 +6,8 @@
 #include "settingwidgetbinder.h"
 
 static void addBooleanTweakOption(QtHostInterface* host_interface, QTableWidget* table, QString name,
-                                  std::string section, std::string key, bool default_value)
+                                  std::string section, std::string key, bool default_value,
+                                  const QString& help = QString())
 {
   const int row = table->rowCount();
   const bool current_value = host_interface->GetBoolSettingValue(section.c_str(), key.c_str(), default_value);
@@ -20,6 +21,12 @@ static void addBooleanTweakOption(QtHostInterface* host_interface, QTableWidget*
   QCheckBox* cb = new QCheckBox(table);
   SettingWidgetBinder::BindWidgetToBoolSetting(host_interface, cb, std::move(section), std::move(key), default_value);
   table->setCellWidget(row, 1, cb);
+
+  if (!help.isEmpty())
+  {
+    name_item->setToolTip(help);
+    cb->setToolTip(help);
+  }
 }
 
 static void setBooleanTweakOption(QTableWidget* table, int row, bool value)
@@ -149,6 +156,8 @@ AdvancedSettingsWidget::AdvancedSettingsWidget(QtHostInterface* host_interface,
                         "DisableAllEnhancements", false);
   addIntRangeTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Display FPS Limit"), "Display", "MaxFPS", 0, 1000,
                          0);
+  addIntRangeTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Frame Skip When Fast Forwarding"), "Display",
+                         "FrameSkip", 0, 60, 0);
 
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("PGXP Vertex Cache"), "GPU", "PGXPVertexCache",
                         false);
@@ -173,6 +182,13 @@ AdvancedSettingsWidget::AdvancedSettingsWidget(QtHostInterface* host_interface,
                         "TextureReplacements", "EnableVRAMWriteReplacements", false);
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Preload Texture Replacements"),
                         "TextureReplacements", "PreloadTextures", false);
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Asynchronous Texture Replacement Loading"),
+                        "TextureReplacements", "AsyncLoading", false);
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Prefetch Texture Replacements"),
+                        "TextureReplacements", "PrefetchTextures", false);
+  addIntRangeTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Texture Replacement Memory Budget (MB)"),
+                         "TextureReplacements", "MemoryBudget", 0, 65536,
+                         Settings::DEFAULT_TEXTURE_REPLACEMENT_MEMORY_BUDGET);
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Dump Replaceable VRAM Writes"),
                         "TextureReplacements", "DumpVRAMWrites", false);
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Set Dumped VRAM Write Alpha Channel"),
@@ -194,9 +210,24 @@ AdvancedSettingsWidget::AdvancedSettingsWidget(QtHostInterface* host_interface,
                          1000, Settings::DEFAULT_GPU_MAX_RUN_AHEAD);
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Use Debug Host GPU Device"), "GPU",
                         "UseDebugDevice", false);
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Asynchronous Pipeline Compilation"), "GPU",
+                        "AsyncPipelineCompilation", false);
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Cache Decoded Palette Textures"), "GPU",
+                        "PaletteTextureCache", false);
+  addBooleanTweakOption(
+    m_host_interface, m_ui.tweakOptionTable, tr("Vulkan Render Thread (Experimental)"), "GPU", "VulkanRenderThread",
+    false,
+    tr("Records Vulkan draw commands on a separate thread. Experimental: the output matches the single-threaded "
+       "renderer, but it has not been shown to be faster on real hardware, and can be slower on systems with few "
+       "cores."));
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Expand Sprites On GPU"), "GPU",
+                        "SpriteInstancing", true);
 
   addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Increase Timer Resolution"), "Main",
                         "IncreaseTimerResolution", true);
+
+  addBooleanTweakOption(m_host_interface, m_ui.tweakOptionTable, tr("Asynchronous Logging"), "Logging", "LogAsync",
+                        false);
 }
 
 AdvancedSettingsWidget::~AdvancedSettingsWidget() = default;
@@ -205,24 +236,34 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
 {
   setBooleanTweakOption(m_ui.tweakOptionTable, 0, false);
   setIntRangeTweakOption(m_ui.tweakOptionTable, 1, 0);
-  setBooleanTweakOption(m_ui.tweakOptionTable, 2, false);
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 2, 0);
   setBooleanTweakOption(m_ui.tweakOptionTable, 3, false);
   setBooleanTweakOption(m_ui.tweakOptionTable, 4, false);
-  setFloatRangeTweakOption(m_ui.tweakOptionTable, 5, -1.0f);
-  setFloatRangeTweakOption(m_ui.tweakOptionTable, 6, Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD);
-  setBooleanTweakOption(m_ui.tweakOptionTable, 7, false);
-  setChoiceTweakOption(m_ui.tweakOptionTable, 8, Settings::DEFAULT_CPU_FASTMEM_MODE);
-  setBooleanTweakOption(m_ui.tweakOptionTable, 9, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 5, false);
+  setFloatRangeTweakOption(m_ui.tweakOptionTable, 6, -1.0f);
+  setFloatRangeTweakOption(m_ui.tweakOptionTable, 7, Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 8, false);
+  setChoiceTweakOption(m_ui.tweakOptionTable, 9, Settings::DEFAULT_CPU_FASTMEM_MODE);
   setBooleanTweakOption(m_ui.tweakOptionTable, 10, false);
   setBooleanTweakOption(m_ui.tweakOptionTable, 11, false);
   setBooleanTweakOption(m_ui.tweakOptionTable, 12, false);
   setBooleanTweakOption(m_ui.tweakOptionTable, 13, false);
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 14, Settings::DEFAULT_VRAM_WRITE_DUMP_WIDTH_THRESHOLD);
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 15, Settings::DEFAULT_VRAM_WRITE_DUMP_HEIGHT_THRESHOLD);
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 16, static_cast<int>(Settings::DEFAULT_DMA_MAX_SLICE_TICKS));
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 17, static_cast<int>(Settings::DEFAULT_DMA_HALT_TICKS));
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 18, static_cast<int>(Settings::DEFAULT_GPU_FIFO_SIZE));
-  setIntRangeTweakOption(m_ui.tweakOptionTable, 19, static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD));
-  setBooleanTweakOption(m_ui.tweakOptionTable, 20, false);
-  setBooleanTweakOption(m_ui.tweakOptionTable, 21, true);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 14, false);
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 15,
+                         static_cast<int>(Settings::DEFAULT_TEXTURE_REPLACEMENT_MEMORY_BUDGET));
+  setBooleanTweakOption(m_ui.tweakOptionTable, 16, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 17, false);
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 18, Settings::DEFAULT_VRAM_WRITE_DUMP_WIDTH_THRESHOLD);
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 19, Settings::DEFAULT_VRAM_WRITE_DUMP_HEIGHT_THRESHOLD);
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 20, static_cast<int>(Settings::DEFAULT_DMA_MAX_SLICE_TICKS));
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 21, static_cast<int>(Settings::DEFAULT_DMA_HALT_TICKS));
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 22, static_cast<int>(Settings::DEFAULT_GPU_FIFO_SIZE));
+  setIntRangeTweakOption(m_ui.tweakOptionTable, 23, static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD));
+  setBooleanTweakOption(m_ui.tweakOptionTable, 24, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 25, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 26, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 27, false);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 28, true);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 29, true);
+  setBooleanTweakOption(m_ui.tweakOptionTable, 30, false);
 }
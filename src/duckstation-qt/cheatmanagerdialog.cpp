@@ -653,7 +653,7 @@ void CheatManagerDialog::addToWatchClicked()
   if (index < 0)
     return;
 
-  const MemoryScan::Result& res = m_scanner.GetResults()[static_cast<u32>(index)];
+  const MemoryScan::Result res = m_scanner.GetResult(static_cast<u32>(index));
   m_watch.AddEntry(StringUtil::StdStringFromFormat("0x%08x", res.address), res.address, m_scanner.GetSize(),
                    m_scanner.GetValueSigned(), false);
   updateWatch();
@@ -794,21 +794,22 @@ void CheatManagerDialog::updateResults()
   QSignalBlocker sb(m_ui.scanTable);
   m_ui.scanTable->setRowCount(0);
 
-  const MemoryScan::ResultVector& results = m_scanner.GetResults();
-  if (!results.empty())
+  const u32 result_count = m_scanner.GetResultCount();
+  if (result_count > 0)
   {
     int row = 0;
-    for (const MemoryScan::Result& res : m_scanner.GetResults())
+    for (u32 i = 0; i < result_count; i++)
     {
       if (row == MAX_DISPLAYED_SCAN_RESULTS)
       {
         QMessageBox::information(this, tr("Memory Scan"),
                                  tr("Memory scan found %1 addresses, but only the first %2 are displayed.")
-                                   .arg(m_scanner.GetResultCount())
+                                   .arg(result_count)
                                    .arg(MAX_DISPLAYED_SCAN_RESULTS));
         break;
       }
 
+      const MemoryScan::Result res = m_scanner.GetResult(i);
       m_ui.scanTable->insertRow(row);
 
       QTableWidgetItem* address_item = new QTableWidgetItem(formatHexValue(res.address, 8));
@@ -842,8 +843,8 @@ void CheatManagerDialog::updateResults()
     }
   }
 
-  m_ui.scanResetSearch->setEnabled(!results.empty());
-  m_ui.scanSearchAgain->setEnabled(!results.empty());
+  m_ui.scanResetSearch->setEnabled(result_count > 0);
+  m_ui.scanSearchAgain->setEnabled(result_count > 0);
   m_ui.scanAddWatch->setEnabled(false);
 }
 
@@ -851,9 +852,11 @@ void CheatManagerDialog::updateResultsValues()
 {
   QSignalBlocker sb(m_ui.scanTable);
 
+  const u32 result_count = m_scanner.GetResultCount();
   int row = 0;
-  for (const MemoryScan::Result& res : m_scanner.GetResults())
+  for (u32 i = 0; i < result_count; i++)
   {
+    const MemoryScan::Result res = m_scanner.GetResult(i);
     if (res.value_changed)
     {
       QTableWidgetItem* item = m_ui.scanTable->item(row, 1);
@@ -127,13 +127,14 @@ void DebuggerWindow::onTraceTriggered()
   {
     QMessageBox::critical(
       this, windowTitle(),
-      tr("Trace logging started to cpu_log.txt.\nThis file can be several gigabytes, so be aware of SSD wear."));
+      tr("Trace logging started to cpu_trace.bin.\nThis file can be several gigabytes, so be aware of SSD wear.\nUse "
+         "cpu-trace-tool to convert it to text or compare it against another trace."));
     CPU::StartTrace();
   }
   else
   {
     CPU::StopTrace();
-    QMessageBox::critical(this, windowTitle(), tr("Trace logging to cpu_log.txt stopped."));
+    QMessageBox::critical(this, windowTitle(), tr("Trace logging to cpu_trace.bin stopped."));
   }
 }
 
@@ -46,6 +46,8 @@ DisplaySettingsWidget::DisplaySettingsWidget(QtHostInterface* host_interface, QW
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.showSpeed, "Display", "ShowSpeed", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.showResolution, "Display", "ShowResolution",
                                                false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.showPresentLatency, "Display",
+                                               "ShowPresentLatency", false);
 
   connect(m_ui.renderer, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &DisplaySettingsWidget::populateGPUAdaptersAndResolutions);
@@ -97,8 +99,9 @@ DisplaySettingsWidget::DisplaySettingsWidget(QtHostInterface* host_interface, QW
     tr("Enable this option to match DuckStation's refresh rate with your current monitor or screen. "
        "VSync is automatically disabled when it is not possible (e.g. running at non-100% speed)."));
   dialog->registerWidgetHelp(m_ui.threadedPresentation, tr("Threaded Presentation"), tr("Checked"),
-                             tr("Presents frames on a background thread when fast forwarding or vsync is disabled. "
-                                "This can measurably improve performance in the Vulkan renderer."));
+                             tr("Presents frames on a background thread, so the emulation doesn't wait for the swap, "
+                                "and measures the refresh rate of the monitor for syncing to it. Available in the "
+                                "Vulkan and OpenGL (EGL) renderers."));
   dialog->registerWidgetHelp(m_ui.gpuThread, tr("Threaded Rendering"), tr("Checked"),
                              tr("Uses a second thread for drawing graphics. Currently only available for the software "
                                 "renderer, but can provide a significant speed improvement, and is safe to use."));
@@ -113,6 +116,10 @@ DisplaySettingsWidget::DisplaySettingsWidget(QtHostInterface* host_interface, QW
   dialog->registerWidgetHelp(
     m_ui.showSpeed, tr("Show Speed"), tr("Unchecked"),
     tr("Shows the current emulation speed of the system in the top-right corner of the display as a percentage."));
+  dialog->registerWidgetHelp(m_ui.showPresentLatency, tr("Show Present Latency"), tr("Unchecked"),
+                             tr("Shows the average and 99th percentile time from the start of an emulated frame, "
+                                "when input is read, to the frame being handed to the display, in the top-right "
+                                "corner of the display. Time spent by the compositor and monitor is not included."));
 
 #ifdef _WIN32
   {
@@ -179,6 +186,10 @@ void DisplaySettingsWidget::populateGPUAdaptersAndResolutions()
       threaded_presentation_supported = true;
       break;
 
+    case GPURenderer::HardwareOpenGL:
+      threaded_presentation_supported = true;
+      break;
+
     case GPURenderer::Software:
       thread_supported = true;
       break;
@@ -4,6 +4,7 @@
 #include "qtutils.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMessageBox>
+#include <cstdio>
 #include <cstdlib>
 #include <memory>
 
@@ -50,6 +51,12 @@ int main(int argc, char* argv[])
   if (!ParseCommandLineParameters(app, host_interface.get(), &boot_params))
     return EXIT_FAILURE;
 
+  if (host_interface->InHeadlessMode())
+  {
+    std::fprintf(stderr, "Headless mode is only supported by the SDL frontend.\n");
+    return EXIT_FAILURE;
+  }
+
   std::unique_ptr<MainWindow> window = std::make_unique<MainWindow>(host_interface.get());
 
   if (!host_interface->Initialize())
@@ -183,6 +183,11 @@ bool QtHostInterface::ConfirmMessage(const char* message)
   return result;
 }
 
+void QtHostInterface::RunLater(std::function<void()> callback)
+{
+  executeOnEmulationThread(std::move(callback), false);
+}
+
 std::string QtHostInterface::GetStringSettingValue(const char* section, const char* key,
                                                    const char* default_value /*= ""*/)
 {
@@ -694,7 +699,7 @@ void QtHostInterface::OnSystemDestroyed()
 
 void QtHostInterface::OnSystemPerformanceCountersUpdated()
 {
-  HostInterface::OnSystemPerformanceCountersUpdated();
+  CommonHostInterface::OnSystemPerformanceCountersUpdated();
 
   emit systemPerformanceCountersUpdated(System::GetEmulationSpeed(), System::GetFPS(), System::GetVPS(),
                                         System::GetAverageFrameTime(), System::GetWorstFrameTime());
@@ -1429,7 +1434,11 @@ void QtHostInterface::threadEntryPoint()
       PauseSystem(true);
     }
 
-    renderDisplay();
+    if (!System::IsFrameSkipped())
+    {
+      renderDisplay();
+      System::OnFramePresented();
+    }
 
     System::UpdatePerformanceCounters();
 
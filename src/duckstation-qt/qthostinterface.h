@@ -53,6 +53,7 @@ public Q_SLOTS:
   void ReportMessage(const char* message) override;
   void ReportDebuggerMessage(const char* message) override;
   bool ConfirmMessage(const char* message) override;
+  void RunLater(std::function<void()> callback) override;
 
 public:
   /// Thread-safe settings access.
@@ -103,7 +103,8 @@ void SDLHostInterface::DestroySDLWindow()
 
 bool SDLHostInterface::CreateDisplay()
 {
-  std::optional<WindowInfo> wi = SDLUtil::GetWindowInfoForSDLWindow(m_window);
+  // a default WindowInfo is surfaceless, which gets an offscreen target
+  std::optional<WindowInfo> wi = m_window ? SDLUtil::GetWindowInfoForSDLWindow(m_window) : WindowInfo();
   if (!wi.has_value())
   {
     ReportError("Failed to get window info from SDL window");
@@ -142,8 +143,9 @@ bool SDLHostInterface::CreateDisplay()
     return false;
   }
 
-  bool imgui_result;
-  switch (display->GetRenderAPI())
+  // the SDL side of ImGui only handles window input, there's none when headless
+  bool imgui_result = true;
+  switch (m_window ? display->GetRenderAPI() : HostDisplay::RenderAPI::None)
   {
 #ifdef WIN32
     case HostDisplay::RenderAPI::D3D11:
@@ -161,7 +163,6 @@ bool SDLHostInterface::CreateDisplay()
       break;
 
     default:
-      imgui_result = true;
       break;
   }
   if (!imgui_result)
@@ -175,7 +176,9 @@ bool SDLHostInterface::CreateDisplay()
   if (!m_app_icon_texture)
     return false;
 
-  display->SetDisplayTopMargin(m_fullscreen ? 0 : static_cast<int>(20.0f * ImGui::GetIO().DisplayFramebufferScale.x));
+  // the menu bar isn't drawn fullscreen or headless
+  display->SetDisplayTopMargin(
+    (m_fullscreen || !m_window) ? 0 : static_cast<int>(20.0f * ImGui::GetIO().DisplayFramebufferScale.x));
   m_display = std::move(display);
   return true;
 }
@@ -189,7 +192,8 @@ void SDLHostInterface::DestroyDisplay()
 
 void SDLHostInterface::CreateImGuiContext()
 {
-  const float framebuffer_scale = SDLUtil::GetDPIScaleFactor(m_window);
+  // querying the DPI without a window creates one
+  const float framebuffer_scale = m_window ? SDLUtil::GetDPIScaleFactor(m_window) : 1.0f;
 
   ImGui::CreateContext();
   ImGui::GetIO().IniFilename = nullptr;
@@ -202,9 +206,24 @@ void SDLHostInterface::CreateImGuiContext()
   ImGui::AddRobotoRegularFont(15.0f * framebuffer_scale);
 }
 
+void SDLHostInterface::NewImGuiFrame()
+{
+  if (m_window)
+  {
+    ImGui_ImplSDL2_NewFrame(m_window);
+  }
+  else
+  {
+    ImGui::GetIO().DisplaySize =
+      ImVec2(static_cast<float>(m_display->GetWindowWidth()), static_cast<float>(m_display->GetWindowHeight()));
+  }
+
+  ImGui::NewFrame();
+}
+
 void SDLHostInterface::UpdateFramebufferScale()
 {
-  const float framebuffer_scale = SDLUtil::GetDPIScaleFactor(m_window);
+  const float framebuffer_scale = m_window ? SDLUtil::GetDPIScaleFactor(m_window) : 1.0f;
   ImGui::GetIO().DisplayFramebufferScale.x = framebuffer_scale;
   ImGui::GetIO().DisplayFramebufferScale.y = framebuffer_scale;
 }
@@ -242,14 +261,17 @@ bool SDLHostInterface::AcquireHostDisplay()
     DestroyDisplay();
 
     // We need to recreate the window, otherwise bad things happen...
-    DestroySDLWindow();
-    if (!CreateSDLWindow())
-      Panic("Failed to recreate SDL window on GPU renderer switch");
+    if (m_window)
+    {
+      DestroySDLWindow();
+      if (!CreateSDLWindow())
+        Panic("Failed to recreate SDL window on GPU renderer switch");
+    }
 
     if (!CreateDisplay())
       Panic("Failed to recreate display on GPU renderer switch");
 
-    ImGui::NewFrame();
+    NewImGuiFrame();
   }
 
   if (!CreateHostDisplayResources())
@@ -314,6 +336,9 @@ void SDLHostInterface::OnRunningGameChanged()
   CommonHostInterface::FixIncompatibleSettings(true);
   CheckForSettingsChanges(old_settings);
 
+  if (!m_window)
+    return;
+
   if (!System::GetRunningTitle().empty())
     SDL_SetWindowTitle(m_window, System::GetRunningTitle().c_str());
   else
@@ -356,6 +381,8 @@ bool SDLHostInterface::SetFullscreen(bool enabled)
 {
   if (m_fullscreen == enabled)
     return true;
+  else if (!m_window)
+    return false;
 
   SDL_SetWindowFullscreen(m_window, enabled ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
 
@@ -387,7 +414,7 @@ bool SDLHostInterface::Initialize()
   if (!FileSystem::SetWorkingDirectory(m_user_directory.c_str()))
     Log_ErrorPrintf("Failed to set working directory to '%s'", m_user_directory.c_str());
 
-  if (!CreateSDLWindow())
+  if (!InHeadlessMode() && !CreateSDLWindow())
   {
     Log_ErrorPrintf("Failed to create SDL window");
     return false;
@@ -400,7 +427,7 @@ bool SDLHostInterface::Initialize()
     return false;
   }
 
-  ImGui::NewFrame();
+  NewImGuiFrame();
 
   // process events to pick up controllers before updating input map
   ProcessEvents();
@@ -450,6 +477,16 @@ bool SDLHostInterface::RequestRenderWindowSize(s32 new_window_width, s32 new_win
   if (new_window_width <= 0 || new_window_height <= 0 || m_fullscreen)
     return false;
 
+  if (!m_window)
+  {
+    // nothing to fit around the display, the offscreen target is just resized
+    m_display->ResizeRenderWindow(new_window_width, new_window_height);
+    if (!System::IsShutdown())
+      g_gpu->UpdateResolutionScale();
+
+    return true;
+  }
+
   // use imgui scale as the dpr
   const float dpi_scale = ImGui::GetIO().DisplayFramebufferScale.x;
   const s32 scaled_width =
@@ -472,6 +509,17 @@ bool SDLHostInterface::RequestRenderWindowSize(s32 new_window_width, s32 new_win
   return true;
 }
 
+bool SDLHostInterface::GetMainDisplayRefreshRate(float* refresh_rate)
+{
+  // the display the window is on, rather than the primary one
+  SDL_DisplayMode mode;
+  if (!m_window || SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(m_window), &mode) != 0 || mode.refresh_rate <= 0)
+    return CommonHostInterface::GetMainDisplayRefreshRate(refresh_rate);
+
+  *refresh_rate = static_cast<float>(mode.refresh_rate);
+  return true;
+}
+
 void SDLHostInterface::LoadSettings()
 {
   // Settings need to be loaded prior to creating the window for OpenGL bits.
@@ -483,6 +531,12 @@ void SDLHostInterface::LoadSettings()
 
 void SDLHostInterface::ReportError(const char* message)
 {
+  if (!m_window)
+  {
+    Log_ErrorPrint(message);
+    return;
+  }
+
   const bool was_fullscreen = IsFullscreen();
   if (was_fullscreen)
     SetFullscreen(false);
@@ -1142,6 +1196,14 @@ void SDLHostInterface::DrawQuickSettingsMenu()
       StopDumpingAudio();
   }
 
+  if (ImGui::MenuItem("Capture Video", nullptr, System::IsCapturingMedia(), System::IsValid()))
+  {
+    if (!System::IsCapturingMedia())
+      StartMediaCapture();
+    else
+      StopMediaCapture();
+  }
+
   if (ImGui::MenuItem("Save Screenshot"))
     RunLater([this]() { SaveScreenshot(); });
 
@@ -1173,6 +1235,7 @@ void SDLHostInterface::DrawDebugMenu()
   settings_changed |= ImGui::MenuItem("Log To Console", nullptr, &m_settings_copy.log_to_console);
   settings_changed |= ImGui::MenuItem("Log To Debug", nullptr, &m_settings_copy.log_to_debug);
   settings_changed |= ImGui::MenuItem("Log To File", nullptr, &m_settings_copy.log_to_file);
+  settings_changed |= ImGui::MenuItem("Asynchronous Logging", nullptr, &m_settings_copy.log_async);
 
   ImGui::Separator();
 
@@ -1865,21 +1928,30 @@ void SDLHostInterface::Run()
       }
     }
 
-    // rendering
+    // rendering, skipped frames aren't presented
+    if (!System::IsRunning() || !System::IsFrameSkipped())
     {
-      DrawImGuiWindows();
+      // the menus and OSD aren't part of the headless output, so it only depends on the emulated frame
+      if (m_window)
+        DrawImGuiWindows();
 
       m_display->Render();
-      ImGui_ImplSDL2_NewFrame(m_window);
-      ImGui::NewFrame();
-
       if (System::IsRunning())
       {
-        System::UpdatePerformanceCounters();
-
-        if (m_throttler_enabled)
-          System::Throttle();
+        System::OnFramePresented();
+        if (!m_window)
+          WriteHeadlessFrameHash();
       }
+
+      NewImGuiFrame();
+    }
+
+    if (System::IsRunning())
+    {
+      System::UpdatePerformanceCounters();
+
+      if (m_throttler_enabled)
+        System::Throttle();
     }
   }
 
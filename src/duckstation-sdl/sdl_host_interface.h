@@ -39,6 +39,7 @@ public:
   float GetFloatSettingValue(const char* section, const char* key, float default_value = 0.0f) override;
 
   bool RequestRenderWindowSize(s32 new_window_width, s32 new_window_height) override;
+  bool GetMainDisplayRefreshRate(float* refresh_rate) override;
 
   void Run();
 
@@ -59,17 +60,18 @@ protected:
   std::optional<HostKeyCode> GetHostKeyCode(const std::string_view key_code) const override;
   void UpdateInputMap() override;
 
+  /// Executes a callback later, after the UI has finished rendering. Needed to boot while rendering ImGui.
+  void RunLater(std::function<void()> callback) override;
+
 private:
   bool CreateSDLWindow();
   void DestroySDLWindow();
   bool CreateDisplay();
   void DestroyDisplay();
   void CreateImGuiContext();
+  void NewImGuiFrame();
   void UpdateFramebufferScale();
 
-  /// Executes a callback later, after the UI has finished rendering. Needed to boot while rendering ImGui.
-  void RunLater(std::function<void()> callback);
-
   void SaveAndUpdateSettings();
 
   bool IsFullscreen() const override;
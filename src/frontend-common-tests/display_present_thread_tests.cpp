@@ -0,0 +1,189 @@
+#include "frontend-common/display_present_thread.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using FrontendCommon::DisplayPresentThread;
+
+namespace {
+// Holds presents until it's opened, so frames can be queued up behind one.
+class PresentGate
+{
+public:
+  bool Wait()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waiting = true;
+    m_cv.notify_all();
+    m_cv.wait(lock, [this]() { return m_open; });
+    return true;
+  }
+
+  void WaitUntilHeld()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_waiting; });
+  }
+
+  void Open()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_open = true;
+    m_cv.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_waiting = false;
+  bool m_open = false;
+};
+
+static void PublishFrame(DisplayPresentThread& thread, u64 frame_number)
+{
+  const u32 slot = thread.AcquireSlot();
+  ASSERT_NE(slot, static_cast<u32>(DisplayPresentThread::INVALID_SLOT));
+  thread.PublishSlot(slot, {frame_number, frame_number, 0});
+}
+
+// Collects presented frames until there are count of them, or a few seconds went by.
+static std::vector<HostDisplay::FrameTimestamps> WaitForPresentedFrames(DisplayPresentThread& thread, size_t count)
+{
+  std::vector<HostDisplay::FrameTimestamps> frames;
+  for (u32 i = 0; i < 5000 && frames.size() < count; i++)
+  {
+    thread.GetPresentedFrames(&frames);
+    if (frames.size() < count)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return frames;
+}
+} // namespace
+
+TEST(DisplayPresentThread, VSyncPresentsEveryFrameInOrder)
+{
+  DisplayPresentThread thread;
+  ASSERT_TRUE(thread.Start(true, [](u32) { return true; }));
+
+  static constexpr u64 NUM_FRAMES = 20;
+  for (u64 i = 1; i <= NUM_FRAMES; i++)
+    PublishFrame(thread, i);
+
+  const std::vector<HostDisplay::FrameTimestamps> frames = WaitForPresentedFrames(thread, NUM_FRAMES);
+  thread.Stop();
+
+  ASSERT_EQ(frames.size(), NUM_FRAMES);
+  for (u64 i = 0; i < NUM_FRAMES; i++)
+  {
+    EXPECT_EQ(frames[i].frame_start_time, i + 1);
+    EXPECT_NE(frames[i].present_time, 0u);
+  }
+}
+
+TEST(DisplayPresentThread, VSyncAcquireWaitsForFreeSlot)
+{
+  PresentGate gate;
+  DisplayPresentThread thread;
+  ASSERT_TRUE(thread.Start(true, [&gate](u32) { return gate.Wait(); }));
+
+  // one frame being presented, the other two queued behind it
+  PublishFrame(thread, 1);
+  gate.WaitUntilHeld();
+  PublishFrame(thread, 2);
+  PublishFrame(thread, 3);
+
+  std::atomic_bool acquired{false};
+  std::thread acquire_thread([&thread, &acquired]() {
+    const u32 slot = thread.AcquireSlot();
+    acquired.store(true);
+    thread.ReleaseSlot(slot);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(acquired.load());
+
+  gate.Open();
+  acquire_thread.join();
+  EXPECT_TRUE(acquired.load());
+
+  const std::vector<HostDisplay::FrameTimestamps> frames = WaitForPresentedFrames(thread, 3);
+  thread.Stop();
+  ASSERT_EQ(frames.size(), 3u);
+}
+
+TEST(DisplayPresentThread, NoVSyncReplacesQueuedFrames)
+{
+  PresentGate gate;
+  DisplayPresentThread thread;
+  ASSERT_TRUE(thread.Start(false, [&gate](u32) { return gate.Wait(); }));
+
+  PublishFrame(thread, 1);
+  gate.WaitUntilHeld();
+
+  // never waits, the oldest queued frame is taken back when the slots run out
+  for (u64 i = 2; i <= 10; i++)
+    PublishFrame(thread, i);
+
+  gate.Open();
+  const std::vector<HostDisplay::FrameTimestamps> frames = WaitForPresentedFrames(thread, 2);
+  thread.Stop();
+
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0].frame_start_time, 1u);
+  EXPECT_EQ(frames[1].frame_start_time, 10u);
+}
+
+TEST(DisplayPresentThread, MeasuresRefreshRateWithVSync)
+{
+  // a present which blocks like a 100hz display would
+  DisplayPresentThread thread;
+  ASSERT_TRUE(thread.Start(true, [](u32) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return true;
+  }));
+
+  // keep the mailbox full, so the presents are only paced by the "display"
+  for (u64 i = 1; i <= DisplayPresentThread::MIN_REFRESH_SAMPLES + 10; i++)
+    PublishFrame(thread, i);
+
+  WaitForPresentedFrames(thread, DisplayPresentThread::MIN_REFRESH_SAMPLES + 10);
+  thread.Stop();
+
+  // sleeps only ever overshoot
+  const float refresh_rate = thread.GetMeasuredRefreshRate();
+  EXPECT_GT(refresh_rate, 50.0f);
+  EXPECT_LE(refresh_rate, 101.0f);
+}
+
+TEST(DisplayPresentThread, NoRefreshRateWithoutVSync)
+{
+  DisplayPresentThread thread;
+  ASSERT_TRUE(thread.Start(false, [](u32) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+  }));
+
+  for (u64 i = 1; i <= DisplayPresentThread::MIN_REFRESH_SAMPLES + 10; i++)
+  {
+    PublishFrame(thread, i);
+    WaitForPresentedFrames(thread, 1);
+  }
+
+  thread.Stop();
+  EXPECT_EQ(thread.GetMeasuredRefreshRate(), 0.0f);
+}
+
+TEST(DisplayPresentThread, InitFailureStopsThread)
+{
+  bool shutdown_called = false;
+  DisplayPresentThread thread;
+  EXPECT_FALSE(thread.Start(
+    true, [](u32) { return true; }, []() { return false; }, [&shutdown_called]() { shutdown_called = true; }));
+  EXPECT_FALSE(thread.IsRunning());
+  EXPECT_FALSE(shutdown_called);
+}
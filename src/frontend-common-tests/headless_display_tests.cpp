@@ -0,0 +1,136 @@
+#include "common/window_info.h"
+#include "core/host_display.h"
+#include "frontend-common/opengl_host_display.h"
+#include "frontend-common/vulkan_host_display.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+namespace {
+// Small enough to check every pixel, and not square so a transposed readback doesn't pass.
+static constexpr u32 TEST_WIDTH = 64;
+static constexpr u32 TEST_HEIGHT = 32;
+
+static std::vector<u32> MakeTestPattern()
+{
+  std::vector<u32> pixels(TEST_WIDTH * TEST_HEIGHT);
+  for (u32 y = 0; y < TEST_HEIGHT; y++)
+  {
+    for (u32 x = 0; x < TEST_WIDTH; x++)
+      pixels[y * TEST_WIDTH + x] = 0xFF000000u | ((x * 4u) << 16) | ((y * 8u) << 8) | ((x ^ y) & 1u ? 0xFFu : 0u);
+  }
+
+  return pixels;
+}
+
+class HeadlessDisplay : public testing::TestWithParam<HostDisplay::RenderAPI>
+{
+protected:
+  void SetUp() override
+  {
+    if (GetParam() == HostDisplay::RenderAPI::Vulkan)
+      m_display = std::make_unique<FrontendCommon::VulkanHostDisplay>();
+    else
+      m_display = std::make_unique<FrontendCommon::OpenGLHostDisplay>();
+
+    // the same window info the frontends use with -headless
+    WindowInfo wi;
+    wi.surface_width = TEST_WIDTH;
+    wi.surface_height = TEST_HEIGHT;
+    if (!m_display->CreateRenderDevice(wi, {}, false, false))
+    {
+      m_display.reset();
+      GTEST_SKIP() << "No device available for headless rendering";
+    }
+
+    ASSERT_TRUE(m_display->InitializeRenderDevice({}, false, false));
+    ASSERT_TRUE(m_display->HasRenderSurface());
+  }
+
+  void TearDown() override
+  {
+    if (!m_display)
+      return;
+
+    m_texture.reset();
+    m_display->DestroyRenderDevice();
+    m_display.reset();
+  }
+
+  // Shows the pattern unscaled and without filtering, so the output should match it exactly.
+  void ShowPattern(const std::vector<u32>& pattern)
+  {
+    m_texture = m_display->CreateTexture(TEST_WIDTH, TEST_HEIGHT, pattern.data(), TEST_WIDTH * sizeof(u32));
+    ASSERT_TRUE(m_texture);
+
+    m_display->SetDisplayTexture(m_texture->GetHandle(), m_texture->GetFormat(), TEST_WIDTH, TEST_HEIGHT, 0, 0,
+                                 TEST_WIDTH, TEST_HEIGHT);
+    m_display->SetDisplayParameters(TEST_WIDTH, TEST_HEIGHT, 0, 0, TEST_WIDTH, TEST_HEIGHT,
+                                    static_cast<float>(TEST_WIDTH) / static_cast<float>(TEST_HEIGHT));
+    m_display->SetDisplayLinearFiltering(false);
+    ASSERT_TRUE(m_display->Render());
+  }
+
+  std::unique_ptr<HostDisplay> m_display;
+  std::unique_ptr<HostDisplayTexture> m_texture;
+};
+} // namespace
+
+TEST_P(HeadlessDisplay, OutputMatchesDisplayTexture)
+{
+  const std::vector<u32> pattern = MakeTestPattern();
+  ShowPattern(pattern);
+
+  std::vector<u32> output;
+  u32 width, height;
+  ASSERT_TRUE(m_display->DownloadHeadlessOutput(&output, &width, &height));
+  ASSERT_EQ(width, TEST_WIDTH);
+  ASSERT_EQ(height, TEST_HEIGHT);
+  for (u32 i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++)
+    ASSERT_EQ(output[i] & 0xFFFFFFu, pattern[i] & 0xFFFFFFu) << "at " << (i % TEST_WIDTH) << "," << (i / TEST_WIDTH);
+}
+
+TEST_P(HeadlessDisplay, OutputFollowsResize)
+{
+  m_display->ResizeRenderWindow(TEST_WIDTH * 2, TEST_HEIGHT * 2);
+  ASSERT_EQ(m_display->GetWindowWidth(), static_cast<s32>(TEST_WIDTH * 2));
+
+  const std::vector<u32> pattern = MakeTestPattern();
+  ShowPattern(pattern);
+
+  std::vector<u32> output;
+  u32 width, height;
+  ASSERT_TRUE(m_display->DownloadHeadlessOutput(&output, &width, &height));
+  ASSERT_EQ(width, TEST_WIDTH * 2);
+  ASSERT_EQ(height, TEST_HEIGHT * 2);
+
+  // exactly 2x, so every source pixel covers a 2x2 block
+  for (u32 y = 0; y < height; y++)
+  {
+    for (u32 x = 0; x < width; x++)
+      ASSERT_EQ(output[y * width + x] & 0xFFFFFFu, pattern[(y / 2) * TEST_WIDTH + (x / 2)] & 0xFFFFFFu);
+  }
+}
+
+TEST_P(HeadlessDisplay, HashIsStableAndSeesChanges)
+{
+  std::vector<u32> pattern = MakeTestPattern();
+  ShowPattern(pattern);
+
+  u64 hash1, hash2;
+  ASSERT_TRUE(m_display->GetHeadlessOutputHash(&hash1));
+  ShowPattern(pattern);
+  ASSERT_TRUE(m_display->GetHeadlessOutputHash(&hash2));
+  ASSERT_EQ(hash1, hash2);
+
+  pattern[TEST_WIDTH * (TEST_HEIGHT / 2) + 3] ^= 0x00010000u;
+  ShowPattern(pattern);
+  ASSERT_TRUE(m_display->GetHeadlessOutputHash(&hash2));
+  ASSERT_NE(hash1, hash2);
+}
+
+INSTANTIATE_TEST_SUITE_P(HeadlessDisplay, HeadlessDisplay,
+                         testing::Values(HostDisplay::RenderAPI::OpenGL, HostDisplay::RenderAPI::Vulkan),
+                         [](const testing::TestParamInfo<HostDisplay::RenderAPI>& info) {
+                           return (info.param == HostDisplay::RenderAPI::Vulkan) ? "Vulkan" : "OpenGL";
+                         });
@@ -13,6 +13,8 @@
 #include "core/gpu.h"
 #include "core/host_display.h"
 #include "core/mdec.h"
+#include "core/media_capture.h"
+#include "core/movie.h"
 #include "core/pgxp.h"
 #include "core/save_state_version.h"
 #include "core/spu.h"
@@ -26,6 +28,7 @@
 #include "ini_settings_interface.h"
 #include "save_state_selector_ui.h"
 #include "scmversion/scmversion.h"
+#include <cinttypes>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
@@ -96,6 +99,12 @@ void CommonHostInterface::Shutdown()
     m_controller_interface->Shutdown();
     m_controller_interface.reset();
   }
+
+  if (m_frame_hash_file)
+  {
+    std::fclose(m_frame_hash_file);
+    m_frame_hash_file = nullptr;
+  }
 }
 
 void CommonHostInterface::InitializeUserDirectory()
@@ -121,8 +130,10 @@ void CommonHostInterface::InitializeUserDirectory()
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("dump").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("dump/audio").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("dump/textures").c_str(), false);
+  result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("dump/video").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("inputprofiles").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("memcards").c_str(), false);
+  result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("movies").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("savestates").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("screenshots").c_str(), false);
   result &= FileSystem::CreateDirectory(GetUserDirectoryRelativePath("shaders").c_str(), false);
@@ -153,6 +164,37 @@ bool CommonHostInterface::BootSystem(const SystemBootParameters& parameters)
   if (g_settings.audio_dump_on_boot)
     StartDumpingAudio();
 
+  if (!m_boot_movie_play_filename.empty())
+  {
+    if (StartMoviePlayback(m_boot_movie_play_filename.c_str(), m_movie_unthrottled) && m_boot_movie_seek_frame > 0)
+      SeekMovie(m_boot_movie_seek_frame);
+  }
+  else if (!m_boot_movie_record_filename.empty())
+    StartMovieRecording(m_boot_movie_record_filename.c_str());
+  m_boot_movie_play_filename = {};
+  m_boot_movie_record_filename = {};
+  m_boot_movie_seek_frame = 0;
+
+  if (!m_boot_media_capture_filename.empty())
+    StartMediaCapture(m_boot_media_capture_filename.c_str());
+  m_boot_media_capture_filename = {};
+
+  if (!m_boot_shared_memory_export_name.empty())
+  {
+    if (System::StartSharedMemoryExport(m_boot_shared_memory_export_name.c_str()))
+    {
+      AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Exporting to shared memory '%s'."),
+                             m_boot_shared_memory_export_name.c_str());
+    }
+    else
+    {
+      AddFormattedOSDMessage(10.0f, TranslateString("OSDMessage", "Failed to create shared memory '%s'."),
+                             m_boot_shared_memory_export_name.c_str());
+    }
+
+    m_boot_shared_memory_export_name = {};
+  }
+
   UpdateSpeedLimiterState();
   return true;
 }
@@ -203,6 +245,9 @@ static void PrintCommandLineHelp(const char* progname, const char* frontend_name
   std::fprintf(stderr, "  -help: Displays this information and exits.\n");
   std::fprintf(stderr, "  -version: Displays version information and exits.\n");
   std::fprintf(stderr, "  -batch: Enables batch mode (exits after powering off).\n");
+  std::fprintf(stderr, "  -headless: Runs without a window, rendering offscreen. Implies -batch.\n");
+  std::fprintf(stderr, "  -framehashes <filename>: Writes a hash of every frame rendered headless\n"
+                       "    to the specified file, one line per frame.\n");
   std::fprintf(stderr, "  -fastboot: Force fast boot for provided filename.\n");
   std::fprintf(stderr, "  -slowboot: Force slow boot for provided filename.\n");
   std::fprintf(stderr, "  -resume: Load resume save state. If a boot filename is provided,\n"
@@ -221,6 +266,15 @@ static void PrintCommandLineHelp(const char* progname, const char* frontend_name
                        "                 the emulator.\n");
   std::fprintf(stderr, "  -settings <filename>: Loads a custom settings configuration from the\n"
                        "    specified filename. Default settings applied if file not found.\n");
+  std::fprintf(stderr, "  -recordmovie <filename>: Records an input movie after booting.\n");
+  std::fprintf(stderr, "  -playmovie <filename>: Plays back an input movie, checking for desyncs.\n"
+                       "    No boot filename is required with this option.\n");
+  std::fprintf(stderr, "  -fastmovie: Plays back the movie without speed limiting.\n");
+  std::fprintf(stderr, "  -seekmovie <frame>: Seeks the movie being played to the specified frame\n"
+                       "    after loading it.\n");
+  std::fprintf(stderr, "  -capture <filename>: Captures video and audio losslessly after booting.\n");
+  std::fprintf(stderr, "  -shmexport <name>: Publishes frames, audio and RAM to a shared memory\n"
+                       "    segment, and takes controller input from it.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
@@ -263,6 +317,18 @@ bool CommonHostInterface::ParseCommandLineParameters(int argc, char* argv[],
         m_command_line_flags.batch_mode = true;
         continue;
       }
+      else if (CHECK_ARG("-headless"))
+      {
+        Log_InfoPrintf("Running headless.");
+        m_command_line_flags.batch_mode = true;
+        m_command_line_flags.headless = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-framehashes"))
+      {
+        m_frame_hash_filename = argv[++i];
+        continue;
+      }
       else if (CHECK_ARG("-fastboot"))
       {
         Log_InfoPrintf("Forcing fast boot.");
@@ -324,6 +390,37 @@ bool CommonHostInterface::ParseCommandLineParameters(int argc, char* argv[],
         m_settings_filename = argv[++i];
         continue;
       }
+      else if (CHECK_ARG_PARAM("-recordmovie"))
+      {
+        m_boot_movie_record_filename = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-playmovie"))
+      {
+        m_boot_movie_play_filename = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-seekmovie"))
+      {
+        m_boot_movie_seek_frame = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-capture"))
+      {
+        m_boot_media_capture_filename = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-shmexport"))
+      {
+        m_boot_shared_memory_export_name = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG("-fastmovie"))
+      {
+        Log_InfoPrintf("Playing movie without speed limiting.");
+        m_movie_unthrottled = true;
+        continue;
+      }
       else if (CHECK_ARG("--"))
       {
         no_more_args = true;
@@ -344,7 +441,10 @@ bool CommonHostInterface::ParseCommandLineParameters(int argc, char* argv[],
     boot_filename += argv[i];
   }
 
-  if (state_index.has_value() || !boot_filename.empty() || !state_filename.empty())
+  // the movie brings its own starting state, so just boot the BIOS underneath it. headless has no UI to start
+  // anything from later, so that boots the BIOS too when there's nothing else.
+  if (state_index.has_value() || !boot_filename.empty() || !state_filename.empty() ||
+      !m_boot_movie_play_filename.empty() || m_command_line_flags.headless)
   {
     // init user directory early since we need it for save states
     SetUserDirectory();
@@ -613,8 +713,12 @@ void CommonHostInterface::UpdateSpeedLimiterState()
   float target_speed = m_turbo_enabled ?
                          g_settings.turbo_speed :
                          (m_fast_forward_enabled ? g_settings.fast_forward_speed : g_settings.emulation_speed);
+  if (m_movie_unthrottled && System::IsPlayingMovie())
+    target_speed = 0.0f;
   m_throttler_enabled = (target_speed != 0.0f);
 
+  // syncing to the host can nudge the speed above 1, which shouldn't count as running fast
+  const float requested_speed = target_speed;
   bool syncing_to_host = false;
   if (g_settings.sync_to_host_refresh_rate && g_settings.audio_resampling && target_speed == 1.0f &&
       g_settings.video_sync_enabled && m_display && System::IsRunning())
@@ -622,6 +726,7 @@ void CommonHostInterface::UpdateSpeedLimiterState()
     float host_refresh_rate;
     if (m_display->GetHostRefreshRate(&host_refresh_rate))
     {
+      m_last_host_refresh_rate = host_refresh_rate;
       const float ratio = host_refresh_rate / System::GetThrottleFrequency();
       syncing_to_host = (ratio >= 0.95f && ratio <= 1.05f);
       Log_InfoPrintf("Refresh rate: Host=%fhz Guest=%fhz Ratio=%f - %s", host_refresh_rate,
@@ -644,7 +749,7 @@ void CommonHostInterface::UpdateSpeedLimiterState()
 
   if (System::IsValid())
   {
-    System::SetTargetSpeed(target_speed);
+    System::SetTargetSpeed(target_speed, requested_speed);
     System::ResetPerformanceCounters();
   }
 
@@ -686,6 +791,9 @@ void CommonHostInterface::RecreateSystem()
 void CommonHostInterface::UpdateLogSettings(LOGLEVEL level, const char* filter, bool log_to_console, bool log_to_debug,
                                             bool log_to_window, bool log_to_file)
 {
+  // anything still queued should go to the sinks it was written for
+  Log::FlushAsyncOutput();
+
   Log::SetFilterLevel(level);
   Log::SetConsoleOutputParams(g_settings.log_to_console, filter, level);
   Log::SetDebugOutputParams(g_settings.log_to_debug, filter, level);
@@ -699,6 +807,8 @@ void CommonHostInterface::UpdateLogSettings(LOGLEVEL level, const char* filter,
   {
     Log::SetFileOutputParams(false, nullptr);
   }
+
+  Log::SetAsyncOutputParams(g_settings.log_async);
 }
 
 void CommonHostInterface::SetUserDirectory()
@@ -791,6 +901,20 @@ void CommonHostInterface::OnSystemDestroyed()
   StopControllerRumble();
 }
 
+void CommonHostInterface::OnSystemPerformanceCountersUpdated()
+{
+  HostInterface::OnSystemPerformanceCountersUpdated();
+
+  // present threads measure the refresh rate as frames go out, so it isn't known when the speed is first set up
+  float host_refresh_rate;
+  if (g_settings.sync_to_host_refresh_rate && m_display && m_display->GetHostRefreshRate(&host_refresh_rate) &&
+      std::abs(host_refresh_rate - m_last_host_refresh_rate) >= 0.05f)
+  {
+    m_last_host_refresh_rate = host_refresh_rate;
+    UpdateSpeedLimiterState();
+  }
+}
+
 void CommonHostInterface::OnRunningGameChanged()
 {
   HostInterface::OnRunningGameChanged();
@@ -814,6 +938,21 @@ void CommonHostInterface::OnControllerTypeChanged(u32 slot)
   UpdateInputMap();
 }
 
+void CommonHostInterface::OnMoviePlaybackStopped(u32 frame_count, u32 desync_count)
+{
+  HostInterface::OnMoviePlaybackStopped(frame_count, desync_count);
+
+  if (m_movie_unthrottled)
+  {
+    m_movie_unthrottled = false;
+    UpdateSpeedLimiterState();
+  }
+
+  // replaying from the command line for verification, nothing left to do
+  if (InBatchMode())
+    RequestExit();
+}
+
 void CommonHostInterface::DrawImGuiWindows()
 {
   if (System::IsValid())
@@ -831,13 +970,13 @@ void CommonHostInterface::DrawImGuiWindows()
 void CommonHostInterface::DrawFPSWindow()
 {
   if (!(g_settings.display_show_fps | g_settings.display_show_vps | g_settings.display_show_speed |
-        g_settings.display_show_resolution))
+        g_settings.display_show_resolution | g_settings.display_show_present_latency))
   {
     return;
   }
 
   const ImVec2 window_size =
-    ImVec2(175.0f * ImGui::GetIO().DisplayFramebufferScale.x, 48.0f * ImGui::GetIO().DisplayFramebufferScale.y);
+    ImVec2(175.0f * ImGui::GetIO().DisplayFramebufferScale.x, 64.0f * ImGui::GetIO().DisplayFramebufferScale.y);
   ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - window_size.x, 0.0f), ImGuiCond_Always);
   ImGui::SetNextWindowSize(window_size);
 
@@ -870,6 +1009,13 @@ void CommonHostInterface::DrawFPSWindow()
     }
 
     ImGui::Text("%.2f", System::GetVPS());
+
+    const float skipped_fps = System::GetSkippedFPS();
+    if (skipped_fps > 0.0f)
+    {
+      ImGui::SameLine();
+      ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(%.0f skipped)", skipped_fps);
+    }
   }
   if (g_settings.display_show_speed)
   {
@@ -901,6 +1047,13 @@ void CommonHostInterface::DrawFPSWindow()
     ImGui::Text("%ux%u (%s)", effective_width, effective_height, interlaced ? "interlaced" : "progressive");
   }
 
+  if (g_settings.display_show_present_latency)
+  {
+    // average and 99th percentile from input to present
+    const Common::LatencyHistogram& latency = System::GetLatencyStatistics().input_to_present;
+    ImGui::Text("Input to Present: %.1f/%.1fms", latency.GetAverage(), latency.GetPercentile(0.99f));
+  }
+
   ImGui::End();
 }
 
@@ -1127,6 +1280,29 @@ void CommonHostInterface::StopControllerRumble()
   }
 }
 
+void CommonHostInterface::WriteHeadlessFrameHash()
+{
+  if (m_frame_hash_filename.empty() || System::IsShutdown())
+    return;
+
+  if (!m_frame_hash_file)
+  {
+    m_frame_hash_file = FileSystem::OpenCFile(m_frame_hash_filename.c_str(), "wb");
+    if (!m_frame_hash_file)
+    {
+      Log_ErrorPrintf("Failed to open frame hash file '%s'", m_frame_hash_filename.c_str());
+      m_frame_hash_filename = {};
+      return;
+    }
+  }
+
+  u64 hash;
+  if (!m_display->GetHeadlessOutputHash(&hash))
+    return;
+
+  std::fprintf(m_frame_hash_file, "%u %016" PRIX64 "\n", System::GetFrameNumber(), hash);
+}
+
 static bool SplitBinding(const std::string& binding, std::string_view* device, std::string_view* sub_binding)
 {
   const std::string::size_type slash_pos = binding.find('/');
@@ -1606,6 +1782,46 @@ void CommonHostInterface::RegisterGeneralHotkeys()
                    if (pressed)
                      DoFrameStep();
                  });
+
+  RegisterHotkey(StaticString(TRANSLATABLE("Hotkeys", "General")), StaticString("ToggleMovieRecording"),
+                 StaticString(TRANSLATABLE("Hotkeys", "Toggle Movie Recording")), [this](bool pressed) {
+                   if (!pressed || !System::IsValid())
+                     return;
+
+                   if (System::IsRecordingMovie())
+                     StopMovieRecording();
+                   else
+                     StartMovieRecording();
+                 });
+
+  RegisterHotkey(StaticString(TRANSLATABLE("Hotkeys", "General")), StaticString("MovieSeekBackward"),
+                 StaticString(TRANSLATABLE("Hotkeys", "Seek Movie Backward")), [this](bool pressed) {
+                   if (!pressed || !System::IsPlayingMovie())
+                     return;
+
+                   const u32 frame = System::GetMovieFrameNumber();
+                   const u32 interval = System::GetMovieKeyframeInterval();
+                   SeekMovie((frame > interval) ? (frame - interval) : 0);
+                 });
+
+  RegisterHotkey(StaticString(TRANSLATABLE("Hotkeys", "General")), StaticString("MovieSeekForward"),
+                 StaticString(TRANSLATABLE("Hotkeys", "Seek Movie Forward")), [this](bool pressed) {
+                   if (!pressed || !System::IsPlayingMovie())
+                     return;
+
+                   SeekMovie(System::GetMovieFrameNumber() + System::GetMovieKeyframeInterval());
+                 });
+
+  RegisterHotkey(StaticString(TRANSLATABLE("Hotkeys", "General")), StaticString("ToggleMediaCapture"),
+                 StaticString(TRANSLATABLE("Hotkeys", "Toggle Video Capture")), [this](bool pressed) {
+                   if (!pressed || !System::IsValid())
+                     return;
+
+                   if (System::IsCapturingMedia())
+                     StopMediaCapture();
+                   else
+                     StartMediaCapture();
+                 });
 }
 
 void CommonHostInterface::RegisterGraphicsHotkeys()
@@ -2303,7 +2519,8 @@ void CommonHostInterface::CheckForSettingsChanges(const Settings& old_settings)
 
   if (g_settings.log_level != old_settings.log_level || g_settings.log_filter != old_settings.log_filter ||
       g_settings.log_to_console != old_settings.log_to_console ||
-      g_settings.log_to_window != old_settings.log_to_window || g_settings.log_to_file != old_settings.log_to_file)
+      g_settings.log_to_window != old_settings.log_to_window || g_settings.log_to_file != old_settings.log_to_file ||
+      g_settings.log_async != old_settings.log_async)
   {
     UpdateLogSettings(g_settings.log_level, g_settings.log_filter.empty() ? nullptr : g_settings.log_filter.c_str(),
                       g_settings.log_to_console, g_settings.log_to_debug, g_settings.log_to_window,
@@ -2463,6 +2680,128 @@ void CommonHostInterface::StopDumpingAudio()
   AddOSDMessage(TranslateStdString("OSDMessage", "Stopped dumping audio."), 5.0f);
 }
 
+bool CommonHostInterface::StartMovieRecording(const char* filename /* = nullptr */)
+{
+  if (System::IsShutdown())
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& code = System::GetRunningCode();
+    if (code.empty())
+    {
+      auto_filename = GetUserDirectoryRelativePath("movies/%s.dsm", GetTimestampStringForFileName().GetCharArray());
+    }
+    else
+    {
+      auto_filename = GetUserDirectoryRelativePath("movies/%s_%s.dsm", code.c_str(),
+                                                   GetTimestampStringForFileName().GetCharArray());
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  if (!System::StartMovieRecording(filename, Movie::DEFAULT_KEYFRAME_INTERVAL))
+  {
+    AddFormattedOSDMessage(10.0f, TranslateString("OSDMessage", "Failed to start recording movie to '%s'."), filename);
+    return false;
+  }
+
+  AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Started recording movie to '%s'."), filename);
+  return true;
+}
+
+void CommonHostInterface::StopMovieRecording()
+{
+  if (!System::IsRecordingMovie())
+    return;
+
+  const u32 frame_count = System::GetMovieFrameCount();
+  System::StopMovieRecording();
+  AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Stopped recording movie after %u frames."), frame_count);
+}
+
+bool CommonHostInterface::StartMoviePlayback(const char* filename, bool unthrottled)
+{
+  if (System::IsShutdown())
+    return false;
+
+  if (!System::StartMoviePlayback(filename))
+  {
+    AddFormattedOSDMessage(10.0f, TranslateString("OSDMessage", "Failed to play movie '%s'."), filename);
+    return false;
+  }
+
+  AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Playing movie '%s' (%u frames)."), filename,
+                         System::GetMovieFrameCount());
+  m_movie_unthrottled = unthrottled;
+  UpdateSpeedLimiterState();
+  return true;
+}
+
+bool CommonHostInterface::SeekMovie(u32 frame)
+{
+  if (!System::IsPlayingMovie())
+    return false;
+
+  // playback stops once the last frame has run, so that's as far as a seek can go
+  const u32 frame_count = System::GetMovieFrameCount();
+  frame = std::min(frame, frame_count - 1);
+  if (!System::SeekMovie(frame))
+  {
+    AddFormattedOSDMessage(10.0f, TranslateString("OSDMessage", "Failed to seek movie to frame %u."), frame);
+    return false;
+  }
+
+  AddFormattedOSDMessage(2.0f, TranslateString("OSDMessage", "Movie seeked to frame %u of %u."), frame, frame_count);
+  return true;
+}
+
+bool CommonHostInterface::StartMediaCapture(const char* filename /* = nullptr */)
+{
+  if (System::IsShutdown())
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& code = System::GetRunningCode();
+    if (code.empty())
+    {
+      auto_filename =
+        GetUserDirectoryRelativePath("dump/video/%s.dscap", GetTimestampStringForFileName().GetCharArray());
+    }
+    else
+    {
+      auto_filename = GetUserDirectoryRelativePath("dump/video/%s_%s.dscap", code.c_str(),
+                                                   GetTimestampStringForFileName().GetCharArray());
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  if (!System::StartMediaCapture(filename))
+  {
+    AddFormattedOSDMessage(10.0f, TranslateString("OSDMessage", "Failed to start capturing video to '%s'."), filename);
+    return false;
+  }
+
+  AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Started capturing video to '%s'."), filename);
+  return true;
+}
+
+void CommonHostInterface::StopMediaCapture()
+{
+  if (!System::IsCapturingMedia())
+    return;
+
+  const MediaCapture::Writer::Stats stats = System::GetMediaCapture()->GetStats();
+  System::StopMediaCapture();
+  AddFormattedOSDMessage(5.0f, TranslateString("OSDMessage", "Stopped capturing video after %u frames (%u dropped)."),
+                         stats.frames_captured, stats.frames_dropped);
+}
+
 bool CommonHostInterface::SaveScreenshot(const char* filename /* = nullptr */, bool full_resolution /* = true */,
                                          bool apply_aspect_ratio /* = true */, bool compress_on_thread /* = true */)
 {
@@ -2494,6 +2833,7 @@ bool CommonHostInterface::SaveScreenshot(const char* filename /* = nullptr */, b
     return false;
   }
 
+  System::UpdateSkippedFrameDisplay();
   const bool screenshot_saved =
     m_display->WriteDisplayTextureToFile(filename, full_resolution, apply_aspect_ratio, compress_on_thread);
   if (!screenshot_saved)
@@ -4,6 +4,7 @@
 #include "core/controller.h"
 #include "core/host_interface.h"
 #include <atomic>
+#include <cstdio>
 #include <functional>
 #include <map>
 #include <memory>
@@ -97,6 +98,9 @@ public:
   /// Returns true if running in batch mode, i.e. exit after emulation.
   ALWAYS_INLINE bool InBatchMode() const { return m_command_line_flags.batch_mode; }
 
+  /// Returns true if running without a window, i.e. rendering offscreen.
+  ALWAYS_INLINE bool InHeadlessMode() const { return m_command_line_flags.headless; }
+
   /// Parses command line parameters for all frontends.
   bool ParseCommandLineParameters(int argc, char* argv[], std::unique_ptr<SystemBootParameters>* out_boot_params);
 
@@ -149,6 +153,24 @@ public:
   /// Stops dumping audio to file if it has been started.
   void StopDumpingAudio();
 
+  /// Starts recording an input movie. If no file name is provided, one will be generated automatically.
+  bool StartMovieRecording(const char* filename = nullptr);
+
+  /// Stops recording the input movie, writing it to disk.
+  void StopMovieRecording();
+
+  /// Loads the movie's starting state and replays its input, optionally as fast as possible.
+  bool StartMoviePlayback(const char* filename, bool unthrottled);
+
+  /// Seeks the movie being played to the specified frame, replaying from the closest keyframe.
+  bool SeekMovie(u32 frame);
+
+  /// Starts capturing video and audio to a file. If no file name is provided, one will be generated automatically.
+  bool StartMediaCapture(const char* filename = nullptr);
+
+  /// Stops capturing video and audio, completing any frames which are still being encoded.
+  void StopMediaCapture();
+
   /// Saves a screenshot to the specified file. IF no file name is provided, one will be generated automatically.
   bool SaveScreenshot(const char* filename = nullptr, bool full_resolution = true, bool apply_aspect_ratio = true,
                       bool compress_on_thread = true);
@@ -241,8 +263,10 @@ protected:
   virtual void OnSystemCreated() override;
   virtual void OnSystemPaused(bool paused);
   virtual void OnSystemDestroyed() override;
+  virtual void OnSystemPerformanceCountersUpdated() override;
   virtual void OnRunningGameChanged() override;
   virtual void OnControllerTypeChanged(u32 slot) override;
+  virtual void OnMoviePlaybackStopped(u32 frame_count, u32 desync_count) override;
 
   virtual std::optional<HostKeyCode> GetHostKeyCode(const std::string_view key_code) const;
 
@@ -281,6 +305,9 @@ protected:
   void UpdateControllerRumble();
   void StopControllerRumble();
 
+  /// Appends the hash of the frame which was just rendered headless to the file given on the command line.
+  void WriteHeadlessFrameHash();
+
   /// Returns the path to a save state file. Specifying an index of -1 is the "resume" save state.
   std::string GetGameSaveStateFileName(const char* game_code, s32 slot) const;
 
@@ -355,6 +382,21 @@ protected:
   bool m_turbo_enabled = false;
   bool m_timer_resolution_increased = false;
   bool m_throttler_enabled = true;
+  bool m_movie_unthrottled = false;
+
+  // host refresh rate the speed limiter was last set up for, the display's measurement of it can settle later
+  float m_last_host_refresh_rate = 0.0f;
+
+  // movie to record/play once the system boots, from the command line
+  std::string m_boot_movie_record_filename;
+  std::string m_boot_movie_play_filename;
+  u32 m_boot_movie_seek_frame = 0;
+  std::string m_boot_media_capture_filename;
+  std::string m_boot_shared_memory_export_name;
+
+  // hashes of frames rendered headless, from the command line
+  std::string m_frame_hash_filename;
+  std::FILE* m_frame_hash_file = nullptr;
 
 private:
   void InitializeUserDirectory();
@@ -409,6 +451,9 @@ private:
 
     // disable controller interface (buggy devices with SDL)
     BitField<u8, bool, 1, 1> disable_controller_interface;
+
+    // no window, render offscreen
+    BitField<u8, bool, 2, 1> headless;
   } m_command_line_flags = {};
 
 #ifdef WITH_DISCORD_PRESENCE
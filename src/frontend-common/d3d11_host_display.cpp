@@ -175,6 +175,57 @@ bool D3D11HostDisplay::DownloadTexture(const void* texture_handle, HostDisplayPi
   }
 }
 
+bool D3D11HostDisplay::BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format,
+                                          u32 x, u32 y, u32 width, u32 height)
+{
+  ID3D11ShaderResourceView* srv =
+    const_cast<ID3D11ShaderResourceView*>(static_cast<const ID3D11ShaderResourceView*>(texture_handle));
+  ComPtr<ID3D11Resource> srv_resource;
+  D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc;
+  srv->GetResource(srv_resource.GetAddressOf());
+  srv->GetDesc(&srv_desc);
+
+  AsyncDownload& dl = m_async_downloads[slot];
+  dl.pending = false;
+  if (!dl.texture.EnsureSize(m_context.Get(), width, height, srv_desc.Format, false))
+    return false;
+
+  // only queues the copy, the map in EndAsyncDownload() is what waits
+  dl.texture.CopyFromTexture(m_context.Get(), srv_resource.Get(), 0, x, y, 0, 0, width, height);
+  dl.width = width;
+  dl.height = height;
+  dl.pending = true;
+  return true;
+}
+
+bool D3D11HostDisplay::EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride)
+{
+  AsyncDownload& dl = m_async_downloads[slot];
+  if (!dl.pending)
+    return false;
+
+  dl.pending = false;
+  if (dl.texture.GetFormat() == DXGI_FORMAT_B5G6R5_UNORM || dl.texture.GetFormat() == DXGI_FORMAT_B5G5R5A1_UNORM)
+  {
+    return dl.texture.ReadPixels<u16>(m_context.Get(), 0, 0, dl.width, dl.height, out_data_stride / sizeof(u16),
+                                      static_cast<u16*>(out_data));
+  }
+  else
+  {
+    return dl.texture.ReadPixels<u32>(m_context.Get(), 0, 0, dl.width, dl.height, out_data_stride / sizeof(u32),
+                                      static_cast<u32*>(out_data));
+  }
+}
+
+void D3D11HostDisplay::DestroyAsyncDownloads()
+{
+  for (AsyncDownload& dl : m_async_downloads)
+  {
+    dl.texture.Destroy();
+    dl.pending = false;
+  }
+}
+
 static constexpr std::array<DXGI_FORMAT, static_cast<u32>(HostDisplayPixelFormat::Count)>
   s_display_pixel_format_mapping = {{DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM,
                                      DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_B5G5R5A1_UNORM}};
@@ -667,6 +718,8 @@ bool D3D11HostDisplay::CreateResources()
 
 void D3D11HostDisplay::DestroyResources()
 {
+  DestroyAsyncDownloads();
+
   m_post_processing_chain.ClearStages();
   m_post_processing_input_texture.Destroy();
   m_post_processing_stages.clear();
@@ -6,6 +6,7 @@
 #include "common/windows_headers.h"
 #include "core/host_display.h"
 #include "frontend-common/postprocessing_chain.h"
+#include <array>
 #include <d3d11.h>
 #include <dxgi.h>
 #include <memory>
@@ -56,6 +57,10 @@ public:
                      u32 texture_data_stride) override;
   bool DownloadTexture(const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y, u32 width,
                        u32 height, void* out_data, u32 out_data_stride) override;
+  bool BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y,
+                          u32 width, u32 height) override;
+  bool EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride) override;
+  void DestroyAsyncDownloads() override;
   bool SupportsDisplayPixelFormat(HostDisplayPixelFormat format) const override;
   bool BeginSetDisplayPixels(HostDisplayPixelFormat format, u32 width, u32 height, void** out_buffer,
                              u32* out_pitch) override;
@@ -131,6 +136,15 @@ protected:
   D3D11::StreamBuffer m_display_uniform_buffer;
   D3D11::AutoStagingTexture m_readback_staging_texture;
 
+  struct AsyncDownload
+  {
+    D3D11::AutoStagingTexture texture;
+    u32 width = 0;
+    u32 height = 0;
+    bool pending = false;
+  };
+  std::array<AsyncDownload, MAX_ASYNC_DOWNLOAD_SLOTS> m_async_downloads;
+
   bool m_allow_tearing_supported = false;
   bool m_using_flip_model_swap_chain = true;
   bool m_using_allow_tearing = false;
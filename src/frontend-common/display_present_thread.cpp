@@ -0,0 +1,232 @@
+#include "display_present_thread.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include <algorithm>
+Log_SetChannel(DisplayPresentThread);
+
+namespace FrontendCommon {
+
+DisplayPresentThread::DisplayPresentThread() = default;
+
+DisplayPresentThread::~DisplayPresentThread()
+{
+  Stop();
+}
+
+bool DisplayPresentThread::Start(bool vsync, PresentCallback present_callback, InitCallback init_callback /* = {} */,
+                                 ShutdownCallback shutdown_callback /* = {} */)
+{
+  Assert(!m_thread.joinable());
+
+  m_present_callback = std::move(present_callback);
+  m_slots = {};
+  m_vsync = vsync;
+  m_shutdown = false;
+
+  // wait for the init callback, so a failure can be returned here
+  std::unique_lock<std::mutex> lock(m_mutex);
+  bool init_done = false;
+  m_thread = std::thread([this, &init_done, init_callback = std::move(init_callback),
+                          shutdown_callback = std::move(shutdown_callback)]() mutable {
+    const bool init_result = !init_callback || init_callback();
+    {
+      std::unique_lock<std::mutex> thread_lock(m_mutex);
+      m_shutdown = !init_result;
+      init_done = true;
+    }
+    m_slot_freed_cv.notify_all();
+
+    if (init_result)
+      ThreadEntryPoint(std::move(shutdown_callback));
+  });
+
+  m_slot_freed_cv.wait(lock, [&init_done]() { return init_done; });
+  if (m_shutdown)
+  {
+    lock.unlock();
+    m_thread.join();
+    m_present_callback = {};
+    Log_ErrorPrintf("Failed to initialize present thread");
+    return false;
+  }
+
+  Log_InfoPrintf("Present thread started, vsync %s", vsync ? "on" : "off");
+  return true;
+}
+
+void DisplayPresentThread::Stop()
+{
+  if (!m_thread.joinable())
+    return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_frame_queued_cv.notify_one();
+  m_slot_freed_cv.notify_all();
+
+  m_thread.join();
+  m_present_callback = {};
+  m_slots = {};
+}
+
+u32 DisplayPresentThread::GetQueuedSlot(bool newest) const
+{
+  u32 found = INVALID_SLOT;
+  for (u32 i = 0; i < NUM_SLOTS; i++)
+  {
+    if (m_slots[i].state != SlotState::Queued)
+      continue;
+
+    if (found == INVALID_SLOT || ((m_slots[i].sequence > m_slots[found].sequence) == newest))
+      found = i;
+  }
+
+  return found;
+}
+
+u32 DisplayPresentThread::AcquireSlot()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;)
+  {
+    for (u32 i = 0; i < NUM_SLOTS; i++)
+    {
+      if (m_slots[i].state == SlotState::Free)
+      {
+        m_slots[i].state = SlotState::Rendering;
+        return i;
+      }
+    }
+
+    if (!m_vsync)
+    {
+      // at most one slot is being presented, so there's always a queued one to take back
+      const u32 oldest = GetQueuedSlot(false);
+      Assert(oldest != INVALID_SLOT);
+      m_slots[oldest].state = SlotState::Rendering;
+      return oldest;
+    }
+
+    m_slot_freed_cv.wait(lock);
+  }
+}
+
+void DisplayPresentThread::PublishSlot(u32 slot, const HostDisplay::FrameTimestamps& timestamps)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    DebugAssert(m_slots[slot].state == SlotState::Rendering);
+    m_slots[slot].state = SlotState::Queued;
+    m_slots[slot].sequence = m_next_sequence++;
+    m_slots[slot].timestamps = timestamps;
+  }
+
+  m_frame_queued_cv.notify_one();
+}
+
+void DisplayPresentThread::ReleaseSlot(u32 slot)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    DebugAssert(m_slots[slot].state == SlotState::Rendering);
+    m_slots[slot].state = SlotState::Free;
+  }
+
+  m_slot_freed_cv.notify_all();
+}
+
+void DisplayPresentThread::GetPresentedFrames(std::vector<HostDisplay::FrameTimestamps>* frames)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  frames->insert(frames->end(), m_presented_frames.begin(), m_presented_frames.end());
+  m_presented_frames.clear();
+}
+
+void DisplayPresentThread::AddPresentInterval(double interval_ms)
+{
+  // a missed vblank takes a multiple of the refresh interval, which would pull the rate down
+  if (m_present_interval_samples >= MIN_REFRESH_SAMPLES && interval_ms > m_average_present_interval * 1.5)
+    return;
+
+  // plain average to start with, then a slow moving one so the rate doesn't wander with scheduling noise
+  m_present_interval_samples++;
+  const double weight = std::max(1.0 / static_cast<double>(m_present_interval_samples), 0.02);
+  m_average_present_interval += (interval_ms - m_average_present_interval) * weight;
+
+  if (m_present_interval_samples >= MIN_REFRESH_SAMPLES && m_average_present_interval > 0.0)
+    m_measured_refresh_rate.store(static_cast<float>(1000.0 / m_average_present_interval));
+}
+
+void DisplayPresentThread::ThreadEntryPoint(ShutdownCallback shutdown_callback)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  Common::Timer::Value last_present_time = 0;
+  bool waited_for_frame = true;
+  while (!m_shutdown)
+  {
+    // vsync shows every frame in order, otherwise only the newest one matters
+    const u32 slot = GetQueuedSlot(!m_vsync);
+    if (slot == INVALID_SLOT)
+    {
+      waited_for_frame = true;
+      m_frame_queued_cv.wait(lock);
+      continue;
+    }
+
+    bool dropped_frames = false;
+    if (!m_vsync)
+    {
+      for (Slot& older : m_slots)
+      {
+        if (older.state == SlotState::Queued && older.sequence < m_slots[slot].sequence)
+        {
+          older.state = SlotState::Free;
+          dropped_frames = true;
+        }
+      }
+    }
+
+    m_slots[slot].state = SlotState::Presenting;
+    const bool vsync = m_vsync;
+    lock.unlock();
+    if (dropped_frames)
+      m_slot_freed_cv.notify_all();
+
+    const bool presented = m_present_callback(slot);
+    const Common::Timer::Value present_time = Common::Timer::GetValue();
+
+    lock.lock();
+    if (presented)
+    {
+      if (m_presented_frames.size() == MAX_PRESENTED_FRAMES)
+        m_presented_frames.erase(m_presented_frames.begin());
+      m_presented_frames.push_back(m_slots[slot].timestamps);
+      m_presented_frames.back().present_time = present_time;
+    }
+
+    m_slots[slot].state = SlotState::Free;
+    m_slot_freed_cv.notify_all();
+    if (!presented)
+    {
+      last_present_time = 0;
+      continue;
+    }
+
+    // presents are only paced by the host when the next frame was already waiting, otherwise the interval is however
+    // long the emulation took to produce it
+    if (vsync && !waited_for_frame && last_present_time != 0)
+      AddPresentInterval(Common::Timer::ConvertValueToMilliseconds(present_time - last_present_time));
+
+    last_present_time = present_time;
+    waited_for_frame = false;
+  }
+
+  lock.unlock();
+  if (shutdown_callback)
+    shutdown_callback();
+}
+
+} // namespace FrontendCommon
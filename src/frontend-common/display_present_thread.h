@@ -0,0 +1,110 @@
+#pragma once
+#include "core/host_display.h"
+#include "core/types.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FrontendCommon {
+
+/// Presents frames on a thread of its own, so the emulation thread doesn't wait in the swap. The display renders each
+/// frame into one of NUM_SLOTS offscreen targets and publishes it to the mailbox, which the thread copies to the
+/// window. With vsync, frames are shown in order, and acquiring a slot waits when all of them are in use, which holds
+/// the emulation to the host refresh rate like a blocking swap would. Without vsync, the newest frame replaces any
+/// which haven't been shown yet.
+class DisplayPresentThread
+{
+public:
+  enum : u32
+  {
+    NUM_SLOTS = 3,
+    INVALID_SLOT = NUM_SLOTS,
+
+    // presented frames which are kept when nobody collects them
+    MAX_PRESENTED_FRAMES = 256,
+
+    // presents needed before the refresh rate is reported
+    MIN_REFRESH_SAMPLES = 30
+  };
+
+  /// Shows a slot, called on the present thread. Returns false if nothing was presented.
+  using PresentCallback = std::function<bool(u32 slot)>;
+
+  /// Called on the present thread before the first present, e.g. to make a context current there.
+  using InitCallback = std::function<bool()>;
+
+  /// Called on the present thread after the last present.
+  using ShutdownCallback = std::function<void()>;
+
+  DisplayPresentThread();
+  ~DisplayPresentThread();
+
+  ALWAYS_INLINE bool IsRunning() const { return m_thread.joinable(); }
+  ALWAYS_INLINE bool IsVSyncEnabled() const { return m_vsync; }
+
+  /// Host refresh rate measured from presents which were held back by vsync, or zero until there are enough.
+  ALWAYS_INLINE float GetMeasuredRefreshRate() const { return m_measured_refresh_rate.load(); }
+
+  /// Starts the thread, and waits for the init callback. Returns false if that failed.
+  bool Start(bool vsync, PresentCallback present_callback, InitCallback init_callback = {},
+             ShutdownCallback shutdown_callback = {});
+
+  /// Stops the thread once the present in progress finishes. Frames which haven't been shown are dropped.
+  void Stop();
+
+  /// Returns a slot to render the next frame into. When all of them are in use, this waits for the thread with vsync,
+  /// and takes back the oldest frame which hasn't been shown without.
+  u32 AcquireSlot();
+
+  /// Queues a rendered slot to be shown. The timestamps come back from GetPresentedFrames() with the present time.
+  void PublishSlot(u32 slot, const HostDisplay::FrameTimestamps& timestamps);
+
+  /// Gives back a slot which nothing was rendered to.
+  void ReleaseSlot(u32 slot);
+
+  /// Moves the frames presented since the last call into frames.
+  void GetPresentedFrames(std::vector<HostDisplay::FrameTimestamps>* frames);
+
+private:
+  enum class SlotState : u8
+  {
+    Free,
+    Rendering,
+    Queued,
+    Presenting
+  };
+
+  struct Slot
+  {
+    SlotState state = SlotState::Free;
+    u64 sequence = 0;
+    HostDisplay::FrameTimestamps timestamps = {};
+  };
+
+  u32 GetQueuedSlot(bool newest) const;
+  void AddPresentInterval(double interval_ms);
+  void ThreadEntryPoint(ShutdownCallback shutdown_callback);
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_frame_queued_cv;
+  std::condition_variable m_slot_freed_cv;
+
+  PresentCallback m_present_callback;
+  std::array<Slot, NUM_SLOTS> m_slots;
+  std::vector<HostDisplay::FrameTimestamps> m_presented_frames;
+  u64 m_next_sequence = 1;
+  bool m_vsync = false;
+  bool m_shutdown = false;
+
+  // only touched by the present thread, kept across restarts since the display doesn't change with them
+  double m_average_present_interval = 0.0;
+  u32 m_present_interval_samples = 0;
+  std::atomic<float> m_measured_refresh_rate{0.0f};
+};
+
+} // namespace FrontendCommon
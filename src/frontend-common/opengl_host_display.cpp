@@ -2,7 +2,9 @@
 #include "common/align.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <tuple>
 #ifdef WITH_IMGUI
 #include "imgui.h"
@@ -149,6 +151,116 @@ bool OpenGLHostDisplay::DownloadTexture(const void* texture_handle, HostDisplayP
   return true;
 }
 
+static bool SupportsAsyncDownload()
+{
+  // needs pixel pack buffers and fences
+  return (GLAD_GL_VERSION_3_2 || GLAD_GL_ARB_sync || GLAD_GL_ES_VERSION_3_0);
+}
+
+bool OpenGLHostDisplay::BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format,
+                                           u32 x, u32 y, u32 width, u32 height)
+{
+  if (!SupportsAsyncDownload())
+    return HostDisplay::BeginAsyncDownload(slot, texture_handle, texture_format, x, y, width, height);
+
+  AsyncDownload& dl = m_async_downloads[slot];
+  if (dl.fence)
+  {
+    glDeleteSync(dl.fence);
+    dl.fence = nullptr;
+  }
+
+  const u32 pixel_size = GetDisplayPixelFormatSize(texture_format);
+  dl.row_size = width * pixel_size;
+  dl.stride = Common::AlignUpPow2(dl.row_size, 4);
+  dl.height = height;
+
+  const u32 size = dl.stride * height;
+  if (dl.buffer_id == 0)
+    glGenBuffers(1, &dl.buffer_id);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, dl.buffer_id);
+  if (dl.buffer_size < size)
+  {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    dl.buffer_size = size;
+  }
+
+  GLint old_alignment = 0, old_row_length = 0;
+  glGetIntegerv(GL_PACK_ALIGNMENT, &old_alignment);
+  glGetIntegerv(GL_PACK_ROW_LENGTH, &old_row_length);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glPixelStorei(GL_PACK_ROW_LENGTH, dl.stride / pixel_size);
+
+  const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(texture_handle));
+  const auto [gl_internal_format, gl_format, gl_type] =
+    s_display_pixel_format_mapping[static_cast<u32>(texture_format)];
+
+  // with a pack buffer bound, the pointer is an offset into the buffer, and the copy doesn't block
+  GL::Texture::GetTextureSubImage(texture, 0, x, y, 0, width, height, 1, gl_format, gl_type, size, nullptr);
+
+  glPixelStorei(GL_PACK_ALIGNMENT, old_alignment);
+  glPixelStorei(GL_PACK_ROW_LENGTH, old_row_length);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  dl.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  return true;
+}
+
+bool OpenGLHostDisplay::EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride)
+{
+  AsyncDownload& dl = m_async_downloads[slot];
+  if (!dl.fence)
+    return HostDisplay::EndAsyncDownload(slot, out_data, out_data_stride);
+
+  // normally signaled already, the copy was issued a few frames ago
+  const GLenum wait_result = glClientWaitSync(dl.fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_C(1000000000));
+  glDeleteSync(dl.fence);
+  dl.fence = nullptr;
+  if (wait_result == GL_TIMEOUT_EXPIRED || wait_result == GL_WAIT_FAILED)
+  {
+    Log_ErrorPrintf("Waiting for async download failed: 0x%04X", wait_result);
+    return false;
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, dl.buffer_id);
+  const u8* src_ptr =
+    static_cast<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, dl.stride * dl.height, GL_MAP_READ_BIT));
+  if (src_ptr)
+  {
+    u8* dst_ptr = static_cast<u8*>(out_data);
+    for (u32 row = 0; row < dl.height; row++)
+    {
+      std::memcpy(dst_ptr, src_ptr, dl.row_size);
+      src_ptr += dl.stride;
+      dst_ptr += out_data_stride;
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  else
+  {
+    Log_ErrorPrintf("Failed to map async download buffer");
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return (src_ptr != nullptr);
+}
+
+void OpenGLHostDisplay::DestroyAsyncDownloads()
+{
+  for (AsyncDownload& dl : m_async_downloads)
+  {
+    if (dl.fence)
+      glDeleteSync(dl.fence);
+    if (dl.buffer_id != 0)
+      glDeleteBuffers(1, &dl.buffer_id);
+
+    dl = {};
+  }
+
+  HostDisplay::DestroyAsyncDownloads();
+}
+
 bool OpenGLHostDisplay::SupportsDisplayPixelFormat(HostDisplayPixelFormat format) const
 {
   return (std::get<0>(s_display_pixel_format_mapping[static_cast<u32>(format)]) != static_cast<GLenum>(0));
@@ -244,6 +356,19 @@ bool OpenGLHostDisplay::SetDisplayPixels(HostDisplayPixelFormat format, u32 widt
 
 void OpenGLHostDisplay::SetVSync(bool enabled)
 {
+  if (m_present_context)
+  {
+    // The swap interval belongs to the present context, which is current on the present thread.
+    if (m_present_thread.IsVSyncEnabled() == enabled)
+      return;
+
+    m_present_thread.Stop();
+    if (RunPresentThread(enabled))
+      return;
+
+    StopPresentThread(true);
+  }
+
   if (m_gl_context->GetWindowInfo().type == WindowInfo::Type::Surfaceless)
     return;
 
@@ -313,7 +438,7 @@ bool OpenGLHostDisplay::HasRenderDevice() const
 
 bool OpenGLHostDisplay::HasRenderSurface() const
 {
-  return m_window_info.type != WindowInfo::Type::Surfaceless;
+  return (m_window_info.type != WindowInfo::Type::Surfaceless || m_headless_texture.IsValid());
 }
 
 bool OpenGLHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, bool debug_device,
@@ -329,9 +454,176 @@ bool OpenGLHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_vie
   m_window_info = wi;
   m_window_info.surface_width = m_gl_context->GetSurfaceWidth();
   m_window_info.surface_height = m_gl_context->GetSurfaceHeight();
+
+  if (wi.type == WindowInfo::Type::Surfaceless && !CreateHeadlessTarget())
+  {
+    Log_ErrorPrintf("Failed to create headless render target");
+    m_gl_context.reset();
+    return false;
+  }
+
+  return true;
+}
+
+bool OpenGLHostDisplay::CreateHeadlessTarget()
+{
+  if (m_window_info.surface_width == 0 || m_window_info.surface_height == 0)
+  {
+    m_window_info.surface_width = DEFAULT_HEADLESS_WIDTH;
+    m_window_info.surface_height = DEFAULT_HEADLESS_HEIGHT;
+  }
+
+  if (!m_headless_texture.Create(m_window_info.surface_width, m_window_info.surface_height, 1, GL_RGBA8, GL_RGBA,
+                                 GL_UNSIGNED_BYTE, nullptr, false) ||
+      !m_headless_texture.CreateFramebuffer())
+  {
+    return false;
+  }
+
+  Log_InfoPrintf("Rendering headless to a %ux%u target", m_window_info.surface_width, m_window_info.surface_height);
+  return true;
+}
+
+bool OpenGLHostDisplay::StartPresentThread(bool vsync)
+{
+  if (!m_gl_context->SupportsSurfaceless() || m_use_gles2_draw_path ||
+      !(GLAD_GL_VERSION_3_2 || GLAD_GL_ARB_sync || GLAD_GL_ES_VERSION_3_0))
+  {
+    Log_WarningPrintf("Context can't present on a thread, presenting without one");
+    return false;
+  }
+
+  // The window can only have one surface, so the main context lets go of it before the present context takes it.
+  WindowInfo surfaceless_wi(m_window_info);
+  surfaceless_wi.type = WindowInfo::Type::Surfaceless;
+  surfaceless_wi.window_handle = nullptr;
+  if (!m_gl_context->ChangeSurface(surfaceless_wi))
+  {
+    Log_ErrorPrintf("Failed to switch to surfaceless for threaded presentation");
+    if (!m_gl_context->ChangeSurface(m_window_info))
+      Panic("Failed to switch back to window surface");
+
+    return false;
+  }
+
+  m_present_context = m_gl_context->CreateSharedContext(m_window_info);
+  if (!m_present_context)
+  {
+    Log_ErrorPrintf("Failed to create present context");
+    if (!m_gl_context->ChangeSurface(m_window_info))
+      Panic("Failed to switch back to window surface");
+
+    return false;
+  }
+
+  m_window_info.surface_width = m_present_context->GetSurfaceWidth();
+  m_window_info.surface_height = m_present_context->GetSurfaceHeight();
+  if (!CreatePresentSlots() || !RunPresentThread(vsync))
+  {
+    StopPresentThread(true);
+    return false;
+  }
+
   return true;
 }
 
+bool OpenGLHostDisplay::RunPresentThread(bool vsync)
+{
+  return m_present_thread.Start(
+    vsync, [this](u32 slot) { return PresentFromSlot(slot); },
+    [this, vsync]() {
+      if (!m_present_context->MakeCurrent())
+        return false;
+
+      m_present_context->SetSwapInterval(vsync ? 1 : 0);
+      glGenFramebuffers(1, &m_present_read_fbo);
+      return true;
+    },
+    [this]() {
+      glDeleteFramebuffers(1, &m_present_read_fbo);
+      m_present_read_fbo = 0;
+      m_present_context->DoneCurrent();
+    });
+}
+
+void OpenGLHostDisplay::StopPresentThread(bool reattach_window)
+{
+  if (!m_present_context)
+    return;
+
+  m_present_thread.Stop();
+  DestroyPresentSlots();
+
+  // Release the window surface before the present context goes, so the main context can create one again.
+  m_present_context->ChangeSurface(WindowInfo());
+  m_present_context.reset();
+
+  if (reattach_window)
+  {
+    if (!m_gl_context->ChangeSurface(m_window_info))
+      Panic("Failed to switch back to window surface");
+
+    SetVSync(m_present_thread.IsVSyncEnabled());
+  }
+}
+
+bool OpenGLHostDisplay::CreatePresentSlots()
+{
+  for (PresentSlot& slot : m_present_slots)
+  {
+    if (!slot.texture.Create(m_window_info.surface_width, m_window_info.surface_height, 1, GL_RGBA8, GL_RGBA,
+                             GL_UNSIGNED_BYTE, nullptr, false) ||
+        !slot.texture.CreateFramebuffer())
+    {
+      Log_ErrorPrintf("Failed to create present slot");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void OpenGLHostDisplay::DestroyPresentSlots()
+{
+  for (PresentSlot& slot : m_present_slots)
+  {
+    if (slot.render_fence)
+    {
+      glDeleteSync(slot.render_fence);
+      slot.render_fence = nullptr;
+    }
+    if (slot.present_fence)
+    {
+      glDeleteSync(slot.present_fence);
+      slot.present_fence = nullptr;
+    }
+
+    slot.texture.Destroy();
+  }
+}
+
+bool OpenGLHostDisplay::PresentFromSlot(u32 slot_index)
+{
+  // Runs on the present thread, with the present context current.
+  PresentSlot& slot = m_present_slots[slot_index];
+  glWaitSync(slot.render_fence, 0, GL_TIMEOUT_IGNORED);
+  glDeleteSync(slot.render_fence);
+  slot.render_fence = nullptr;
+
+  // Attaching the texture again is what makes the main context's rendering to it visible here.
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_present_read_fbo);
+  glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot.texture.GetGLId(), 0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+  const GLint width = static_cast<GLint>(slot.texture.GetWidth());
+  const GLint height = static_cast<GLint>(slot.texture.GetHeight());
+  glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  // Render() waits for this before drawing to the slot again.
+  slot.present_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  return m_present_context->SwapBuffers();
+}
+
 bool OpenGLHostDisplay::InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device,
                                                bool threaded_presentation)
 {
@@ -356,9 +648,11 @@ bool OpenGLHostDisplay::InitializeRenderDevice(std::string_view shader_cache_dir
     return false;
 #endif
 
-  // Start with vsync on.
-  SetVSync(true);
+  // Start with vsync on. The present thread sets it on its own context.
+  if (threaded_presentation && m_window_info.type != WindowInfo::Type::Surfaceless && StartPresentThread(true))
+    return true;
 
+  SetVSync(true);
   return true;
 }
 
@@ -383,12 +677,15 @@ void OpenGLHostDisplay::DestroyRenderDevice()
   if (!m_gl_context)
     return;
 
+  StopPresentThread(false);
+
 #ifdef WITH_IMGUI
   if (ImGui::GetCurrentContext())
     DestroyImGuiContext();
 #endif
 
   DestroyResources();
+  m_headless_texture.Destroy();
 
   m_gl_context->DoneCurrent();
   m_gl_context.reset();
@@ -398,6 +695,9 @@ bool OpenGLHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
 {
   Assert(m_gl_context);
 
+  const bool was_presenting_on_thread = static_cast<bool>(m_present_context);
+  StopPresentThread(false);
+
   if (!m_gl_context->ChangeSurface(new_wi))
   {
     Log_ErrorPrintf("Failed to change surface");
@@ -416,6 +716,9 @@ bool OpenGLHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
   }
 #endif
 
+  if (was_presenting_on_thread && new_wi.type != WindowInfo::Type::Surfaceless)
+    StartPresentThread(m_present_thread.IsVSyncEnabled());
+
   return true;
 }
 
@@ -424,9 +727,35 @@ void OpenGLHostDisplay::ResizeRenderWindow(s32 new_window_width, s32 new_window_
   if (!m_gl_context)
     return;
 
-  m_gl_context->ResizeSurface(static_cast<u32>(new_window_width), static_cast<u32>(new_window_height));
-  m_window_info.surface_width = m_gl_context->GetSurfaceWidth();
-  m_window_info.surface_height = m_gl_context->GetSurfaceHeight();
+  if (m_headless_texture.IsValid())
+  {
+    // No window to follow, just recreate the offscreen target at the requested size.
+    if (new_window_width <= 0 || new_window_height <= 0)
+      return;
+
+    m_headless_texture.Destroy();
+    m_window_info.surface_width = static_cast<u32>(new_window_width);
+    m_window_info.surface_height = static_cast<u32>(new_window_height);
+    if (!CreateHeadlessTarget())
+      Panic("Failed to resize headless render target");
+  }
+  else if (m_present_context)
+  {
+    // The slots follow the size of the window.
+    m_present_thread.Stop();
+    DestroyPresentSlots();
+    m_present_context->ResizeSurface(static_cast<u32>(new_window_width), static_cast<u32>(new_window_height));
+    m_window_info.surface_width = m_present_context->GetSurfaceWidth();
+    m_window_info.surface_height = m_present_context->GetSurfaceHeight();
+    if (!CreatePresentSlots() || !RunPresentThread(m_present_thread.IsVSyncEnabled()))
+      StopPresentThread(true);
+  }
+  else
+  {
+    m_gl_context->ResizeSurface(static_cast<u32>(new_window_width), static_cast<u32>(new_window_height));
+    m_window_info.surface_width = m_gl_context->GetSurfaceWidth();
+    m_window_info.surface_height = m_gl_context->GetSurfaceHeight();
+  }
 
 #ifdef WITH_IMGUI
   if (ImGui::GetCurrentContext())
@@ -457,6 +786,7 @@ void OpenGLHostDisplay::DestroyRenderSurface()
   if (!m_gl_context)
     return;
 
+  StopPresentThread(false);
   m_window_info = {};
   if (!m_gl_context->ChangeSurface(m_window_info))
     Log_ErrorPrintf("Failed to switch to surfaceless");
@@ -637,6 +967,8 @@ void main()
 
 void OpenGLHostDisplay::DestroyResources()
 {
+  DestroyAsyncDownloads();
+
   m_post_processing_chain.ClearStages();
   m_post_processing_input_texture.Destroy();
   m_post_processing_ubo.reset();
@@ -683,8 +1015,29 @@ bool OpenGLHostDisplay::Render()
     return false;
   }
 
+  if (m_present_thread.IsRunning())
+  {
+    m_present_slot = m_present_thread.AcquireSlot();
+    PresentSlot& slot = m_present_slots[m_present_slot];
+
+    // The last blit from the slot has to finish before it's drawn over.
+    if (slot.present_fence)
+    {
+      glWaitSync(slot.present_fence, 0, GL_TIMEOUT_IGNORED);
+      glDeleteSync(slot.present_fence);
+      slot.present_fence = nullptr;
+    }
+
+    // Without vsync, this can be a frame which was replaced before it was shown.
+    if (slot.render_fence)
+    {
+      glDeleteSync(slot.render_fence);
+      slot.render_fence = nullptr;
+    }
+  }
+
   glDisable(GL_SCISSOR_TEST);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GetOutputFramebuffer());
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 
@@ -697,7 +1050,19 @@ bool OpenGLHostDisplay::Render()
 
   RenderSoftwareCursor();
 
-  m_gl_context->SwapBuffers();
+  if (m_present_slot != DisplayPresentThread::INVALID_SLOT)
+  {
+    // The fence has to reach the GPU before the present context can wait for it.
+    m_present_slots[m_present_slot].render_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    m_present_thread.PublishSlot(m_present_slot, m_next_frame_timestamps);
+    m_present_slot = DisplayPresentThread::INVALID_SLOT;
+    m_next_frame_timestamps = {};
+  }
+  else if (!m_headless_texture.IsValid())
+  {
+    m_gl_context->SwapBuffers();
+  }
 
 #ifdef WITH_IMGUI
   if (ImGui::GetCurrentContext())
@@ -716,6 +1081,47 @@ void OpenGLHostDisplay::RenderImGui()
 #endif
 }
 
+float OpenGLHostDisplay::GetMeasuredRefreshRate() const
+{
+  return m_present_thread.GetMeasuredRefreshRate();
+}
+
+bool OpenGLHostDisplay::GetPresentedFrames(std::vector<FrameTimestamps>* frames)
+{
+  if (!m_present_thread.IsRunning())
+    return false;
+
+  m_present_thread.GetPresentedFrames(frames);
+  return true;
+}
+
+bool OpenGLHostDisplay::DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height)
+{
+  if (!m_headless_texture.IsValid())
+    return false;
+
+  const u32 output_width = m_headless_texture.GetWidth();
+  const u32 output_height = m_headless_texture.GetHeight();
+  pixels->resize(output_width * output_height);
+  if (!DownloadTexture(reinterpret_cast<void*>(static_cast<uintptr_t>(m_headless_texture.GetGLId())),
+                       HostDisplayPixelFormat::RGBA8, 0, 0, output_width, output_height, pixels->data(),
+                       output_width * sizeof(u32)))
+  {
+    return false;
+  }
+
+  // GL's origin is the bottom-left corner
+  for (u32 row = 0; row < (output_height / 2); row++)
+  {
+    std::swap_ranges(pixels->begin() + row * output_width, pixels->begin() + (row + 1) * output_width,
+                     pixels->begin() + (output_height - row - 1) * output_width);
+  }
+
+  *width = output_width;
+  *height = output_height;
+  return true;
+}
+
 void OpenGLHostDisplay::RenderDisplay()
 {
   if (!HasDisplayTexture())
@@ -725,9 +1131,10 @@ void OpenGLHostDisplay::RenderDisplay()
 
   if (!m_post_processing_chain.IsEmpty())
   {
-    ApplyPostProcessingChain(0, left, GetWindowHeight() - top - height, width, height, m_display_texture_handle,
-                             m_display_texture_width, m_display_texture_height, m_display_texture_view_x,
-                             m_display_texture_view_y, m_display_texture_view_width, m_display_texture_view_height);
+    ApplyPostProcessingChain(GetOutputFramebuffer(), left, GetWindowHeight() - top - height, width, height,
+                             m_display_texture_handle, m_display_texture_width, m_display_texture_height,
+                             m_display_texture_view_x, m_display_texture_view_y, m_display_texture_view_width,
+                             m_display_texture_view_height);
     return;
   }
 
@@ -14,7 +14,9 @@
 #include "common/gl/texture.h"
 #include "common/window_info.h"
 #include "core/host_display.h"
+#include "display_present_thread.h"
 #include "postprocessing_chain.h"
+#include <array>
 #include <memory>
 
 namespace FrontendCommon {
@@ -54,6 +56,10 @@ public:
                      u32 texture_data_stride) override;
   bool DownloadTexture(const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y, u32 width,
                        u32 height, void* out_data, u32 out_data_stride) override;
+  bool BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y,
+                          u32 width, u32 height) override;
+  bool EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride) override;
+  void DestroyAsyncDownloads() override;
   bool SupportsDisplayPixelFormat(HostDisplayPixelFormat format) const override;
   bool BeginSetDisplayPixels(HostDisplayPixelFormat format, u32 width, u32 height, void** out_buffer,
                              u32* out_pitch) override;
@@ -63,6 +69,9 @@ public:
   virtual void SetVSync(bool enabled) override;
 
   virtual bool Render() override;
+  float GetMeasuredRefreshRate() const override;
+  bool GetPresentedFrames(std::vector<FrameTimestamps>* frames) override;
+  bool DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height) override;
 
 protected:
   const char* GetGLSLVersionString() const;
@@ -90,6 +99,34 @@ protected:
     u32 uniforms_size;
   };
 
+  struct AsyncDownload
+  {
+    GLuint buffer_id = 0;
+    GLsync fence = nullptr;
+    u32 buffer_size = 0;
+    u32 row_size = 0;
+    u32 stride = 0;
+    u32 height = 0;
+  };
+
+  /// The window's framebuffer, the present slot being rendered, or the offscreen target when running headless.
+  ALWAYS_INLINE GLuint GetOutputFramebuffer() const
+  {
+    if (m_present_slot != DisplayPresentThread::INVALID_SLOT)
+      return m_present_slots[m_present_slot].texture.GetGLFramebufferID();
+
+    return m_headless_texture.GetGLFramebufferID();
+  }
+
+  bool CreateHeadlessTarget();
+
+  bool StartPresentThread(bool vsync);
+  bool RunPresentThread(bool vsync);
+  void StopPresentThread(bool reattach_window);
+  bool CreatePresentSlots();
+  void DestroyPresentSlots();
+  bool PresentFromSlot(u32 slot);
+
   bool CheckPostProcessingRenderTargets(u32 target_width, u32 target_height);
   void ApplyPostProcessingChain(GLuint final_target, s32 final_left, s32 final_top, s32 final_width, s32 final_height,
                                 void* texture_handle, u32 texture_width, s32 texture_height, s32 texture_view_x,
@@ -114,6 +151,27 @@ protected:
   std::unique_ptr<GL::StreamBuffer> m_post_processing_ubo;
   std::vector<PostProcessingStage> m_post_processing_stages;
 
+  std::array<AsyncDownload, MAX_ASYNC_DOWNLOAD_SLOTS> m_async_downloads;
+
+  // Rendered into instead of the window when the device was created without one.
+  GL::Texture m_headless_texture;
+
+  // With threaded presentation, the main context goes surfaceless and renders frames to these, and a shared context
+  // which owns the window blits them to it on the present thread. Sync objects are shared between the contexts.
+  struct PresentSlot
+  {
+    GL::Texture texture;
+    GLsync render_fence = nullptr;
+    GLsync present_fence = nullptr;
+  };
+  std::unique_ptr<GL::Context> m_present_context;
+  DisplayPresentThread m_present_thread;
+  std::array<PresentSlot, DisplayPresentThread::NUM_SLOTS> m_present_slots;
+  u32 m_present_slot = DisplayPresentThread::INVALID_SLOT;
+
+  // framebuffer objects aren't shared, this one belongs to the present context
+  GLuint m_present_read_fbo = 0;
+
   bool m_use_gles2_draw_path = false;
 };
 
@@ -117,6 +117,9 @@ void* VulkanHostDisplay::GetRenderContext() const
 
 bool VulkanHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
 {
+  const bool was_presenting_on_thread = m_present_thread.IsRunning();
+  StopPresentThread();
+
   if (new_wi.type == WindowInfo::Type::Surfaceless)
   {
     g_vulkan_context->ExecuteCommandBuffer(true);
@@ -151,18 +154,41 @@ bool VulkanHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
   }
 #endif
 
+  if (was_presenting_on_thread)
+    StartPresentThread();
+
   return true;
 }
 
 void VulkanHostDisplay::ResizeRenderWindow(s32 new_window_width, s32 new_window_height)
 {
+  const bool was_presenting_on_thread = m_present_thread.IsRunning();
+  StopPresentThread();
   g_vulkan_context->WaitForGPUIdle();
 
-  if (!m_swap_chain->ResizeSwapChain(new_window_width, new_window_height))
-    Panic("Failed to resize swap chain");
+  if (m_swap_chain)
+  {
+    if (!m_swap_chain->ResizeSwapChain(new_window_width, new_window_height))
+      Panic("Failed to resize swap chain");
 
-  m_window_info.surface_width = m_swap_chain->GetWidth();
-  m_window_info.surface_height = m_swap_chain->GetHeight();
+    m_window_info.surface_width = m_swap_chain->GetWidth();
+    m_window_info.surface_height = m_swap_chain->GetHeight();
+
+    if (was_presenting_on_thread)
+      StartPresentThread();
+  }
+  else if (m_headless_framebuffer != VK_NULL_HANDLE)
+  {
+    // No window to follow, just recreate the offscreen target at the requested size.
+    if (new_window_width <= 0 || new_window_height <= 0)
+      return;
+
+    DestroyHeadlessTarget();
+    m_window_info.surface_width = static_cast<u32>(new_window_width);
+    m_window_info.surface_height = static_cast<u32>(new_window_height);
+    if (!CreateHeadlessTarget())
+      Panic("Failed to resize headless render target");
+  }
 
 #ifdef WITH_IMGUI
   if (ImGui::GetCurrentContext())
@@ -191,6 +217,7 @@ bool VulkanHostDisplay::SetFullscreen(bool fullscreen, u32 width, u32 height, fl
 void VulkanHostDisplay::DestroyRenderSurface()
 {
   m_window_info = {};
+  StopPresentThread();
   g_vulkan_context->WaitForGPUIdle();
   m_swap_chain.reset();
 }
@@ -246,6 +273,53 @@ bool VulkanHostDisplay::DownloadTexture(const void* texture_handle, HostDisplayP
   return true;
 }
 
+bool VulkanHostDisplay::BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format,
+                                           u32 x, u32 y, u32 width, u32 height)
+{
+  Vulkan::Texture* texture = static_cast<Vulkan::Texture*>(const_cast<void*>(texture_handle));
+
+  AsyncDownload& dl = m_async_downloads[slot];
+  dl.pending = false;
+  if (!dl.texture.IsValid() || dl.format != texture->GetFormat() || dl.texture.GetWidth() < width ||
+      dl.texture.GetHeight() < height)
+  {
+    // the slot's previous copy may still be in flight
+    dl.texture.Destroy(true);
+    if (!dl.texture.Create(Vulkan::StagingBuffer::Type::Readback, texture->GetFormat(), width, height))
+      return false;
+
+    dl.format = texture->GetFormat();
+  }
+
+  // recorded into the current command buffer, ReadTexels() only waits if that hasn't completed yet
+  dl.texture.CopyFromTexture(*texture, x, y, 0, 0, 0, 0, width, height);
+  dl.width = width;
+  dl.height = height;
+  dl.pending = true;
+  return true;
+}
+
+bool VulkanHostDisplay::EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride)
+{
+  AsyncDownload& dl = m_async_downloads[slot];
+  if (!dl.pending)
+    return false;
+
+  dl.pending = false;
+  dl.texture.ReadTexels(0, 0, dl.width, dl.height, out_data, out_data_stride);
+  return true;
+}
+
+void VulkanHostDisplay::DestroyAsyncDownloads()
+{
+  for (AsyncDownload& dl : m_async_downloads)
+  {
+    dl.texture.Destroy(false);
+    dl.format = VK_FORMAT_UNDEFINED;
+    dl.pending = false;
+  }
+}
+
 static constexpr std::array<VkFormat, static_cast<u32>(HostDisplayPixelFormat::Count)> s_display_pixel_format_mapping =
   {{VK_FORMAT_UNDEFINED, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R5G6B5_UNORM_PACK16,
     VK_FORMAT_A1R5G5B5_UNORM_PACK16}};
@@ -302,12 +376,19 @@ void VulkanHostDisplay::EndSetDisplayPixels()
 
 void VulkanHostDisplay::SetVSync(bool enabled)
 {
-  if (!m_swap_chain)
+  if (!m_swap_chain || m_swap_chain->IsVSyncEnabled() == enabled)
     return;
 
+  // The present thread paces itself differently with vsync, so it's restarted along with the swap chain.
+  const bool was_presenting_on_thread = m_present_thread.IsRunning();
+  StopPresentThread();
+
   // This swap chain should not be used by the current buffer, thus safe to destroy.
   g_vulkan_context->WaitForGPUIdle();
   m_swap_chain->SetVSync(enabled);
+
+  if (was_presenting_on_thread)
+    StartPresentThread();
 }
 
 bool VulkanHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, bool debug_device,
@@ -325,10 +406,209 @@ bool VulkanHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_vie
     m_window_info.surface_width = m_swap_chain->GetWidth();
     m_window_info.surface_height = m_swap_chain->GetHeight();
   }
+  else if (wi.type == WindowInfo::Type::Surfaceless && !CreateHeadlessTarget())
+  {
+    Log_ErrorPrintf("Failed to create headless render target");
+    Vulkan::Context::Destroy();
+    return false;
+  }
+
+  return true;
+}
+
+bool VulkanHostDisplay::CreateHeadlessTarget()
+{
+  if (m_window_info.surface_width == 0 || m_window_info.surface_height == 0)
+  {
+    m_window_info.surface_width = DEFAULT_HEADLESS_WIDTH;
+    m_window_info.surface_height = DEFAULT_HEADLESS_HEIGHT;
+  }
 
+  static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+  m_headless_render_pass =
+    g_vulkan_context->GetRenderPass(format, VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_CLEAR);
+  if (m_headless_render_pass == VK_NULL_HANDLE ||
+      !m_headless_texture.Create(m_window_info.surface_width, m_window_info.surface_height, 1, 1, format,
+                                 VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ||
+      (m_headless_framebuffer = m_headless_texture.CreateFramebuffer(m_headless_render_pass)) == VK_NULL_HANDLE)
+  {
+    DestroyHeadlessTarget();
+    return false;
+  }
+
+  Log_InfoPrintf("Rendering headless to a %ux%u target", m_window_info.surface_width, m_window_info.surface_height);
   return true;
 }
 
+void VulkanHostDisplay::DestroyHeadlessTarget()
+{
+  Vulkan::Util::SafeDestroyFramebuffer(m_headless_framebuffer);
+  m_headless_texture.Destroy(false);
+  m_headless_render_pass = VK_NULL_HANDLE;
+}
+
+bool VulkanHostDisplay::StartPresentThread()
+{
+  if (!m_swap_chain->CanCopyToImages())
+  {
+    Log_WarningPrintf("Swap chain images can't be copied to, presenting without a thread");
+    return false;
+  }
+
+  const VkDevice device = g_vulkan_context->GetDevice();
+  const VkCommandPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr, 0,
+                                             g_vulkan_context->GetGraphicsQueueFamilyIndex()};
+  VkResult res = vkCreateCommandPool(device, &pool_info, nullptr, &m_present_command_pool);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreateCommandPool failed: ");
+    return false;
+  }
+
+  const VkCommandBufferAllocateInfo buffer_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, nullptr,
+                                                   m_present_command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1};
+  res = vkAllocateCommandBuffers(device, &buffer_info, &m_present_command_buffer);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkAllocateCommandBuffers failed: ");
+    DestroyPresentThreadResources();
+    return false;
+  }
+
+  const VkFenceCreateInfo fence_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0};
+  res = vkCreateFence(device, &fence_info, nullptr, &m_present_fence);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreateFence failed: ");
+    DestroyPresentThreadResources();
+    return false;
+  }
+
+  for (PresentSlot& slot : m_present_slots)
+  {
+    if (!slot.texture.Create(m_swap_chain->GetWidth(), m_swap_chain->GetHeight(), 1, 1,
+                             m_swap_chain->GetTextureFormat(), VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D,
+                             VK_IMAGE_TILING_OPTIMAL,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ||
+        (slot.framebuffer = slot.texture.CreateFramebuffer(m_swap_chain->GetClearRenderPass())) == VK_NULL_HANDLE)
+    {
+      Log_ErrorPrintf("Failed to create present slot");
+      DestroyPresentThreadResources();
+      return false;
+    }
+  }
+
+  if (!m_present_thread.Start(m_swap_chain->IsVSyncEnabled(), [this](u32 slot) { return PresentFromSlot(slot); }))
+  {
+    DestroyPresentThreadResources();
+    return false;
+  }
+
+  return true;
+}
+
+void VulkanHostDisplay::StopPresentThread()
+{
+  if (!m_present_thread.IsRunning())
+    return;
+
+  m_present_thread.Stop();
+  m_present_swap_chain_out_of_date.store(false);
+
+  // Frames which were queued but not shown may still be rendering to the slots.
+  g_vulkan_context->WaitForGPUIdle();
+  DestroyPresentThreadResources();
+}
+
+void VulkanHostDisplay::DestroyPresentThreadResources()
+{
+  for (PresentSlot& slot : m_present_slots)
+  {
+    Vulkan::Util::SafeDestroyFramebuffer(slot.framebuffer);
+    slot.texture.Destroy(false);
+  }
+
+  const VkDevice device = g_vulkan_context->GetDevice();
+  if (m_present_fence != VK_NULL_HANDLE)
+  {
+    vkDestroyFence(device, m_present_fence, nullptr);
+    m_present_fence = VK_NULL_HANDLE;
+  }
+  if (m_present_command_pool != VK_NULL_HANDLE)
+  {
+    vkDestroyCommandPool(device, m_present_command_pool, nullptr);
+    m_present_command_pool = VK_NULL_HANDLE;
+    m_present_command_buffer = VK_NULL_HANDLE;
+  }
+}
+
+bool VulkanHostDisplay::PresentFromSlot(u32 slot)
+{
+  // Runs on the present thread. The emulation thread leaves the swap chain alone while it's running.
+  VkResult res = m_swap_chain->AcquireNextImage();
+  if (res == VK_SUBOPTIMAL_KHR || res == VK_ERROR_OUT_OF_DATE_KHR)
+    m_present_swap_chain_out_of_date.store(true);
+  if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR)
+  {
+    if (res != VK_ERROR_OUT_OF_DATE_KHR)
+      LOG_VULKAN_ERROR(res, "vkAcquireNextImageKHR() failed: ");
+
+    return false;
+  }
+
+  const VkDevice device = g_vulkan_context->GetDevice();
+  res = vkResetCommandPool(device, m_present_command_pool, 0);
+  if (res != VK_SUCCESS)
+    LOG_VULKAN_ERROR(res, "vkResetCommandPool failed: ");
+
+  const VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
+                                               VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr};
+  res = vkBeginCommandBuffer(m_present_command_buffer, &begin_info);
+  if (res != VK_SUCCESS)
+    LOG_VULKAN_ERROR(res, "vkBeginCommandBuffer failed: ");
+
+  // Render() left the slot in transfer source layout.
+  const Vulkan::Texture& src_texture = m_present_slots[slot].texture;
+  Vulkan::Texture& dst_texture = m_swap_chain->GetCurrentTexture();
+  dst_texture.OverrideImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+  dst_texture.TransitionToLayout(m_present_command_buffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  const VkImageCopy region = {{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+                              {0, 0, 0},
+                              {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+                              {0, 0, 0},
+                              {src_texture.GetWidth(), src_texture.GetHeight(), 1}};
+  vkCmdCopyImage(m_present_command_buffer, src_texture.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                 dst_texture.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  dst_texture.TransitionToLayout(m_present_command_buffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+  res = vkEndCommandBuffer(m_present_command_buffer);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkEndCommandBuffer failed: ");
+    Panic("Failed to end command buffer");
+  }
+
+  const VkResult present_res = g_vulkan_context->SubmitAndPresent(
+    m_present_command_buffer, m_present_fence, m_swap_chain->GetImageAvailableSemaphore(),
+    VK_PIPELINE_STAGE_TRANSFER_BIT, m_swap_chain->GetRenderingFinishedSemaphore(), m_swap_chain->GetSwapChain(),
+    m_swap_chain->GetCurrentImageIndex());
+  if (present_res == VK_ERROR_OUT_OF_DATE_KHR || present_res == VK_SUBOPTIMAL_KHR)
+    m_present_swap_chain_out_of_date.store(true);
+
+  // The slot can be rendered to again once the copy is done.
+  res = vkWaitForFences(device, 1, &m_present_fence, VK_TRUE, UINT64_MAX);
+  if (res != VK_SUCCESS)
+    LOG_VULKAN_ERROR(res, "vkWaitForFences failed: ");
+  vkResetFences(device, 1, &m_present_fence);
+
+  // Suboptimal images are still shown.
+  return (present_res == VK_SUCCESS || present_res == VK_SUBOPTIMAL_KHR);
+}
+
 bool VulkanHostDisplay::InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device,
                                                bool threaded_presentation)
 {
@@ -342,6 +622,10 @@ bool VulkanHostDisplay::InitializeRenderDevice(std::string_view shader_cache_dir
     return false;
 #endif
 
+  // Falls back to presenting from Render() if the thread can't be used.
+  if (threaded_presentation && m_swap_chain)
+    StartPresentThread();
+
   return true;
 }
 
@@ -352,12 +636,12 @@ bool VulkanHostDisplay::HasRenderDevice() const
 
 bool VulkanHostDisplay::HasRenderSurface() const
 {
-  return static_cast<bool>(m_swap_chain);
+  return (m_swap_chain || m_headless_framebuffer != VK_NULL_HANDLE);
 }
 
 VkRenderPass VulkanHostDisplay::GetRenderPassForDisplay() const
 {
-  return m_swap_chain->GetClearRenderPass();
+  return GetOutputRenderPass();
 }
 
 bool VulkanHostDisplay::CreateResources()
@@ -513,6 +797,7 @@ void VulkanHostDisplay::DestroyResources()
   m_display_pixels_texture.Destroy(false);
   m_readback_staging_texture.Destroy(false);
   m_upload_staging_texture.Destroy(false);
+  DestroyAsyncDownloads();
 
   Vulkan::Util::SafeDestroyPipeline(m_display_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_cursor_pipeline);
@@ -534,6 +819,7 @@ void VulkanHostDisplay::DestroyRenderDevice()
   if (!g_vulkan_context)
     return;
 
+  StopPresentThread();
   g_vulkan_context->WaitForGPUIdle();
 
 #ifdef WITH_IMGUI
@@ -542,6 +828,7 @@ void VulkanHostDisplay::DestroyRenderDevice()
 #endif
 
   DestroyResources();
+  DestroyHeadlessTarget();
 
   Vulkan::ShaderCache::Destroy();
   DestroyRenderSurface();
@@ -571,11 +858,11 @@ bool VulkanHostDisplay::CreateImGuiContext()
   vii.QueueFamily = g_vulkan_context->GetGraphicsQueueFamilyIndex();
   vii.Queue = g_vulkan_context->GetGraphicsQueue();
   vii.PipelineCache = g_vulkan_shader_cache->GetPipelineCache();
-  vii.MinImageCount = m_swap_chain->GetImageCount();
-  vii.ImageCount = m_swap_chain->GetImageCount();
+  vii.MinImageCount = m_swap_chain ? m_swap_chain->GetImageCount() : 2;
+  vii.ImageCount = vii.MinImageCount;
   vii.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
-  if (!ImGui_ImplVulkan_Init(&vii, m_swap_chain->GetClearRenderPass()) ||
+  if (!ImGui_ImplVulkan_Init(&vii, GetOutputRenderPass()) ||
       !ImGui_ImplVulkan_CreateFontsTexture(g_vulkan_context->GetCurrentCommandBuffer()))
   {
     return false;
@@ -602,32 +889,50 @@ bool VulkanHostDisplay::Render()
     return false;
   }
 
-  VkResult res = m_swap_chain->AcquireNextImage();
-  if (res != VK_SUCCESS)
+  // The present thread can't recreate the swap chain itself.
+  if (m_present_thread.IsRunning() && m_present_swap_chain_out_of_date.load())
+    ResizeRenderWindow(0, 0);
+
+  if (m_present_thread.IsRunning())
+  {
+    m_present_slot = m_present_thread.AcquireSlot();
+  }
+  else if (m_swap_chain)
   {
-    if (res == VK_SUBOPTIMAL_KHR || res == VK_ERROR_OUT_OF_DATE_KHR)
+    VkResult res = m_swap_chain->AcquireNextImage();
+    if (res != VK_SUCCESS)
     {
-      ResizeRenderWindow(0, 0);
-      res = m_swap_chain->AcquireNextImage();
-    }
+      if (res == VK_SUBOPTIMAL_KHR || res == VK_ERROR_OUT_OF_DATE_KHR)
+      {
+        ResizeRenderWindow(0, 0);
+        res = m_swap_chain->AcquireNextImage();
+      }
 
-    // This can happen when multiple resize events happen in quick succession.
-    // In this case, just wait until the next frame to try again.
-    if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR)
-    {
-      // Still submit the command buffer, otherwise we'll end up with several frames waiting.
-      LOG_VULKAN_ERROR(res, "vkAcquireNextImageKHR() failed: ");
-      g_vulkan_context->ExecuteCommandBuffer(false);
-      return false;
+      // This can happen when multiple resize events happen in quick succession.
+      // In this case, just wait until the next frame to try again.
+      if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR)
+      {
+        // Still submit the command buffer, otherwise we'll end up with several frames waiting.
+        LOG_VULKAN_ERROR(res, "vkAcquireNextImageKHR() failed: ");
+        g_vulkan_context->ExecuteCommandBuffer(false);
+        return false;
+      }
     }
   }
+  else if (m_headless_framebuffer == VK_NULL_HANDLE)
+  {
+    return false;
+  }
 
   VkCommandBuffer cmdbuffer = g_vulkan_context->GetCurrentCommandBuffer();
-  Vulkan::Texture& swap_chain_texture = m_swap_chain->GetCurrentTexture();
+  Vulkan::Texture& output_texture =
+    (m_present_slot != DisplayPresentThread::INVALID_SLOT) ?
+      m_present_slots[m_present_slot].texture :
+      (m_swap_chain ? m_swap_chain->GetCurrentTexture() : m_headless_texture);
 
-  // Swap chain images start in undefined
-  swap_chain_texture.OverrideImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
-  swap_chain_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  // Swap chain images start in undefined, and the slots and headless target are cleared anyway
+  output_texture.OverrideImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+  output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
   RenderDisplay();
 
@@ -640,11 +945,28 @@ bool VulkanHostDisplay::Render()
 
   vkCmdEndRenderPass(cmdbuffer);
 
-  swap_chain_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-
-  g_vulkan_context->SubmitCommandBuffer(m_swap_chain->GetImageAvailableSemaphore(),
-                                        m_swap_chain->GetRenderingFinishedSemaphore(), m_swap_chain->GetSwapChain(),
-                                        m_swap_chain->GetCurrentImageIndex(), !m_swap_chain->IsVSyncEnabled());
+  if (m_present_slot != DisplayPresentThread::INVALID_SLOT)
+  {
+    // The present thread copies it to the swap chain once this command buffer has been submitted.
+    output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    g_vulkan_context->SubmitCommandBuffer();
+    m_present_thread.PublishSlot(m_present_slot, m_next_frame_timestamps);
+    m_present_slot = DisplayPresentThread::INVALID_SLOT;
+    m_next_frame_timestamps = {};
+  }
+  else if (m_swap_chain)
+  {
+    output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    g_vulkan_context->SubmitCommandBuffer(m_swap_chain->GetImageAvailableSemaphore(),
+                                          m_swap_chain->GetRenderingFinishedSemaphore(), m_swap_chain->GetSwapChain(),
+                                          m_swap_chain->GetCurrentImageIndex(), !m_swap_chain->IsVSyncEnabled());
+  }
+  else
+  {
+    // Nothing to present to, leave the image readable for whoever wants the output.
+    output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    g_vulkan_context->SubmitCommandBuffer();
+  }
   g_vulkan_context->MoveToNextCommandBuffer();
 
 #ifdef WITH_IMGUI
@@ -655,14 +977,47 @@ bool VulkanHostDisplay::Render()
   return true;
 }
 
+float VulkanHostDisplay::GetMeasuredRefreshRate() const
+{
+  return m_present_thread.GetMeasuredRefreshRate();
+}
+
+bool VulkanHostDisplay::GetPresentedFrames(std::vector<FrameTimestamps>* frames)
+{
+  if (!m_present_thread.IsRunning())
+    return false;
+
+  m_present_thread.GetPresentedFrames(frames);
+  return true;
+}
+
+bool VulkanHostDisplay::DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height)
+{
+  if (m_headless_framebuffer == VK_NULL_HANDLE)
+    return false;
+
+  const u32 output_width = m_headless_texture.GetWidth();
+  const u32 output_height = m_headless_texture.GetHeight();
+  pixels->resize(output_width * output_height);
+  if (!DownloadTexture(&m_headless_texture, HostDisplayPixelFormat::RGBA8, 0, 0, output_width, output_height,
+                       pixels->data(), output_width * sizeof(u32)))
+  {
+    return false;
+  }
+
+  *width = output_width;
+  *height = output_height;
+  return true;
+}
+
 void VulkanHostDisplay::BeginSwapChainRenderPass(VkFramebuffer framebuffer)
 {
   const VkClearValue clear_value = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
   const VkRenderPassBeginInfo rp = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
                                     nullptr,
-                                    m_swap_chain->GetClearRenderPass(),
+                                    GetOutputRenderPass(),
                                     framebuffer,
-                                    {{0, 0}, {m_swap_chain->GetWidth(), m_swap_chain->GetHeight()}},
+                                    {{0, 0}, {GetOutputWidth(), GetOutputHeight()}},
                                     1u,
                                     &clear_value};
   vkCmdBeginRenderPass(g_vulkan_context->GetCurrentCommandBuffer(), &rp, VK_SUBPASS_CONTENTS_INLINE);
@@ -672,7 +1027,7 @@ void VulkanHostDisplay::RenderDisplay()
 {
   if (!HasDisplayTexture())
   {
-    BeginSwapChainRenderPass(m_swap_chain->GetCurrentFramebuffer());
+    BeginSwapChainRenderPass(GetOutputFramebuffer());
     return;
   }
 
@@ -686,7 +1041,7 @@ void VulkanHostDisplay::RenderDisplay()
     return;
   }
 
-  BeginSwapChainRenderPass(m_swap_chain->GetCurrentFramebuffer());
+  BeginSwapChainRenderPass(GetOutputFramebuffer());
   RenderDisplay(left, top, width, height, m_display_texture_handle, m_display_texture_width, m_display_texture_height,
                 m_display_texture_view_x, m_display_texture_view_y, m_display_texture_view_width,
                 m_display_texture_view_height, m_display_linear_filtering);
@@ -909,7 +1264,7 @@ bool VulkanHostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 t
       m_post_processing_input_framebuffer = VK_NULL_HANDLE;
     }
 
-    if (!m_post_processing_input_texture.Create(target_width, target_height, 1, 1, m_swap_chain->GetTextureFormat(),
+    if (!m_post_processing_input_texture.Create(target_width, target_height, 1, 1, GetOutputFormat(),
                                                 VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
                                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) ||
         (m_post_processing_input_framebuffer =
@@ -931,7 +1286,7 @@ bool VulkanHostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 t
         pps.output_framebuffer = VK_NULL_HANDLE;
       }
 
-      if (!pps.output_texture.Create(target_width, target_height, 1, 1, m_swap_chain->GetTextureFormat(),
+      if (!pps.output_texture.Create(target_width, target_height, 1, 1, GetOutputFormat(),
                                      VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
                                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) ||
           (pps.output_framebuffer = pps.output_texture.CreateFramebuffer(GetRenderPassForDisplay())) == VK_NULL_HANDLE)
@@ -949,9 +1304,9 @@ void VulkanHostDisplay::ApplyPostProcessingChain(s32 final_left, s32 final_top,
                                                  s32 texture_view_x, s32 texture_view_y, s32 texture_view_width,
                                                  s32 texture_view_height)
 {
-  if (!CheckPostProcessingRenderTargets(m_swap_chain->GetWidth(), m_swap_chain->GetHeight()))
+  if (!CheckPostProcessingRenderTargets(GetOutputWidth(), GetOutputHeight()))
   {
-    BeginSwapChainRenderPass(m_swap_chain->GetCurrentFramebuffer());
+    BeginSwapChainRenderPass(GetOutputFramebuffer());
     RenderDisplay(final_left, final_top, final_width, final_height, texture_handle, texture_width, texture_height,
                   texture_view_x, texture_view_y, texture_view_width, texture_view_height, m_display_linear_filtering);
     return;
@@ -985,7 +1340,7 @@ void VulkanHostDisplay::ApplyPostProcessingChain(s32 final_left, s32 final_top,
     }
     else
     {
-      BeginSwapChainRenderPass(m_swap_chain->GetCurrentFramebuffer());
+      BeginSwapChainRenderPass(GetOutputFramebuffer());
     }
 
     const bool use_push_constants = m_post_processing_chain.GetShaderStage(i).UsePushConstants();
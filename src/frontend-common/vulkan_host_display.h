@@ -4,8 +4,11 @@
 #include "common/vulkan/swap_chain.h"
 #include "common/window_info.h"
 #include "core/host_display.h"
+#include "display_present_thread.h"
 #include "postprocessing_chain.h"
 #include "vulkan_loader.h"
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string_view>
 
@@ -53,6 +56,10 @@ public:
                      u32 texture_data_stride) override;
   bool DownloadTexture(const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y, u32 width,
                        u32 height, void* out_data, u32 out_data_stride) override;
+  bool BeginAsyncDownload(u32 slot, const void* texture_handle, HostDisplayPixelFormat texture_format, u32 x, u32 y,
+                          u32 width, u32 height) override;
+  bool EndAsyncDownload(u32 slot, void* out_data, u32 out_data_stride) override;
+  void DestroyAsyncDownloads() override;
 
   bool SupportsDisplayPixelFormat(HostDisplayPixelFormat format) const override;
   bool BeginSetDisplayPixels(HostDisplayPixelFormat format, u32 width, u32 height, void** out_buffer,
@@ -62,6 +69,9 @@ public:
   virtual void SetVSync(bool enabled) override;
 
   virtual bool Render() override;
+  float GetMeasuredRefreshRate() const override;
+  bool GetPresentedFrames(std::vector<FrameTimestamps>* frames) override;
+  bool DownloadHeadlessOutput(std::vector<u32>* pixels, u32* width, u32* height) override;
 
   static std::vector<std::string> EnumerateAdapterNames();
 
@@ -86,6 +96,39 @@ protected:
     u32 uniforms_size = 0;
   };
 
+  /// The swap chain, or the offscreen target when running headless.
+  ALWAYS_INLINE VkRenderPass GetOutputRenderPass() const
+  {
+    return m_swap_chain ? m_swap_chain->GetClearRenderPass() : m_headless_render_pass;
+  }
+  ALWAYS_INLINE VkFramebuffer GetOutputFramebuffer() const
+  {
+    if (m_present_slot != DisplayPresentThread::INVALID_SLOT)
+      return m_present_slots[m_present_slot].framebuffer;
+
+    return m_swap_chain ? m_swap_chain->GetCurrentFramebuffer() : m_headless_framebuffer;
+  }
+  ALWAYS_INLINE VkFormat GetOutputFormat() const
+  {
+    return m_swap_chain ? m_swap_chain->GetTextureFormat() : m_headless_texture.GetFormat();
+  }
+  ALWAYS_INLINE u32 GetOutputWidth() const
+  {
+    return m_swap_chain ? m_swap_chain->GetWidth() : m_headless_texture.GetWidth();
+  }
+  ALWAYS_INLINE u32 GetOutputHeight() const
+  {
+    return m_swap_chain ? m_swap_chain->GetHeight() : m_headless_texture.GetHeight();
+  }
+
+  bool CreateHeadlessTarget();
+  void DestroyHeadlessTarget();
+
+  bool StartPresentThread();
+  void StopPresentThread();
+  void DestroyPresentThreadResources();
+  bool PresentFromSlot(u32 slot);
+
   bool CheckPostProcessingRenderTargets(u32 target_width, u32 target_height);
   void ApplyPostProcessingChain(s32 final_left, s32 final_top, s32 final_width, s32 final_height, void* texture_handle,
                                 u32 texture_width, s32 texture_height, s32 texture_view_x, s32 texture_view_y,
@@ -112,6 +155,28 @@ protected:
 
   std::unique_ptr<Vulkan::SwapChain> m_swap_chain;
 
+  // Rendered into instead of the swap chain when the device was created without a window.
+  Vulkan::Texture m_headless_texture;
+  VkRenderPass m_headless_render_pass = VK_NULL_HANDLE;
+  VkFramebuffer m_headless_framebuffer = VK_NULL_HANDLE;
+
+  // With threaded presentation, frames are rendered to these in the swap chain format, and the present thread copies
+  // them to the swap chain with its own command buffer.
+  struct PresentSlot
+  {
+    Vulkan::Texture texture;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  };
+  DisplayPresentThread m_present_thread;
+  std::array<PresentSlot, DisplayPresentThread::NUM_SLOTS> m_present_slots;
+  u32 m_present_slot = DisplayPresentThread::INVALID_SLOT;
+  VkCommandPool m_present_command_pool = VK_NULL_HANDLE;
+  VkCommandBuffer m_present_command_buffer = VK_NULL_HANDLE;
+  VkFence m_present_fence = VK_NULL_HANDLE;
+
+  // set by the present thread, the swap chain is recreated by the next Render()
+  std::atomic_bool m_present_swap_chain_out_of_date{false};
+
   VkDescriptorSetLayout m_descriptor_set_layout = VK_NULL_HANDLE;
   VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
   VkPipeline m_cursor_pipeline = VK_NULL_HANDLE;
@@ -123,6 +188,16 @@ protected:
   Vulkan::StagingTexture m_upload_staging_texture;
   Vulkan::StagingTexture m_readback_staging_texture;
 
+  struct AsyncDownload
+  {
+    Vulkan::StagingTexture texture;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    u32 width = 0;
+    u32 height = 0;
+    bool pending = false;
+  };
+  std::array<AsyncDownload, MAX_ASYNC_DOWNLOAD_SLOTS> m_async_downloads;
+
   VkDescriptorSetLayout m_post_process_descriptor_set_layout = VK_NULL_HANDLE;
   VkDescriptorSetLayout m_post_process_ubo_descriptor_set_layout = VK_NULL_HANDLE;
   VkPipelineLayout m_post_process_pipeline_layout = VK_NULL_HANDLE;
@@ -0,0 +1,369 @@
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "core/bus.h"
+#include "core/gpu.h"
+#include "core/settings.h"
+#include "core/timing_event.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+static constexpr u32 DEFAULT_ITERATIONS = 200;
+static constexpr u32 DEFAULT_PRIMITIVES = 4000;
+static constexpr u32 SYNTHETIC_OT_ENTRIES = 2048;
+static constexpr u32 SYNTHETIC_OT_ADDRESS = 0x100000;
+static constexpr u32 SYNTHETIC_PACKET_ADDRESS = 0x1000;
+static constexpr u32 MAX_LIST_NODES = 1024 * 1024;
+
+namespace {
+
+// Decodes GP0 commands without rasterizing, so the timings only cover the DMA and command processing paths.
+class BenchmarkGPU final : public GPU
+{
+public:
+  BenchmarkGPU() : m_vram(VRAM_WIDTH * VRAM_HEIGHT) { m_vram_ptr = m_vram.data(); }
+
+  bool IsHardwareRenderer() const override { return false; }
+
+  void Prepare()
+  {
+    Reset();
+    std::fill(m_vram.begin(), m_vram.end(), static_cast<u16>(0));
+    m_stats = {};
+
+    // GP1(04h): DMA direction CPU->GP0
+    WriteRegister(0x04, 0x04000002u);
+  }
+
+  void BeginList()
+  {
+    // The command tick event never runs here, so don't let the run-ahead limit stall the list.
+    m_pending_command_ticks = 0;
+    m_max_run_ahead = std::numeric_limits<TickCount>::max() / 2;
+  }
+
+  const std::vector<u16>& GetVRAM() const { return m_vram; }
+  u32 GetNumPolygons() const { return m_stats.num_polygons; }
+  u32 GetNumVertices() const { return m_stats.num_vertices; }
+  u32 GetNumDirectWords() const { return m_stats.num_dma_direct_words; }
+  u32 GetNumFIFOWords() const { return m_stats.num_dma_fifo_words; }
+
+private:
+  std::vector<u16> m_vram;
+};
+
+struct ListNode
+{
+  u32 address;
+  u32 word_count;
+};
+
+} // namespace
+
+static u32 ReadRAMWord(u32 address)
+{
+  u32 value;
+  std::memcpy(&value, &Bus::g_ram[address & Bus::RAM_MASK], sizeof(value));
+  return value;
+}
+
+static void WriteRAMWord(u32 address, u32 value)
+{
+  std::memcpy(&Bus::g_ram[address & Bus::RAM_MASK], &value, sizeof(value));
+}
+
+static bool WalkList(u32 head_address, std::vector<ListNode>* nodes)
+{
+  u32 address = head_address & Bus::RAM_MASK;
+  for (u32 i = 0; i < MAX_LIST_NODES; i++)
+  {
+    const u32 header = ReadRAMWord(address);
+    const u32 word_count = header >> 24;
+    if (word_count > 0)
+      nodes->push_back({(address + 4) & Bus::RAM_MASK, word_count});
+
+    address = header & UINT32_C(0x00FFFFFF);
+    if (address & UINT32_C(0x800000))
+      return true;
+  }
+
+  std::fprintf(stderr, "Linked list at 0x%08X does not terminate after %u nodes\n", head_address, MAX_LIST_NODES);
+  return false;
+}
+
+static u32 GenerateSyntheticList(u32 num_primitives)
+{
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<u32> coord_x(0, 639);
+  std::uniform_int_distribution<u32> coord_y(0, 479);
+  std::uniform_int_distribution<u32> small_offset(0, 63);
+  std::uniform_int_distribution<u32> any_word(0, 0xFFFFFFu);
+  std::uniform_int_distribution<u32> ot_index(0, SYNTHETIC_OT_ENTRIES - 1);
+  std::uniform_int_distribution<u32> kind(0, 99);
+
+  // Cleared ordering table, as the OTC DMA channel produces it: each entry links to the previous one.
+  WriteRAMWord(SYNTHETIC_OT_ADDRESS, UINT32_C(0x00FFFFFF));
+  for (u32 i = 1; i < SYNTHETIC_OT_ENTRIES; i++)
+    WriteRAMWord(SYNTHETIC_OT_ADDRESS + i * sizeof(u32), SYNTHETIC_OT_ADDRESS + (i - 1) * sizeof(u32));
+
+  u32 packet_address = SYNTHETIC_PACKET_ADDRESS;
+  auto add_packet = [&packet_address](u32 ot_entry_address, std::initializer_list<u32> words) {
+    const u32 ot_entry = ReadRAMWord(ot_entry_address);
+    WriteRAMWord(packet_address, (static_cast<u32>(words.size()) << 24) | (ot_entry & UINT32_C(0x00FFFFFF)));
+    WriteRAMWord(ot_entry_address, (ot_entry & UINT32_C(0xFF000000)) | packet_address);
+
+    u32 address = packet_address + sizeof(u32);
+    for (const u32 word : words)
+    {
+      WriteRAMWord(address, word);
+      address += sizeof(u32);
+    }
+    packet_address = address;
+  };
+
+  auto vertex = [&]() {
+    const u32 x = coord_x(rng);
+    const u32 y = coord_y(rng);
+    return x | (y << 16);
+  };
+  auto near_vertex = [&](u32 base) {
+    const u32 x = std::min<u32>((base & 0xFFFFu) + small_offset(rng), 1023);
+    const u32 y = std::min<u32>((base >> 16) + small_offset(rng), 511);
+    return x | (y << 16);
+  };
+
+  // Drawing area and offset go at the very end of the table so they're processed first.
+  const u32 head = SYNTHETIC_OT_ADDRESS + (SYNTHETIC_OT_ENTRIES - 1) * sizeof(u32);
+  add_packet(head, {0xE3000000u, 0xE4000000u | 1023u | (511u << 10), 0xE5000000u});
+
+  for (u32 i = 0; i < num_primitives; i++)
+  {
+    const u32 ot_entry_address = SYNTHETIC_OT_ADDRESS + ot_index(rng) * sizeof(u32);
+    const u32 k = kind(rng);
+    const u32 color = any_word(rng);
+    const u32 v0 = vertex();
+    if (k < 30)
+    {
+      // textured gouraud quad
+      add_packet(ot_entry_address, {0x3C000000u | color, v0, 0x78000000u, any_word(rng), near_vertex(v0), 0x00080020u,
+                                    any_word(rng), near_vertex(v0), 0x2000u, any_word(rng), near_vertex(v0), 0x2020u});
+    }
+    else if (k < 50)
+    {
+      // textured flat quad
+      add_packet(ot_entry_address, {0x2C808080u, v0, 0x78000000u, near_vertex(v0), 0x00080020u, near_vertex(v0),
+                                    0x2000u, near_vertex(v0), 0x2020u});
+    }
+    else if (k < 65)
+    {
+      // gouraud triangle
+      add_packet(ot_entry_address, {0x30000000u | color, v0, any_word(rng), near_vertex(v0), any_word(rng),
+                                    near_vertex(v0)});
+    }
+    else if (k < 75)
+    {
+      // flat triangle
+      add_packet(ot_entry_address, {0x20000000u | color, v0, near_vertex(v0), near_vertex(v0)});
+    }
+    else if (k < 90)
+    {
+      // textured sprite, preceded by a draw mode change
+      add_packet(ot_entry_address, {0xE1000000u | (i & 0x1Fu)});
+      add_packet(ot_entry_address, {0x64808080u, v0, 0x78000000u, 0x00100010u});
+    }
+    else if (k < 98)
+    {
+      // line
+      add_packet(ot_entry_address, {0x40000000u | color, v0, near_vertex(v0)});
+    }
+    else
+    {
+      // small CPU->VRAM upload
+      const u32 x = v0 & 0x3F0u;
+      const u32 y = (v0 >> 16) & 0x1F0u;
+      const u32 ot_entry = ReadRAMWord(ot_entry_address);
+      const u32 word_count = 3 + (16 * 8) / 2;
+      WriteRAMWord(packet_address, (word_count << 24) | (ot_entry & UINT32_C(0x00FFFFFF)));
+      WriteRAMWord(ot_entry_address, (ot_entry & UINT32_C(0xFF000000)) | packet_address);
+      WriteRAMWord(packet_address + 4, 0xA0000000u);
+      WriteRAMWord(packet_address + 8, x | (y << 16));
+      WriteRAMWord(packet_address + 12, 16u | (8u << 16));
+      for (u32 j = 3; j < word_count; j++)
+        WriteRAMWord(packet_address + 4 + j * sizeof(u32), any_word(rng));
+      packet_address += (word_count + 1) * sizeof(u32);
+    }
+
+    if (packet_address >= SYNTHETIC_OT_ADDRESS - 256)
+    {
+      std::fprintf(stderr, "Synthetic list truncated to %u primitives\n", i + 1);
+      break;
+    }
+  }
+
+  return head;
+}
+
+static void RunPerWord(BenchmarkGPU& gpu, const std::vector<ListNode>& nodes)
+{
+  gpu.BeginList();
+  for (const ListNode& node : nodes)
+  {
+    if (!gpu.BeginDMAWrite())
+      continue;
+
+    u32 address = node.address;
+    for (u32 i = 0; i < node.word_count; i++)
+    {
+      gpu.DMAWrite(address, ReadRAMWord(address));
+      address = (address + sizeof(u32)) & Bus::RAM_MASK;
+    }
+    gpu.EndDMAWrite();
+  }
+}
+
+static void RunBlock(BenchmarkGPU& gpu, const std::vector<ListNode>& nodes)
+{
+  gpu.BeginList();
+  for (const ListNode& node : nodes)
+  {
+    if (!gpu.BeginDMAWrite())
+      continue;
+
+    if ((node.address + (node.word_count * sizeof(u32))) <= Bus::RAM_SIZE)
+    {
+      gpu.DMAWriteBlock(node.address, node.word_count);
+    }
+    else
+    {
+      u32 address = node.address;
+      for (u32 i = 0; i < node.word_count; i++)
+      {
+        gpu.DMAWrite(address, ReadRAMWord(address));
+        address = (address + sizeof(u32)) & Bus::RAM_MASK;
+      }
+    }
+    gpu.EndDMAWrite();
+  }
+}
+
+template<typename T>
+static double TimeRuns(BenchmarkGPU& gpu, const std::vector<ListNode>& nodes, u32 iterations, const T& run)
+{
+  gpu.Prepare();
+  run(gpu, nodes);
+
+  Common::Timer timer;
+  for (u32 i = 0; i < iterations; i++)
+    run(gpu, nodes);
+
+  return timer.GetTimeMilliseconds() / static_cast<double>(iterations);
+}
+
+static void PrintUsage(const char* progname)
+{
+  std::fprintf(stderr, "Usage:\n");
+  std::fprintf(stderr, "  %s [-i <iterations>] [-n <primitives>]\n", progname);
+  std::fprintf(stderr, "    Benchmarks a synthetic ordering table (default: %u primitives, %u iterations).\n",
+               DEFAULT_PRIMITIVES, DEFAULT_ITERATIONS);
+  std::fprintf(stderr, "  %s [-i <iterations>] <ram.bin> <list head address>\n", progname);
+  std::fprintf(stderr, "    Benchmarks an ordering table from a RAM dump (Debug -> Dump RAM).\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_WARNING);
+
+  u32 iterations = DEFAULT_ITERATIONS;
+  u32 num_primitives = DEFAULT_PRIMITIVES;
+  std::vector<const char*> args;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "-i") == 0 && (i + 1) < argc)
+      iterations = std::max(static_cast<u32>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+    else if (std::strcmp(argv[i], "-n") == 0 && (i + 1) < argc)
+      num_primitives = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+    else if (argv[i][0] == '-')
+    {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    else
+      args.push_back(argv[i]);
+  }
+  if (!args.empty() && args.size() != 2)
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<u8> ram(Bus::RAM_SIZE);
+  Bus::g_ram = ram.data();
+
+  u32 head_address;
+  if (args.empty())
+  {
+    head_address = GenerateSyntheticList(num_primitives);
+  }
+  else
+  {
+    std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(args[0]);
+    if (!data.has_value() || data->empty())
+    {
+      std::fprintf(stderr, "Failed to read '%s'\n", args[0]);
+      return EXIT_FAILURE;
+    }
+
+    std::memcpy(ram.data(), data->data(), std::min(data->size(), ram.size()));
+    head_address = static_cast<u32>(std::strtoul(args[1], nullptr, 16));
+  }
+
+  std::vector<ListNode> nodes;
+  if (!WalkList(head_address, &nodes))
+    return EXIT_FAILURE;
+
+  u32 total_words = 0;
+  for (const ListNode& node : nodes)
+    total_words += node.word_count;
+  std::printf("List at 0x%08X: %zu packets, %u words\n", head_address, nodes.size(), total_words);
+
+  TimingEvents::Initialize();
+
+  BenchmarkGPU per_word_gpu;
+  BenchmarkGPU block_gpu;
+  if (!per_word_gpu.Initialize(nullptr) || !block_gpu.Initialize(nullptr))
+  {
+    std::fprintf(stderr, "Failed to initialize GPU\n");
+    return EXIT_FAILURE;
+  }
+
+  // Both paths must leave the GPU in the same state.
+  per_word_gpu.Prepare();
+  RunPerWord(per_word_gpu, nodes);
+  block_gpu.Prepare();
+  RunBlock(block_gpu, nodes);
+  std::printf("Polygons: %u, vertices: %u, direct words: %u, FIFO words: %u\n", block_gpu.GetNumPolygons(),
+              block_gpu.GetNumVertices(), block_gpu.GetNumDirectWords(), block_gpu.GetNumFIFOWords());
+  if (per_word_gpu.GetVRAM() != block_gpu.GetVRAM() ||
+      per_word_gpu.GetNumPolygons() != block_gpu.GetNumPolygons() ||
+      per_word_gpu.GetNumVertices() != block_gpu.GetNumVertices())
+  {
+    std::fprintf(stderr, "Per-word and block DMA paths produced different results\n");
+    return EXIT_FAILURE;
+  }
+
+  const double per_word_ms = TimeRuns(per_word_gpu, nodes, iterations, RunPerWord);
+  const double block_ms = TimeRuns(block_gpu, nodes, iterations, RunBlock);
+  std::printf("Per-word: %.4f ms/list (%.2f ns/word)\n", per_word_ms,
+              (per_word_ms * 1000000.0) / static_cast<double>(std::max(total_words, 1u)));
+  std::printf("Block:    %.4f ms/list (%.2f ns/word)\n", block_ms,
+              (block_ms * 1000000.0) / static_cast<double>(std::max(total_words, 1u)));
+  std::printf("Speedup:  %.2fx\n", per_word_ms / block_ms);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include "common/file_system.h"
+#include "common/image.h"
+#include "common/log.h"
+#include "core/texture_pack.h"
+#include "core/texture_replacements.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct PackInput
+{
+  TextureReplacementHash hash;
+  std::string filename;
+};
+
+static bool WritePadding(std::FILE* fp, u64* position, u32 alignment)
+{
+  static constexpr u8 zeros[TexturePack::DATA_ALIGNMENT] = {};
+  const u32 padding = static_cast<u32>((alignment - (*position % alignment)) % alignment);
+  if (padding > 0 && std::fwrite(zeros, padding, 1, fp) != 1)
+    return false;
+
+  *position += padding;
+  return true;
+}
+
+static int Pack(const char* directory, const char* output_filename)
+{
+  FileSystem::FindResultsArray files;
+  FileSystem::FindFiles(directory, "*", FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_RECURSIVE, &files);
+
+  std::vector<PackInput> inputs;
+  for (FILESYSTEM_FIND_DATA& fd : files)
+  {
+    if (fd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+      continue;
+
+    PackInput input;
+    TextureReplacements::ReplacmentType type;
+    if (!TextureReplacements::ParseReplacementFilename(fd.FileName, &input.hash, &type))
+      continue;
+
+    input.filename = std::move(fd.FileName);
+    inputs.push_back(std::move(input));
+  }
+
+  std::sort(inputs.begin(), inputs.end(), [](const PackInput& lhs, const PackInput& rhs) {
+    return TexturePack::CompareHash(lhs.hash.low, lhs.hash.high, rhs.hash.low, rhs.hash.high);
+  });
+
+  std::FILE* fp = FileSystem::OpenCFile(output_filename, "wb");
+  if (!fp)
+  {
+    std::fprintf(stderr, "Failed to open output file '%s'\n", output_filename);
+    return EXIT_FAILURE;
+  }
+
+  // header gets rewritten once we know where the index is
+  TexturePack::FileHeader header = {};
+  header.magic = TexturePack::FILE_MAGIC;
+  header.version = TexturePack::FILE_VERSION;
+  u64 position = sizeof(header);
+  bool okay = (std::fwrite(&header, sizeof(header), 1, fp) == 1);
+
+  std::vector<TexturePack::IndexEntry> index;
+  index.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size() && okay; i++)
+  {
+    const PackInput& input = inputs[i];
+    if (!index.empty() && index.back().hash_low == input.hash.low && index.back().hash_high == input.hash.high)
+    {
+      std::fprintf(stderr, "Skipping duplicate replacement '%s'\n", input.filename.c_str());
+      continue;
+    }
+
+    Common::RGBA8Image image;
+    if (!Common::LoadImageFromFile(&image, input.filename.c_str()))
+    {
+      std::fprintf(stderr, "Failed to load '%s', skipping\n", input.filename.c_str());
+      continue;
+    }
+
+    okay = WritePadding(fp, &position, TexturePack::DATA_ALIGNMENT);
+
+    TexturePack::IndexEntry entry = {};
+    entry.hash_low = input.hash.low;
+    entry.hash_high = input.hash.high;
+    entry.width = image.GetWidth();
+    entry.height = image.GetHeight();
+    entry.offset = position;
+
+    const size_t size = static_cast<size_t>(image.GetByteStride()) * image.GetHeight();
+    okay = okay && (std::fwrite(image.GetPixels(), size, 1, fp) == 1);
+    position += size;
+    index.push_back(entry);
+
+    std::printf("[%zu/%zu] %s: %ux%u\n", i + 1, inputs.size(), input.filename.c_str(), entry.width, entry.height);
+  }
+
+  okay = okay && WritePadding(fp, &position, alignof(u64));
+  header.entry_count = static_cast<u32>(index.size());
+  header.index_offset = position;
+  okay = okay && (index.empty() || std::fwrite(index.data(), sizeof(TexturePack::IndexEntry), index.size(), fp) ==
+                                     index.size());
+  okay = okay && (std::fseek(fp, 0, SEEK_SET) == 0) && (std::fwrite(&header, sizeof(header), 1, fp) == 1);
+  okay = (std::fclose(fp) == 0) && okay;
+  if (!okay)
+  {
+    std::fprintf(stderr, "Failed to write '%s'\n", output_filename);
+    FileSystem::DeleteFile(output_filename);
+    return EXIT_FAILURE;
+  }
+
+  std::printf("Wrote %zu textures (%" PRIu64 " bytes) to '%s'\n", index.size(),
+              position + index.size() * sizeof(TexturePack::IndexEntry), output_filename);
+  return EXIT_SUCCESS;
+}
+
+static int List(const char* filename)
+{
+  TexturePack::Reader reader;
+  if (!reader.Open(filename))
+  {
+    std::fprintf(stderr, "Failed to open texture pack '%s'\n", filename);
+    return EXIT_FAILURE;
+  }
+
+  for (u32 i = 0; i < reader.GetEntryCount(); i++)
+  {
+    const TexturePack::IndexEntry& entry = reader.GetEntry(i);
+    std::printf("vram-write-%016" PRIx64 "%016" PRIx64 ": %ux%u at 0x%" PRIx64 "\n", entry.hash_high, entry.hash_low,
+                entry.width, entry.height, entry.offset);
+  }
+
+  std::printf("%u textures\n", reader.GetEntryCount());
+  return EXIT_SUCCESS;
+}
+
+static void PrintUsage(const char* progname)
+{
+  std::fprintf(stderr, "Usage:\n");
+  std::fprintf(stderr, "  %s pack <directory> <output.dstp>\n", progname);
+  std::fprintf(stderr, "    Decodes every replacement texture in a directory into a texture pack.\n");
+  std::fprintf(stderr, "    Place the pack at textures/<serial>.dstp in the user directory to use it.\n");
+  std::fprintf(stderr, "  %s list <pack.dstp>\n", progname);
+  std::fprintf(stderr, "    Lists the textures in a pack.\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_WARNING);
+
+  if (argc == 4 && std::strcmp(argv[1], "pack") == 0)
+    return Pack(argv[2], argv[3]);
+  else if (argc == 3 && std::strcmp(argv[1], "list") == 0)
+    return List(argv[2]);
+
+  PrintUsage(argv[0]);
+  return EXIT_FAILURE;
+}